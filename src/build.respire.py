@@ -72,6 +72,13 @@ def Build(registry, out_dir, platform, configured_toolchain,
       configured_toolchain=configured_toolchain,
       host_configured_toolchain=host_configured_toolchain)
 
+  # The googletest build replaces the include directories of the toolchain
+  # that it is given.
+  googletest_modules = registry.SubRespireExternal(
+      'stdext/src/third_party/googletest/build.respire.py', 'Build',
+      out_dir=os.path.join(out_dir, 'googletest'),
+      configured_toolchain=copy.deepcopy(configured_toolchain))
+
   platform_window_modules = registry.SubRespireExternal(
       'platform_window/build.respire.py', 'Build',
       out_dir=os.path.join(out_dir, 'platform_window'),
@@ -84,6 +91,11 @@ def Build(registry, out_dir, platform, configured_toolchain,
     os.path.join(os.path.dirname(os.path.realpath(__file__)), os.pardir)
   ]
 
+  trace_log_module = registry.SubRespireExternal(
+      'trace_log/build.respire.py', 'Build',
+      out_dir=os.path.join(out_dir, 'trace_log'),
+      configured_toolchain=configured_toolchain)
+
   renderer_modules = registry.SubRespireExternal(
       'renderer/build.respire.py', 'Build',
       out_dir=os.path.join(out_dir, 'renderer'),
@@ -92,6 +104,7 @@ def Build(registry, out_dir, platform, configured_toolchain,
       protobuf_modules=protobuf_modules,
       flatbuffers_modules=flatbuffers_modules,
       stdext_module=stdext_modules['stdext_lib'],
+      trace_log_module=trace_log_module,
       third_party_directory=os.path.abspath('third_party'))
 
   entify_modules = registry.SubRespire(
@@ -99,7 +112,8 @@ def Build(registry, out_dir, platform, configured_toolchain,
       configured_toolchain=configured_toolchain,
       platform_window_modules=platform_window_modules,
       renderer_modules=renderer_modules,
-      stdext_module=stdext_modules['stdext_lib'])
+      stdext_module=stdext_modules['stdext_lib'],
+      trace_log_module=trace_log_module)
 
   entify_modules = registry.SubRespire(
       AddEntifyDemoToModules, out_dir=out_dir,
@@ -111,12 +125,24 @@ def Build(registry, out_dir, platform, configured_toolchain,
       configured_toolchain=configured_toolchain,
       entify_modules=entify_modules)
 
+  entify_modules = registry.SubRespire(
+      AddRegistryBenchmarkToModules, out_dir=out_dir,
+      configured_toolchain=configured_toolchain,
+      entify_modules=entify_modules)
+
+  entify_modules = registry.SubRespire(
+      AddTestsToModules, out_dir=out_dir,
+      configured_toolchain=configured_toolchain,
+      entify_modules=entify_modules,
+      renderer_module=renderer_modules['renderer'],
+      googletest_modules=googletest_modules)
+
   return entify_modules
 
 
 def BuildLibWithDeps(
     registry, out_dir, configured_toolchain, platform_window_modules,
-    renderer_modules, stdext_module):
+    renderer_modules, stdext_module, trace_log_module):
   entify_modules = {}
 
   export_configured_toolchain = copy.deepcopy(configured_toolchain)
@@ -132,7 +158,8 @@ def BuildLibWithDeps(
       configured_toolchain=export_configured_toolchain,
       platform_window_module=platform_window_modules['platform_window'],
       renderer_module=renderer_modules['renderer'],
-      stdext_module=stdext_module, libb2_module=libb2_module)
+      stdext_module=stdext_module, libb2_module=libb2_module,
+      trace_log_module=trace_log_module)
 
   entify_modules['entifypp'] = registry.SubRespireExternal(
       'entifypp/build.respire.py', 'Build',
@@ -149,7 +176,7 @@ def BuildLibWithDeps(
 
 def BuildEntify(
     registry, out_dir, configured_toolchain, platform_window_module,
-    renderer_module, stdext_module, libb2_module):
+    renderer_module, stdext_module, libb2_module, trace_log_module):
   entify_module = modules.SharedLibraryModule(
       'entify', registry, out_dir, configured_toolchain,
       sources=[
@@ -161,6 +188,8 @@ def BuildEntify(
           'context.h',
           'backend.h',
           'external_reference.h',
+          'memory_accounting.cc',
+          'memory_accounting.h',
       ],
       public_include_paths=[
           'include',
@@ -169,7 +198,8 @@ def BuildEntify(
           platform_window_module,
           renderer_module,
           stdext_module,
-          libb2_module
+          libb2_module,
+          trace_log_module,
       ])
 
   entify_module.AttachPackageFile('julia/')
@@ -215,8 +245,74 @@ def AddEntifyppDemoToModules(
   return entify_modules
 
 
+def AddRegistryBenchmarkToModules(
+    registry, out_dir, configured_toolchain, entify_modules):
+  out_dir = os.path.join(out_dir, 'entify_registry_benchmark')
+  if not os.path.exists(out_dir):
+    os.makedirs(out_dir)
+
+  registry_benchmark_module = modules.ExecutableModule(
+      'entify_registry_benchmark', registry, out_dir, configured_toolchain,
+      sources = [
+        'demo/registry_benchmark_main.cc',
+      ],
+      module_dependencies=[
+        entify_modules['entify'],
+        entify_modules['renderer_protobuf_defs']
+      ])
+
+  entify_modules['entify_registry_benchmark'] = registry_benchmark_module
+
+  return entify_modules
+
+
+def AddTestsToModules(
+    registry, out_dir, configured_toolchain, entify_modules, renderer_module,
+    googletest_modules):
+  out_dir = os.path.join(out_dir, 'entify_tests')
+  if not os.path.exists(out_dir):
+    os.makedirs(out_dir)
+
+  entify_tests_module = modules.ExecutableModule(
+      'entify_tests', registry, out_dir, configured_toolchain,
+      sources = [
+        'external_reference_test.cc',
+        'renderer/gles2/deletion_queue_test.cc',
+        'renderer/gles2/etc_codec_test.cc',
+        'renderer/gles2/fake_gl_for_testing.cc',
+        'renderer/gles2/fake_gl_for_testing.h',
+        'renderer/gles2/mesh_optimizer_test.cc',
+        'renderer/gles2/pixel_conversion_test.cc',
+        'renderer/gles2/render_tree/draw_sequence_test.cc',
+        'renderer/gles2/texture_atlas_test.cc',
+        'renderer/gles2/vertex_buffer_pool_test.cc',
+      ],
+      module_dependencies=[
+        renderer_module,
+        googletest_modules['gtest_main'],
+      ])
+
+  run_entify_tests_timestamp_file = os.path.join(
+      out_dir, 'entify_tests.timestamp')
+  registry.PythonFunction(
+      inputs=[entify_tests_module.GetOutputFiles()[0]],
+      outputs=[run_entify_tests_timestamp_file],
+      function=run_with_timestamp.RunAndTimestampOnSuccess,
+      timestamp_file=run_entify_tests_timestamp_file,
+      command=[entify_tests_module.GetOutputFiles()[0]])
+
+  entify_modules['entify_tests'] = entify_tests_module
+  entify_modules['run_entify_tests'] = run_entify_tests_timestamp_file
+
+  return entify_modules
+
+
 def StartBuilds(registry, build_modules):
-  for build_module in build_modules.values():
+  for name, build_module in build_modules.items():
+    # Test runs are timestamp files rather than modules.
+    if name.startswith('run_'):
+      registry.Build(build_module)
+      continue
     for output_file in build_module.GetOutputFiles():
       registry.Build(output_file)
 
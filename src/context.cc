@@ -1,64 +1,181 @@
 #include "src/context.h"
 
+#include <algorithm>
 #include <cassert>
+#include <cmath>
+#include <string>
 #include <vector>
 
 namespace entify {
 
+namespace {
+struct LastError {
+  const Context* context = nullptr;
+  std::string message;
+};
+
+// Each producer thread sees the error from its own most recent call.
+thread_local LastError t_last_error;
+
+void SetLastError(const Context* context, const std::string& message) {
+  t_last_error.context = context;
+  t_last_error.message = message;
+}
+
+const char* NodeTypeName(EntifyNodeType node_type) {
+  switch (node_type) {
+    case kEntifyNodeTypeVertexBuffer: return "VertexBuffer";
+    case kEntifyNodeTypeUniformValues: return "UniformValues";
+    case kEntifyNodeTypeVertexShader: return "VertexShader";
+    case kEntifyNodeTypeFragmentShader: return "FragmentShader";
+    case kEntifyNodeTypePipeline: return "Pipeline";
+    case kEntifyNodeTypeDrawTree: return "DrawTree";
+    case kEntifyNodeTypeSampler: return "Sampler";
+    case kEntifyNodeTypePixelData: return "PixelData";
+    case kEntifyNodeTypeRenderTarget: return "RenderTarget";
+    case kEntifyNodeTypeIndexBuffer: return "IndexBuffer";
+    case kEntifyNodeTypeCount: break;
+  }
+  return "Unknown";
+}
+
+// Returns the |percentile|th percentile of the |field| values in |history|,
+// using the nearest-rank method.
+template <typename T>
+T FieldPercentile(const std::deque<EntifyFrameStats>& history,
+                  T EntifyFrameStats::* field, double percentile) {
+  std::vector<T> values;
+  values.reserve(history.size());
+  for (const auto& frame_stats : history) {
+    values.push_back(frame_stats.*field);
+  }
+
+  size_t rank = static_cast<size_t>(
+      std::ceil(percentile / 100.0 * values.size()));
+  size_t index = std::min(values.size() - 1, rank > 0 ? rank - 1 : 0);
+  std::nth_element(values.begin(), values.begin() + index, values.end());
+  return values[index];
+}
+}  // namespace
+
 EntifyReference Context::TryGetReferenceFromId(EntifyId id) {
-  auto found = id_lookup_.find(id);
-  if (found != id_lookup_.end()) {
-    found->second->increment_external_reference_count();
-    return found->second.get();
+  ExternalReference* found = id_lookup_.FindAndAddReference(id);
+  if (found) {
+    return found;
   }
   return kEntifyInvalidReference;
 }
 
-EntifyReference Context::CreateReferenceFromProtocolBuffer(
-    EntifyId id, const char* data, size_t data_size) {
-  last_error_.clear();
-  renderer::ParseOutput result = backend_->ParseProtocolBuffer(
-      id_lookup_, data, data_size);
+EntifyReference Context::AddParseOutput(
+    EntifyId id, renderer::ParseOutput&& result,
+    ScopedTraceEvent* trace_event) {
   if (result.value.get() == nullptr) {
-    last_error_ = result.error_message;
-    assert(!last_error_.empty());
+    SetLastError(this, result.error_message);
+    assert(!t_last_error.message.empty());
     return kEntifyInvalidReference;
   }
 
-  result.value->increment_external_reference_count();
+  SetLastError(this, std::string());
+  trace_event->AddArg(
+      "node_type", NodeTypeName(result.value->memory_usage().node_type));
+
+  ExternalReference* reference =
+      id_lookup_.InsertAndAddReference(id, &result.value);
+  if (result.value) {
+    // Another thread registered the same id while we were parsing, so use
+    // its node and discard ours.
+    std::vector<std::shared_ptr<void>> duplicate;
+    duplicate.push_back(result.value->object());
+    result.value.reset();
+    backend_->ReleaseReferences(std::move(duplicate));
+  } else {
+    memory_accounting_.AddNode(reference->memory_usage(), this);
+  }
 
-  auto insert_results =
-      id_lookup_.insert(std::make_pair(id, std::move(result.value)));
-  assert(insert_results.second);
+  return reference;
+}
 
-  return insert_results.first->second.get();
+EntifyReference Context::CreateReferenceFromProtocolBuffer(
+    EntifyId id, const char* data, size_t data_size) {
+  ScopedTraceEvent trace_event("entify", "ParseProtocolBuffer");
+  trace_event.AddArg("id", id);
+  return AddParseOutput(
+      id, backend_->ParseProtocolBuffer(id_lookup_, id, data, data_size),
+      &trace_event);
 }
 
 EntifyReference Context::CreateReferenceFromFlatBuffer(
     EntifyId id, const char* data, size_t data_size) {
-  last_error_.clear();
-  renderer::ParseOutput result = backend_->ParseFlatBuffer(
-      id_lookup_, data, data_size);
-  if (result.value.get() == nullptr) {
-    last_error_ = result.error_message;
-    assert(!last_error_.empty());
-    return kEntifyInvalidReference;
+  ScopedTraceEvent trace_event("entify", "ParseFlatBuffer");
+  trace_event.AddArg("id", id);
+  return AddParseOutput(
+      id, backend_->ParseFlatBuffer(id_lookup_, id, data, data_size),
+      &trace_event);
+}
+
+bool Context::CopyReferenceForUpdate(
+    EntifyId id, std::unique_ptr<ExternalReference>* reference) {
+  // Copy the reference out instead of calling into the backend while the
+  // lookup is locked, since the backend looks up nodes while parsing.
+  std::shared_ptr<void> object;
+  stdext::TypeId type_id;
+  if (!id_lookup_.Visit(id, [&](const ExternalReference& found) {
+        object = found.object();
+        type_id = found.type_id();
+      })) {
+    SetLastError(this, "No node with id " + std::to_string(id) + ".");
+    return false;
+  }
+
+  reference->reset(new ExternalReference(type_id, object));
+  return true;
+}
+
+int Context::UpdateUniformValues(
+    EntifyId id, const char* data, size_t data_size) {
+  std::unique_ptr<ExternalReference> reference;
+  if (!CopyReferenceForUpdate(id, &reference)) {
+    return 0;
+  }
+
+  std::string error = backend_->UpdateUniformValues(
+      *reference, data, data_size);
+  SetLastError(this, error);
+  return error.empty() ? 1 : 0;
+}
+
+int Context::UpdateTextureRegion(
+    EntifyId id, int x, int y, int width, int height, int stride_in_bytes,
+    const char* data) {
+  std::unique_ptr<ExternalReference> reference;
+  if (!CopyReferenceForUpdate(id, &reference)) {
+    return 0;
   }
 
-  result.value->increment_external_reference_count();
+  std::string error = backend_->UpdateTextureRegion(
+      *reference, x, y, width, height, stride_in_bytes, data);
+  SetLastError(this, error);
+  return error.empty() ? 1 : 0;
+}
 
-  auto insert_results =
-      id_lookup_.insert(std::make_pair(id, std::move(result.value)));
-  assert(insert_results.second);
+int Context::UpdateDrawSequence(
+    EntifyId id, const EntifyDrawSequenceEdit* edits, size_t num_edits) {
+  std::unique_ptr<ExternalReference> reference;
+  if (!CopyReferenceForUpdate(id, &reference)) {
+    return 0;
+  }
 
-  return insert_results.first->second.get();
+  std::string error = backend_->UpdateDrawSequence(
+      id_lookup_, *reference, edits, num_edits);
+  SetLastError(this, error);
+  return error.empty() ? 1 : 0;
 }
 
 int Context::GetLastError(const char** message) {
-  if (last_error_.empty()) {
+  if (t_last_error.context != this || t_last_error.message.empty()) {
     return 0;
   } else {
-    *message = last_error_.c_str();
+    *message = t_last_error.message.c_str();
     return 1;
   }
 }
@@ -82,29 +199,165 @@ Context::CreateRenderTargetFromPlatformWindow(
       platform_window, width, height);
 }
 
-void Context::DoGarbageCollection() {
-  std::vector<EntifyId> to_erase;
-  for (const auto& entry : id_lookup_) {
-    const ExternalReference& reference = *entry.second;
-    if (!reference.is_referenced()) {
-      to_erase.push_back(entry.first);
-    }
+EntifyMemoryUsage Context::GetMemoryUsage() const {
+  EntifyMemoryUsage total = memory_accounting_.GetTotal();
+  EntifyMemoryUsage internal = backend_->GetInternalMemoryUsage();
+  total.cpu_bytes += internal.cpu_bytes;
+  total.gpu_bytes += internal.gpu_bytes;
+  return total;
+}
+
+void Context::GetMemoryUsageByNodeType(
+    EntifyMemoryUsage* by_node_type) const {
+  memory_accounting_.GetByNodeType(by_node_type);
+}
+
+int32_t Context::GetLargestNodes(
+    EntifyNodeMemoryUsage* nodes, int32_t max_nodes) {
+  if (max_nodes <= 0) {
+    return 0;
   }
 
+  std::vector<EntifyNodeMemoryUsage> all_nodes;
+  id_lookup_.ForEach(
+      [&all_nodes](EntifyId id, const ExternalReference& reference) {
+        const NodeMemoryUsage& usage = reference.memory_usage();
+        all_nodes.push_back(
+            {id, usage.node_type, usage.cpu_bytes, usage.gpu_bytes});
+      });
+
+  int32_t num_nodes =
+      std::min(max_nodes, static_cast<int32_t>(all_nodes.size()));
+  std::partial_sort(
+      all_nodes.begin(), all_nodes.begin() + num_nodes, all_nodes.end(),
+      [](const EntifyNodeMemoryUsage& a, const EntifyNodeMemoryUsage& b) {
+        return a.cpu_bytes + a.gpu_bytes > b.cpu_bytes + b.gpu_bytes;
+      });
+  std::copy(all_nodes.begin(), all_nodes.begin() + num_nodes, nodes);
+  return num_nodes;
+}
+
+void Context::SetGPUMemoryBudget(
+    int64_t gpu_budget_bytes, EntifyMemoryBudgetCallback callback,
+    void* user_data) {
+  memory_accounting_.SetGPUBudget(gpu_budget_bytes, callback, user_data);
+}
+
+void Context::DoGarbageCollection() {
+  ScopedTraceEvent trace_event("entify", "GarbageCollection");
+
   std::vector<std::shared_ptr<void>> references_to_release;
-  references_to_release.reserve(to_erase.size());
-  for (const auto& id_to_erase : to_erase) {
-    auto found = id_lookup_.find(id_to_erase);
-    references_to_release.push_back(found->second->object());
-    id_lookup_.erase(found);
-  }
+  id_lookup_.RemoveUnreferenced(
+      [this, &references_to_release](const ExternalReference& reference) {
+        memory_accounting_.RemoveNode(reference.memory_usage());
+        references_to_release.push_back(reference.object());
+      });
+
+  trace_event.AddArg("removed", references_to_release.size());
 
   backend_->ReleaseReferences(std::move(references_to_release));
 }
 
 void Context::Submit(EntifyReference render_tree, RenderTarget* render_target) {
-  backend_->Submit(static_cast<ExternalReference*>(render_tree), render_target);
+  ScopedTraceEvent trace_event("entify", "Submit");
+
+  EntifyFrameStats frame_stats = {};
+  std::vector<renderer::GPUTiming> gpu_timings;
+  backend_->Submit(static_cast<ExternalReference*>(render_tree), render_target,
+                   &frame_stats, &gpu_timings);
   DoGarbageCollection();
+
+  std::lock_guard<std::mutex> lock(frame_stats_mutex_);
+  frame_stats_history_.push_back(frame_stats);
+  if (frame_stats_history_.size() > kEntifyFrameStatsHistorySize) {
+    frame_stats_history_.pop_front();
+  }
+
+  for (const auto& gpu_timing : gpu_timings) {
+    gpu_timing_history_.push_back({gpu_timing.frame_number, gpu_timing.type,
+                                   gpu_timing.id, gpu_timing.gpu_ms});
+  }
+  while (gpu_timing_history_.size() > kEntifyGPUTimingHistorySize) {
+    gpu_timing_history_.pop_front();
+  }
+}
+
+int32_t Context::GetGPUTimings(
+    EntifyGPUTiming* gpu_timings, int32_t max_timings) {
+  if (max_timings <= 0) {
+    return 0;
+  }
+
+  std::lock_guard<std::mutex> lock(frame_stats_mutex_);
+  int32_t num_timings = std::min(
+      max_timings, static_cast<int32_t>(gpu_timing_history_.size()));
+  std::copy(gpu_timing_history_.end() - num_timings,
+            gpu_timing_history_.end(), gpu_timings);
+  return num_timings;
+}
+
+int32_t Context::GetGLCallCounts(
+    EntifyGLCallCount* counts, int32_t max_counts) {
+  if (max_counts <= 0) {
+    return 0;
+  }
+
+  std::vector<EntifyGLCallCount> all_counts =
+      backend_->GetGLCallCountsForLastFrame();
+  int32_t num_counts =
+      std::min(max_counts, static_cast<int32_t>(all_counts.size()));
+  std::partial_sort(
+      all_counts.begin(), all_counts.begin() + num_counts, all_counts.end(),
+      [](const EntifyGLCallCount& a, const EntifyGLCallCount& b) {
+        return a.calls > b.calls;
+      });
+  std::copy(all_counts.begin(), all_counts.begin() + num_counts, counts);
+  return num_counts;
+}
+
+int32_t Context::GetFrameStats(
+    EntifyFrameStats* frame_stats, int32_t max_frames) {
+  if (max_frames <= 0) {
+    return 0;
+  }
+
+  std::lock_guard<std::mutex> lock(frame_stats_mutex_);
+  int32_t num_frames = std::min(
+      max_frames, static_cast<int32_t>(frame_stats_history_.size()));
+  std::copy(frame_stats_history_.end() - num_frames,
+            frame_stats_history_.end(), frame_stats);
+  return num_frames;
+}
+
+int32_t Context::GetFrameStatsPercentile(
+    double percentile, EntifyFrameStats* result) {
+  if (std::isnan(percentile)) {
+    return 0;
+  }
+  percentile = std::min(std::max(percentile, 0.0), 100.0);
+
+  std::lock_guard<std::mutex> lock(frame_stats_mutex_);
+  if (frame_stats_history_.empty()) {
+    return 0;
+  }
+
+#define SET_PERCENTILE(field) \
+  result->field = FieldPercentile( \
+      frame_stats_history_, &EntifyFrameStats::field, percentile)
+  SET_PERCENTILE(draw_calls);
+  SET_PERCENTILE(vertices);
+  SET_PERCENTILE(program_switches);
+  SET_PERCENTILE(texture_binds);
+  SET_PERCENTILE(uniform_uploads);
+  SET_PERCENTILE(buffer_binds);
+  SET_PERCENTILE(render_target_passes);
+  SET_PERCENTILE(gl_calls);
+  SET_PERCENTILE(tree_walk_ms);
+  SET_PERCENTILE(gl_submission_ms);
+  SET_PERCENTILE(swap_ms);
+#undef SET_PERCENTILE
+
+  return static_cast<int32_t>(frame_stats_history_.size());
 }
 
 }  // namespace entify
@@ -1,12 +1,21 @@
 #ifndef _SRC_ENTIFY_CONTEXT_H_
 #define _SRC_ENTIFY_CONTEXT_H_
 
+#include <deque>
+#include <mutex>
+#include <vector>
+
+#include "entify/entify.h"
 #include "entify/registry.h"
 #include "src/renderer/backend.h"
 #include "src/external_reference.h"
+#include "src/memory_accounting.h"
+#include "src/trace_log/trace_log.h"
 
 namespace entify {
 
+// All methods may be called concurrently from multiple threads.  Errors
+// reported by GetLastError() are tracked per thread.
 class Context {
  public:
   using RenderTarget = renderer::RenderTarget;
@@ -22,6 +31,14 @@ class Context {
       EntifyId id, const char* data, size_t data_size);
   int GetLastError(const char** message);
 
+  // Returns 1 on success, and 0 on failure, after recording the error for
+  // the calling thread.
+  int UpdateUniformValues(EntifyId id, const char* data, size_t data_size);
+  int UpdateTextureRegion(EntifyId id, int x, int y, int width, int height,
+                          int stride_in_bytes, const char* data);
+  int UpdateDrawSequence(EntifyId id, const EntifyDrawSequenceEdit* edits,
+                         size_t num_edits);
+
   void AddReference(EntifyReference reference);
   void ReleaseReference(EntifyReference reference);
 
@@ -30,15 +47,49 @@ class Context {
 
   void Submit(EntifyReference render_tree, RenderTarget* render_target);
 
+  EntifyMemoryUsage GetMemoryUsage() const;
+  void GetMemoryUsageByNodeType(EntifyMemoryUsage* by_node_type) const;
+  int32_t GetLargestNodes(EntifyNodeMemoryUsage* nodes, int32_t max_nodes);
+  void SetGPUMemoryBudget(int64_t gpu_budget_bytes,
+                          EntifyMemoryBudgetCallback callback,
+                          void* user_data);
+
+  int32_t GetFrameStats(EntifyFrameStats* frame_stats, int32_t max_frames);
+  int32_t GetFrameStatsPercentile(double percentile, EntifyFrameStats* result);
+
+  int32_t GetGPUTimings(EntifyGPUTiming* gpu_timings, int32_t max_timings);
+
+  int32_t GetGLCallCounts(EntifyGLCallCount* counts, int32_t max_counts);
+
  private:
+  // Copies the lookup entry for |id| into |reference|, so that the backend
+  // can be called without the lookup locked.  Records an error for the
+  // calling thread and returns false if there is no such node.
+  bool CopyReferenceForUpdate(
+      EntifyId id, std::unique_ptr<ExternalReference>* reference);
+
+  // Inserts a successfully parsed node into |id_lookup_|, or records the
+  // parse error for the calling thread.  The node's type is added to
+  // |trace_event|, the span covering the parse.
+  EntifyReference AddParseOutput(EntifyId id, renderer::ParseOutput&& result,
+                                 ScopedTraceEvent* trace_event);
+
   // Looks through all of the external reference lookups and removes those who
   // are unreferenced (i.e. those whose only reference is the lookup entry
   // itself).
   void DoGarbageCollection();
 
+
   std::unique_ptr<renderer::Backend> backend_;
   ExternalReferenceLookup id_lookup_;
-  std::string last_error_;
+  MemoryAccounting memory_accounting_;
+
+  // Guards both histories.
+  std::mutex frame_stats_mutex_;
+  // The stats of the last kEntifyFrameStatsHistorySize frames, oldest first.
+  std::deque<EntifyFrameStats> frame_stats_history_;
+  // The last kEntifyGPUTimingHistorySize GPU timings, oldest first.
+  std::deque<EntifyGPUTiming> gpu_timing_history_;
 };
 
 }  // namespace entify
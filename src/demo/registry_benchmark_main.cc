@@ -0,0 +1,128 @@
+// Measures how registry operations scale as more producer threads create and
+// look up nodes on the same context concurrently.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "entify/entify.h"
+#include "entify/renderer_definitions.pb.h"
+
+namespace {
+const int kThreadCounts[] = {1, 2, 4, 8, 16};
+const int kDefaultNodesPerThread = 20000;
+const int kLookupsPerNode = 8;
+
+std::string SerializeUniformValues(float x) {
+  entify_renderer::RendererNode node;
+  entify_renderer::UniformValues* uniform_values =
+      node.mutable_uniform_values();
+  uniform_values->mutable_types()->add_types(
+      entify_renderer::PrimitiveTypeFloat32V3);
+  float data[] = {x, 0.0f, 0.0f};
+  uniform_values->set_data(data, sizeof(data));
+
+  std::string serialized;
+  if (!node.SerializeToString(&serialized)) {
+    std::fprintf(stderr, "Could not serialize the UniformValues node.\n");
+    std::exit(1);
+  }
+  return serialized;
+}
+
+// Each thread creates |nodes_per_thread| nodes with ids that are unique to
+// that thread and this run.
+void CreateNodes(EntifyContext context, const std::string& serialized,
+                 EntifyId first_id, int nodes_per_thread) {
+  for (int i = 0; i < nodes_per_thread; ++i) {
+    EntifyReference reference = EntifyCreateReferenceFromProtocolBuffer(
+        context, first_id + i, serialized.data(), serialized.size());
+    if (reference == kEntifyInvalidReference) {
+      const char* message = "";
+      EntifyGetLastError(context, &message);
+      std::fprintf(stderr, "Could not create node %ld: %s\n",
+                   static_cast<long>(first_id + i), message);
+      std::exit(1);
+    }
+    EntifyReleaseReference(context, reference);
+  }
+}
+
+// Each thread repeatedly looks up, adds and releases references to the nodes
+// created by every thread.
+void LookupNodes(EntifyContext context, EntifyId first_id, int total_nodes,
+                 int thread_index) {
+  for (int i = 0; i < total_nodes * kLookupsPerNode; i += kLookupsPerNode) {
+    EntifyId id = first_id + (i + thread_index) % total_nodes;
+    EntifyReference reference = EntifyTryGetReferenceFromId(context, id);
+    if (reference == kEntifyInvalidReference) {
+      std::fprintf(stderr, "Could not find node %ld.\n",
+                   static_cast<long>(id));
+      std::exit(1);
+    }
+    EntifyAddReference(context, reference);
+    EntifyReleaseReference(context, reference);
+    EntifyReleaseReference(context, reference);
+  }
+}
+
+template <typename Function>
+double RunOnThreads(int thread_count, Function function) {
+  auto start = std::chrono::steady_clock::now();
+
+  std::vector<std::thread> threads;
+  threads.reserve(thread_count);
+  for (int i = 0; i < thread_count; ++i) {
+    threads.emplace_back(function, i);
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  return std::chrono::duration<double>(
+      std::chrono::steady_clock::now() - start).count();
+}
+}  // namespace
+
+int main(int argc, const char** args) {
+  int nodes_per_thread =
+      argc > 1 ? std::atoi(args[1]) : kDefaultNodesPerThread;
+
+  EntifyContext context = EntifyCreateContext();
+  if (context == kEntifyInvalidContext) {
+    std::fprintf(stderr, "Could not create a context.\n");
+    return 1;
+  }
+
+  std::string serialized = SerializeUniformValues(1.0f);
+
+  std::printf("%8s %16s %16s\n", "threads", "creates/s", "lookups/s");
+
+  EntifyId next_id = 1;
+  for (int thread_count : kThreadCounts) {
+    EntifyId first_id = next_id;
+    int total_nodes = thread_count * nodes_per_thread;
+    next_id += total_nodes;
+
+    double create_seconds = RunOnThreads(thread_count, [&](int thread_index) {
+      CreateNodes(context, serialized,
+                  first_id + thread_index * nodes_per_thread,
+                  nodes_per_thread);
+    });
+
+    double lookup_seconds = RunOnThreads(thread_count, [&](int thread_index) {
+      LookupNodes(context, first_id, total_nodes, thread_index);
+    });
+
+    std::printf("%8d %16.0f %16.0f\n", thread_count,
+                total_nodes / create_seconds,
+                thread_count * total_nodes / lookup_seconds);
+  }
+
+  EntifyDestroyContext(context);
+
+  return 0;
+}
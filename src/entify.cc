@@ -22,3 +22,27 @@ void EntifySubmit(
   static_cast<entify::Context*>(context)->Submit(
       render_tree, static_cast<entify::Context::RenderTarget*>(render_target));
 }
+
+int32_t EntifyGetFrameStats(
+    EntifyContext context, EntifyFrameStats* frame_stats, int32_t max_frames) {
+  return static_cast<entify::Context*>(context)->GetFrameStats(
+      frame_stats, max_frames);
+}
+
+int32_t EntifyGetFrameStatsPercentile(
+    EntifyContext context, double percentile, EntifyFrameStats* result) {
+  return static_cast<entify::Context*>(context)->GetFrameStatsPercentile(
+      percentile, result);
+}
+
+int32_t EntifyGetGPUTimings(
+    EntifyContext context, EntifyGPUTiming* timings, int32_t max_timings) {
+  return static_cast<entify::Context*>(context)->GetGPUTimings(
+      timings, max_timings);
+}
+
+int32_t EntifyGetGLCallCounts(
+    EntifyContext context, EntifyGLCallCount* counts, int32_t max_counts) {
+  return static_cast<entify::Context*>(context)->GetGLCallCounts(
+      counts, max_counts);
+}
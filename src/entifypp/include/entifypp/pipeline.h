@@ -42,12 +42,28 @@ struct PipelineOptions {
     Coefficient dst_alpha = Coefficient::kOneMinusSrcAlpha;
   };
 
+  // How the vertices of draw calls are assembled into primitives.
+  enum class PrimitiveMode {
+    kTriangles,
+    kTriangleStrip,
+    kTriangleFan,
+    kLines,
+    kLineStrip,
+    kLineLoop,
+    kPoints,
+  };
+
   PipelineOptions& set_blend(const BlendOptions& _blend) {
     blend = _blend;
     return *this;
   }
+  PipelineOptions& set_primitive_mode(PrimitiveMode _primitive_mode) {
+    primitive_mode = _primitive_mode;
+    return *this;
+  }
 
   BlendOptions blend;
+  PrimitiveMode primitive_mode = PrimitiveMode::kTriangles;
 };
 
 inline PipelineOptions::BlendOptions NoBlending() {
@@ -114,6 +130,7 @@ class Pipeline : public PipelineBase {
     hasher.Add(options_.blend.dst_color);
     hasher.Add(options_.blend.src_alpha);
     hasher.Add(options_.blend.dst_alpha);
+    hasher.Add(options_.primitive_mode);
     hash_ = hasher.Get();
   }
 
@@ -14,9 +14,15 @@ class Sampler {
     kClamp,
   };
 
+  // The mipmapped filters can only be min filters, and sample textures
+  // without mipmaps like their base filter.
   enum class FilterType {
     kLinear,
-    kNearest
+    kNearest,
+    kNearestMipmapNearest,
+    kLinearMipmapNearest,
+    kNearestMipmapLinear,
+    kLinearMipmapLinear,
   };
 
   struct Options {
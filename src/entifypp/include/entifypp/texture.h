@@ -11,6 +11,42 @@ namespace entifypp {
 enum PixelType {
   kPixelTypeRGB,
   kPixelTypeRGBA,
+  kPixelTypeLuminance,
+  kPixelTypeAlpha,
+  kPixelTypeLuminanceAlpha,
+  // Packed into one native endian uint16_t per pixel.
+  kPixelTypeRGB565,
+  kPixelTypeRGBA4444,
+  kPixelTypeRGBA5551,
+  // ETC compressed, in blocks of 4x4 pixels with rows of blocks tightly
+  // packed.
+  kPixelTypeETC1,
+  kPixelTypeETC2RGB,
+  kPixelTypeETC2RGBA,
+};
+
+// Which row of pixel data comes first.
+enum PixelOrigin {
+  kPixelOriginBottomLeft,
+  kPixelOriginTopLeft,
+};
+
+// The order of the channels of kPixelTypeRGB and kPixelTypeRGBA pixels in
+// memory.  Without alpha, kChannelOrderBGRA stands for BGR.
+enum ChannelOrder {
+  kChannelOrderRGBA,
+  kChannelOrderBGRA,
+  kChannelOrderARGB,
+};
+
+// How pixel data is laid out, which the renderer converts from when it
+// uploads the texture.  The defaults need no conversion.
+struct PixelLayout {
+  PixelOrigin origin = kPixelOriginBottomLeft;
+  ChannelOrder channel_order = kChannelOrderRGBA;
+  // If set, the colors of kPixelTypeRGBA pixels are multiplied by their
+  // alpha.
+  bool straight_alpha = false;
 };
 
 class ReferenceTexture;
@@ -64,21 +100,31 @@ class ReferenceTexture : public Texture {
 
 class RenderTargetTexture : public Texture {
  public:
+  // Formats that the renderer can not render to fall back to
+  // kPixelTypeRGBA.  If |generate_mipmaps| is set, the renderer generates
+  // mipmaps from the rendered image where the size allows it.
   RenderTargetTexture(int width_in_pixels, int height_in_pixels,
-               std::shared_ptr<DrawTree> draw_tree)
+               std::shared_ptr<DrawTree> draw_tree,
+               PixelType pixel_type = kPixelTypeRGBA,
+               bool generate_mipmaps = false)
       : width_in_pixels_(width_in_pixels), height_in_pixels_(height_in_pixels),
-        draw_tree_(draw_tree) {
+        draw_tree_(draw_tree), pixel_type_(pixel_type),
+        generate_mipmaps_(generate_mipmaps) {
     Hasher hasher;
     hasher.Add(internal::GetTypeId<RenderTargetTexture>());
     hasher.Add(width_in_pixels_);
     hasher.Add(height_in_pixels_);
     hasher.Add(draw_tree_->hash());
+    hasher.Add(pixel_type_);
+    hasher.Add(generate_mipmaps_);
     hash_ = hasher.Get();
   }
 
   int width_in_pixels() const { return width_in_pixels_; }
   int height_in_pixels() const { return height_in_pixels_; }
   const std::shared_ptr<DrawTree>& draw_tree() const { return draw_tree_; }
+  PixelType pixel_type() const { return pixel_type_; }
+  bool generate_mipmaps() const { return generate_mipmaps_; }
 
   void Accept(TextureVisitor* visitor) const override {
     visitor->Visit(this);
@@ -88,16 +134,27 @@ class RenderTargetTexture : public Texture {
   int width_in_pixels_;
   int height_in_pixels_;
   std::shared_ptr<DrawTree> draw_tree_;
+  PixelType pixel_type_;
+  bool generate_mipmaps_;
 };
 
 class PixelDataTexture : public Texture {
  public:
+  // If |compress| is set, kPixelTypeRGB and kPixelTypeRGBA images are
+  // compressed by the renderer when the implementation supports ETC.  If
+  // |generate_mipmaps| is set, the renderer generates mipmaps where the size
+  // allows it.  If |atlas| is set, small kPixelTypeRGBA images are packed
+  // into a texture shared with others, see the |atlas| field of PixelData.
   PixelDataTexture(
       std::vector<uint8_t>&& pixel_data, int width_in_pixels,
-      int height_in_pixels, int stride_in_bytes, PixelType pixel_type)
+      int height_in_pixels, int stride_in_bytes, PixelType pixel_type,
+      const PixelLayout& layout = PixelLayout(), bool compress = false,
+      bool generate_mipmaps = false, bool atlas = false)
       : pixel_data_(std::move(pixel_data)),
         width_in_pixels_(width_in_pixels), height_in_pixels_(height_in_pixels),
-        stride_in_bytes_(stride_in_bytes), pixel_type_(pixel_type) {
+        stride_in_bytes_(stride_in_bytes), pixel_type_(pixel_type),
+        layout_(layout), compress_(compress),
+        generate_mipmaps_(generate_mipmaps), atlas_(atlas) {
     Hasher hasher;
     hasher.Add(internal::GetTypeId<PixelDataTexture>());
     hasher.Add(pixel_data_);
@@ -105,6 +162,12 @@ class PixelDataTexture : public Texture {
     hasher.Add(height_in_pixels_);
     hasher.Add(stride_in_bytes_);
     hasher.Add(pixel_type_);
+    hasher.Add(layout_.origin);
+    hasher.Add(layout_.channel_order);
+    hasher.Add(layout_.straight_alpha);
+    hasher.Add(compress_);
+    hasher.Add(generate_mipmaps_);
+    hasher.Add(atlas_);
     hash_ = hasher.Get();
   }
 
@@ -113,6 +176,10 @@ class PixelDataTexture : public Texture {
   int height_in_pixels() const { return height_in_pixels_; }
   int stride_in_bytes() const { return stride_in_bytes_; }
   PixelType pixel_type() const { return pixel_type_; }
+  const PixelLayout& layout() const { return layout_; }
+  bool compress() const { return compress_; }
+  bool generate_mipmaps() const { return generate_mipmaps_; }
+  bool atlas() const { return atlas_; }
 
   void Accept(TextureVisitor* visitor) const override {
     visitor->Visit(this);
@@ -124,6 +191,10 @@ class PixelDataTexture : public Texture {
   int height_in_pixels_;
   int stride_in_bytes_;
   PixelType pixel_type_;
+  PixelLayout layout_;
+  bool compress_;
+  bool generate_mipmaps_;
+  bool atlas_;
 };
 
 }  // namespace entifypp
@@ -1,6 +1,8 @@
 #ifndef _SRC_ENTIFY_ENTIFYPP_RENDER_TREE_TYPES_H_
 #define _SRC_ENTIFY_ENTIFYPP_RENDER_TREE_TYPES_H_
 
+#include <array>
+#include <cstdint>
 #include <memory>
 
 #include "entifypp/sampler.h"
@@ -8,7 +10,9 @@
 
 namespace entifypp {
 
-enum Type {
+// A fixed-length uniform array has the type of its elements combined with
+// its length, see ToTypeEnum<std::array<T, N>>.
+enum Type : int32_t {
   TypeInvalid,
 
   TypeFloat32V1,
@@ -21,11 +25,68 @@ enum Type {
   TypeUInt8V3,
   TypeUInt8V4,
   TypeSampler,
+
+  // Vertex attribute only types.
+  TypeFloat16V1,
+  TypeFloat16V2,
+  TypeFloat16V3,
+  TypeFloat16V4,
+  TypeInt16V1,
+  TypeInt16V2,
+  TypeInt16V3,
+  TypeInt16V4,
+  TypeUInt16V1,
+  TypeUInt16V2,
+  TypeUInt16V3,
+  TypeUInt16V4,
+  TypeUNorm8V1,
+  TypeUNorm8V2,
+  TypeUNorm8V3,
+  TypeUNorm8V4,
+  TypeSNorm16V1,
+  TypeSNorm16V2,
+  TypeSNorm16V3,
+  TypeSNorm16V4,
 };
 
+// Vertex attribute components that are stored as IEEE half floats, e.g.
+// as produced by glm::packHalf1x16().  |T| is uint16_t or a glm vector of
+// uint16_t.  Requires GL_OES_vertex_half_float.
+template <typename T>
+struct HalfFloat {
+  T bits;
+};
+
+// Vertex attribute components that shaders read normalized to [0, 1], for
+// unsigned types, or [-1, 1], for signed types.  |T| is uint8_t, int16_t or
+// a glm vector of either.
+template <typename T>
+struct Normalized {
+  T value;
+};
+
+// The length of an array type is stored in the bits above the element type.
+const int kTypeArrayLengthShift = 8;
+
+inline Type TypeArrayElementType(Type type) {
+  return static_cast<Type>(type & ((1 << kTypeArrayLengthShift) - 1));
+}
+
+// 0 if |type| is not an array.
+inline int32_t TypeArrayLength(Type type) {
+  return type >> kTypeArrayLengthShift;
+}
+
 template <typename T>
 struct ToTypeEnum {};
 
+// Uniform arrays, whose elements must be floats, glm::vec2-4 or glm::mat4s.
+template <typename T, size_t N>
+struct ToTypeEnum<std::array<T, N>> {
+  static_assert(N > 0, "Uniform arrays can not be empty.");
+  enum { value = ToTypeEnum<T>::value | (N << kTypeArrayLengthShift) };
+};
+
 template <>
 struct ToTypeEnum<float> {
   enum { value = TypeFloat32V1 };
@@ -76,6 +137,106 @@ struct ToTypeEnum<std::shared_ptr<Sampler>> {
   enum { value = TypeSampler };
 };
 
+template <>
+struct ToTypeEnum<HalfFloat<uint16_t>> {
+  enum { value = TypeFloat16V1 };
+};
+
+template <>
+struct ToTypeEnum<HalfFloat<glm::tvec2<uint16_t>>> {
+  enum { value = TypeFloat16V2 };
+};
+
+template <>
+struct ToTypeEnum<HalfFloat<glm::tvec3<uint16_t>>> {
+  enum { value = TypeFloat16V3 };
+};
+
+template <>
+struct ToTypeEnum<HalfFloat<glm::tvec4<uint16_t>>> {
+  enum { value = TypeFloat16V4 };
+};
+
+template <>
+struct ToTypeEnum<int16_t> {
+  enum { value = TypeInt16V1 };
+};
+
+template <>
+struct ToTypeEnum<glm::tvec2<int16_t>> {
+  enum { value = TypeInt16V2 };
+};
+
+template <>
+struct ToTypeEnum<glm::tvec3<int16_t>> {
+  enum { value = TypeInt16V3 };
+};
+
+template <>
+struct ToTypeEnum<glm::tvec4<int16_t>> {
+  enum { value = TypeInt16V4 };
+};
+
+template <>
+struct ToTypeEnum<uint16_t> {
+  enum { value = TypeUInt16V1 };
+};
+
+template <>
+struct ToTypeEnum<glm::tvec2<uint16_t>> {
+  enum { value = TypeUInt16V2 };
+};
+
+template <>
+struct ToTypeEnum<glm::tvec3<uint16_t>> {
+  enum { value = TypeUInt16V3 };
+};
+
+template <>
+struct ToTypeEnum<glm::tvec4<uint16_t>> {
+  enum { value = TypeUInt16V4 };
+};
+
+template <>
+struct ToTypeEnum<Normalized<uint8_t>> {
+  enum { value = TypeUNorm8V1 };
+};
+
+template <>
+struct ToTypeEnum<Normalized<glm::tvec2<uint8_t>>> {
+  enum { value = TypeUNorm8V2 };
+};
+
+template <>
+struct ToTypeEnum<Normalized<glm::tvec3<uint8_t>>> {
+  enum { value = TypeUNorm8V3 };
+};
+
+template <>
+struct ToTypeEnum<Normalized<glm::tvec4<uint8_t>>> {
+  enum { value = TypeUNorm8V4 };
+};
+
+template <>
+struct ToTypeEnum<Normalized<int16_t>> {
+  enum { value = TypeSNorm16V1 };
+};
+
+template <>
+struct ToTypeEnum<Normalized<glm::tvec2<int16_t>>> {
+  enum { value = TypeSNorm16V2 };
+};
+
+template <>
+struct ToTypeEnum<Normalized<glm::tvec3<int16_t>>> {
+  enum { value = TypeSNorm16V3 };
+};
+
+template <>
+struct ToTypeEnum<Normalized<glm::tvec4<int16_t>>> {
+  enum { value = TypeSNorm16V4 };
+};
+
 namespace detail {
 
 template <typename... Args>
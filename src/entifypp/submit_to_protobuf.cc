@@ -1,3 +1,5 @@
+#include <algorithm>
+
 #include "entify/entify.h"
 #include "entify/renderer_definitions.pb.h"
 #include "entifypp/draw_tree_visitor.h"
@@ -95,7 +97,7 @@ class DrawTreeProtobufVisitor : public DrawTreeVisitor {
 };
 
 entify_renderer::PrimitiveType ConvertTypeToProtobuf(Type type) {
-  switch (type) {
+  switch (TypeArrayElementType(type)) {
     case TypeFloat32V1: return entify_renderer::PrimitiveTypeFloat32V1;
     case TypeFloat32V2: return entify_renderer::PrimitiveTypeFloat32V2;
     case TypeFloat32V3: return entify_renderer::PrimitiveTypeFloat32V3;
@@ -106,6 +108,26 @@ entify_renderer::PrimitiveType ConvertTypeToProtobuf(Type type) {
     case TypeUInt8V3: return entify_renderer::PrimitiveTypeUInt8V3;
     case TypeUInt8V4: return entify_renderer::PrimitiveTypeUInt8V4;
     case TypeSampler: return entify_renderer::PrimitiveTypeSampler;
+    case TypeFloat16V1: return entify_renderer::PrimitiveTypeFloat16V1;
+    case TypeFloat16V2: return entify_renderer::PrimitiveTypeFloat16V2;
+    case TypeFloat16V3: return entify_renderer::PrimitiveTypeFloat16V3;
+    case TypeFloat16V4: return entify_renderer::PrimitiveTypeFloat16V4;
+    case TypeInt16V1: return entify_renderer::PrimitiveTypeInt16V1;
+    case TypeInt16V2: return entify_renderer::PrimitiveTypeInt16V2;
+    case TypeInt16V3: return entify_renderer::PrimitiveTypeInt16V3;
+    case TypeInt16V4: return entify_renderer::PrimitiveTypeInt16V4;
+    case TypeUInt16V1: return entify_renderer::PrimitiveTypeUInt16V1;
+    case TypeUInt16V2: return entify_renderer::PrimitiveTypeUInt16V2;
+    case TypeUInt16V3: return entify_renderer::PrimitiveTypeUInt16V3;
+    case TypeUInt16V4: return entify_renderer::PrimitiveTypeUInt16V4;
+    case TypeUNorm8V1: return entify_renderer::PrimitiveTypeUNorm8V1;
+    case TypeUNorm8V2: return entify_renderer::PrimitiveTypeUNorm8V2;
+    case TypeUNorm8V3: return entify_renderer::PrimitiveTypeUNorm8V3;
+    case TypeUNorm8V4: return entify_renderer::PrimitiveTypeUNorm8V4;
+    case TypeSNorm16V1: return entify_renderer::PrimitiveTypeSNorm16V1;
+    case TypeSNorm16V2: return entify_renderer::PrimitiveTypeSNorm16V2;
+    case TypeSNorm16V3: return entify_renderer::PrimitiveTypeSNorm16V3;
+    case TypeSNorm16V4: return entify_renderer::PrimitiveTypeSNorm16V4;
     default:
       assert(false);
       return static_cast<entify_renderer::PrimitiveType>(0);
@@ -116,12 +138,44 @@ entify_renderer::PixelType ConvertPixelTypeToProtobuf(PixelType type) {
   switch (type) {
     case kPixelTypeRGB: return entify_renderer::PixelTypeRGB;
     case kPixelTypeRGBA: return entify_renderer::PixelTypeRGBA;
+    case kPixelTypeLuminance: return entify_renderer::PixelTypeLuminance;
+    case kPixelTypeAlpha: return entify_renderer::PixelTypeAlpha;
+    case kPixelTypeLuminanceAlpha:
+        return entify_renderer::PixelTypeLuminanceAlpha;
+    case kPixelTypeRGB565: return entify_renderer::PixelTypeRGB565;
+    case kPixelTypeRGBA4444: return entify_renderer::PixelTypeRGBA4444;
+    case kPixelTypeRGBA5551: return entify_renderer::PixelTypeRGBA5551;
+    case kPixelTypeETC1: return entify_renderer::PixelTypeETC1;
+    case kPixelTypeETC2RGB: return entify_renderer::PixelTypeETC2RGB;
+    case kPixelTypeETC2RGBA: return entify_renderer::PixelTypeETC2RGBA;
   }
 
   assert(false);
   return static_cast<entify_renderer::PixelType>(0);
 }
 
+entify_renderer::PixelOrigin ConvertPixelOriginToProtobuf(PixelOrigin origin) {
+  switch (origin) {
+    case kPixelOriginBottomLeft: return entify_renderer::PixelOriginBottomLeft;
+    case kPixelOriginTopLeft: return entify_renderer::PixelOriginTopLeft;
+  }
+
+  assert(false);
+  return static_cast<entify_renderer::PixelOrigin>(0);
+}
+
+entify_renderer::ChannelOrder ConvertChannelOrderToProtobuf(
+    ChannelOrder channel_order) {
+  switch (channel_order) {
+    case kChannelOrderRGBA: return entify_renderer::ChannelOrderRGBA;
+    case kChannelOrderBGRA: return entify_renderer::ChannelOrderBGRA;
+    case kChannelOrderARGB: return entify_renderer::ChannelOrderARGB;
+  }
+
+  assert(false);
+  return static_cast<entify_renderer::ChannelOrder>(0);
+}
+
 void PopulateProtobufTypeTuple(
     const std::vector<Type>& types,
     entify_renderer::PrimitiveTypeTuple* output_pb) {
@@ -140,6 +194,9 @@ void PopulateProtobufNamedTypeTuple(
         output_pb->add_named_types();
     named_type_pb->set_name(names[i]);
     named_type_pb->set_type(ConvertTypeToProtobuf(types[i]));
+    if (TypeArrayLength(types[i]) > 0) {
+      named_type_pb->set_array_length(TypeArrayLength(types[i]));
+    }
   }
 }
 
@@ -240,6 +297,28 @@ entify_renderer::BlendCoefficient ConvertPipelineBlendCoefficient(
   assert(false);
   return entify_renderer::BlendCoefficientOne;
 }
+
+entify_renderer::PrimitiveMode ConvertPipelinePrimitiveMode(
+    PipelineOptions::PrimitiveMode primitive_mode) {
+  switch (primitive_mode) {
+    case PipelineOptions::PrimitiveMode::kTriangles:
+        return entify_renderer::PrimitiveModeTriangles;
+    case PipelineOptions::PrimitiveMode::kTriangleStrip:
+        return entify_renderer::PrimitiveModeTriangleStrip;
+    case PipelineOptions::PrimitiveMode::kTriangleFan:
+        return entify_renderer::PrimitiveModeTriangleFan;
+    case PipelineOptions::PrimitiveMode::kLines:
+        return entify_renderer::PrimitiveModeLines;
+    case PipelineOptions::PrimitiveMode::kLineStrip:
+        return entify_renderer::PrimitiveModeLineStrip;
+    case PipelineOptions::PrimitiveMode::kLineLoop:
+        return entify_renderer::PrimitiveModeLineLoop;
+    case PipelineOptions::PrimitiveMode::kPoints:
+        return entify_renderer::PrimitiveModePoints;
+  }
+  assert(false);
+  return entify_renderer::PrimitiveModeTriangles;
+}
 }  // namespace
 
 ScopedReference SubmitPipeline(
@@ -270,6 +349,8 @@ ScopedReference SubmitPipeline(
   pipeline_pb.set_vertex_shader_id(pipeline->vertex_shader_base()->hash());
   pipeline_pb.set_fragment_shader_id(pipeline->fragment_shader_base()->hash());
   pipeline_pb.set_allocated_blend_parameters(&blend_params_pb);
+  pipeline_pb.set_primitive_mode(ConvertPipelinePrimitiveMode(
+      pipeline->options().primitive_mode));
 
   std::string serialized = SerializeAsRendererNode(
       &entify_renderer::RendererNode::set_allocated_pipeline,
@@ -340,6 +421,14 @@ entify_renderer::SamplerFilterType ConvertSamplerFilterTypeToProtobuf(
         return entify_renderer::SamplerFilterTypeLinear;
     case Sampler::FilterType::kNearest:
         return entify_renderer::SamplerFilterTypeNearest;
+    case Sampler::FilterType::kNearestMipmapNearest:
+        return entify_renderer::SamplerFilterTypeNearestMipmapNearest;
+    case Sampler::FilterType::kLinearMipmapNearest:
+        return entify_renderer::SamplerFilterTypeLinearMipmapNearest;
+    case Sampler::FilterType::kNearestMipmapLinear:
+        return entify_renderer::SamplerFilterTypeNearestMipmapLinear;
+    case Sampler::FilterType::kLinearMipmapLinear:
+        return entify_renderer::SamplerFilterTypeLinearMipmapLinear;
   }
   assert(false);
   return entify_renderer::SamplerFilterTypeLinear;
@@ -389,11 +478,19 @@ ScopedReference SubmitUniformValues(
     return std::move(result);
   }
 
+  std::vector<Type> types = uniform_values->GetTypes();
   entify_renderer::PrimitiveTypeTuple types_pb;
-  PopulateProtobufTypeTuple(uniform_values->GetTypes(), &types_pb);
+  PopulateProtobufTypeTuple(types, &types_pb);
 
   entify_renderer::UniformValues uniform_values_pb;
   uniform_values_pb.set_allocated_types(&types_pb);
+  if (std::any_of(types.begin(), types.end(), [](Type type) {
+        return TypeArrayLength(type) > 0;
+      })) {
+    for (Type type : types) {
+      uniform_values_pb.add_array_lengths(TypeArrayLength(type));
+    }
+  }
 
   auto data_info = uniform_values->GetDataInfo();
   uniform_values_pb.set_data(data_info.data, data_info.size);
@@ -565,6 +662,9 @@ void TextureProtobufVisitor::Visit(const RenderTargetTexture* render_target) {
   render_target_pb.set_width_in_pixels(render_target->width_in_pixels());
   render_target_pb.set_height_in_pixels(render_target->height_in_pixels());
   render_target_pb.set_draw_tree_id(render_target->draw_tree()->hash());
+  render_target_pb.set_pixel_type(
+      ConvertPixelTypeToProtobuf(render_target->pixel_type()));
+  render_target_pb.set_generate_mipmaps(render_target->generate_mipmaps());
 
   entify_renderer::Texture texture_pb;
   texture_pb.set_allocated_render_target(&render_target_pb);
@@ -587,6 +687,14 @@ void TextureProtobufVisitor::Visit(const PixelDataTexture* pixel_data) {
   pixel_data_pb.set_height_in_pixels(pixel_data->height_in_pixels());
   pixel_data_pb.set_stride_in_bytes(pixel_data->stride_in_bytes());
   pixel_data_pb.set_pixel_type(ConvertPixelTypeToProtobuf(pixel_data->pixel_type()));
+  pixel_data_pb.set_origin(
+      ConvertPixelOriginToProtobuf(pixel_data->layout().origin));
+  pixel_data_pb.set_channel_order(
+      ConvertChannelOrderToProtobuf(pixel_data->layout().channel_order));
+  pixel_data_pb.set_straight_alpha(pixel_data->layout().straight_alpha);
+  pixel_data_pb.set_compress(pixel_data->compress());
+  pixel_data_pb.set_generate_mipmaps(pixel_data->generate_mipmaps());
+  pixel_data_pb.set_atlas(pixel_data->atlas());
 
   pixel_data_pb.set_data(
       pixel_data->pixel_data().data(), pixel_data->pixel_data().size());
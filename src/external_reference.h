@@ -1,14 +1,27 @@
 #ifndef _SRC_ENTIFY_REFERENCE_H_
 #define _SRC_ENTIFY_REFERENCE_H_
 
+#include <array>
+#include <atomic>
 #include <memory>
+#include <mutex>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include "src/include/entify/registry.h"
 #include "stdext/type_id.h"
 
 namespace entify {
 
+// The memory used by a single node, as estimated by the backend that created
+// it.
+struct NodeMemoryUsage {
+  EntifyNodeType node_type = kEntifyNodeTypeCount;
+  int64_t cpu_bytes = 0;
+  int64_t gpu_bytes = 0;
+};
+
 class ExternalReference {
  public:
   ExternalReference(
@@ -29,20 +42,136 @@ class ExternalReference {
     return external_reference_count() > 0 || object().use_count() > 1;
   }
 
-  int32_t external_reference_count() const { return external_reference_count_; }
-  void increment_external_reference_count() { ++external_reference_count_; }
-  void decrement_external_reference_count() { --external_reference_count_; }
+  int32_t external_reference_count() const {
+    return external_reference_count_.load(std::memory_order_acquire);
+  }
+  void increment_external_reference_count() {
+    external_reference_count_.fetch_add(1, std::memory_order_relaxed);
+  }
+  void decrement_external_reference_count() {
+    external_reference_count_.fetch_sub(1, std::memory_order_release);
+  }
+
+  const NodeMemoryUsage& memory_usage() const { return memory_usage_; }
+  void set_memory_usage(const NodeMemoryUsage& memory_usage) {
+    memory_usage_ = memory_usage;
+  }
 
  private:
-  int32_t external_reference_count_;
+  std::atomic<int32_t> external_reference_count_;
   stdext::TypeId type_id_;
+  NodeMemoryUsage memory_usage_;
 
   // The "internal reference" to the object.
   std::shared_ptr<void> object_;
 };
 
-using ExternalReferenceLookup =
-    std::unordered_map<EntifyId, std::unique_ptr<ExternalReference>>;
+// Maps EntifyIds to their ExternalReferences.  The table is split into
+// independently locked shards so that producers on different threads only
+// contend with each other when their ids hash to the same shard.
+class ExternalReferenceLookup {
+ public:
+  // Calls |visitor| with the entry for |id| while its shard is locked.
+  // Returns false if there is no entry for |id|.
+  template <typename Visitor>
+  bool Visit(EntifyId id, Visitor&& visitor) const {
+    const Shard& shard = GetShard(id);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto found = shard.map.find(id);
+    if (found == shard.map.end()) {
+      return false;
+    }
+    visitor(*found->second);
+    return true;
+  }
+
+  // Returns the entry for |id| with its external reference count incremented,
+  // or nullptr if there is no such entry.  The increment happens while the
+  // shard is locked so that a concurrent RemoveUnreferenced() can not erase
+  // the entry in between.
+  ExternalReference* FindAndAddReference(EntifyId id) {
+    Shard& shard = GetShard(id);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto found = shard.map.find(id);
+    if (found == shard.map.end()) {
+      return nullptr;
+    }
+    found->second->increment_external_reference_count();
+    return found->second.get();
+  }
+
+  // Inserts |reference| for |id| and increments its external reference count.
+  // If another thread inserted an entry for |id| first, that entry is
+  // returned (also incremented) and |reference| is left untouched so that the
+  // caller can dispose of it.
+  ExternalReference* InsertAndAddReference(
+      EntifyId id, std::unique_ptr<ExternalReference>* reference) {
+    Shard& shard = GetShard(id);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto insert_results = shard.map.insert(std::make_pair(id, nullptr));
+    if (insert_results.second) {
+      insert_results.first->second = std::move(*reference);
+    }
+    insert_results.first->second->increment_external_reference_count();
+    return insert_results.first->second.get();
+  }
+
+  // Calls |visitor| with the id and entry of every entry, one shard at a
+  // time with that shard locked.
+  template <typename Visitor>
+  void ForEach(Visitor&& visitor) const {
+    for (const Shard& shard : shards_) {
+      std::lock_guard<std::mutex> lock(shard.mutex);
+      for (const auto& entry : shard.map) {
+        visitor(entry.first, *entry.second);
+      }
+    }
+  }
+
+  // Removes all entries that are no longer referenced (i.e. those whose only
+  // reference is the lookup entry itself), calling |on_remove| with each of
+  // them right before it is removed.
+  template <typename OnRemove>
+  void RemoveUnreferenced(OnRemove&& on_remove) {
+    for (Shard& shard : shards_) {
+      std::lock_guard<std::mutex> lock(shard.mutex);
+      for (auto iter = shard.map.begin(); iter != shard.map.end();) {
+        if (!iter->second->is_referenced()) {
+          on_remove(*iter->second);
+          iter = shard.map.erase(iter);
+        } else {
+          ++iter;
+        }
+      }
+    }
+  }
+
+ private:
+  static const size_t kNumShards = 64;
+
+  struct Shard {
+    mutable std::mutex mutex;
+    std::unordered_map<EntifyId, std::unique_ptr<ExternalReference>> map;
+  };
+
+  Shard& GetShard(EntifyId id) {
+    return shards_[ShardIndex(id)];
+  }
+  const Shard& GetShard(EntifyId id) const {
+    return shards_[ShardIndex(id)];
+  }
+  static size_t ShardIndex(EntifyId id) {
+    // Ids are usually content hashes, but mix the bits anyway in case a
+    // client hands out sequential ids.
+    uint64_t x = static_cast<uint64_t>(id);
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdULL;
+    x ^= x >> 33;
+    return static_cast<size_t>(x % kNumShards);
+  }
+
+  std::array<Shard, kNumShards> shards_;
+};
 
 }  // namespace entify
 
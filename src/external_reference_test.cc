@@ -0,0 +1,143 @@
+#include "src/external_reference.h"
+
+#include <memory>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace entify {
+
+namespace {
+const int kNumThreads = 8;
+const EntifyId kNumIds = 2000;
+
+std::unique_ptr<ExternalReference> MakeReference(EntifyId id) {
+  return std::unique_ptr<ExternalReference>(
+      new ExternalReference(std::make_shared<EntifyId>(id)));
+}
+
+EntifyId GetId(const ExternalReference& reference) {
+  return *static_cast<const EntifyId*>(reference.object().get());
+}
+}  // namespace
+
+TEST(ExternalReferenceLookupTests, InsertAndFind) {
+  ExternalReferenceLookup lookup;
+  EXPECT_EQ(nullptr, lookup.FindAndAddReference(1));
+
+  std::unique_ptr<ExternalReference> reference = MakeReference(1);
+  ExternalReference* inserted = lookup.InsertAndAddReference(1, &reference);
+  EXPECT_EQ(nullptr, reference);
+  EXPECT_EQ(1, inserted->external_reference_count());
+
+  EXPECT_EQ(inserted, lookup.FindAndAddReference(1));
+  EXPECT_EQ(2, inserted->external_reference_count());
+  EXPECT_EQ(nullptr, lookup.FindAndAddReference(2));
+}
+
+TEST(ExternalReferenceLookupTests, RemoveUnreferencedKeepsReferencedEntries) {
+  ExternalReferenceLookup lookup;
+  for (EntifyId id = 0; id < 10; ++id) {
+    std::unique_ptr<ExternalReference> reference = MakeReference(id);
+    ExternalReference* inserted = lookup.InsertAndAddReference(id, &reference);
+    if (id % 2 == 0) {
+      inserted->decrement_external_reference_count();
+    }
+  }
+
+  std::set<EntifyId> removed;
+  lookup.RemoveUnreferenced([&removed](const ExternalReference& reference) {
+    removed.insert(GetId(reference));
+  });
+
+  EXPECT_EQ(std::set<EntifyId>({0, 2, 4, 6, 8}), removed);
+  for (EntifyId id = 0; id < 10; ++id) {
+    EXPECT_EQ(id % 2 != 0, lookup.Visit(id, [](const ExternalReference&) {}));
+  }
+}
+
+TEST(ExternalReferenceLookupTests, ConcurrentInsertsOfTheSameIdKeepOneEntry) {
+  ExternalReferenceLookup lookup;
+
+  // Each thread tries to insert its own reference for every id, and records
+  // the entry that it got back and whether its own reference was taken.
+  std::vector<std::vector<ExternalReference*>> entries(kNumThreads);
+  std::vector<std::vector<bool>> inserted(kNumThreads);
+  std::vector<std::thread> threads;
+  for (int i = 0; i < kNumThreads; ++i) {
+    threads.emplace_back([&lookup, &entries, &inserted, i]() {
+      for (EntifyId id = 0; id < kNumIds; ++id) {
+        std::unique_ptr<ExternalReference> reference = MakeReference(id);
+        entries[i].push_back(lookup.InsertAndAddReference(id, &reference));
+        inserted[i].push_back(reference == nullptr);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  for (EntifyId id = 0; id < kNumIds; ++id) {
+    int num_inserted = 0;
+    for (int i = 0; i < kNumThreads; ++i) {
+      EXPECT_EQ(entries[0][id], entries[i][id]);
+      num_inserted += inserted[i][id] ? 1 : 0;
+    }
+    EXPECT_EQ(1, num_inserted);
+    EXPECT_EQ(kNumThreads, entries[0][id]->external_reference_count());
+    EXPECT_EQ(id, GetId(*entries[0][id]));
+  }
+}
+
+TEST(ExternalReferenceLookupTests,
+     RemoveUnreferencedDoesNotRemoveEntriesBeingFound) {
+  ExternalReferenceLookup lookup;
+  for (EntifyId id = 0; id < kNumIds; ++id) {
+    std::unique_ptr<ExternalReference> reference = MakeReference(id);
+    lookup.InsertAndAddReference(id, &reference)
+        ->decrement_external_reference_count();
+  }
+
+  // One thread finds and references every entry while another removes the
+  // unreferenced ones, so every entry is either found or removed first.
+  std::vector<EntifyId> found;
+  std::thread finder([&lookup, &found]() {
+    for (EntifyId id = 0; id < kNumIds; ++id) {
+      ExternalReference* reference = lookup.FindAndAddReference(id);
+      if (reference) {
+        EXPECT_EQ(id, GetId(*reference));
+        found.push_back(id);
+      }
+    }
+  });
+
+  std::mutex removed_mutex;
+  std::set<EntifyId> removed;
+  auto on_remove = [&removed_mutex, &removed](
+      const ExternalReference& reference) {
+    std::lock_guard<std::mutex> lock(removed_mutex);
+    removed.insert(GetId(reference));
+  };
+  std::thread remover([&lookup, &on_remove]() {
+    for (int i = 0; i < 100; ++i) {
+      lookup.RemoveUnreferenced(on_remove);
+    }
+  });
+
+  finder.join();
+  remover.join();
+  lookup.RemoveUnreferenced(on_remove);
+
+  for (EntifyId id : found) {
+    EXPECT_EQ(0u, removed.count(id));
+    EXPECT_TRUE(lookup.Visit(id, [](const ExternalReference& reference) {
+      EXPECT_EQ(1, reference.external_reference_count());
+    }));
+  }
+  EXPECT_EQ(static_cast<size_t>(kNumIds), found.size() + removed.size());
+}
+
+}  // namespace entify
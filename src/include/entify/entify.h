@@ -30,6 +30,94 @@ PUBLIC_API void EntifySubmit(
     EntifyContext context, EntifyReference render_tree,
     EntifyRenderTarget render_target);
 
+// Statistics about the work done to render a frame.  The counters include
+// the RenderTarget passes that were rendered since the previous frame.
+typedef struct {
+  int64_t draw_calls;
+  int64_t vertices;
+  int64_t program_switches;
+  int64_t texture_binds;
+  int64_t uniform_uploads;
+  int64_t buffer_binds;
+  int64_t render_target_passes;
+  // The GL calls made, which are only counted when the ENTIFY_GL_DISPATCH
+  // environment variable is set to "counting", and are 0 otherwise.
+  int64_t gl_calls;
+
+  // CPU time, in milliseconds, spent walking the draw tree, issuing GL
+  // commands, and swapping buffers.
+  double tree_walk_ms;
+  double gl_submission_ms;
+  double swap_ms;
+} EntifyFrameStats;
+
+// The number of most recent frames for which stats are kept.
+const int32_t kEntifyFrameStatsHistorySize = 300;
+
+// Copies the stats of the (at most) |max_frames| most recently submitted
+// frames into |frame_stats|, oldest first, and returns the number of frames
+// copied.
+PUBLIC_API int32_t EntifyGetFrameStats(
+    EntifyContext context, EntifyFrameStats* frame_stats, int32_t max_frames);
+
+// Sets each field of |result| to the |percentile|th percentile (clamped to
+// between 0 and 100) of that field over the frames returned by
+// EntifyGetFrameStats().  Returns the number of frames that the percentiles
+// were computed over, which is 0 if |percentile| is NaN.  If that is 0,
+// |result| is left untouched.
+PUBLIC_API int32_t EntifyGetFrameStatsPercentile(
+    EntifyContext context, double percentile, EntifyFrameStats* result);
+
+// GPU timing of individual passes.  It is enabled by setting the
+// ENTIFY_GPU_TIMING environment variable to "query", which uses
+// GL_EXT_disjoint_timer_query if available, or to "finish", a diagnostic mode
+// that brackets each pass with glFinish() and measures CPU time instead,
+// which stalls the pipeline.  Query results are read back a few frames after
+// the work was submitted.  Only work done on the thread that created the
+// context is timed.
+typedef enum {
+  // The rendering of the RenderTarget node |id|.
+  kEntifyGPUTimingTypeRenderTarget,
+  // The rendering of |id|, a child of the DrawSequence submitted to a window,
+  // or the submitted draw tree itself if it is not a DrawSequence.
+  kEntifyGPUTimingTypeDrawTree,
+} EntifyGPUTimingType;
+
+typedef struct {
+  // The number of frames submitted before the work was done.  RenderTarget
+  // passes are rendered while parsing, so they count towards the next frame.
+  int64_t frame_number;
+  // One of EntifyGPUTimingType.
+  int32_t type;
+  // The node the work was done for, which may have been released since.
+  EntifyId id;
+  double gpu_ms;
+} EntifyGPUTiming;
+
+// The number of most recent GPU timings that are kept.
+const int32_t kEntifyGPUTimingHistorySize = 1024;
+
+// Copies the (at most) |max_timings| most recently read back GPU timings into
+// |timings|, oldest first, and returns the number of timings copied.
+PUBLIC_API int32_t EntifyGetGPUTimings(
+    EntifyContext context, EntifyGPUTiming* timings, int32_t max_timings);
+
+typedef struct {
+  // The name of the GL function, which stays valid for as long as the
+  // library is loaded.
+  const char* function;
+  int64_t calls;
+} EntifyGLCallCount;
+
+// Copies the (at most) |max_counts| GL functions that were called most often
+// during the most recently submitted frame into |counts|, most called first,
+// and returns the number of functions copied.  Calls are only counted when
+// the ENTIFY_GL_DISPATCH environment variable is set to "counting", and the
+// counts cover the GL work of every context, since GL calls are dispatched
+// through one table for the whole process.  Returns 0 otherwise.
+PUBLIC_API int32_t EntifyGetGLCallCounts(
+    EntifyContext context, EntifyGLCallCount* counts, int32_t max_counts);
+
 #ifdef __cplusplus  
 } 
 #endif
@@ -20,6 +20,13 @@ typedef int64_t EntifyId;
 const EntifyContext kEntifyInvalidContext = 0;
 const EntifyReference kEntifyInvalidReference = 0;
 
+// The functions below may be called concurrently from multiple threads on the
+// same context.  Looking up and counting references scales with the number
+// of threads, as does the CPU work of creating nodes (decoding them and
+// converting pixel data), but nodes that own GL objects are then created one
+// at a time, and UniformValues and Samplers are the only nodes whose
+// creation runs fully in parallel.
+
 PUBLIC_API EntifyContext EntifyCreateContext();
 PUBLIC_API void EntifyDestroyContext(EntifyContext context);
 
@@ -34,10 +41,10 @@ PUBLIC_API EntifyReference
     EntifyCreateReferenceFromFlatBuffer(
         EntifyContext context, EntifyId id, const char* data, size_t data_size);
 
-// Returns 1 if there was an error from the previous
-// EntifyCreateReferenceFromFlatBuffer() or
-// EntifyCreateReferenceFromProtocolBuffer() call.  If 1 is returned,
-// then |message| will be set to point to an error message.
+// Returns 1 if there was an error from the calling thread's previous
+// EntifyCreateReferenceFromFlatBuffer(),
+// EntifyCreateReferenceFromProtocolBuffer() or EntifyUpdate*() call.  If 1 is
+// returned, then |message| will be set to point to an error message.
 PUBLIC_API int EntifyGetLastError(
     EntifyContext context, const char** message);
 
@@ -47,6 +54,126 @@ PUBLIC_API void EntifyAddReference(
 PUBLIC_API void EntifyReleaseReference(
     EntifyContext context, EntifyReference reference);
 
+// Overwrites the data of the UniformValues node |id|, which must have been
+// created with |updatable| set, with |data_size| bytes laid out as for its
+// creation.  The new values are used from the next EntifySubmit() on, but
+// RenderTargets that were already rendered with the node are not rendered
+// again.  Returns 1 on success, and 0 on failure, in which case the error
+// can be retrieved with EntifyGetLastError().
+PUBLIC_API int EntifyUpdateUniformValues(
+    EntifyContext context, EntifyId id, const char* data, size_t data_size);
+
+// Overwrites the |width| x |height| region with its corner at (|x|, |y|) of
+// the PixelData texture |id|, which must have been created with |updatable|
+// set.  |data| holds the region's pixels in the texture's pixel type and
+// layout, with rows |stride_in_bytes| apart, and (|x|, |y|) counts from the
+// texture's origin, all as for its creation.
+// The new pixels are used from the next EntifySubmit() on.  If the texture is
+// |double_buffered|, updates are written to a second copy of the texture,
+// never the one sampled by the last submitted frame, and all updates made
+// before an EntifySubmit() become visible together at its start.  Returns 1
+// on success, and 0 on failure, in which case the error can be retrieved with
+// EntifyGetLastError().
+PUBLIC_API int EntifyUpdateTextureRegion(
+    EntifyContext context, EntifyId id, int32_t x, int32_t y, int32_t width,
+    int32_t height, int32_t stride_in_bytes, const char* data);
+
+typedef enum {
+  // Inserts the draw tree before the child at |index|, or at the end if
+  // |index| is the number of children.
+  kEntifyDrawSequenceEditInsert,
+  kEntifyDrawSequenceEditRemove,
+  kEntifyDrawSequenceEditReplace,
+} EntifyDrawSequenceEditType;
+
+typedef struct {
+  // One of EntifyDrawSequenceEditType.
+  int32_t type;
+  int32_t index;
+  // The draw tree to insert or to replace the child with.  Not used for
+  // removals.
+  EntifyId draw_tree_id;
+} EntifyDrawSequenceEdit;
+
+// Applies |num_edits| edits, in order, to the children of the DrawSequence
+// node |id|, which must have been created with |updatable| set.  Each edit
+// sees the indices as left by the edits before it.  Unlike creating a new
+// sequence, only the edited children are processed, and a sequence whose
+// children are all immutable keeps its list of draw calls updated in place
+// rather than gathering it from the tree every frame.  The changes are drawn
+// from the next EntifySubmit() on, but RenderTargets that were already
+// created from the sequence keep what it held at the time.  DrawTemplates can
+// not be created from a draw tree that contains an updatable sequence.
+// Returns 1 on success, and 0 on failure, in which case the error can be
+// retrieved with EntifyGetLastError() and the edits before the failed one
+// remain applied.
+PUBLIC_API int EntifyUpdateDrawSequence(
+    EntifyContext context, EntifyId id, const EntifyDrawSequenceEdit* edits,
+    size_t num_edits);
+
+// Memory accounting for the nodes held by the registry.  Nodes are accounted
+// for from the moment they are created until they are garbage collected.
+typedef enum {
+  kEntifyNodeTypeVertexBuffer,
+  kEntifyNodeTypeUniformValues,
+  kEntifyNodeTypeVertexShader,
+  kEntifyNodeTypeFragmentShader,
+  kEntifyNodeTypePipeline,
+  kEntifyNodeTypeDrawTree,
+  kEntifyNodeTypeSampler,
+  kEntifyNodeTypePixelData,
+  kEntifyNodeTypeRenderTarget,
+  kEntifyNodeTypeIndexBuffer,
+  kEntifyNodeTypeCount,
+} EntifyNodeType;
+
+typedef struct {
+  int64_t node_count;
+  // Memory held by the nodes in system memory.
+  int64_t cpu_bytes;
+  // An estimate of the GPU memory held by the nodes' GL objects.
+  int64_t gpu_bytes;
+} EntifyMemoryUsage;
+
+typedef struct {
+  EntifyId id;
+  // One of EntifyNodeType.
+  int32_t node_type;
+  int64_t cpu_bytes;
+  int64_t gpu_bytes;
+} EntifyNodeMemoryUsage;
+
+// The total includes memory that the renderer holds for itself rather than
+// for any one node, such as merged vertex buffers and the free room of
+// texture atlas pages, so it can be more than the sum of
+// EntifyGetMemoryUsageByNodeType().
+PUBLIC_API void EntifyGetMemoryUsage(
+    EntifyContext context, EntifyMemoryUsage* total);
+
+// |by_node_type| must point to kEntifyNodeTypeCount entries, indexed by
+// EntifyNodeType.
+PUBLIC_API void EntifyGetMemoryUsageByNodeType(
+    EntifyContext context, EntifyMemoryUsage* by_node_type);
+
+// Writes the (at most) |max_nodes| live nodes that use the most memory (CPU
+// and GPU combined) to |nodes|, largest first, and returns how many were
+// written.
+PUBLIC_API int32_t EntifyGetLargestNodes(
+    EntifyContext context, EntifyNodeMemoryUsage* nodes, int32_t max_nodes);
+
+// Called when the creation of a node pushes the estimated GPU memory usage
+// above the budget.  It is called again only after usage has dropped back
+// down to or below the budget and exceeds it again.
+typedef void (*EntifyMemoryBudgetCallback)(
+    EntifyContext context, int64_t gpu_bytes, int64_t gpu_budget_bytes,
+    void* user_data);
+
+// Sets the GPU memory budget and the callback for when it is exceeded.  A
+// budget of 0 or a NULL |callback| disables the callback.
+PUBLIC_API void EntifySetGPUMemoryBudget(
+    EntifyContext context, int64_t gpu_budget_bytes,
+    EntifyMemoryBudgetCallback callback, void* user_data);
+
 #ifdef __cplusplus
 } 
 #endif
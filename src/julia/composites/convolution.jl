@@ -100,8 +100,9 @@ function CreateConvolutionBlitter(kernel::ByteKernel{2})
 
   blitter = CreateBlitter(convolution_shader)
 
+  # A luminance texture, whose red channel holds the kernel value.
   kernel_sampler = Sampler(
-      PixelData(map(x -> RGBA(x, x, x, x), kernel.data)),
+      PixelData(map(Gray, kernel.data)),
       wrap=SamplerWrapTypeTypeClamp, filt=SamplerFilterTypeTypeNearest)
 
   return function(source::Sampler, vertex_buffer=FullscreenBlitterVertexBuffer)
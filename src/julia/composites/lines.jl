@@ -123,17 +123,21 @@ function GetLinePathTriangleVertices(
   return vertices
 end
 
+# Set |transient| for paths whose points change from frame to frame.
 function LinePath(
     points::Vector{vec2}, width_radius::AbstractFloat, color::vec4,
-    transform_matrix::mat4; closed_path::Bool = false)
+    transform_matrix::mat4; closed_path::Bool = false,
+    transient::Bool = false)
   return DrawCall(pipeline,
                   VertexBuffer(GetLinePathTriangleVertices(
-                      points, width_radius, color, closed_path)),
+                      points, width_radius, color, closed_path),
+                      transient=transient),
                   UniformValues(transform_matrix), nothing)
 end
 
 Polygon(points::Vector{vec2}, width_radius::AbstractFloat, color::vec4,
-        transform_matrix::mat4) = LinePath(
-    points, width_radius, color, transform_matrix, closed_path=true)
+        transform_matrix::mat4; transient::Bool = false) = LinePath(
+    points, width_radius, color, transform_matrix, closed_path=true,
+    transient=transient)
 
 end
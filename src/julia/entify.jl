@@ -47,6 +47,10 @@ export BlendParameters
 @ImportEnum(SamplerWrapType)
 @ImportEnum(SamplerFilterType)
 @ImportEnum(PixelType)
+@ImportEnum(PixelOrigin)
+@ImportEnum(ChannelOrder)
+@ImportEnum(IndexType)
+@ImportEnum(PrimitiveMode)
 
 _RendererNode(x::entify.renderer.RendererNodeUnion) =
     entify.renderer.RendererNode(
@@ -110,6 +114,12 @@ function _MapChildren(params_with_types_expr)
   return (mapped, children)
 end
 
+# Ids derived from contents are never negative, so that the negative ids can
+# be handed out by _NewUniqueId() to nodes that must not be shared with others
+# created from the same contents, such as updatable ones.
+const _last_unique_id = Threads.Atomic{Lib.EntifyId}(0)
+_NewUniqueId() = -(Threads.atomic_add!(_last_unique_id, Lib.EntifyId(1)) + 1)
+
 function _GetDataHash(data::Vector{UInt8})
   data_hash = Vector{UInt8}(undef, sizeof(Lib.EntifyId))
 
@@ -119,7 +129,7 @@ function _GetDataHash(data::Vector{UInt8})
 
   @assert (blake2s_result == 0) "Failed to hash."
 
-  return reinterpret(Lib.EntifyId, data_hash)[1]
+  return reinterpret(Lib.EntifyId, data_hash)[1] & typemax(Lib.EntifyId)
 end
 
 macro MakeWrapper(node_name, base_type, flatbuffer_constructor, params)
@@ -202,19 +212,73 @@ end
 export ReferenceNode
 
 @MakeTextureWrapper(PixelData)
-# The provided |image| is in column-major format with origin in bottom left.
-function PixelData(image::Array{T, 2} where T)
-  image = transpose(image)[:,end:-1:1]
+# Images are indexed by row, from the top, and then by column, so their rows
+# are passed to the renderer top first, which flips them while uploading.
+_ImageToTextureRows(image::Array{T, 2} where T) = permutedims(image)
+_ImageToTextureData(rows::Array{T, 2} where T) =
+    Vector{UInt8}(reinterpret(UInt8, vec(rows)))
+# The provided |image| is indexed by row, from the top, and then by column.
+# Its rows are passed top first, with PixelOriginTopLeft.
+# If |compress| is set, RGB and RGBA images are compressed by the renderer,
+# which quarters their memory use where the implementation supports ETC.  If
+# |straight_alpha| is set, the colors of RGBA images are premultiplied by the
+# renderer.  If |generate_mipmaps| is set, the renderer generates mipmaps for
+# samplers with mipmapped min filters, where the image's size allows it.  If
+# |atlas| is set, small RGBA images share a texture with others, and shaders
+# that sample them must map their coordinates with a vec4 uniform named after
+# the sampler with a "_uv_transform" suffix, and sample them with clamped,
+# unmipmapped Samplers, or their DrawCalls are rejected.
+function PixelData(image::Array{T, 2} where T;
+                   updatable::Bool=false, double_buffered::Bool=false,
+                   compress::Bool=false, straight_alpha::Bool=false,
+                   generate_mipmaps::Bool=false, atlas::Bool=false)
+  color_type = eltype(image)
+  rows = _ImageToTextureRows(image)
   return PixelData(
-      Int32(size(image)[1]), Int32(size(image)[2]),
-      Int32(size(image)[1] * sizeof(typeof(image).parameters[1])),
-      ColorTypeToEntify(typeof(image).parameters[1]),
-      Vector{UInt8}(reinterpret(UInt8, reshape(image, length(image)))))
+      Int32(size(rows)[1]), Int32(size(rows)[2]),
+      Int32(size(rows)[1] * sizeof(color_type)),
+      ColorTypeToEntify(color_type), _ImageToTextureData(rows), updatable,
+      double_buffered, compress, PixelOriginTopLeft,
+      ColorTypeToChannelOrder(color_type), straight_alpha, generate_mipmaps,
+      atlas)
 end
 export PixelData
 
+# A PixelData texture whose pixels can be changed in place with
+# UpdateTextureRegion().  It gets a unique id instead of one derived from its
+# contents, so that it is not shared with other textures created from the
+# same image, and so that the nodes that refer to it keep their ids across
+# updates.
+struct UpdatablePixelData <: Texture
+  node_info::NodeInfo
+  width_in_pixels::Int32
+  height_in_pixels::Int32
+  pixel_type::PixelType
+  channel_order::ChannelOrder
+
+  function UpdatablePixelData(image::Array{T, 2} where T;
+                              double_buffered::Bool=false)
+    pixel_data = PixelData(
+        image, updatable=true, double_buffered=double_buffered)
+    return new(
+        NodeInfo(pixel_data.node_info.data, _NewUniqueId(),
+                 pixel_data.node_info.children),
+        pixel_data.width_in_pixels, pixel_data.height_in_pixels,
+        pixel_data.pixel_type, pixel_data.channel_order)
+  end
+end
+export UpdatablePixelData
+
 @MakeTextureWrapper(RenderTarget, (
-    width_in_pixels::Signed, height_in_pixels::Signed, draw_tree::DrawTree))
+    width_in_pixels::Signed, height_in_pixels::Signed, draw_tree::DrawTree,
+    pixel_type::PixelType, generate_mipmaps::Bool))
+# Formats that can not be rendered to, such as PixelTypeLuminance and
+# PixelTypeAlpha on GLES2, fall back to PixelTypeRGBA.
+RenderTarget(width_in_pixels::Signed, height_in_pixels::Signed,
+             draw_tree::DrawTree; pixel_type::PixelType=PixelTypeRGBA,
+             generate_mipmaps::Bool=false) =
+    RenderTarget(width_in_pixels, height_in_pixels, draw_tree, pixel_type,
+                 generate_mipmaps)
 export RenderTarget
 
 @MakeNodeWrapper(Sampler, (
@@ -223,12 +287,22 @@ export RenderTarget
     wrap_t::SamplerWrapType,
     min_filter::SamplerFilterType,
     max_filter::SamplerFilterType))
+# |min_filt| may also be one of the mipmapped filters, such as
+# SamplerFilterTypeTypeLinearMipmapLinear.
 Sampler(texture::Texture;
-        wrap=SamplerWrapTypeTypeRepeat, filt=SamplerFilterTypeTypeLinear) =
+        wrap=SamplerWrapTypeTypeRepeat, filt=SamplerFilterTypeTypeLinear,
+        min_filt=filt) =
     Sampler(
-        texture, wrap, wrap, filt, filt)
+        texture, wrap, wrap, min_filt, filt)
 export Sampler
 
+# Wraps vertex attribute components that shaders read normalized to [0, 1],
+# for UInt8, or [-1, 1], for Int16.  E.g. Normalized(SVector{4, UInt8}(...)).
+struct Normalized{T}
+  value::T
+end
+export Normalized
+
 DataTypeToPrimitiveType = Dict(
   Sampler => PrimitiveTypeSampler,
   Float32 => PrimitiveTypeFloat32V1,
@@ -239,11 +313,40 @@ DataTypeToPrimitiveType = Dict(
   UInt8 => PrimitiveTypeUInt8V1,
   SVector{2, UInt8} => PrimitiveTypeUInt8V2,
   SVector{3, UInt8} => PrimitiveTypeUInt8V3,
-  SVector{4, UInt8} => PrimitiveTypeUInt8V4)
+  SVector{4, UInt8} => PrimitiveTypeUInt8V4,
+  Float16 => PrimitiveTypeFloat16V1,
+  SVector{2, Float16} => PrimitiveTypeFloat16V2,
+  SVector{3, Float16} => PrimitiveTypeFloat16V3,
+  SVector{4, Float16} => PrimitiveTypeFloat16V4,
+  Int16 => PrimitiveTypeInt16V1,
+  SVector{2, Int16} => PrimitiveTypeInt16V2,
+  SVector{3, Int16} => PrimitiveTypeInt16V3,
+  SVector{4, Int16} => PrimitiveTypeInt16V4,
+  UInt16 => PrimitiveTypeUInt16V1,
+  SVector{2, UInt16} => PrimitiveTypeUInt16V2,
+  SVector{3, UInt16} => PrimitiveTypeUInt16V3,
+  SVector{4, UInt16} => PrimitiveTypeUInt16V4,
+  Normalized{UInt8} => PrimitiveTypeUNorm8V1,
+  Normalized{SVector{2, UInt8}} => PrimitiveTypeUNorm8V2,
+  Normalized{SVector{3, UInt8}} => PrimitiveTypeUNorm8V3,
+  Normalized{SVector{4, UInt8}} => PrimitiveTypeUNorm8V4,
+  Normalized{Int16} => PrimitiveTypeSNorm16V1,
+  Normalized{SVector{2, Int16}} => PrimitiveTypeSNorm16V2,
+  Normalized{SVector{3, Int16}} => PrimitiveTypeSNorm16V3,
+  Normalized{SVector{4, Int16}} => PrimitiveTypeSNorm16V4)
 ToPrimitiveType(t) = DataTypeToPrimitiveType[typeof(t)]
 
-NamedPrimitiveTypeFromTuple(t) =
-    NamedPrimitiveType(DataTypeToPrimitiveType[t[1]], t[2])
+# Uniform arrays are given as NTuples of their elements, e.g.
+# NTuple{9, Float32} for "uniform float name[9];".  Their elements must be
+# Float32s, vec2-4s or mat4s.
+_ArrayElementTypeAndLength(::Type{NTuple{N, T}}) where {N, T} = (T, N)
+_ArrayElementTypeAndLength(t::Type) = (t, 0)
+
+function NamedPrimitiveTypeFromTuple(t)
+  element_type, array_length = _ArrayElementTypeAndLength(t[1])
+  return NamedPrimitiveType(
+      DataTypeToPrimitiveType[element_type], t[2], Int32(array_length))
+end
 PrimitiveTypeFromTuple(t) = DataTypeToPrimitiveType[t[1]]
 
 DataTypeToGLSLString = Dict(
@@ -252,9 +355,38 @@ DataTypeToGLSLString = Dict(
   SVector{3, Float32} => "vec3",
   SVector{4, Float32} => "vec4",
   SMatrix{4, 4, Float32, 16} => "mat4",
-  Sampler => "sampler2D")
-GetGLSLDeclarationLine(type::String, decl::Tuple{DataType, String}) =
-    "$type $(DataTypeToGLSLString[decl[1]]) $(decl[2]);\n"
+  Sampler => "sampler2D",
+  # Shaders read all other vertex attribute types as floats.
+  UInt8 => "float",
+  SVector{2, UInt8} => "vec2",
+  SVector{3, UInt8} => "vec3",
+  SVector{4, UInt8} => "vec4",
+  Float16 => "float",
+  SVector{2, Float16} => "vec2",
+  SVector{3, Float16} => "vec3",
+  SVector{4, Float16} => "vec4",
+  Int16 => "float",
+  SVector{2, Int16} => "vec2",
+  SVector{3, Int16} => "vec3",
+  SVector{4, Int16} => "vec4",
+  UInt16 => "float",
+  SVector{2, UInt16} => "vec2",
+  SVector{3, UInt16} => "vec3",
+  SVector{4, UInt16} => "vec4",
+  Normalized{UInt8} => "float",
+  Normalized{SVector{2, UInt8}} => "vec2",
+  Normalized{SVector{3, UInt8}} => "vec3",
+  Normalized{SVector{4, UInt8}} => "vec4",
+  Normalized{Int16} => "float",
+  Normalized{SVector{2, Int16}} => "vec2",
+  Normalized{SVector{3, Int16}} => "vec3",
+  Normalized{SVector{4, Int16}} => "vec4")
+function GetGLSLDeclarationLine(type::String, decl::Tuple{DataType, String})
+  element_type, array_length = _ArrayElementTypeAndLength(decl[1])
+  array_suffix = array_length > 0 ? "[$array_length]" : ""
+  return "$type $(DataTypeToGLSLString[element_type]) " *
+         "$(decl[2])$array_suffix;\n"
+end
 
 abstract type AbstractGLSLVertexShader <: Node end
 @MakeWrapper(
@@ -351,23 +483,32 @@ abstract type AbstractPipeline <: Node end
     _RendererNode, (
     vertex_shader::AbstractGLSLVertexShader,
     fragment_shader::AbstractGLSLFragmentShader,
-    blend_parameters::BlendParameters))
+    blend_parameters::BlendParameters,
+    primitive_mode::PrimitiveMode))
 PipelineUntyped(vertex_shader::AbstractGLSLVertexShader,
-                fragment_shader::AbstractGLSLFragmentShader) =
+                fragment_shader::AbstractGLSLFragmentShader;
+                primitive_mode::PrimitiveMode=PrimitiveModeTriangles) =
     PipelineUntyped(vertex_shader, fragment_shader,
              Entify.BlendParameters(
                  Entify.BlendCoefficientOne,
                  Entify.BlendCoefficientOneMinusSrcAlpha,
                  Entify.BlendCoefficientOne,
-                 Entify.BlendCoefficientOneMinusSrcAlpha))
+                 Entify.BlendCoefficientOneMinusSrcAlpha),
+             primitive_mode)
+# |primitive_mode| selects how the vertices of draw calls made with the
+# pipeline are assembled, e.g. PrimitiveModeTriangleStrip for quads, or
+# PrimitiveModePoints for particles that set gl_PointSize.
 struct Pipeline{i, vu, fu} <: AbstractPipeline
   node_info::NodeInfo
 
   function Pipeline(
       vertex_shader::GLSLVertexShader{vi, vo, vu},
-      fragment_shader::GLSLFragmentShader{vo, fu}) where {vi, vo, vu, fu}
+      fragment_shader::GLSLFragmentShader{vo, fu};
+      primitive_mode::PrimitiveMode=PrimitiveModeTriangles) where {
+          vi, vo, vu, fu}
     return new{vi, vu, fu}(
-        PipelineUntyped(vertex_shader, fragment_shader).node_info)
+        PipelineUntyped(vertex_shader, fragment_shader,
+                        primitive_mode=primitive_mode).node_info)
   end
 end
 
@@ -378,45 +519,94 @@ abstract type AbstractVertexBuffer <: Node end
 @MakeWrapper(
     VertexBuffer, VertexBufferUntyped, AbstractVertexBuffer,
     _RendererNode, nothing)
-function VertexBufferUntyped(vertices::Vector{<:Tuple})
+# Set |transient| for geometry that is only drawn for a frame or two, so that
+# it is streamed to the GPU when drawn instead of getting a buffer of its own.
+# Set |weld_vertices| to have duplicate vertices of a triangle list merged,
+# so that they are only stored and transformed once.
+function VertexBufferUntyped(vertices::Vector{<:Tuple};
+                             transient::Bool=false,
+                             weld_vertices::Bool=false)
   @assert (length(vertices) > 0)
   types = ToPrimitiveType.(vertices[1])
   offsets = accumulate(+, sizeof.([vertices[1]...]))
   return VertexBufferUntyped([types...], Int32(offsets[end]),
                       Vector{UInt8}(reinterpret(UInt8, vertices)),
-                      Int32.(vcat([0], offsets[1:end-1])))
+                      Int32.(vcat([0], offsets[1:end-1])), transient,
+                      weld_vertices)
 end
 
 struct VertexBuffer{t} <: AbstractVertexBuffer
   node_info::NodeInfo
 
-  function VertexBuffer(vertices::Vector{<:Tuple})
+  function VertexBuffer(vertices::Vector{<:Tuple}; transient::Bool=false,
+                        weld_vertices::Bool=false)
     return new{Tuple{typeof.(vertices[1])...}}(
-        VertexBufferUntyped(vertices).node_info)
+        VertexBufferUntyped(vertices, transient=transient,
+                            weld_vertices=weld_vertices).node_info)
   end
 end
 export VertexBufferUntyped
 export VertexBuffer
 
+@MakeWrapper(IndexBuffer, Node, _RendererNode, (
+    type::IndexType, data::Vector{UInt8}, optimize_vertex_cache::Bool))
+# |indices| are 1-based, and are stored with the smallest type that fits
+# them.  Set |optimize_vertex_cache| if they form a triangle list, to have
+# the triangles reordered for the GPU's vertex cache.
+function IndexBuffer(indices::Vector{<:Integer};
+                     optimize_vertex_cache::Bool=false)
+  @assert (length(indices) > 0 && minimum(indices) >= 1)
+  if maximum(indices) <= typemax(UInt8) + 1
+    return IndexBuffer(
+        IndexTypeUInt8, Vector{UInt8}(indices .- 1), optimize_vertex_cache)
+  else
+    @assert (maximum(indices) <= typemax(UInt16) + 1)
+    return IndexBuffer(
+        IndexTypeUInt16,
+        Vector{UInt8}(reinterpret(UInt8, Vector{UInt16}(indices .- 1))),
+        optimize_vertex_cache)
+  end
+end
+export IndexBuffer
+
 function ColorTypeToEntify(type::Type)::PixelType
-  if type <: ColorTypes.RGB{FixedPointNumbers.Normed{UInt8,8}}
+  if (type <: ColorTypes.RGB{FixedPointNumbers.Normed{UInt8,8}} ||
+      type <: ColorTypes.BGR{FixedPointNumbers.Normed{UInt8,8}})
     return PixelTypeRGB
-  elseif type <: ColorTypes.RGBA{FixedPointNumbers.Normed{UInt8,8}}
+  elseif (type <: ColorTypes.RGBA{FixedPointNumbers.Normed{UInt8,8}} ||
+          type <: ColorTypes.BGRA{FixedPointNumbers.Normed{UInt8,8}} ||
+          type <: ColorTypes.ARGB{FixedPointNumbers.Normed{UInt8,8}})
     return PixelTypeRGBA
+  elseif type <: ColorTypes.Gray{FixedPointNumbers.Normed{UInt8,8}}
+    return PixelTypeLuminance
+  elseif type <: ColorTypes.GrayA{FixedPointNumbers.Normed{UInt8,8}}
+    return PixelTypeLuminanceAlpha
   else
     error("Invalid pixel type")
   end
 end
 
+function ColorTypeToChannelOrder(type::Type)::ChannelOrder
+  if (type <: ColorTypes.BGR{FixedPointNumbers.Normed{UInt8,8}} ||
+      type <: ColorTypes.BGRA{FixedPointNumbers.Normed{UInt8,8}})
+    return ChannelOrderBGRA
+  elseif type <: ColorTypes.ARGB{FixedPointNumbers.Normed{UInt8,8}}
+    return ChannelOrderARGB
+  else
+    return ChannelOrderRGBA
+  end
+end
+
 abstract type AbstractUniformValues <: Node end
 @MakeWrapper(
     UniformValues, UniformValuesUntyped, AbstractUniformValues,
     _RendererNode, (
         types::Vector{PrimitiveType},
         data::Vector{UInt8},
-        samplers::Vector{Sampler}))
-function UniformValuesUntyped(values...)
-  entify_types = map(ToPrimitiveType, [values...])
+        samplers::Vector{Sampler},
+        updatable::Bool,
+        array_lengths::Vector{Int32}))
+function _UniformValuesData(values...)
   non_sampler_data = Vector{UInt8}()
   samplers = Vector{Sampler}()
 
@@ -428,14 +618,32 @@ function UniformValuesUntyped(values...)
     AppendData!(value)
   end
 
-  return UniformValuesUntyped(entify_types, non_sampler_data, samplers)
+  return (non_sampler_data, samplers)
+end
+function UniformValuesUntyped(values...; updatable::Bool=false)
+  non_sampler_data, samplers = _UniformValuesData(values...)
+  element_types_and_lengths =
+      map(x -> _ArrayElementTypeAndLength(typeof(x)), [values...])
+  return UniformValuesUntyped(
+      map(x -> DataTypeToPrimitiveType[x[1]], element_types_and_lengths),
+      non_sampler_data, samplers, updatable,
+      map(x -> Int32(x[2]), element_types_and_lengths))
 end
 struct UniformValues{t} <: AbstractUniformValues
   node_info::NodeInfo
 
-  function UniformValues(values...)
-    return new{Tuple{map(typeof, [values...])...}}(
-        UniformValuesUntyped(values...).node_info)
+  # If |updatable| is set, the values can later be changed in place with
+  # UpdateUniformValues().  The node then gets a unique id instead of one
+  # derived from its contents, so that it is not shared with other nodes
+  # created with the same values, and so that the nodes that refer to it keep
+  # their ids across updates.
+  function UniformValues(values...; updatable::Bool=false)
+    node_info = UniformValuesUntyped(values..., updatable=updatable).node_info
+    if updatable
+      node_info = NodeInfo(
+          node_info.data, _NewUniqueId(), node_info.children)
+    end
+    return new{Tuple{map(typeof, [values...])...}}(node_info)
   end
 end
 export UniformValuesUntyped
@@ -446,7 +654,15 @@ abstract type AbstractDrawCall <: DrawTree end
     DrawCall, DrawCallUntyped, AbstractDrawCall, _DrawTree,
     ( pipeline::AbstractPipeline, vertex_buffer::AbstractVertexBuffer,
       vertex_uniform_values::Union{AbstractUniformValues, Nothing},
-      fragment_uniform_values::Union{AbstractUniformValues, Nothing}))
+      fragment_uniform_values::Union{AbstractUniformValues, Nothing},
+      index_buffer::Union{IndexBuffer, Nothing}))
+DrawCallUntyped(pipeline::AbstractPipeline,
+                vertex_buffer::AbstractVertexBuffer,
+                vertex_uniform_values::Union{AbstractUniformValues, Nothing},
+                fragment_uniform_values::Union{AbstractUniformValues,
+                                               Nothing}) =
+    DrawCallUntyped(pipeline, vertex_buffer, vertex_uniform_values,
+                    fragment_uniform_values, nothing)
 DrawCallUntyped(pipeline::AbstractPipeline,
                 vertex_buffer::AbstractVertexBuffer) =
     DrawCallUntyped(pipeline, vertex_buffer, nothing, nothing)
@@ -456,11 +672,12 @@ struct DrawCall{vi, vu, fu} <: AbstractDrawCall
   function DrawCall(
       pipeline::Pipeline{vi, vu, fu}, vertex_buffer::VertexBuffer{vi},
       vertex_uniform_values::Union{UniformValues{vu}, Nothing},
-      fragment_uniform_values::Union{UniformValues{fu}, Nothing}) where
+      fragment_uniform_values::Union{UniformValues{fu}, Nothing},
+      index_buffer::Union{IndexBuffer, Nothing}=nothing) where
           {vi, vu, fu}
     return new{vi, vu, fu}(DrawCallUntyped(
         pipeline, vertex_buffer, vertex_uniform_values,
-        fragment_uniform_values).node_info)
+        fragment_uniform_values, index_buffer).node_info)
   end
 end
 
@@ -470,12 +687,59 @@ DrawCall(pipeline, vertex_buffer) =
 export DrawCallUntyped
 export DrawCall
 
-@MakeWrapper(DrawSequence, DrawTree, _DrawTree, (draw_trees::Vector{<:DrawTree},))
+@MakeWrapper(DrawSequence, DrawTree, _DrawTree, (
+    draw_trees::Vector{<:DrawTree}, updatable::Bool))
+DrawSequence(draw_trees::Vector{<:DrawTree}) = DrawSequence(draw_trees, false)
 export DrawSequence
 
+# A DrawSequence whose children can be inserted, removed and replaced in place
+# with InsertIntoDrawSequence(), RemoveFromDrawSequence() and
+# ReplaceInDrawSequence().  It gets a unique id instead of one derived from
+# its contents, so that the nodes that refer to it keep their ids across
+# edits.
+struct UpdatableDrawSequence <: DrawTree
+  node_info::NodeInfo
+
+  function UpdatableDrawSequence(draw_trees::Vector{<:DrawTree})
+    node_info = DrawSequence(draw_trees, true).node_info
+    return new(NodeInfo(node_info.data, _NewUniqueId(),
+                        node_info.children))
+  end
+end
+UpdatableDrawSequence() = UpdatableDrawSequence(DrawTree[])
+export UpdatableDrawSequence
+
 @MakeWrapper(DrawSet, DrawTree, _DrawTree, (draw_trees::Vector{<:DrawTree},))
 export DrawSet
 
+# A draw tree that is submitted once and then drawn through
+# DrawTemplateInstances, each of which only carries new values for the
+# template's parameters.  The draw tree can not contain an updatable
+# DrawSequence.
+@MakeWrapper(DrawTemplate, DrawTree, _DrawTree, (
+    draw_tree::DrawTree,
+    parameters::Vector{entify.renderer.DrawTemplateParameter}))
+# Each of |parameters| is a (name, uniform_values, index) tuple that binds a
+# parameter to the |index|th value of |uniform_values|, which must be used by
+# |draw_tree|.
+function DrawTemplate(
+    draw_tree::DrawTree,
+    parameters::Vector{<:Tuple{String, AbstractUniformValues, Integer}})
+  return DrawTemplate(draw_tree, map(
+      p -> entify.renderer.DrawTemplateParameter(
+          p[1], p[2].node_info.id, Int32(p[3] - 1)),
+      parameters))
+end
+export DrawTemplate
+
+@MakeWrapper(DrawTemplateInstance, DrawTree, _DrawTree, (
+    draw_template::DrawTemplate, parameters::Vector{UInt8}))
+# |values| are the values of the template's parameters, in the order they
+# were declared.
+DrawTemplateInstance(draw_template::DrawTemplate, values...) =
+    DrawTemplateInstance(draw_template, _UniformValuesData(values...)[1])
+export DrawTemplateInstance
+
 struct ParseError
   message::String
 end
@@ -518,6 +782,106 @@ SubmitReference(context::Ptr{Lib.EntifyContext}, node::Node) =
 
 export SubmitReference
 
+struct UpdateError
+  message::String
+end
+function Base.showerror(io::IO, err::UpdateError)
+  print(io, "Entify.UpdateError: ")
+  print(io, err.message)
+end
+export UpdateError
+
+# Overwrites the values of |uniform_values|, which must have been created
+# with |updatable| set and already be submitted to |context|.  The samplers
+# of a node can not be changed, so sampler values are ignored.
+function UpdateUniformValues(
+    context::Ptr{Lib.EntifyContext}, uniform_values::UniformValues{t},
+    values...) where t
+  @assert (Tuple{map(typeof, [values...])...} == t)
+  data, _ = _UniformValuesData(values...)
+
+  if Lib.EntifyUpdateUniformValues(
+         context, uniform_values.node_info.id, data, sizeof(data)) == 0
+    error_message::Vector{Cstring} = [C_NULL]
+    Lib.EntifyGetLastError(context, error_message)
+    throw(UpdateError(unsafe_string(error_message[1])))
+  end
+end
+
+export UpdateUniformValues
+
+# Overwrites the pixels of |texture|, which must already be submitted to
+# |context|, with |image|, given as for PixelData().  The bottom left pixel of
+# |image| is written to (|x|, |y|), counted in pixels from the bottom left of
+# the texture.
+function UpdateTextureRegion(
+    context::Ptr{Lib.EntifyContext}, texture::UpdatablePixelData,
+    x::Integer, y::Integer, image::Array{T, 2} where T)
+  @assert ColorTypeToEntify(eltype(image)) == texture.pixel_type
+  @assert ColorTypeToChannelOrder(eltype(image)) == texture.channel_order
+  rows = _ImageToTextureRows(image)
+  data = _ImageToTextureData(rows)
+
+  # The texture's rows were given top first, which the region's corner has
+  # to count from too.
+  top = texture.height_in_pixels - y - size(rows)[2]
+  if Lib.EntifyUpdateTextureRegion(
+         context, texture.node_info.id, x, top, size(rows)[1], size(rows)[2],
+         size(rows)[1] * sizeof(eltype(rows)), data) == 0
+    error_message::Vector{Cstring} = [C_NULL]
+    Lib.EntifyGetLastError(context, error_message)
+    throw(UpdateError(unsafe_string(error_message[1])))
+  end
+end
+
+export UpdateTextureRegion
+
+function _UpdateDrawSequence(
+    context::Ptr{Lib.EntifyContext}, sequence::UpdatableDrawSequence,
+    edit_type::Int32, index::Integer, draw_tree::Union{DrawTree, Nothing})
+  draw_tree_reference = (draw_tree == nothing ?
+      Ptr{Lib.EntifyReference}(C_NULL) :
+      SubmitReference(context, draw_tree.node_info))
+  try
+    edit = Lib.EntifyDrawSequenceEdit(
+        edit_type, Int32(index - 1),
+        draw_tree == nothing ? Lib.EntifyId(0) : draw_tree.node_info.id)
+    if Lib.EntifyUpdateDrawSequence(
+           context, sequence.node_info.id, Ref(edit), 1) == 0
+      error_message::Vector{Cstring} = [C_NULL]
+      Lib.EntifyGetLastError(context, error_message)
+      throw(UpdateError(unsafe_string(error_message[1])))
+    end
+  finally
+    if draw_tree_reference != C_NULL
+      Lib.EntifyReleaseReference(context, draw_tree_reference)
+    end
+  end
+end
+
+# Edits the children of |sequence|, which must already be submitted to
+# |context|.  Indices are 1-based, and inserting at one past the last child
+# appends.
+InsertIntoDrawSequence(
+    context::Ptr{Lib.EntifyContext}, sequence::UpdatableDrawSequence,
+    index::Integer, draw_tree::DrawTree) =
+    _UpdateDrawSequence(context, sequence, Lib.kEntifyDrawSequenceEditInsert,
+                        index, draw_tree)
+RemoveFromDrawSequence(
+    context::Ptr{Lib.EntifyContext}, sequence::UpdatableDrawSequence,
+    index::Integer) =
+    _UpdateDrawSequence(context, sequence, Lib.kEntifyDrawSequenceEditRemove,
+                        index, nothing)
+ReplaceInDrawSequence(
+    context::Ptr{Lib.EntifyContext}, sequence::UpdatableDrawSequence,
+    index::Integer, draw_tree::DrawTree) =
+    _UpdateDrawSequence(context, sequence, Lib.kEntifyDrawSequenceEditReplace,
+                        index, draw_tree)
+
+export InsertIntoDrawSequence
+export RemoveFromDrawSequence
+export ReplaceInDrawSequence
+
 function Submit(context::Ptr{Lib.EntifyContext},
                 render_target::Ptr{Lib.EntifyRenderTarget},
                 draw_tree::DrawTree)
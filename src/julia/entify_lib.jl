@@ -80,6 +80,33 @@ const EntifyId = Int64
     :GetLastError, Int,
     (context::Ptr{EntifyContext}, message::Ref{Cstring}))
 
+@EntifyLibraryFunction(
+    :UpdateUniformValues, Cint,
+    (context::Ptr{EntifyContext}, id::EntifyId, data::Ref{UInt8},
+     data_size::Csize_t))
+
+@EntifyLibraryFunction(
+    :UpdateTextureRegion, Cint,
+    (context::Ptr{EntifyContext}, id::EntifyId, x::Int32, y::Int32,
+     width::Int32, height::Int32, stride_in_bytes::Int32, data::Ref{UInt8}))
+
+# Values of EntifyDrawSequenceEdit.type.
+const kEntifyDrawSequenceEditInsert = Int32(0)
+const kEntifyDrawSequenceEditRemove = Int32(1)
+const kEntifyDrawSequenceEditReplace = Int32(2)
+
+# Mirrors the C struct of the same name.
+struct EntifyDrawSequenceEdit
+  type::Int32
+  index::Int32
+  draw_tree_id::EntifyId
+end
+
+@EntifyLibraryFunction(
+    :UpdateDrawSequence, Cint,
+    (context::Ptr{EntifyContext}, id::EntifyId,
+     edits::Ref{EntifyDrawSequenceEdit}, num_edits::Csize_t))
+
 @EntifyLibraryFunction(
     :AddReference, Cvoid,
     (context::Ptr{EntifyContext}, reference::Ptr{EntifyReference}))
@@ -104,6 +131,68 @@ const EntifyId = Int64
     (context::Ptr{EntifyContext}, render_tree::Ptr{EntifyReference},
      render_target::Ptr{EntifyRenderTarget}))
 
+# Mirrors the C struct of the same name.
+struct EntifyFrameStats
+  draw_calls::Int64
+  vertices::Int64
+  program_switches::Int64
+  texture_binds::Int64
+  uniform_uploads::Int64
+  buffer_binds::Int64
+  render_target_passes::Int64
+  gl_calls::Int64
+
+  tree_walk_ms::Float64
+  gl_submission_ms::Float64
+  swap_ms::Float64
+end
+
+const kEntifyFrameStatsHistorySize = 300
+
+@EntifyLibraryFunction(
+    :GetFrameStats,
+    Int32,
+    (context::Ptr{EntifyContext}, frame_stats::Ptr{EntifyFrameStats},
+     max_frames::Int32))
+
+@EntifyLibraryFunction(
+    :GetFrameStatsPercentile,
+    Int32,
+    (context::Ptr{EntifyContext}, percentile::Float64,
+     result::Ref{EntifyFrameStats}))
+
+# Values of EntifyGPUTiming.type.
+const kEntifyGPUTimingTypeRenderTarget = Int32(0)
+const kEntifyGPUTimingTypeDrawTree = Int32(1)
+
+# Mirrors the C struct of the same name.
+struct EntifyGPUTiming
+  frame_number::Int64
+  type::Int32
+  id::EntifyId
+  gpu_ms::Float64
+end
+
+const kEntifyGPUTimingHistorySize = 1024
+
+# Mirrors the C struct of the same name.
+struct EntifyGLCallCount
+  function_name::Cstring
+  calls::Int64
+end
+
+@EntifyLibraryFunction(
+    :GetGLCallCounts,
+    Int32,
+    (context::Ptr{EntifyContext}, counts::Ptr{EntifyGLCallCount},
+     max_counts::Int32))
+
+@EntifyLibraryFunction(
+    :GetGPUTimings,
+    Int32,
+    (context::Ptr{EntifyContext}, timings::Ptr{EntifyGPUTiming},
+     max_timings::Int32))
+
 
 macro Blake2LibraryFunction(function_name, return_type, params)
   blake2_path = joinpath(splitdir(@__FILE__)[1], "blake2")
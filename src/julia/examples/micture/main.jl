@@ -47,8 +47,9 @@ function MakeDrawTree(window_width, window_height, reference_provider)
 
   blend_blitter = CreateBlitter(blend_fragment_shader)
 
-  # Now we load our image data into Sampler objects.
-  samplers = map(x -> Sampler(PixelData(Images.load(x))), [
+  # Now we load our image data into Sampler objects.  The photos are large,
+  # so they are compressed on the GPU.
+  samplers = map(x -> Sampler(PixelData(Images.load(x), compress=true)), [
       "slovakia-1.jpg",
       "slovakia-2.jpg",
       "slovakia-3.jpg",
@@ -111,6 +111,29 @@ function RenderSceneInWindow(create_scene_function::Function)
   end
 end
 
+function PrintFrameStatsSummary(context::Ptr{Entify.Lib.EntifyContext})
+  for percentile in [50.0, 99.0]
+    stats = Ref{Entify.Lib.EntifyFrameStats}()
+    num_frames = Entify.Lib.EntifyGetFrameStatsPercentile(
+        context, percentile, stats)
+    if num_frames == 0
+      return
+    end
+
+    s = stats[]
+    println("p$(Int(percentile)) over $(num_frames) frames: " *
+            "tree walk $(round(s.tree_walk_ms, digits=3))ms, " *
+            "GL submission $(round(s.gl_submission_ms, digits=3))ms, " *
+            "swap $(round(s.swap_ms, digits=3))ms, " *
+            "$(s.draw_calls) draws, $(s.vertices) vertices, " *
+            "$(s.program_switches) program switches, " *
+            "$(s.texture_binds) texture binds, " *
+            "$(s.uniform_uploads) uniform uploads, " *
+            "$(s.buffer_binds) buffer binds, " *
+            "$(s.render_target_passes) render target passes")
+  end
+end
+
 function RenderSceneInWindow(
     window::Ptr{Entify.Lib.PlatformWindow},
     context::Ptr{Entify.Lib.EntifyContext},
@@ -127,20 +150,18 @@ function RenderSceneInWindow(
 
   try
     frame_interval_times::Vector{Float32} = []
-    submit_times::Vector{Float32} = []
+    frames_since_stats_summary = 0
     prev_time_elapsed = GetElapsedTimeInSeconds()
     while true
       time_elapsed_in_seconds::Float32 = GetElapsedTimeInSeconds()
 
       scene = scene_function(time_elapsed_in_seconds)
-      submit_time = @elapsed(Submit(context, render_target, scene))
-
-      push!(submit_times, Float32(submit_time))
-      if length(submit_times) > 300
-        average_submit_time_ms =
-            1000.0 * reduce(+, submit_times) / length(submit_times)
-        println("Average submit time: $(average_submit_time_ms)ms")
-        submit_times = Vector{Float32}()
+      Submit(context, render_target, scene)
+
+      frames_since_stats_summary += 1
+      if frames_since_stats_summary >= Entify.Lib.kEntifyFrameStatsHistorySize
+        PrintFrameStatsSummary(context)
+        frames_since_stats_summary = 0
       end
 
       push!(frame_interval_times, time_elapsed_in_seconds - prev_time_elapsed)
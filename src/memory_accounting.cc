@@ -0,0 +1,98 @@
+#include "src/memory_accounting.h"
+
+#include <cassert>
+
+namespace entify {
+
+MemoryAccounting::MemoryAccounting() : total_gpu_bytes_(0) {
+  for (auto& usage : by_node_type_) {
+    usage.node_count.store(0);
+    usage.cpu_bytes.store(0);
+    usage.gpu_bytes.store(0);
+  }
+}
+
+void MemoryAccounting::AddNode(
+    const NodeMemoryUsage& usage, EntifyContext context) {
+  assert(usage.node_type >= 0 && usage.node_type < kEntifyNodeTypeCount);
+  AtomicMemoryUsage& type_usage = by_node_type_[usage.node_type];
+  type_usage.node_count.fetch_add(1, std::memory_order_relaxed);
+  type_usage.cpu_bytes.fetch_add(usage.cpu_bytes, std::memory_order_relaxed);
+  type_usage.gpu_bytes.fetch_add(usage.gpu_bytes, std::memory_order_relaxed);
+
+  int64_t total_gpu_bytes =
+      total_gpu_bytes_.fetch_add(usage.gpu_bytes, std::memory_order_relaxed) +
+      usage.gpu_bytes;
+
+  EntifyMemoryBudgetCallback callback;
+  void* user_data;
+  int64_t gpu_budget_bytes;
+  {
+    std::lock_guard<std::mutex> lock(budget_mutex_);
+    if (!budget_callback_ || gpu_budget_bytes_ <= 0 || budget_exceeded_ ||
+        total_gpu_bytes <= gpu_budget_bytes_) {
+      return;
+    }
+    budget_exceeded_ = true;
+    callback = budget_callback_;
+    user_data = budget_callback_user_data_;
+    gpu_budget_bytes = gpu_budget_bytes_;
+  }
+
+  // Called without the lock held so that the callback may call back into
+  // the API, e.g. to query the largest nodes.
+  callback(context, total_gpu_bytes, gpu_budget_bytes, user_data);
+}
+
+void MemoryAccounting::RemoveNode(const NodeMemoryUsage& usage) {
+  assert(usage.node_type >= 0 && usage.node_type < kEntifyNodeTypeCount);
+  AtomicMemoryUsage& type_usage = by_node_type_[usage.node_type];
+  type_usage.node_count.fetch_sub(1, std::memory_order_relaxed);
+  type_usage.cpu_bytes.fetch_sub(usage.cpu_bytes, std::memory_order_relaxed);
+  type_usage.gpu_bytes.fetch_sub(usage.gpu_bytes, std::memory_order_relaxed);
+
+  int64_t total_gpu_bytes =
+      total_gpu_bytes_.fetch_sub(usage.gpu_bytes, std::memory_order_relaxed) -
+      usage.gpu_bytes;
+
+  std::lock_guard<std::mutex> lock(budget_mutex_);
+  if (total_gpu_bytes <= gpu_budget_bytes_) {
+    budget_exceeded_ = false;
+  }
+}
+
+EntifyMemoryUsage MemoryAccounting::GetTotal() const {
+  EntifyMemoryUsage by_node_type[kEntifyNodeTypeCount];
+  GetByNodeType(by_node_type);
+
+  EntifyMemoryUsage total = {0, 0, 0};
+  for (const auto& usage : by_node_type) {
+    total.node_count += usage.node_count;
+    total.cpu_bytes += usage.cpu_bytes;
+    total.gpu_bytes += usage.gpu_bytes;
+  }
+  return total;
+}
+
+void MemoryAccounting::GetByNodeType(EntifyMemoryUsage* by_node_type) const {
+  for (int i = 0; i < kEntifyNodeTypeCount; ++i) {
+    by_node_type[i].node_count =
+        by_node_type_[i].node_count.load(std::memory_order_relaxed);
+    by_node_type[i].cpu_bytes =
+        by_node_type_[i].cpu_bytes.load(std::memory_order_relaxed);
+    by_node_type[i].gpu_bytes =
+        by_node_type_[i].gpu_bytes.load(std::memory_order_relaxed);
+  }
+}
+
+void MemoryAccounting::SetGPUBudget(
+    int64_t gpu_budget_bytes, EntifyMemoryBudgetCallback callback,
+    void* user_data) {
+  std::lock_guard<std::mutex> lock(budget_mutex_);
+  gpu_budget_bytes_ = gpu_budget_bytes;
+  budget_callback_ = callback;
+  budget_callback_user_data_ = user_data;
+  budget_exceeded_ = false;
+}
+
+}  // namespace entify
@@ -0,0 +1,53 @@
+#ifndef _SRC_ENTIFY_MEMORY_ACCOUNTING_H_
+#define _SRC_ENTIFY_MEMORY_ACCOUNTING_H_
+
+#include <atomic>
+#include <mutex>
+
+#include "src/external_reference.h"
+#include "src/include/entify/registry.h"
+
+namespace entify {
+
+// Keeps running totals of the memory used by the nodes in a registry, per
+// node type, and calls the budget callback when the GPU total exceeds the
+// budget.  All methods may be called concurrently.
+class MemoryAccounting {
+ public:
+  MemoryAccounting();
+
+  // |context| is passed to the budget callback if the budget is exceeded by
+  // this node.
+  void AddNode(const NodeMemoryUsage& usage, EntifyContext context);
+  void RemoveNode(const NodeMemoryUsage& usage);
+
+  EntifyMemoryUsage GetTotal() const;
+  // |by_node_type| must point to kEntifyNodeTypeCount entries.
+  void GetByNodeType(EntifyMemoryUsage* by_node_type) const;
+
+  void SetGPUBudget(int64_t gpu_budget_bytes,
+                    EntifyMemoryBudgetCallback callback, void* user_data);
+
+ private:
+  struct AtomicMemoryUsage {
+    std::atomic<int64_t> node_count;
+    std::atomic<int64_t> cpu_bytes;
+    std::atomic<int64_t> gpu_bytes;
+  };
+
+  AtomicMemoryUsage by_node_type_[kEntifyNodeTypeCount];
+  std::atomic<int64_t> total_gpu_bytes_;
+
+  mutable std::mutex budget_mutex_;
+  int64_t gpu_budget_bytes_ = 0;
+  EntifyMemoryBudgetCallback budget_callback_ = nullptr;
+  void* budget_callback_user_data_ = nullptr;
+  // Set once the budget callback was called, and cleared once usage drops
+  // back down to the budget, so that the callback is not called for every
+  // node created while over budget.
+  bool budget_exceeded_ = false;
+};
+
+}  // namespace entify
+
+#endif  // _SRC_ENTIFY_MEMORY_ACCOUNTING_H_
@@ -39,3 +39,46 @@ void EntifyAddReference(EntifyContext context, EntifyReference reference) {
 void EntifyReleaseReference(EntifyContext context, EntifyReference reference) {
   static_cast<entify::Context*>(context)->ReleaseReference(reference);
 }
+
+int EntifyUpdateUniformValues(
+    EntifyContext context, EntifyId id, const char* data, size_t data_size) {
+  return static_cast<entify::Context*>(context)->UpdateUniformValues(
+      id, data, data_size);
+}
+
+int EntifyUpdateTextureRegion(
+    EntifyContext context, EntifyId id, int32_t x, int32_t y, int32_t width,
+    int32_t height, int32_t stride_in_bytes, const char* data) {
+  return static_cast<entify::Context*>(context)->UpdateTextureRegion(
+      id, x, y, width, height, stride_in_bytes, data);
+}
+
+int EntifyUpdateDrawSequence(
+    EntifyContext context, EntifyId id, const EntifyDrawSequenceEdit* edits,
+    size_t num_edits) {
+  return static_cast<entify::Context*>(context)->UpdateDrawSequence(
+      id, edits, num_edits);
+}
+
+void EntifyGetMemoryUsage(EntifyContext context, EntifyMemoryUsage* total) {
+  *total = static_cast<entify::Context*>(context)->GetMemoryUsage();
+}
+
+void EntifyGetMemoryUsageByNodeType(
+    EntifyContext context, EntifyMemoryUsage* by_node_type) {
+  static_cast<entify::Context*>(context)->GetMemoryUsageByNodeType(
+      by_node_type);
+}
+
+int32_t EntifyGetLargestNodes(
+    EntifyContext context, EntifyNodeMemoryUsage* nodes, int32_t max_nodes) {
+  return static_cast<entify::Context*>(context)->GetLargestNodes(
+      nodes, max_nodes);
+}
+
+void EntifySetGPUMemoryBudget(
+    EntifyContext context, int64_t gpu_budget_bytes,
+    EntifyMemoryBudgetCallback callback, void* user_data) {
+  static_cast<entify::Context*>(context)->SetGPUMemoryBudget(
+      gpu_budget_bytes, callback, user_data);
+}
@@ -2,9 +2,12 @@
 #define _SRC_ENTIFY_RENDERER_BACKEND_H_
 
 #include <memory>
+#include <string>
 #include <vector>
 
+#include "entify/entify.h"
 #include "src/external_reference.h"
+#include "src/renderer/gpu_timing.h"
 #include "src/renderer/render_target.h"
 #include "src/renderer/parse_output.h"
 
@@ -23,16 +26,52 @@ class Backend {
   virtual void ReleaseReferences(
       std::vector<std::shared_ptr<void>>&& references) = 0;
 
+  // Parses a node that is to be registered as |id|.
   virtual ParseOutput ParseProtocolBuffer(
-      const ExternalReferenceLookup& reference_lookup,
+      const ExternalReferenceLookup& reference_lookup, EntifyId id,
       const char* data, size_t data_size) = 0;
 
   virtual ParseOutput ParseFlatBuffer(
-      const ExternalReferenceLookup& reference_lookup,
+      const ExternalReferenceLookup& reference_lookup, EntifyId id,
       const char* data, size_t data_size) = 0;
 
+  // Overwrites the data of the updatable UniformValues node |reference|.
+  // Returns an error message, or an empty string on success.
+  virtual std::string UpdateUniformValues(
+      const ExternalReference& reference, const char* data,
+      size_t data_size) = 0;
+
+  // Overwrites a region of the updatable PixelData texture |reference|.
+  // Returns an error message, or an empty string on success.
+  virtual std::string UpdateTextureRegion(
+      const ExternalReference& reference, int x, int y, int width,
+      int height, int stride_in_bytes, const char* data) = 0;
+
+  // Applies |num_edits| edits, in order, to the updatable DrawSequence node
+  // |reference|.  Inserted draw trees are looked up in |reference_lookup|.
+  // Returns an error message, or an empty string on success.
+  virtual std::string UpdateDrawSequence(
+      const ExternalReferenceLookup& reference_lookup,
+      const ExternalReference& reference,
+      const EntifyDrawSequenceEdit* edits, size_t num_edits) = 0;
+
+  // Renders |render_tree| and fills in |frame_stats| with statistics about
+  // the work that was done for it.  GPU timings of earlier work that have
+  // become available are appended to |gpu_timings|.
   virtual void Submit(
-      ExternalReference* render_tree, RenderTarget* render_target) = 0;
+      ExternalReference* render_tree, RenderTarget* render_target,
+      EntifyFrameStats* frame_stats, std::vector<GPUTiming>* gpu_timings) = 0;
+
+  // Returns the memory that the renderer holds for itself rather than for
+  // any one node, e.g. in caches that nodes share.  May be called from any
+  // thread.
+  virtual EntifyMemoryUsage GetInternalMemoryUsage() const = 0;
+
+  // Returns the number of calls made to each GL function that was called
+  // during the most recently submitted frame, in no particular order.  Empty
+  // if the renderer does not count its calls.
+  virtual std::vector<EntifyGLCallCount> GetGLCallCountsForLastFrame()
+      const = 0;
 };
 
 std::unique_ptr<Backend> MakeDefaultRenderer();
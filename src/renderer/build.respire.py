@@ -5,7 +5,8 @@ import respire.buildlib.modules as modules
 
 
 def Build(registry, out_dir, platform, configured_toolchain, protobuf_modules,
-          flatbuffers_modules, stdext_module, third_party_directory):
+          flatbuffers_modules, stdext_module, trace_log_module,
+          third_party_directory):
   if not os.path.exists(out_dir):
     os.makedirs(out_dir)
 
@@ -29,13 +30,14 @@ def Build(registry, out_dir, platform, configured_toolchain, protobuf_modules,
       entify_protobuf_definitions_module=entify_protobuf_definitions_module,
       entify_flatbuffers_definitions_module=entify_flatbuffers_definitions_module,
       stdext_module=stdext_module,
+      trace_log_module=trace_log_module,
       third_party_directory=third_party_directory)
 
 
 def BuildWithDeps(registry, out_dir, configured_toolchain, platform,
                   entify_protobuf_definitions_module,
                   entify_flatbuffers_definitions_module,
-                  stdext_module, third_party_directory):
+                  stdext_module, trace_log_module, third_party_directory):
   renderer_module = registry.SubRespireExternal(
       'gles2/build.respire.py', 'Build',
       out_dir=os.path.join(out_dir, 'gles2'),
@@ -44,6 +46,7 @@ def BuildWithDeps(registry, out_dir, configured_toolchain, platform,
       entify_protobuf_definitions_module=entify_protobuf_definitions_module,
       entify_flatbuffers_definitions_module=entify_flatbuffers_definitions_module,
       stdext_module=stdext_module,
+      trace_log_module=trace_log_module,
       third_party_directory=third_party_directory)
 
   return {'protobuf_c_lib': entify_protobuf_definitions_module,
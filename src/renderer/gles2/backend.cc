@@ -4,7 +4,11 @@
 // file.
 #include "src/renderer/gles2/backend.h"
 
+#include <algorithm>
+#include <chrono>
 #include <memory>
+#include <unordered_map>
+#include <vector>
 
 #include <GLES2/gl2.h>
 #include <EGL/eglext.h>
@@ -13,18 +17,110 @@
 #include "src/renderer/gles2/egl_device_interface.h"
 #endif
 
+#include "src/renderer/gles2/gl_dispatch.h"
 #include "src/renderer/gles2/lookup_utils.h"
+#include "src/renderer/gles2/memory_usage.h"
 #include "src/renderer/gles2/parse_protobuf.h"
 #include "src/renderer/gles2/parse_flatbuffer.h"
 #include "src/renderer/gles2/render.h"
+#include "src/renderer/gles2/render_tree/draw_sequence.h"
 #include "src/renderer/gles2/render_tree/draw_tree.h"
+#include "src/renderer/gles2/render_tree/texture.h"
+#include "src/renderer/gles2/render_tree/uniform_values.h"
 #include "src/renderer/gles2/utils.h"
 #include "src/renderer/gles2/window_render_target.h"
+#include "src/trace_log/trace_log.h"
 
 namespace entify {
 namespace renderer {
 namespace gles2 {
 
+namespace {
+const size_t kMaxDeletionsPerFrame = 256;
+}  // namespace
+
+// The contexts that a backend created for threads other than its owning
+// thread.  Producer threads may come and go, so each thread destroys its
+// contexts when it exits, for the backends that are still alive, and the
+// backend destroys the ones that are left when it is destroyed.
+class ThreadContexts {
+ public:
+  explicit ThreadContexts(EGLDisplay display) : display_(display) {}
+
+  // Returns the calling thread's context, or EGL_NO_CONTEXT if it has none.
+  EGLContext Find() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto found = contexts_.find(std::this_thread::get_id());
+    return found == contexts_.end() ? EGL_NO_CONTEXT : found->second;
+  }
+
+  void Add(EGLContext context) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    contexts_[std::this_thread::get_id()] = context;
+  }
+
+  // Destroys the calling thread's context.
+  void DestroyForCurrentThread() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto found = contexts_.find(std::this_thread::get_id());
+    if (found == contexts_.end()) {
+      return;
+    }
+    if (eglGetCurrentContext() == found->second) {
+      EGL_CALL(eglMakeCurrent(
+          display_, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT));
+    }
+    EGL_CALL(eglDestroyContext(display_, found->second));
+    contexts_.erase(found);
+  }
+
+  // Contexts still current on other threads are destroyed by EGL once those
+  // threads release them.
+  void DestroyAll() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto& context : contexts_) {
+      EGL_CALL(eglDestroyContext(display_, context.second));
+    }
+    contexts_.clear();
+  }
+
+ private:
+  EGLDisplay display_;
+  std::mutex mutex_;
+  std::unordered_map<std::thread::id, EGLContext> contexts_;
+};
+
+namespace {
+// Destroys the contexts that backends created for this thread when the
+// thread exits.
+class ThreadExitGuard {
+ public:
+  ~ThreadExitGuard() {
+    for (const auto& weak_thread_contexts : thread_contexts_) {
+      if (auto thread_contexts = weak_thread_contexts.lock()) {
+        thread_contexts->DestroyForCurrentThread();
+      }
+    }
+  }
+
+  void Add(const std::shared_ptr<ThreadContexts>& thread_contexts) {
+    // Forget backends that have been destroyed since, so that threads that
+    // outlive many backends do not accumulate them.
+    thread_contexts_.erase(
+        std::remove_if(thread_contexts_.begin(), thread_contexts_.end(),
+                       [](const std::weak_ptr<ThreadContexts>& x) {
+                         return x.expired();
+                       }),
+        thread_contexts_.end());
+    thread_contexts_.push_back(thread_contexts);
+  }
+
+ private:
+  std::vector<std::weak_ptr<ThreadContexts>> thread_contexts_;
+};
+
+thread_local ThreadExitGuard thread_exit_guard;
+}  // namespace
 
 Backend::Backend() {
 #if defined(USE_EGLDEVICE)
@@ -74,10 +170,45 @@ Backend::Backend() {
       display_, config_, NULL, kContextAttributes));
   ASSERT_NO_EGL_ERROR;
 
+  owning_thread_ = std::this_thread::get_id();
+  thread_contexts_ = std::make_shared<ThreadContexts>(display_);
+
   InitializeDummySurface();
+
+  {
+    WithCurrent current_context(this);
+    device_.vertex_array_cache()->Initialize(context_);
+    device_.gpu_timer()->Initialize(context_);
+    device_.set_supports_half_float_vertices(
+        HasGLExtension("GL_OES_vertex_half_float"));
+    device_.set_supports_npot_mipmaps(HasGLExtension("GL_OES_texture_npot"));
+
+    GLint num_compressed_texture_formats = 0;
+    GL_CALL(glGetIntegerv(GL_NUM_COMPRESSED_TEXTURE_FORMATS,
+                          &num_compressed_texture_formats));
+    std::vector<GLint> compressed_texture_formats(
+        num_compressed_texture_formats);
+    if (num_compressed_texture_formats > 0) {
+      GL_CALL(glGetIntegerv(GL_COMPRESSED_TEXTURE_FORMATS,
+                            compressed_texture_formats.data()));
+    }
+    device_.set_compressed_texture_formats(
+        std::move(compressed_texture_formats));
+  }
+}
+
+namespace {
+bool HasEglExtension(EGLDisplay display, const char* extension) {
+  return ExtensionListContains(
+      eglQueryString(display, EGL_EXTENSIONS), extension);
 }
+}  // namespace
 
 void Backend::InitializeDummySurface() {
+  if (HasEglExtension(display_, "EGL_KHR_surfaceless_context")) {
+    return;
+  }
+
   const EGLint kDummySurfaceAttribList[] = {
       EGL_WIDTH, 1,
       EGL_HEIGHT, 1,
@@ -89,8 +220,30 @@ void Backend::InitializeDummySurface() {
 }
 
 Backend::~Backend() {
-  EGL_CALL(eglDestroySurface(display_, dummy_surface_));
-
+  {
+    WithCurrent current_context(this);
+    device_.static_batcher()->Shutdown();
+    device_.vertex_array_cache()->Shutdown();
+    device_.vertex_buffer_pool()->Shutdown();
+    device_.texture_atlas()->Shutdown();
+    device_.stream_vertex_buffer()->Shutdown();
+    device_.deletion_queue()->FlushAll();
+    device_.gpu_timer()->Shutdown();
+  }
+
+  EGLContext current_context = eglGetCurrentContext();
+  if (current_context == context_ ||
+      (current_context != EGL_NO_CONTEXT &&
+       current_context == thread_contexts_->Find())) {
+    EGL_CALL(eglMakeCurrent(
+        display_, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT));
+  }
+
+  if (dummy_surface_ != EGL_NO_SURFACE) {
+    EGL_CALL(eglDestroySurface(display_, dummy_surface_));
+  }
+
+  thread_contexts_->DestroyAll();
   EGL_CALL(eglDestroyContext(display_, context_));
   EGL_CALL(eglTerminate(display_));
 }
@@ -102,32 +255,193 @@ std::unique_ptr<RenderTarget> Backend::CreateRenderTargetFromPlatformWindow(
       display_, config_));
 }
 
+namespace {
+ParseOutput WithMemoryUsage(ParseOutput&& output) {
+  if (output.value) {
+    output.value->set_memory_usage(EstimateMemoryUsage(*output.value));
+  }
+  return std::move(output);
+}
+}  // namespace
+
 void Backend::ReleaseReferences(
     std::vector<std::shared_ptr<void>>&& references) {
-  WithCurrent current_context(this);
+  ScopedTraceEvent trace_event("gles2", "ReleaseReferences");
+  trace_event.AddArg("references", references.size());
+
+  // This does not need a context to be current, since nodes only queue
+  // their GL objects for deletion, which happens after the next swap.
   references.clear();
 }
 
 ParseOutput Backend::ParseProtocolBuffer(
-    const ExternalReferenceLookup& reference_lookup,
+    const ExternalReferenceLookup& reference_lookup, EntifyId id,
     const char* data, size_t data_size) {
-  WithCurrent current_context(this);
-
-  return entify::renderer::gles2::ParseProtocolBuffer(
-      reference_lookup, data, data_size);
+  // Converting and compressing pixel data can take a while, so it is done
+  // before taking the context, which nodes that make no GL calls skip.
+  PreparedProtocolBuffer prepared;
+  PrepareProtocolBuffer(&device_, data, data_size, &prepared);
+
+  std::unique_ptr<WithCurrent> current_context;
+  if (prepared.needs_context) {
+    current_context.reset(new WithCurrent(this));
+  }
+
+  return WithMemoryUsage(entify::renderer::gles2::ParseProtocolBuffer(
+      &device_, reference_lookup, id, &prepared));
 }
 
 ParseOutput Backend::ParseFlatBuffer(
-    const ExternalReferenceLookup& reference_lookup,
+    const ExternalReferenceLookup& reference_lookup, EntifyId id,
     const char* data, size_t data_size) {
+  // Converting and compressing pixel data can take a while, so it is done
+  // before taking the context, which nodes that make no GL calls skip.
+  PreparedFlatBuffer prepared;
+  PrepareFlatBuffer(&device_, data, data_size, &prepared);
+
+  std::unique_ptr<WithCurrent> current_context;
+  if (prepared.needs_context) {
+    current_context.reset(new WithCurrent(this));
+  }
+
+  return WithMemoryUsage(entify::renderer::gles2::ParseFlatBuffer(
+      &device_, reference_lookup, id, &prepared));
+}
+
+std::string Backend::UpdateUniformValues(
+    const ExternalReference& reference, const char* data, size_t data_size) {
+  auto uniform_values =
+      ExternalReferenceToRenderTree<render_tree::UniformValues>(reference);
+  if (!uniform_values) {
+    return "Node is not a UniformValues node.";
+  }
+  if (!uniform_values->updatable()) {
+    return "UniformValues node was not created as updatable.";
+  }
+  if (data_size != uniform_values->data().size()) {
+    return "Expected " + std::to_string(uniform_values->data().size()) +
+           " bytes of uniform data, got " + std::to_string(data_size) + ".";
+  }
+
+  // No GL calls are made, but the data must not change while it is being
+  // rendered.
+  std::lock_guard<std::mutex> lock(mutex_);
+  uniform_values->UpdateData(data, data_size);
+  return std::string();
+}
+
+std::string Backend::UpdateTextureRegion(
+    const ExternalReference& reference, int x, int y, int width, int height,
+    int stride_in_bytes, const char* data) {
+  auto pixel_data = std::dynamic_pointer_cast<render_tree::PixelData>(
+      ExternalReferenceToRenderTree<render_tree::Texture>(reference));
+  if (!pixel_data) {
+    return "Node is not a PixelData texture.";
+  }
+  if (!pixel_data->updatable()) {
+    return "PixelData node was not created as updatable.";
+  }
+  if (x < 0 || y < 0 || width < 0 || height < 0 ||
+      width > pixel_data->width_in_pixels() - x ||
+      height > pixel_data->height_in_pixels() - y) {
+    return "Region is not within the " +
+           std::to_string(pixel_data->width_in_pixels()) + "x" +
+           std::to_string(pixel_data->height_in_pixels()) + " texture.";
+  }
+  int row_size = width * pixel_data->bytes_per_pixel();
+  if (stride_in_bytes < row_size) {
+    return "Stride of " + std::to_string(stride_in_bytes) +
+           " bytes is smaller than a row of " + std::to_string(row_size) +
+           " bytes.";
+  }
+
   WithCurrent current_context(this);
 
-  return entify::renderer::gles2::ParseFlatBuffer(
-      reference_lookup, data, data_size);
+  pixel_data->UpdateRegion(x, y, width, height, stride_in_bytes, data);
+  if (pixel_data->double_buffered()) {
+    device_.AddPendingTextureSwap(pixel_data);
+  }
+  return std::string();
+}
+
+namespace {
+std::string EditError(size_t edit_index, const std::string& message) {
+  return "Edit " + std::to_string(edit_index) + ": " + message;
+}
+}  // namespace
+
+std::string Backend::UpdateDrawSequence(
+    const ExternalReferenceLookup& reference_lookup,
+    const ExternalReference& reference,
+    const EntifyDrawSequenceEdit* edits, size_t num_edits) {
+  auto draw_tree =
+      ExternalReferenceToRenderTree<render_tree::DrawTree>(reference);
+  if (!draw_tree ||
+      draw_tree->type() != render_tree::DrawTree::kTypeDrawSequence) {
+    return "Node is not a DrawSequence node.";
+  }
+  auto draw_sequence =
+      std::static_pointer_cast<render_tree::DrawSequence>(draw_tree);
+  if (!draw_sequence->updatable()) {
+    return "DrawSequence node was not created as updatable.";
+  }
+
+  // The inserted draw trees are looked up before |mutex_| is taken, since
+  // parsing looks up nodes while holding it.
+  std::vector<std::shared_ptr<render_tree::DrawTree>> draw_trees(num_edits);
+  for (size_t i = 0; i < num_edits; ++i) {
+    if (edits[i].type == kEntifyDrawSequenceEditRemove) {
+      continue;
+    }
+    draw_trees[i] = LookupNode<render_tree::DrawTree>(
+        reference_lookup, edits[i].draw_tree_id);
+    if (!draw_trees[i]) {
+      return EditError(i, "No DrawTree node with id " +
+                              std::to_string(edits[i].draw_tree_id) + ".");
+    }
+  }
+
+  // No GL calls are made, but the sequence must not change while it is
+  // being rendered.
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (size_t i = 0; i < num_edits; ++i) {
+    const EntifyDrawSequenceEdit& edit = edits[i];
+    if (draw_trees[i] &&
+        ContainsDrawTree(draw_trees[i].get(), draw_sequence.get())) {
+      return EditError(i, "The DrawTree contains the sequence itself.");
+    }
+
+    // Negative indices wrap around to sizes that are out of range.
+    size_t index = static_cast<size_t>(edit.index);
+    bool in_range = false;
+    switch (edit.type) {
+      case kEntifyDrawSequenceEditInsert: {
+        in_range = draw_sequence->Insert(index, draw_trees[i]);
+      } break;
+      case kEntifyDrawSequenceEditRemove: {
+        in_range = draw_sequence->Remove(index);
+      } break;
+      case kEntifyDrawSequenceEditReplace: {
+        in_range = draw_sequence->Replace(index, draw_trees[i]);
+      } break;
+      default: {
+        return EditError(i, "Unknown edit type " +
+                                std::to_string(edit.type) + ".");
+      }
+    }
+    if (!in_range) {
+      return EditError(i, "Index " + std::to_string(edit.index) +
+                              " is out of range for a sequence of " +
+                              std::to_string(draw_sequence->sequence().size()) +
+                              " children.");
+    }
+  }
+  return std::string();
 }
 
 void Backend::Submit(
-    ExternalReference* render_tree, RenderTarget* render_target) {
+    ExternalReference* render_tree, RenderTarget* render_target,
+    EntifyFrameStats* frame_stats, std::vector<GPUTiming>* gpu_timings) {
   assert(render_tree);
   auto draw_tree =
       ExternalReferenceToRenderTree<render_tree::DrawTree>(
@@ -143,28 +457,109 @@ void Backend::Submit(
 
   WithCurrent current_context(this, egl_surface);
 
-  Render(width, height, draw_tree);
+  // Updates to double buffered textures since the last submit all become
+  // visible at once, at the start of a frame.
+  for (const auto& pending_swap : device_.TakePendingTextureSwaps()) {
+    if (auto pixel_data = pending_swap.lock()) {
+      pixel_data->SwapBuffers();
+    }
+  }
+
+  Render(&device_, width, height, draw_tree);
+
+  {
+    ScopedTraceEvent trace_event("gles2", "SwapBuffers");
+    auto swap_start = std::chrono::steady_clock::now();
+    EGL_CALL(eglSwapBuffers(display_, egl_surface));
+    device_.frame_stats()->swap_ms +=
+        std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - swap_start).count();
+  }
 
-  EGL_CALL(eglSwapBuffers(display_, egl_surface));
+  device_.static_batcher()->EndFrame();
+
+  // Free the objects of released nodes now that the frame is submitted, but
+  // bound the amount of work so that releasing a large scene does not cause
+  // a single long frame.
+  device_.deletion_queue()->Flush(kMaxDeletionsPerFrame);
+
+  device_.gpu_timer()->EndFrame(gpu_timings);
+
+  GLDispatchEndFrame();
+  for (uint32_t calls : gles2::GetGLCallCountsForLastFrame()) {
+    device_.frame_stats()->gl_calls += calls;
+  }
+
+  *frame_stats = device_.TakeFrameStats();
+}
+
+std::vector<EntifyGLCallCount> Backend::GetGLCallCountsForLastFrame() const {
+  std::vector<uint32_t> calls = gles2::GetGLCallCountsForLastFrame();
+  std::vector<EntifyGLCallCount> counts;
+  for (int i = 0; i < kNumGLFunctions; ++i) {
+    if (calls[i] > 0) {
+      counts.push_back(
+          {GLFunctionName(static_cast<GLFunction>(i)), calls[i]});
+    }
+  }
+  return counts;
+}
+
+EGLContext Backend::GetContextForCurrentThread() {
+  std::thread::id thread_id = std::this_thread::get_id();
+  if (thread_id == owning_thread_) {
+    return context_;
+  }
+
+  EGLContext context = thread_contexts_->Find();
+  if (context != EGL_NO_CONTEXT) {
+    return context;
+  }
+
+  EGLint kContextAttributes[] = { EGL_CONTEXT_CLIENT_VERSION, 2, EGL_NONE };
+  context = EGL_CALL(eglCreateContext(
+      display_, config_, context_, kContextAttributes));
+  assert(context != EGL_NO_CONTEXT);
+  thread_contexts_->Add(context);
+  thread_exit_guard.Add(thread_contexts_);
+  return context;
+}
+
+void Backend::MakeCurrent(EGLContext context, EGLSurface surface) {
+  // Query EGL rather than tracking this ourselves, since the client may
+  // make its own contexts current on this thread in between our calls.
+  if (eglGetCurrentContext() == context &&
+      eglGetCurrentSurface(EGL_DRAW) == surface &&
+      eglGetCurrentSurface(EGL_READ) == surface) {
+    return;
+  }
+  EGL_CALL(eglMakeCurrent(display_, surface, surface, context));
 }
 
 Backend::WithCurrent::WithCurrent(Backend* backend, EGLSurface surface)
-    : backend_(backend), surface_(surface) {
+    : lock_(backend->mutex_), backend_(backend),
+      flush_on_exit_(std::this_thread::get_id() != backend->owning_thread_) {
   assert(backend_->context_ != EGL_NO_CONTEXT);
-  assert(!backend_->context_is_current_);
-  EGL_CALL(eglMakeCurrent(
-      backend_->display_, surface, surface, backend_->context_));
-  backend_->context_is_current_ = true;
+  backend_->MakeCurrent(backend_->GetContextForCurrentThread(), surface);
 }
 
 Backend::WithCurrent::WithCurrent(Backend* backend)
-    : WithCurrent(backend, backend->dummy_surface_) {}
+    : lock_(backend->mutex_), backend_(backend),
+      flush_on_exit_(std::this_thread::get_id() != backend->owning_thread_) {
+  assert(backend_->context_ != EGL_NO_CONTEXT);
+  EGLContext context = backend_->GetContextForCurrentThread();
+  // Any surface will do, so keep whichever one is bound already.
+  if (eglGetCurrentContext() != context) {
+    backend_->MakeCurrent(context, backend_->dummy_surface_);
+  }
+}
 
 Backend::WithCurrent::~WithCurrent() {
-  assert(backend_->context_is_current_);
-  backend_->context_is_current_ = false;
-  EGL_CALL(eglMakeCurrent(
-      backend_->display_, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT));
+  if (flush_on_exit_) {
+    // Objects created or deleted through a secondary context must be flushed
+    // before the owning thread's context can observe the changes.
+    GL_CALL(glFlush());
+  }
 }
 
 }  // namespace gles2
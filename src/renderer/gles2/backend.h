@@ -2,10 +2,13 @@
 #define _SRC_ENTIFY_RENDERER_GLES2_BACKEND_H_
 
 #include <memory>
+#include <mutex>
+#include <thread>
 #include <vector>
 
 #include "src/renderer/backend.h"
 #include "src/external_reference.h"
+#include "src/renderer/gles2/device.h"
 
 #include <EGL/egl.h>
 
@@ -13,6 +16,8 @@ namespace entify {
 namespace renderer {
 namespace gles2 {
 
+class ThreadContexts;
+
 class Backend : public entify::renderer::Backend {
  public:
   Backend();
@@ -25,38 +30,85 @@ class Backend : public entify::renderer::Backend {
       std::vector<std::shared_ptr<void>>&& references) override;
 
   ParseOutput ParseProtocolBuffer(
-      const ExternalReferenceLookup& reference_lookup,
+      const ExternalReferenceLookup& reference_lookup, EntifyId id,
       const char* data, size_t data_size) override;
 
   ParseOutput ParseFlatBuffer(
-      const ExternalReferenceLookup& reference_lookup,
+      const ExternalReferenceLookup& reference_lookup, EntifyId id,
       const char* data, size_t data_size) override;
 
+  std::string UpdateUniformValues(
+      const ExternalReference& reference, const char* data,
+      size_t data_size) override;
+
+  std::string UpdateTextureRegion(
+      const ExternalReference& reference, int x, int y, int width,
+      int height, int stride_in_bytes, const char* data) override;
+
+  std::string UpdateDrawSequence(
+      const ExternalReferenceLookup& reference_lookup,
+      const ExternalReference& reference,
+      const EntifyDrawSequenceEdit* edits, size_t num_edits) override;
+
   void Submit(
-      ExternalReference* render_tree, RenderTarget* render_target) override;
+      ExternalReference* render_tree, RenderTarget* render_target,
+      EntifyFrameStats* frame_stats,
+      std::vector<GPUTiming>* gpu_timings) override;
+
+  EntifyMemoryUsage GetInternalMemoryUsage() const override {
+    return device_.GetInternalMemoryUsage();
+  }
 
+  std::vector<EntifyGLCallCount> GetGLCallCountsForLastFrame()
+      const override;
+
+  // Ensures that one of the backend's contexts is current on the calling
+  // thread for the lifetime of the object, and serializes all GL work issued
+  // from different threads.  The context is left current afterwards so that
+  // consecutive calls from the same thread do not pay for eglMakeCurrent().
   class WithCurrent {
    public:
+    // Binds |surface| as the draw and read surface.
     WithCurrent(Backend* backend, EGLSurface surface);
+    // For work that does not render to a surface (e.g. creating a texture),
+    // so whatever surface is currently bound is kept.
     WithCurrent(Backend* backend);
     ~WithCurrent();
 
    private:
+    std::lock_guard<std::mutex> lock_;
     Backend* backend_;
-    EGLSurface surface_;
+    bool flush_on_exit_;
   };
 
  private:
-  // Create a dummy EGLSurface object to be assigned as the target surface
-  // when we need to make OpenGL calls that do not depend on a surface (e.g.
-  // creating a texture).
+  // Returns the context to be used by the calling thread.  The thread that
+  // created the backend uses |context_|, all other threads get their own
+  // context sharing objects with it, since an EGL context can only be
+  // current on one thread at a time.  Must be called with |mutex_| held.
+  EGLContext GetContextForCurrentThread();
+
+  // Makes |context| current with |surface| bound, unless it already is.
+  void MakeCurrent(EGLContext context, EGLSurface surface);
+
+  // If EGL_KHR_surfaceless_context is not supported, create a dummy
+  // EGLSurface object to be assigned as the target surface when we need to
+  // make OpenGL calls that do not depend on a surface (e.g. creating a
+  // texture).
   void InitializeDummySurface();
 
-  bool context_is_current_ = false;
+  std::mutex mutex_;
+  Device device_;
   EGLContext context_;
   EGLDisplay display_;
   EGLConfig config_;
-  EGLSurface dummy_surface_;
+  // EGL_NO_SURFACE if EGL_KHR_surfaceless_context is supported.
+  EGLSurface dummy_surface_ = EGL_NO_SURFACE;
+
+  std::thread::id owning_thread_;
+  // The contexts of the other threads.  These are shared with the threads
+  // themselves, which destroy their context when they exit.
+  std::shared_ptr<ThreadContexts> thread_contexts_;
 };
 
 }  // namespace gles2
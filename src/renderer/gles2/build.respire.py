@@ -72,7 +72,7 @@ def MakeWin32RendererModule(
 def Build(registry, out_dir, platform, configured_toolchain,
           entify_protobuf_definitions_module,
           entify_flatbuffers_definitions_module,
-          stdext_module, third_party_directory):
+          stdext_module, trace_log_module, third_party_directory):
   if not os.path.exists(out_dir):
     os.makedirs(out_dir)
 
@@ -80,19 +80,39 @@ def Build(registry, out_dir, platform, configured_toolchain,
   COMMON_SOURCES = [
     'backend.cc',
     'backend.h',
+    'deletion_queue.cc',
+    'deletion_queue.h',
+    'device.h',
+    'etc_codec.cc',
+    'etc_codec.h',
+    'gl_dispatch.cc',
+    'gl_dispatch.h',
+    'gpu_timer.cc',
+    'gpu_timer.h',
     'parse_protobuf.cc',
     'parse_protobuf.h',
     'parse_flatbuffer.cc',
     'parse_flatbuffer.h',
     'lookup_utils.h',
+    'memory_usage.cc',
+    'memory_usage.h',
+    'mesh_optimizer.cc',
+    'mesh_optimizer.h',
+    'pixel_conversion.cc',
+    'pixel_conversion.h',
     'render.cc',
     'render.h',
     'render_tree/draw_call.cc',
     'render_tree/draw_call.h',
+    'render_tree/draw_sequence.cc',
     'render_tree/draw_sequence.h',
+    'render_tree/draw_template.cc',
+    'render_tree/draw_template.h',
     'render_tree/draw_tree.h',
     'render_tree/fragment_shader.cc',
     'render_tree/fragment_shader.h',
+    'render_tree/index_buffer.cc',
+    'render_tree/index_buffer.h',
     'render_tree/program.cc',
     'render_tree/program.h',
     'render_tree/sampler.h',
@@ -104,8 +124,18 @@ def Build(registry, out_dir, platform, configured_toolchain,
     'render_tree/vertex_buffer.h',
     'render_tree/vertex_shader.cc',
     'render_tree/vertex_shader.h',
+    'static_batcher.cc',
+    'static_batcher.h',
+    'stream_vertex_buffer.cc',
+    'stream_vertex_buffer.h',
+    'texture_atlas.cc',
+    'texture_atlas.h',
     'utils.cc',
     'utils.h',
+    'vertex_array_cache.cc',
+    'vertex_array_cache.h',
+    'vertex_buffer_pool.cc',
+    'vertex_buffer_pool.h',
     'window_render_target.cc',
     'window_render_target.h',
   ]
@@ -113,6 +143,7 @@ def Build(registry, out_dir, platform, configured_toolchain,
     entify_protobuf_definitions_module,
     entify_flatbuffers_definitions_module,
     stdext_module,
+    trace_log_module,
   ]
 
   if platform == 'win32':
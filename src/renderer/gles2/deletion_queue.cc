@@ -0,0 +1,97 @@
+#include "src/renderer/gles2/deletion_queue.h"
+
+#include <algorithm>
+#include <limits>
+
+#include "src/renderer/gles2/utils.h"
+#include "src/trace_log/trace_log.h"
+
+namespace entify {
+namespace renderer {
+namespace gles2 {
+
+namespace {
+void DeleteHandles(DeletionQueue::HandleType type,
+                   const std::vector<GLuint>& handles) {
+  if (handles.empty()) {
+    return;
+  }
+
+  switch (type) {
+    case DeletionQueue::kHandleTypeTexture: {
+      GL_CALL(glDeleteTextures(handles.size(), handles.data()));
+    } break;
+    case DeletionQueue::kHandleTypeBuffer: {
+      GL_CALL(glDeleteBuffers(handles.size(), handles.data()));
+    } break;
+    // There are no array versions of the program and shader delete
+    // functions.
+    case DeletionQueue::kHandleTypeProgram: {
+      for (GLuint handle : handles) {
+        GL_CALL(glDeleteProgram(handle));
+      }
+    } break;
+    case DeletionQueue::kHandleTypeShader: {
+      for (GLuint handle : handles) {
+        GL_CALL(glDeleteShader(handle));
+      }
+    } break;
+    default:
+      assert(false);
+  }
+}
+}  // namespace
+
+void DeletionQueue::Enqueue(HandleType type, GLuint handle) {
+  assert(type < kNumHandleTypes);
+  std::lock_guard<std::mutex> lock(mutex_);
+  handles_[type].push_back(handle);
+}
+
+void DeletionQueue::Flush(size_t max_handles) {
+  ScopedTraceEvent trace_event("gles2", "DeleteGLObjects");
+  int64_t num_deleted = 0;
+
+  std::vector<GLuint> to_delete[kNumHandleTypes];
+  {
+    // Only hold the lock while taking handles off the queue, so that
+    // producers releasing nodes are not blocked on the GL calls.
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (int n = 0; n < kNumHandleTypes && max_handles > 0; ++n) {
+      int i = (first_type_ + n) % kNumHandleTypes;
+      std::vector<GLuint>& handles = handles_[i];
+      size_t count = std::min(handles.size(), max_handles);
+      to_delete[i].assign(handles.end() - count, handles.end());
+      handles.resize(handles.size() - count);
+      max_handles -= count;
+      num_deleted += count;
+    }
+    first_type_ = (first_type_ + 1) % kNumHandleTypes;
+  }
+  trace_event.AddArg("handles", num_deleted);
+
+  if (buffer_deletion_callback_ && !to_delete[kHandleTypeBuffer].empty()) {
+    buffer_deletion_callback_(to_delete[kHandleTypeBuffer]);
+  }
+
+  for (int i = 0; i < kNumHandleTypes; ++i) {
+    DeleteHandles(static_cast<HandleType>(i), to_delete[i]);
+  }
+}
+
+void DeletionQueue::FlushAll() {
+  Flush(std::numeric_limits<size_t>::max());
+}
+
+size_t DeletionQueue::size() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  size_t total = 0;
+  for (const auto& handles : handles_) {
+    total += handles.size();
+  }
+  return total;
+}
+
+}  // namespace gles2
+}  // namespace renderer
+}  // namespace entify
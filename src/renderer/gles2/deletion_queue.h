@@ -0,0 +1,58 @@
+#ifndef _SRC_ENTIFY_RENDERER_GLES2_DELETION_QUEUE_H_
+#define _SRC_ENTIFY_RENDERER_GLES2_DELETION_QUEUE_H_
+
+#include <functional>
+#include <mutex>
+#include <vector>
+
+#include <GLES2/gl2.h>
+
+namespace entify {
+namespace renderer {
+namespace gles2 {
+
+// Collects the GL handles of released render tree nodes so that they can be
+// deleted in bulk at a convenient time (e.g. right after a frame is swapped)
+// instead of one at a time whenever the last reference to a node goes away.
+// Handles may be enqueued from any thread without a context being current.
+class DeletionQueue {
+ public:
+  enum HandleType {
+    kHandleTypeTexture,
+    kHandleTypeBuffer,
+    kHandleTypeProgram,
+    kHandleTypeShader,
+    kNumHandleTypes,
+  };
+
+  void Enqueue(HandleType type, GLuint handle);
+
+  // Deletes at most |max_handles| of the queued handles.  Each call starts
+  // taking handles from the next type, so that a backlog of one type does
+  // not hold up the others.  This assumes that a context is current.
+  void Flush(size_t max_handles);
+  // Deletes all queued handles.  This assumes that a context is current.
+  void FlushAll();
+
+  size_t size() const;
+
+  // Runs |callback| with the buffers that each flush deletes, right before
+  // they are deleted, for objects that refer to buffers by handle.
+  void set_buffer_deletion_callback(
+      std::function<void(const std::vector<GLuint>&)> callback) {
+    buffer_deletion_callback_ = std::move(callback);
+  }
+
+ private:
+  mutable std::mutex mutex_;
+  std::vector<GLuint> handles_[kNumHandleTypes];
+  // The type that the next Flush() takes handles from first.
+  int first_type_ = 0;
+  std::function<void(const std::vector<GLuint>&)> buffer_deletion_callback_;
+};
+
+}  // namespace gles2
+}  // namespace renderer
+}  // namespace entify
+
+#endif  // _SRC_ENTIFY_RENDERER_GLES2_DELETION_QUEUE_H_
@@ -0,0 +1,127 @@
+#include "src/renderer/gles2/deletion_queue.h"
+
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "src/renderer/gles2/fake_gl_for_testing.h"
+
+namespace entify {
+namespace renderer {
+namespace gles2 {
+
+namespace {
+std::vector<GLuint> g_deleted_textures;
+std::vector<GLuint> g_deleted_buffers;
+int g_num_delete_calls = 0;
+
+void GL_APIENTRY RecordDeleteTextures(GLsizei n, const GLuint* textures) {
+  ++g_num_delete_calls;
+  g_deleted_textures.insert(g_deleted_textures.end(), textures, textures + n);
+}
+void GL_APIENTRY RecordDeleteBuffers(GLsizei n, const GLuint* buffers) {
+  ++g_num_delete_calls;
+  g_deleted_buffers.insert(g_deleted_buffers.end(), buffers, buffers + n);
+}
+
+class DeletionQueueTests : public ::testing::Test {
+ protected:
+  DeletionQueueTests() {
+    g_deleted_textures.clear();
+    g_deleted_buffers.clear();
+    g_num_delete_calls = 0;
+    GLDispatch dispatch = GetGLDispatch();
+    dispatch.glDeleteTextures = &RecordDeleteTextures;
+    dispatch.glDeleteBuffers = &RecordDeleteBuffers;
+    SetGLDispatchForTesting(dispatch);
+  }
+
+  void Enqueue(DeletionQueue::HandleType type, int count) {
+    for (int i = 0; i < count; ++i) {
+      queue_.Enqueue(type, next_handle_++);
+    }
+  }
+
+  // The number of handles of each type deleted so far.
+  std::vector<size_t> NumDeleted() const {
+    return {g_deleted_textures.size(), g_deleted_buffers.size(),
+            static_cast<size_t>(fake_gl_.calls(kGLFunction_glDeleteProgram)),
+            static_cast<size_t>(fake_gl_.calls(kGLFunction_glDeleteShader))};
+  }
+
+  ScopedFakeGL fake_gl_;
+  DeletionQueue queue_;
+  GLuint next_handle_ = 1;
+};
+
+typedef std::vector<size_t> Counts;
+}  // namespace
+
+TEST_F(DeletionQueueTests, FlushAllDeletesEverything) {
+  Enqueue(DeletionQueue::kHandleTypeTexture, 3);
+  Enqueue(DeletionQueue::kHandleTypeBuffer, 2);
+  Enqueue(DeletionQueue::kHandleTypeProgram, 1);
+  Enqueue(DeletionQueue::kHandleTypeShader, 2);
+  EXPECT_EQ(8u, queue_.size());
+
+  queue_.FlushAll();
+  EXPECT_EQ(0u, queue_.size());
+  EXPECT_EQ(Counts({3, 2, 1, 2}), NumDeleted());
+  // Arrays of textures and buffers are deleted with one call each.
+  EXPECT_EQ(2, g_num_delete_calls);
+}
+
+TEST_F(DeletionQueueTests, FlushStartsAtTheNextTypeEachTime) {
+  for (int type = 0; type < DeletionQueue::kNumHandleTypes; ++type) {
+    Enqueue(static_cast<DeletionQueue::HandleType>(type), 10);
+  }
+
+  queue_.Flush(4);
+  EXPECT_EQ(Counts({4, 0, 0, 0}), NumDeleted());
+  queue_.Flush(4);
+  EXPECT_EQ(Counts({4, 4, 0, 0}), NumDeleted());
+  queue_.Flush(4);
+  EXPECT_EQ(Counts({4, 4, 4, 0}), NumDeleted());
+  queue_.Flush(4);
+  EXPECT_EQ(Counts({4, 4, 4, 4}), NumDeleted());
+  queue_.Flush(4);
+  EXPECT_EQ(Counts({8, 4, 4, 4}), NumDeleted());
+  EXPECT_EQ(20u, queue_.size());
+}
+
+TEST_F(DeletionQueueTests, UnusedBudgetGoesToTheFollowingTypes) {
+  Enqueue(DeletionQueue::kHandleTypeTexture, 10);
+  Enqueue(DeletionQueue::kHandleTypeBuffer, 2);
+
+  queue_.Flush(5);
+  EXPECT_EQ(Counts({5, 0, 0, 0}), NumDeleted());
+  // Starts at the buffers, and wraps around to the textures.
+  queue_.Flush(5);
+  EXPECT_EQ(Counts({8, 2, 0, 0}), NumDeleted());
+  EXPECT_EQ(2u, queue_.size());
+}
+
+TEST_F(DeletionQueueTests, BufferCallbackSeesTheDeletedBuffers) {
+  Enqueue(DeletionQueue::kHandleTypeBuffer, 3);
+  std::vector<GLuint> seen;
+  queue_.set_buffer_deletion_callback(
+      [&seen](const std::vector<GLuint>& buffers) {
+        // Called before the buffers are deleted.
+        EXPECT_TRUE(g_deleted_buffers.empty());
+        seen = buffers;
+      });
+
+  queue_.FlushAll();
+  EXPECT_EQ(g_deleted_buffers, seen);
+  EXPECT_EQ(3u, seen.size());
+
+  // Not called when no buffers are deleted.
+  seen.clear();
+  Enqueue(DeletionQueue::kHandleTypeTexture, 1);
+  queue_.FlushAll();
+  EXPECT_TRUE(seen.empty());
+}
+
+}  // namespace gles2
+}  // namespace renderer
+}  // namespace entify
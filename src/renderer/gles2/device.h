@@ -0,0 +1,121 @@
+#ifndef _SRC_ENTIFY_RENDERER_GLES2_DEVICE_H_
+#define _SRC_ENTIFY_RENDERER_GLES2_DEVICE_H_
+
+#include <algorithm>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include <GLES2/gl2.h>
+
+#include "entify/entify.h"
+#include "src/renderer/gles2/deletion_queue.h"
+#include "src/renderer/gles2/gpu_timer.h"
+#include "src/renderer/gles2/static_batcher.h"
+#include "src/renderer/gles2/stream_vertex_buffer.h"
+#include "src/renderer/gles2/texture_atlas.h"
+#include "src/renderer/gles2/vertex_array_cache.h"
+#include "src/renderer/gles2/vertex_buffer_pool.h"
+
+namespace entify {
+namespace renderer {
+namespace gles2 {
+
+namespace render_tree {
+class PixelData;
+}  // namespace render_tree
+
+// Renderer state that is owned by the backend and shared by all render tree
+// nodes it creates.  It outlives every node.
+class Device {
+ public:
+  DeletionQueue* deletion_queue() { return &deletion_queue_; }
+  GPUTimer* gpu_timer() { return &gpu_timer_; }
+  VertexBufferPool* vertex_buffer_pool() { return &vertex_buffer_pool_; }
+  StreamVertexBuffer* stream_vertex_buffer() {
+    return &stream_vertex_buffer_;
+  }
+  StaticBatcher* static_batcher() { return &static_batcher_; }
+  VertexArrayCache* vertex_array_cache() { return &vertex_array_cache_; }
+  TextureAtlas* texture_atlas() { return &texture_atlas_; }
+
+  // The memory held by the caches above rather than by any node.  May be
+  // called from any thread.
+  EntifyMemoryUsage GetInternalMemoryUsage() const {
+    EntifyMemoryUsage usage = {0, 0, 0};
+    usage.gpu_bytes += static_batcher_.gpu_bytes();
+    usage.gpu_bytes += texture_atlas_.gpu_bytes();
+    return usage;
+  }
+
+  // Whether vertex attributes can be half floats
+  // (GL_OES_vertex_half_float).
+  bool supports_half_float_vertices() const {
+    return supports_half_float_vertices_;
+  }
+  void set_supports_half_float_vertices(bool supported) {
+    supports_half_float_vertices_ = supported;
+  }
+
+  // Whether textures whose sizes are not powers of two can have mipmaps
+  // (GL_OES_texture_npot).
+  bool supports_npot_mipmaps() const { return supports_npot_mipmaps_; }
+  void set_supports_npot_mipmaps(bool supported) {
+    supports_npot_mipmaps_ = supported;
+  }
+
+  // Whether textures can be uploaded in the compressed |format|, as listed
+  // by GL_COMPRESSED_TEXTURE_FORMATS.
+  bool supports_compressed_texture_format(GLenum format) const {
+    return std::find(compressed_texture_formats_.begin(),
+                     compressed_texture_formats_.end(), format) !=
+           compressed_texture_formats_.end();
+  }
+  void set_compressed_texture_formats(std::vector<GLint>&& formats) {
+    compressed_texture_formats_ = std::move(formats);
+  }
+
+  // The stats that rendering work is currently being accounted to.  This
+  // includes RenderTarget passes that are rendered while parsing.
+  EntifyFrameStats* frame_stats() { return &frame_stats_; }
+
+  // Returns the accumulated stats and starts accounting a new frame.
+  EntifyFrameStats TakeFrameStats() {
+    EntifyFrameStats frame_stats = frame_stats_;
+    frame_stats_ = EntifyFrameStats();
+    return frame_stats;
+  }
+
+  // Double buffered textures whose updates are to be made visible by the
+  // next submit.  A texture may be listed more than once.
+  void AddPendingTextureSwap(
+      const std::shared_ptr<render_tree::PixelData>& pixel_data) {
+    pending_texture_swaps_.push_back(pixel_data);
+  }
+  std::vector<std::weak_ptr<render_tree::PixelData>>
+      TakePendingTextureSwaps() {
+    return std::move(pending_texture_swaps_);
+  }
+
+ private:
+  DeletionQueue deletion_queue_;
+  GPUTimer gpu_timer_;
+  VertexBufferPool vertex_buffer_pool_{&deletion_queue_};
+  StreamVertexBuffer stream_vertex_buffer_{&deletion_queue_};
+  // Declared after the vertex buffer pool, as its batches hold vertex buffers.
+  StaticBatcher static_batcher_{this};
+  VertexArrayCache vertex_array_cache_{&deletion_queue_};
+  TextureAtlas texture_atlas_{&deletion_queue_};
+  bool supports_half_float_vertices_ = false;
+  bool supports_npot_mipmaps_ = false;
+  std::vector<GLint> compressed_texture_formats_;
+  EntifyFrameStats frame_stats_ = EntifyFrameStats();
+  // Weak, so that releasing a texture is not held up by a pending swap.
+  std::vector<std::weak_ptr<render_tree::PixelData>> pending_texture_swaps_;
+};
+
+}  // namespace gles2
+}  // namespace renderer
+}  // namespace entify
+
+#endif  // _SRC_ENTIFY_RENDERER_GLES2_DEVICE_H_
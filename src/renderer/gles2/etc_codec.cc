@@ -0,0 +1,572 @@
+#include "src/renderer/gles2/etc_codec.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+namespace entify {
+namespace renderer {
+namespace gles2 {
+
+namespace {
+// Within a block, pixels are numbered down the columns, x * 4 + y, which is
+// the order that their indices are stored in.
+const int kPixelsPerBlock = 16;
+
+// The ETC1 intensity modifier tables, indexed by a pixel's 2-bit index.
+const int kColorModifiers[8][4] = {
+  {2, 8, -2, -8},
+  {5, 17, -5, -17},
+  {9, 29, -9, -29},
+  {13, 42, -13, -42},
+  {18, 60, -18, -60},
+  {24, 80, -24, -80},
+  {33, 106, -33, -106},
+  {47, 183, -47, -183},
+};
+
+// The distances between the paint colors of the ETC2 T and H modes.
+const int kPaintColorDistances[8] = {3, 6, 11, 16, 23, 32, 41, 64};
+
+// The EAC alpha modifier tables, indexed by a pixel's 3-bit index.
+const int kAlphaModifiers[16][8] = {
+  {-3, -6, -9, -15, 2, 5, 8, 14},
+  {-3, -7, -10, -13, 2, 6, 9, 12},
+  {-2, -5, -8, -13, 1, 4, 7, 12},
+  {-2, -4, -6, -13, 1, 3, 5, 12},
+  {-3, -6, -8, -12, 2, 5, 7, 11},
+  {-3, -7, -9, -11, 2, 6, 8, 10},
+  {-4, -7, -8, -11, 3, 6, 7, 10},
+  {-3, -5, -8, -11, 2, 4, 7, 10},
+  {-2, -6, -8, -10, 1, 5, 7, 9},
+  {-2, -5, -8, -10, 1, 4, 7, 9},
+  {-2, -4, -8, -10, 1, 3, 7, 9},
+  {-2, -5, -7, -10, 1, 4, 6, 9},
+  {-3, -4, -7, -10, 2, 3, 6, 9},
+  {-1, -2, -3, -10, 0, 1, 2, 9},
+  {-4, -6, -8, -9, 3, 5, 7, 8},
+  {-3, -5, -7, -9, 2, 4, 6, 8},
+};
+// The table whose modifiers include 0, with the index of that modifier.
+const int kExactAlphaTable = 13;
+const int kExactAlphaIndex = 4;
+
+int NumBlocks(int num_pixels) { return (num_pixels + 3) / 4; }
+
+int BlockSizeInBytes(ETCFormat format) {
+  return format == kETCFormatETC2RGBA ? 16 : 8;
+}
+
+int NumChannels(ETCFormat format) {
+  return format == kETCFormatETC2RGBA ? 4 : 3;
+}
+
+int Clamp255(int value) { return std::min(std::max(value, 0), 255); }
+
+int Expand4(int value) { return (value << 4) | value; }
+int Expand5(int value) { return (value << 3) | (value >> 2); }
+int Expand6(int value) { return (value << 2) | (value >> 4); }
+int Expand7(int value) { return (value << 1) | (value >> 6); }
+
+uint64_t ReadBigEndian64(const uint8_t* data) {
+  uint64_t value = 0;
+  for (int i = 0; i < 8; ++i) {
+    value = (value << 8) | data[i];
+  }
+  return value;
+}
+
+void WriteBigEndian64(uint64_t value, uint8_t* data) {
+  for (int i = 7; i >= 0; --i) {
+    data[i] = static_cast<uint8_t>(value);
+    value >>= 8;
+  }
+}
+
+int Bits(uint64_t value, int lowest_bit, int num_bits) {
+  return static_cast<int>((value >> lowest_bit) & ((1u << num_bits) - 1));
+}
+
+// The 2-bit index of the pixel at |position|, whose high and low bits are
+// stored in separate halves of the block's low 32 bits.
+int ColorIndex(uint64_t block, int position) {
+  return (Bits(block, 16 + position, 1) << 1) | Bits(block, position, 1);
+}
+
+// The pixels of one of the two halves that ETC1 splits a block into.
+struct Subblock {
+  // Indexed by color channel, then by pixel.
+  int32_t colors[3][8];
+  // The position within the block of each pixel.
+  int positions[8];
+  int32_t sums[3];
+};
+
+struct SubblockFit {
+  int64_t error = std::numeric_limits<int64_t>::max();
+  int table = 0;
+  int indices[8];
+};
+
+#if defined(__GNUC__)
+// GCC and Clang lower generic vectors to SSE2 on x86 and to NEON on ARM, so
+// this processes a subblock's 8 pixels as two vectors of 4 with the same
+// source on both.
+typedef int32_t Int32x4 __attribute__((vector_size(16)));
+
+Int32x4 LoadInt32x4(const int32_t* values) {
+  Int32x4 vector;
+  memcpy(&vector, values, sizeof(vector));
+  return vector;
+}
+
+// Picks the modifier of |modifiers| that brings each pixel of |subblock|
+// closest to its color, writing the indices of the modifiers to |indices|
+// and returning the sum of squared errors.
+int64_t FitModifiers(const Subblock& subblock, const int base[3],
+                     const int* modifiers, int indices[8]) {
+  int64_t error = 0;
+  for (int half = 0; half < 2; ++half) {
+    const Int32x4 channels[3] = {
+      LoadInt32x4(subblock.colors[0] + 4 * half),
+      LoadInt32x4(subblock.colors[1] + 4 * half),
+      LoadInt32x4(subblock.colors[2] + 4 * half),
+    };
+    Int32x4 best_errors = Int32x4{} + std::numeric_limits<int32_t>::max();
+    Int32x4 best_indices = Int32x4{};
+    for (int i = 0; i < 4; ++i) {
+      Int32x4 errors = Int32x4{};
+      for (int c = 0; c < 3; ++c) {
+        Int32x4 difference =
+            channels[c] - Clamp255(base[c] + modifiers[i]);
+        errors += difference * difference;
+      }
+      Int32x4 better = errors < best_errors;
+      best_errors = (errors & better) | (best_errors & ~better);
+      best_indices = ((Int32x4{} + i) & better) | (best_indices & ~better);
+    }
+
+    for (int p = 0; p < 4; ++p) {
+      error += best_errors[p];
+      indices[4 * half + p] = best_indices[p];
+    }
+  }
+  return error;
+}
+#else
+int64_t FitModifiers(const Subblock& subblock, const int base[3],
+                     const int* modifiers, int indices[8]) {
+  int values[4][3];
+  for (int i = 0; i < 4; ++i) {
+    for (int c = 0; c < 3; ++c) {
+      values[i][c] = Clamp255(base[c] + modifiers[i]);
+    }
+  }
+
+  int64_t error = 0;
+  for (int p = 0; p < 8; ++p) {
+    int32_t best_error = std::numeric_limits<int32_t>::max();
+    for (int i = 0; i < 4; ++i) {
+      int32_t pixel_error = 0;
+      for (int c = 0; c < 3; ++c) {
+        int32_t difference = subblock.colors[c][p] - values[i][c];
+        pixel_error += difference * difference;
+      }
+      if (pixel_error < best_error) {
+        best_error = pixel_error;
+        indices[p] = i;
+      }
+    }
+    error += best_error;
+  }
+  return error;
+}
+#endif
+
+SubblockFit FitSubblock(const Subblock& subblock, const int base[3]) {
+  SubblockFit best;
+  for (int table = 0; table < 8; ++table) {
+    SubblockFit fit;
+    fit.table = table;
+    fit.error = FitModifiers(
+        subblock, base, kColorModifiers[table], fit.indices);
+    if (fit.error < best.error) {
+      best = fit;
+    }
+  }
+  return best;
+}
+
+// Packs the color block for the quantized base colors |bases|, which are
+// 4-bit, or 5-bit if |differential| is set.
+uint64_t PackColorBlock(bool differential, bool flip, const int bases[2][3],
+                        const Subblock subblocks[2],
+                        const SubblockFit fits[2]) {
+  uint32_t high = 0;
+  for (int c = 0; c < 3; ++c) {
+    if (differential) {
+      high |= bases[0][c] << (27 - 8 * c);
+      high |= ((bases[1][c] - bases[0][c]) & 7) << (24 - 8 * c);
+    } else {
+      high |= bases[0][c] << (28 - 8 * c);
+      high |= bases[1][c] << (24 - 8 * c);
+    }
+  }
+  high |= (fits[0].table << 5) | (fits[1].table << 2) |
+          (differential ? 2 : 0) | (flip ? 1 : 0);
+
+  uint32_t low = 0;
+  for (int s = 0; s < 2; ++s) {
+    for (int p = 0; p < 8; ++p) {
+      int position = subblocks[s].positions[p];
+      int index = fits[s].indices[p];
+      low |= ((index >> 1) << (16 + position)) | ((index & 1) << position);
+    }
+  }
+  return (static_cast<uint64_t>(high) << 32) | low;
+}
+
+// Encodes the colors of a block with the ETC1 modes.  Both ways of
+// splitting the block are tried, with the individual and, where the base
+// colors are close enough, the differential mode, and the one with the
+// least error wins.
+uint64_t EncodeColorBlock(const int32_t colors[3][kPixelsPerBlock]) {
+  int64_t best_error = std::numeric_limits<int64_t>::max();
+  uint64_t best_block = 0;
+  for (int flip = 0; flip < 2; ++flip) {
+    Subblock subblocks[2] = {};
+    int sizes[2] = {0, 0};
+    for (int position = 0; position < kPixelsPerBlock; ++position) {
+      int x = position / 4;
+      int y = position % 4;
+      Subblock& subblock = subblocks[flip ? y / 2 : x / 2];
+      int p = sizes[flip ? y / 2 : x / 2]++;
+      for (int c = 0; c < 3; ++c) {
+        subblock.colors[c][p] = colors[c][position];
+        subblock.sums[c] += colors[c][position];
+      }
+      subblock.positions[p] = position;
+    }
+
+    for (int differential = 0; differential < 2; ++differential) {
+      // The subblocks' average colors, rounded to 5 or 4 bits.
+      int max_value = differential ? 31 : 15;
+      int bases[2][3];
+      int expanded_bases[2][3];
+      bool representable = true;
+      for (int s = 0; s < 2; ++s) {
+        for (int c = 0; c < 3; ++c) {
+          bases[s][c] =
+              (subblocks[s].sums[c] * max_value + 255 * 4) / (255 * 8);
+          expanded_bases[s][c] = differential ? Expand5(bases[s][c]) :
+                                                Expand4(bases[s][c]);
+          if (differential && s == 1) {
+            int delta = bases[1][c] - bases[0][c];
+            representable = representable && delta >= -4 && delta <= 3;
+          }
+        }
+      }
+      if (!representable) {
+        continue;
+      }
+
+      SubblockFit fits[2] = {
+        FitSubblock(subblocks[0], expanded_bases[0]),
+        FitSubblock(subblocks[1], expanded_bases[1]),
+      };
+      int64_t error = fits[0].error + fits[1].error;
+      if (error < best_error) {
+        best_error = error;
+        best_block = PackColorBlock(
+            differential != 0, flip != 0, bases, subblocks, fits);
+      }
+    }
+  }
+  return best_block;
+}
+
+// Encodes an EAC alpha block.  For each table, the multiplier is chosen so
+// that the table's range just covers the block's, with the base centered.
+uint64_t EncodeAlphaBlock(const int32_t alphas[kPixelsPerBlock]) {
+  int min_alpha = *std::min_element(alphas, alphas + kPixelsPerBlock);
+  int max_alpha = *std::max_element(alphas, alphas + kPixelsPerBlock);
+
+  int best_table = kExactAlphaTable;
+  int best_base = min_alpha;
+  int best_multiplier = 1;
+  int best_indices[kPixelsPerBlock];
+  std::fill(best_indices, best_indices + kPixelsPerBlock, kExactAlphaIndex);
+  if (min_alpha != max_alpha) {
+    int64_t best_error = std::numeric_limits<int64_t>::max();
+    for (int table = 0; table < 16; ++table) {
+      const int* modifiers = kAlphaModifiers[table];
+      int range = modifiers[7] - modifiers[3];
+      int multiplier = std::max(
+          1, std::min(15, (max_alpha - min_alpha + range - 1) / range));
+      int base = Clamp255(
+          (min_alpha + max_alpha - multiplier * (modifiers[3] + modifiers[7]))
+          / 2);
+
+      int64_t error = 0;
+      int indices[kPixelsPerBlock];
+      for (int p = 0; p < kPixelsPerBlock; ++p) {
+        int best_pixel_error = std::numeric_limits<int>::max();
+        for (int i = 0; i < 8; ++i) {
+          int difference =
+              alphas[p] - Clamp255(base + modifiers[i] * multiplier);
+          if (difference * difference < best_pixel_error) {
+            best_pixel_error = difference * difference;
+            indices[p] = i;
+          }
+        }
+        error += best_pixel_error;
+      }
+      if (error < best_error) {
+        best_error = error;
+        best_table = table;
+        best_base = base;
+        best_multiplier = multiplier;
+        std::copy(indices, indices + kPixelsPerBlock, best_indices);
+      }
+    }
+  }
+
+  uint64_t block = (static_cast<uint64_t>(best_base) << 56) |
+                   (static_cast<uint64_t>(best_multiplier) << 52) |
+                   (static_cast<uint64_t>(best_table) << 48);
+  for (int p = 0; p < kPixelsPerBlock; ++p) {
+    block |= static_cast<uint64_t>(best_indices[p]) << (45 - 3 * p);
+  }
+  return block;
+}
+
+void SetColor(int r, int g, int b, uint8_t* pixel) {
+  pixel[0] = static_cast<uint8_t>(Clamp255(r));
+  pixel[1] = static_cast<uint8_t>(Clamp255(g));
+  pixel[2] = static_cast<uint8_t>(Clamp255(b));
+}
+
+// Decodes the ETC2 T and H modes, whose pixels pick one of four paint
+// colors.
+void DecodePaintColorBlock(uint64_t block, bool h_mode,
+                           uint8_t pixels[kPixelsPerBlock][4]) {
+  int colors[2][3];
+  int distance_index;
+  if (!h_mode) {
+    colors[0][0] = (Bits(block, 59, 2) << 2) | Bits(block, 56, 2);
+    colors[0][1] = Bits(block, 52, 4);
+    colors[0][2] = Bits(block, 48, 4);
+    colors[1][0] = Bits(block, 44, 4);
+    colors[1][1] = Bits(block, 40, 4);
+    colors[1][2] = Bits(block, 36, 4);
+    distance_index = (Bits(block, 34, 2) << 1) | Bits(block, 32, 1);
+  } else {
+    colors[0][0] = Bits(block, 59, 4);
+    colors[0][1] = (Bits(block, 56, 3) << 1) | Bits(block, 52, 1);
+    colors[0][2] = (Bits(block, 51, 1) << 3) | Bits(block, 47, 3);
+    colors[1][0] = Bits(block, 43, 4);
+    colors[1][1] = Bits(block, 39, 4);
+    colors[1][2] = Bits(block, 35, 4);
+    // The lowest bit of the distance is implied by the order of the colors.
+    int order[2];
+    for (int i = 0; i < 2; ++i) {
+      order[i] = (colors[i][0] << 8) | (colors[i][1] << 4) | colors[i][2];
+    }
+    distance_index = (Bits(block, 34, 1) << 2) | (Bits(block, 32, 1) << 1) |
+                     (order[0] >= order[1] ? 1 : 0);
+  }
+  for (int i = 0; i < 2; ++i) {
+    for (int c = 0; c < 3; ++c) {
+      colors[i][c] = Expand4(colors[i][c]);
+    }
+  }
+
+  int distance = kPaintColorDistances[distance_index];
+  int paint_colors[4][3];
+  for (int c = 0; c < 3; ++c) {
+    if (!h_mode) {
+      paint_colors[0][c] = colors[0][c];
+      paint_colors[1][c] = colors[1][c] + distance;
+      paint_colors[2][c] = colors[1][c];
+      paint_colors[3][c] = colors[1][c] - distance;
+    } else {
+      paint_colors[0][c] = colors[0][c] + distance;
+      paint_colors[1][c] = colors[0][c] - distance;
+      paint_colors[2][c] = colors[1][c] + distance;
+      paint_colors[3][c] = colors[1][c] - distance;
+    }
+  }
+
+  for (int position = 0; position < kPixelsPerBlock; ++position) {
+    const int* color = paint_colors[ColorIndex(block, position)];
+    SetColor(color[0], color[1], color[2], pixels[position]);
+  }
+}
+
+// Decodes the ETC2 planar mode, which interpolates between three colors.
+void DecodePlanarBlock(uint64_t block, uint8_t pixels[kPixelsPerBlock][4]) {
+  int origin[3] = {
+    Expand6(Bits(block, 57, 6)),
+    Expand7((Bits(block, 56, 1) << 6) | Bits(block, 49, 6)),
+    Expand6((Bits(block, 48, 1) << 5) | (Bits(block, 43, 2) << 3) |
+            Bits(block, 39, 3)),
+  };
+  int horizontal[3] = {
+    Expand6((Bits(block, 34, 5) << 1) | Bits(block, 32, 1)),
+    Expand7(Bits(block, 25, 7)),
+    Expand6(Bits(block, 19, 6)),
+  };
+  int vertical[3] = {
+    Expand6(Bits(block, 13, 6)),
+    Expand7(Bits(block, 6, 7)),
+    Expand6(Bits(block, 0, 6)),
+  };
+
+  for (int position = 0; position < kPixelsPerBlock; ++position) {
+    int x = position / 4;
+    int y = position % 4;
+    int color[3];
+    for (int c = 0; c < 3; ++c) {
+      color[c] = (x * (horizontal[c] - origin[c]) +
+                  y * (vertical[c] - origin[c]) + 4 * origin[c] + 2) >> 2;
+    }
+    SetColor(color[0], color[1], color[2], pixels[position]);
+  }
+}
+
+void DecodeColorBlock(const uint8_t* data,
+                      uint8_t pixels[kPixelsPerBlock][4]) {
+  uint64_t block = ReadBigEndian64(data);
+  bool differential = Bits(block, 33, 1) != 0;
+  bool flip = Bits(block, 32, 1) != 0;
+
+  int bases[2][3];
+  for (int c = 0; c < 3; ++c) {
+    if (differential) {
+      int base = Bits(block, 59 - 8 * c, 5);
+      // The delta is a 3-bit two's complement number.
+      int second_base = base + ((Bits(block, 56 - 8 * c, 3) ^ 4) - 4);
+      if (second_base < 0 || second_base > 31) {
+        // ETC1 leaves overflows undefined, and ETC2 uses them to signal its
+        // other modes.
+        if (c == 0 || c == 1) {
+          DecodePaintColorBlock(block, c == 1, pixels);
+        } else {
+          DecodePlanarBlock(block, pixels);
+        }
+        return;
+      }
+      bases[0][c] = Expand5(base);
+      bases[1][c] = Expand5(second_base);
+    } else {
+      bases[0][c] = Expand4(Bits(block, 60 - 8 * c, 4));
+      bases[1][c] = Expand4(Bits(block, 56 - 8 * c, 4));
+    }
+  }
+  const int* tables[2] = {
+    kColorModifiers[Bits(block, 37, 3)],
+    kColorModifiers[Bits(block, 34, 3)],
+  };
+
+  for (int position = 0; position < kPixelsPerBlock; ++position) {
+    int x = position / 4;
+    int y = position % 4;
+    int subblock = flip ? y / 2 : x / 2;
+    int modifier = tables[subblock][ColorIndex(block, position)];
+    SetColor(bases[subblock][0] + modifier, bases[subblock][1] + modifier,
+             bases[subblock][2] + modifier, pixels[position]);
+  }
+}
+
+void DecodeAlphaBlock(const uint8_t* data,
+                      uint8_t pixels[kPixelsPerBlock][4]) {
+  uint64_t block = ReadBigEndian64(data);
+  int base = Bits(block, 56, 8);
+  int multiplier = Bits(block, 52, 4);
+  const int* modifiers = kAlphaModifiers[Bits(block, 48, 4)];
+  for (int position = 0; position < kPixelsPerBlock; ++position) {
+    int index = Bits(block, 45 - 3 * position, 3);
+    pixels[position][3] =
+        static_cast<uint8_t>(Clamp255(base + modifiers[index] * multiplier));
+  }
+}
+}  // namespace
+
+int ETCRowSizeInBytes(ETCFormat format, int width_in_pixels) {
+  return NumBlocks(width_in_pixels) * BlockSizeInBytes(format);
+}
+
+int64_t ETCImageSizeInBytes(ETCFormat format, int width_in_pixels,
+                            int height_in_pixels) {
+  return static_cast<int64_t>(ETCRowSizeInBytes(format, width_in_pixels)) *
+         NumBlocks(height_in_pixels);
+}
+
+void EncodeETC(ETCFormat format, const char* pixels, int width_in_pixels,
+               int height_in_pixels, std::vector<char>* blocks) {
+  int num_channels = NumChannels(format);
+  blocks->resize(
+      ETCImageSizeInBytes(format, width_in_pixels, height_in_pixels));
+  uint8_t* out = reinterpret_cast<uint8_t*>(blocks->data());
+
+  for (int block_y = 0; block_y < NumBlocks(height_in_pixels); ++block_y) {
+    for (int block_x = 0; block_x < NumBlocks(width_in_pixels); ++block_x) {
+      int32_t colors[3][kPixelsPerBlock];
+      int32_t alphas[kPixelsPerBlock];
+      for (int position = 0; position < kPixelsPerBlock; ++position) {
+        // Blocks that stick out of the image repeat its edge pixels, which
+        // keeps them from skewing the block's colors.
+        int x = std::min(block_x * 4 + position / 4, width_in_pixels - 1);
+        int y = std::min(block_y * 4 + position % 4, height_in_pixels - 1);
+        const uint8_t* pixel = reinterpret_cast<const uint8_t*>(pixels) +
+            (static_cast<int64_t>(y) * width_in_pixels + x) * num_channels;
+        for (int c = 0; c < 3; ++c) {
+          colors[c][position] = pixel[c];
+        }
+        alphas[position] = num_channels == 4 ? pixel[3] : 255;
+      }
+
+      if (format == kETCFormatETC2RGBA) {
+        WriteBigEndian64(EncodeAlphaBlock(alphas), out);
+        out += 8;
+      }
+      WriteBigEndian64(EncodeColorBlock(colors), out);
+      out += 8;
+    }
+  }
+}
+
+void DecodeETC(ETCFormat format, const char* blocks, int width_in_pixels,
+               int height_in_pixels, std::vector<char>* pixels) {
+  int num_channels = NumChannels(format);
+  pixels->resize(static_cast<size_t>(width_in_pixels) * height_in_pixels *
+                 num_channels);
+  const uint8_t* in = reinterpret_cast<const uint8_t*>(blocks);
+
+  for (int block_y = 0; block_y < NumBlocks(height_in_pixels); ++block_y) {
+    for (int block_x = 0; block_x < NumBlocks(width_in_pixels); ++block_x) {
+      uint8_t decoded[kPixelsPerBlock][4];
+      if (format == kETCFormatETC2RGBA) {
+        DecodeAlphaBlock(in, decoded);
+        in += 8;
+      }
+      DecodeColorBlock(in, decoded);
+      in += 8;
+
+      for (int position = 0; position < kPixelsPerBlock; ++position) {
+        int x = block_x * 4 + position / 4;
+        int y = block_y * 4 + position % 4;
+        if (x < width_in_pixels && y < height_in_pixels) {
+          memcpy(pixels->data() +
+                     (static_cast<int64_t>(y) * width_in_pixels + x) *
+                         num_channels,
+                 decoded[position], num_channels);
+        }
+      }
+    }
+  }
+}
+
+}  // namespace gles2
+}  // namespace renderer
+}  // namespace entify
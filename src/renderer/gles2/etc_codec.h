@@ -0,0 +1,46 @@
+#ifndef _SRC_ENTIFY_RENDERER_GLES2_ETC_CODEC_H_
+#define _SRC_ENTIFY_RENDERER_GLES2_ETC_CODEC_H_
+
+#include <cstdint>
+#include <vector>
+
+namespace entify {
+namespace renderer {
+namespace gles2 {
+
+// ETC compressed images store each block of 4x4 pixels in 8 bytes, plus 8
+// bytes of EAC alpha for kETCFormatETC2RGBA.  Blocks are stored left to
+// right, top to bottom, and blocks that stick out of the image hold padding.
+enum ETCFormat {
+  // GL_ETC1_RGB8_OES.
+  kETCFormatETC1,
+  // GL_COMPRESSED_RGB8_ETC2, which can also decode every ETC1 block.
+  kETCFormatETC2RGB,
+  // GL_COMPRESSED_RGBA8_ETC2_EAC.
+  kETCFormatETC2RGBA,
+};
+
+// The size of a row of blocks that is |width_in_pixels| wide.
+int ETCRowSizeInBytes(ETCFormat format, int width_in_pixels);
+// The size of a whole image.
+int64_t ETCImageSizeInBytes(ETCFormat format, int width_in_pixels,
+                            int height_in_pixels);
+
+// Compresses the tightly packed image at |pixels|, which is RGB, or RGBA for
+// kETCFormatETC2RGBA, into |blocks|.  Colors are always encoded with the
+// ETC1 modes, so the output of kETCFormatETC2RGB can also be used as ETC1.
+// This is a fast encoder meant to run while nodes are created, so it picks
+// each block's base colors from its averages rather than searching for them.
+void EncodeETC(ETCFormat format, const char* pixels, int width_in_pixels,
+               int height_in_pixels, std::vector<char>* blocks);
+
+// Decompresses |blocks| into tightly packed RGB pixels, or RGBA for
+// kETCFormatETC2RGBA.  Used where the GPU can not sample the format.
+void DecodeETC(ETCFormat format, const char* blocks, int width_in_pixels,
+               int height_in_pixels, std::vector<char>* pixels);
+
+}  // namespace gles2
+}  // namespace renderer
+}  // namespace entify
+
+#endif  // _SRC_ENTIFY_RENDERER_GLES2_ETC_CODEC_H_
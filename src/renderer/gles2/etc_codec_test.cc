@@ -0,0 +1,266 @@
+#include "src/renderer/gles2/etc_codec.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace entify {
+namespace renderer {
+namespace gles2 {
+
+namespace {
+// The largest error that a color channel of a block of one color may have.
+// Base colors are rounded to 5 bits, and the smallest modifiers are +-2.
+const int kMaxSolidColorError = 6;
+// The largest error where the two halves of a block differ, which need the
+// 4-bit base colors of the individual mode.
+const int kMaxTwoColorError = 10;
+// The bounds on the errors of a smooth gradient.
+const int kMaxGradientError = 12;
+const double kMaxGradientMeanSquaredError = 8.0;
+
+struct Errors {
+  int max = 0;
+  double mean_squared = 0.0;
+};
+
+Errors Compare(const std::vector<char>& expected,
+               const std::vector<char>& actual) {
+  Errors errors;
+  EXPECT_EQ(expected.size(), actual.size());
+  if (expected.size() != actual.size() || expected.empty()) {
+    return errors;
+  }
+  int64_t sum_of_squares = 0;
+  for (size_t i = 0; i < expected.size(); ++i) {
+    int error = std::abs(static_cast<uint8_t>(expected[i]) -
+                         static_cast<uint8_t>(actual[i]));
+    errors.max = std::max(errors.max, error);
+    sum_of_squares += error * error;
+  }
+  errors.mean_squared =
+      static_cast<double>(sum_of_squares) / expected.size();
+  return errors;
+}
+
+std::vector<char> RoundTrip(ETCFormat format, const std::vector<char>& pixels,
+                            int width, int height) {
+  std::vector<char> blocks;
+  EncodeETC(format, pixels.data(), width, height, &blocks);
+  EXPECT_EQ(ETCImageSizeInBytes(format, width, height),
+            static_cast<int64_t>(blocks.size()));
+  std::vector<char> decoded;
+  DecodeETC(format, blocks.data(), width, height, &decoded);
+  return decoded;
+}
+
+int NumChannels(ETCFormat format) {
+  return format == kETCFormatETC2RGBA ? 4 : 3;
+}
+
+// Fills an image with the color that |color| returns for each pixel.
+template <typename ColorFunction>
+std::vector<char> MakeImage(ETCFormat format, int width, int height,
+                            const ColorFunction& color) {
+  int num_channels = NumChannels(format);
+  std::vector<char> pixels(width * height * num_channels);
+  for (int y = 0; y < height; ++y) {
+    for (int x = 0; x < width; ++x) {
+      for (int c = 0; c < num_channels; ++c) {
+        pixels[(y * width + x) * num_channels + c] =
+            static_cast<char>(color(x, y, c));
+      }
+    }
+  }
+  return pixels;
+}
+
+std::vector<char> ToBytes(uint64_t block) {
+  std::vector<char> bytes(8);
+  for (int i = 7; i >= 0; --i) {
+    bytes[i] = static_cast<char>(block & 0xff);
+    block >>= 8;
+  }
+  return bytes;
+}
+
+// The channels of the pixel at |x|, |y| of a decoded 4x4 block.
+std::vector<int> PixelAt(const std::vector<char>& pixels, int num_channels,
+                         int x, int y) {
+  std::vector<int> channels;
+  for (int c = 0; c < num_channels; ++c) {
+    channels.push_back(
+        static_cast<uint8_t>(pixels[(y * 4 + x) * num_channels + c]));
+  }
+  return channels;
+}
+
+const ETCFormat kAllFormats[] = {
+  kETCFormatETC1, kETCFormatETC2RGB, kETCFormatETC2RGBA,
+};
+}  // namespace
+
+TEST(ETCCodecTests, ImageSizes) {
+  EXPECT_EQ(8, ETCRowSizeInBytes(kETCFormatETC1, 4));
+  EXPECT_EQ(16, ETCRowSizeInBytes(kETCFormatETC1, 5));
+  EXPECT_EQ(32, ETCRowSizeInBytes(kETCFormatETC2RGBA, 5));
+  EXPECT_EQ(10 * 6 * 8, ETCImageSizeInBytes(kETCFormatETC2RGB, 37, 23));
+  EXPECT_EQ(10 * 6 * 16, ETCImageSizeInBytes(kETCFormatETC2RGBA, 37, 23));
+}
+
+TEST(ETCCodecTests, DecodesIndividualModeBlock) {
+  // Base colors and tables of 0, with every pixel at index 0, whose
+  // modifier is +2.
+  std::vector<char> pixels;
+  DecodeETC(kETCFormatETC1, ToBytes(0).data(), 4, 4, &pixels);
+  for (int y = 0; y < 4; ++y) {
+    for (int x = 0; x < 4; ++x) {
+      EXPECT_EQ(std::vector<int>({2, 2, 2}), PixelAt(pixels, 3, x, y));
+    }
+  }
+}
+
+TEST(ETCCodecTests, DecodesDifferentialModeBlock) {
+  // Split into left and right halves.  The left half has the base color
+  // (16, 8, 4) and table 1, and the right half adds (+3, 0, -1) and uses
+  // table 0.  The bottom right pixel has index 3, the others index 0.
+  uint64_t high = (16u << 27) | (3u << 24) | (8u << 19) | (0u << 16) |
+                  (4u << 11) | (7u << 8) | (1u << 5) | (0u << 2) | 2u;
+  uint64_t low = (1u << (16 + 15)) | (1u << 15);
+  std::vector<char> pixels;
+  DecodeETC(kETCFormatETC1, ToBytes((high << 32) | low).data(), 4, 4,
+            &pixels);
+
+  // The 5-bit base colors expand to (132, 66, 33) and (156, 66, 24).
+  EXPECT_EQ(std::vector<int>({137, 71, 38}), PixelAt(pixels, 3, 0, 0));
+  EXPECT_EQ(std::vector<int>({137, 71, 38}), PixelAt(pixels, 3, 1, 3));
+  EXPECT_EQ(std::vector<int>({158, 68, 26}), PixelAt(pixels, 3, 2, 0));
+  EXPECT_EQ(std::vector<int>({148, 58, 16}), PixelAt(pixels, 3, 3, 3));
+}
+
+TEST(ETCCodecTests, DecodesETC2PlanarModeBlock) {
+  // A differential block whose blue overflows, 0 - 4, selects the planar
+  // mode.  The horizontal red is 63 and every other color is 0.
+  uint64_t block = (1ull << 42) | (0x1full << 34) | (1ull << 33) |
+                   (1ull << 32);
+  std::vector<char> pixels;
+  DecodeETC(kETCFormatETC2RGB, ToBytes(block).data(), 4, 4, &pixels);
+
+  const int kRed[4] = {0, 64, 128, 191};
+  for (int y = 0; y < 4; ++y) {
+    for (int x = 0; x < 4; ++x) {
+      EXPECT_EQ(std::vector<int>({kRed[x], 0, 0}), PixelAt(pixels, 3, x, y));
+    }
+  }
+}
+
+TEST(ETCCodecTests, DecodesEACAlphaBlock) {
+  // Base 100, multiplier 2 and table 13, with each pixel's index being its
+  // position modulo 8.
+  const int kModifiers[8] = {-1, -2, -3, -10, 0, 1, 2, 9};
+  uint64_t alpha_block = (100ull << 56) | (2ull << 52) | (13ull << 48);
+  for (int position = 0; position < 16; ++position) {
+    alpha_block |= static_cast<uint64_t>(position % 8) << (45 - 3 * position);
+  }
+  std::vector<char> blocks = ToBytes(alpha_block);
+  std::vector<char> color_block = ToBytes(0);
+  blocks.insert(blocks.end(), color_block.begin(), color_block.end());
+
+  std::vector<char> pixels;
+  DecodeETC(kETCFormatETC2RGBA, blocks.data(), 4, 4, &pixels);
+  for (int y = 0; y < 4; ++y) {
+    for (int x = 0; x < 4; ++x) {
+      int alpha = 100 + 2 * kModifiers[(x * 4 + y) % 8];
+      EXPECT_EQ(std::vector<int>({2, 2, 2, alpha}), PixelAt(pixels, 4, x, y));
+    }
+  }
+}
+
+TEST(ETCCodecTests, SolidColorsRoundTrip) {
+  for (ETCFormat format : kAllFormats) {
+    for (int r = 0; r < 256; r += 15) {
+      for (int g = 0; g < 256; g += 51) {
+        for (int b = 0; b < 256; b += 85) {
+          const int color[4] = {r, g, b, 255 - r};
+          std::vector<char> pixels = MakeImage(
+              format, 4, 4, [&color](int, int, int c) { return color[c]; });
+          Errors errors =
+              Compare(pixels, RoundTrip(format, pixels, 4, 4));
+          EXPECT_LE(errors.max, kMaxSolidColorError)
+              << "format " << format << " color " << r << ", " << g << ", "
+              << b;
+        }
+      }
+    }
+  }
+}
+
+TEST(ETCCodecTests, BlockHalvesKeepTheirColors) {
+  for (ETCFormat format : kAllFormats) {
+    for (bool vertical : {false, true}) {
+      std::vector<char> pixels = MakeImage(
+          format, 4, 4, [vertical](int x, int y, int c) {
+            bool first = (vertical ? y : x) < 2;
+            const int kColors[2][4] = {{20, 10, 235, 255},
+                                       {230, 115, 25, 255}};
+            return kColors[first ? 0 : 1][c];
+          });
+      Errors errors = Compare(pixels, RoundTrip(format, pixels, 4, 4));
+      EXPECT_LE(errors.max, kMaxTwoColorError)
+          << "format " << format << (vertical ? " vertical" : " horizontal");
+    }
+  }
+}
+
+TEST(ETCCodecTests, GradientsRoundTrip) {
+  // The size is not a multiple of the block size, so the blocks at the
+  // right and bottom edges are padded.
+  const int kWidth = 37;
+  const int kHeight = 23;
+  for (ETCFormat format : kAllFormats) {
+    std::vector<char> pixels = MakeImage(
+        format, kWidth, kHeight, [](int x, int y, int c) {
+          return (x * 255 / (kWidth - 1) * (c + 1) / 4 + y * 3) & 0xff;
+        });
+    Errors errors =
+        Compare(pixels, RoundTrip(format, pixels, kWidth, kHeight));
+    EXPECT_LE(errors.max, kMaxGradientError) << "format " << format;
+    EXPECT_LE(errors.mean_squared, kMaxGradientMeanSquaredError)
+        << "format " << format;
+  }
+}
+
+TEST(ETCCodecTests, ConstantAlphaIsExact) {
+  for (int alpha = 0; alpha < 256; ++alpha) {
+    std::vector<char> pixels = MakeImage(
+        kETCFormatETC2RGBA, 4, 4,
+        [alpha](int x, int y, int c) { return c == 3 ? alpha : x * 40 + y; });
+    std::vector<char> decoded =
+        RoundTrip(kETCFormatETC2RGBA, pixels, 4, 4);
+    for (int i = 3; i < 64; i += 4) {
+      EXPECT_EQ(alpha, static_cast<uint8_t>(decoded[i]));
+    }
+  }
+}
+
+TEST(ETCCodecTests, ETC1BlocksDecodeTheSameAsETC2) {
+  std::vector<char> pixels = MakeImage(
+      kETCFormatETC1, 16, 16, [](int x, int y, int c) {
+        return (x * 16 + y * 7 * c + (x / 4 + y / 4) * 60) & 0xff;
+      });
+  std::vector<char> blocks;
+  EncodeETC(kETCFormatETC1, pixels.data(), 16, 16, &blocks);
+
+  std::vector<char> as_etc1;
+  std::vector<char> as_etc2;
+  DecodeETC(kETCFormatETC1, blocks.data(), 16, 16, &as_etc1);
+  DecodeETC(kETCFormatETC2RGB, blocks.data(), 16, 16, &as_etc2);
+  EXPECT_EQ(as_etc1, as_etc2);
+}
+
+}  // namespace gles2
+}  // namespace renderer
+}  // namespace entify
@@ -0,0 +1,117 @@
+#include "src/renderer/gles2/fake_gl_for_testing.h"
+
+#include <atomic>
+
+namespace entify {
+namespace renderer {
+namespace gles2 {
+
+namespace {
+std::atomic<int> g_calls[kNumGLFunctions];
+std::atomic<GLuint> g_next_handle(1);
+
+void Count(GLFunction function) {
+  g_calls[function].fetch_add(1, std::memory_order_relaxed);
+}
+
+// The fake for every function that has nothing better to do.
+template <typename Function, GLFunction kIndex>
+struct Fake;
+
+template <typename R, typename... Args, GLFunction kIndex>
+struct Fake<R (GL_APIENTRY*)(Args...), kIndex> {
+  static R GL_APIENTRY Call(Args...) {
+    Count(kIndex);
+    return R();
+  }
+};
+
+void GenHandles(GLsizei n, GLuint* handles) {
+  for (GLsizei i = 0; i < n; ++i) {
+    handles[i] = g_next_handle.fetch_add(1);
+  }
+}
+
+void GL_APIENTRY FakeGenBuffers(GLsizei n, GLuint* buffers) {
+  Count(kGLFunction_glGenBuffers);
+  GenHandles(n, buffers);
+}
+void GL_APIENTRY FakeGenFramebuffers(GLsizei n, GLuint* framebuffers) {
+  Count(kGLFunction_glGenFramebuffers);
+  GenHandles(n, framebuffers);
+}
+void GL_APIENTRY FakeGenTextures(GLsizei n, GLuint* textures) {
+  Count(kGLFunction_glGenTextures);
+  GenHandles(n, textures);
+}
+GLuint GL_APIENTRY FakeCreateProgram() {
+  Count(kGLFunction_glCreateProgram);
+  return g_next_handle.fetch_add(1);
+}
+GLuint GL_APIENTRY FakeCreateShader(GLenum) {
+  Count(kGLFunction_glCreateShader);
+  return g_next_handle.fetch_add(1);
+}
+// Reports success for compile and link status queries.
+void GL_APIENTRY FakeGetShaderiv(GLuint, GLenum, GLint* params) {
+  Count(kGLFunction_glGetShaderiv);
+  *params = GL_TRUE;
+}
+void GL_APIENTRY FakeGetProgramiv(GLuint, GLenum, GLint* params) {
+  Count(kGLFunction_glGetProgramiv);
+  *params = GL_TRUE;
+}
+void GL_APIENTRY FakeGetIntegerv(GLenum, GLint* data) {
+  Count(kGLFunction_glGetIntegerv);
+  *data = 0;
+}
+const GLubyte* GL_APIENTRY FakeGetString(GLenum) {
+  Count(kGLFunction_glGetString);
+  return reinterpret_cast<const GLubyte*>("");
+}
+GLenum GL_APIENTRY FakeCheckFramebufferStatus(GLenum) {
+  Count(kGLFunction_glCheckFramebufferStatus);
+  return GL_FRAMEBUFFER_COMPLETE;
+}
+}  // namespace
+
+ScopedFakeGL::ScopedFakeGL() : previous_dispatch_(GetGLDispatch()) {
+  for (auto& calls : g_calls) {
+    calls.store(0);
+  }
+
+  GLDispatch dispatch;
+#define ENTIFY_GL_FAKE(name) \
+  dispatch.name = &Fake<decltype(&::name), kGLFunction_##name>::Call;
+#define ENTIFY_GL_EXTENSION_FAKE(name, type) \
+  dispatch.name = &Fake<type, kGLFunction_##name>::Call;
+  ENTIFY_GL_FUNCTIONS(ENTIFY_GL_FAKE)
+  ENTIFY_GL_EXTENSION_FUNCTIONS(ENTIFY_GL_EXTENSION_FAKE)
+#undef ENTIFY_GL_EXTENSION_FAKE
+#undef ENTIFY_GL_FAKE
+
+  dispatch.glGenBuffers = &FakeGenBuffers;
+  dispatch.glGenFramebuffers = &FakeGenFramebuffers;
+  dispatch.glGenTextures = &FakeGenTextures;
+  dispatch.glCreateProgram = &FakeCreateProgram;
+  dispatch.glCreateShader = &FakeCreateShader;
+  dispatch.glGetShaderiv = &FakeGetShaderiv;
+  dispatch.glGetProgramiv = &FakeGetProgramiv;
+  dispatch.glGetIntegerv = &FakeGetIntegerv;
+  dispatch.glGetString = &FakeGetString;
+  dispatch.glCheckFramebufferStatus = &FakeCheckFramebufferStatus;
+
+  SetGLDispatchForTesting(dispatch);
+}
+
+ScopedFakeGL::~ScopedFakeGL() {
+  SetGLDispatchForTesting(previous_dispatch_);
+}
+
+int ScopedFakeGL::calls(GLFunction function) const {
+  return g_calls[function].load();
+}
+
+}  // namespace gles2
+}  // namespace renderer
+}  // namespace entify
@@ -0,0 +1,31 @@
+#ifndef _SRC_ENTIFY_RENDERER_GLES2_FAKE_GL_FOR_TESTING_H_
+#define _SRC_ENTIFY_RENDERER_GLES2_FAKE_GL_FOR_TESTING_H_
+
+#include "src/renderer/gles2/gl_dispatch.h"
+
+namespace entify {
+namespace renderer {
+namespace gles2 {
+
+// Routes GL_CALL() to fake GL functions for as long as it exists, so that
+// code that makes GL calls can be tested without a context.  The fakes do
+// nothing and return zero, except that the glGen*() and glCreate*()
+// functions hand out distinct handles, status queries report success, and
+// glGetString() returns an empty string.  Calls are counted per function.
+class ScopedFakeGL {
+ public:
+  ScopedFakeGL();
+  ~ScopedFakeGL();
+
+  // The number of calls made to |function| since construction.
+  int calls(GLFunction function) const;
+
+ private:
+  GLDispatch previous_dispatch_;
+};
+
+}  // namespace gles2
+}  // namespace renderer
+}  // namespace entify
+
+#endif  // _SRC_ENTIFY_RENDERER_GLES2_FAKE_GL_FOR_TESTING_H_
@@ -0,0 +1,495 @@
+#include "src/renderer/gles2/gl_dispatch.h"
+
+#include <atomic>
+#include <cassert>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <string>
+
+#include <EGL/egl.h>
+
+namespace entify {
+namespace renderer {
+namespace gles2 {
+
+namespace {
+
+const char* kGLFunctionNames[] = {
+#define ENTIFY_GL_FUNCTION_NAME(name) #name,
+#define ENTIFY_GL_EXTENSION_FUNCTION_NAME(name, type) #name,
+  ENTIFY_GL_FUNCTIONS(ENTIFY_GL_FUNCTION_NAME)
+  ENTIFY_GL_EXTENSION_FUNCTIONS(ENTIFY_GL_EXTENSION_FUNCTION_NAME)
+#undef ENTIFY_GL_EXTENSION_FUNCTION_NAME
+#undef ENTIFY_GL_FUNCTION_NAME
+};
+
+// The extension functions, as loaded through eglGetProcAddress().
+#define ENTIFY_GL_EXTENSION_POINTER(name, type) type g_##name = nullptr;
+ENTIFY_GL_EXTENSION_FUNCTIONS(ENTIFY_GL_EXTENSION_POINTER)
+#undef ENTIFY_GL_EXTENSION_POINTER
+
+// In counting mode, if ENTIFY_GL_REPORT_COUNTS is set, the counts of the last
+// frame are also written to stderr once every this many frames.
+const int kCountingReportInterval = 60;
+
+std::atomic<uint32_t> g_call_counts[kNumGLFunctions];
+
+std::mutex g_last_frame_mutex;
+std::vector<uint32_t> g_last_frame_call_counts(kNumGLFunctions, 0);
+std::atomic<int> g_frame_number(0);
+
+std::mutex g_recording_mutex;
+std::ofstream g_recording_stream;
+
+GLDispatchMode GetDefaultMode() {
+#if defined(NDEBUG)
+  return kGLDispatchModeDirect;
+#else
+  return kGLDispatchModeChecked;
+#endif
+}
+
+GLDispatchMode GetModeFromEnvironment() {
+  const char* mode = std::getenv("ENTIFY_GL_DISPATCH");
+  if (!mode) {
+    return GetDefaultMode();
+  }
+
+  if (strcmp(mode, "direct") == 0) {
+    return kGLDispatchModeDirect;
+  } else if (strcmp(mode, "checked") == 0) {
+    return kGLDispatchModeChecked;
+  } else if (strcmp(mode, "counting") == 0) {
+    return kGLDispatchModeCounting;
+  } else if (strcmp(mode, "recording") == 0) {
+    return kGLDispatchModeRecording;
+  }
+
+  std::cerr << "Unknown ENTIFY_GL_DISPATCH mode '" << mode << "'."
+            << std::endl;
+  return GetDefaultMode();
+}
+
+// Checks for a GL error once the call it was created for has returned.
+class ScopedErrorCheck {
+ public:
+  explicit ScopedErrorCheck(GLFunction function) : function_(function) {}
+  ~ScopedErrorCheck() {
+    GLenum error = ::glGetError();
+    if (error != GL_NO_ERROR) {
+      std::cerr << "GL Error: " << error << " in "
+                << GLFunctionName(function_) << std::endl;
+      assert(false);
+    }
+  }
+
+ private:
+  GLFunction function_;
+};
+
+template <typename T>
+void WriteArgument(std::ostream* out, T value) {
+  // The unary plus makes sure that GLboolean is written as a number.
+  *out << +value;
+}
+template <typename T>
+void WriteArgument(std::ostream* out, T* value) {
+  *out << static_cast<const void*>(value);
+}
+// Output buffers are not initialized yet, so only write their address.
+void WriteArgument(std::ostream* out, GLchar* value) {
+  *out << static_cast<const void*>(value);
+}
+void WriteArgument(std::ostream* out, const GLchar* value) {
+  if (value) {
+    *out << '"' << value << '"';
+  } else {
+    *out << "NULL";
+  }
+}
+
+// Functions without arguments have nothing to write.
+void WriteArguments(std::ostream*) {}
+template <typename... Args>
+void WriteArguments(std::ostream* out, Args... args) {
+  bool first = true;
+  int unused[] = {0, (*out << (first ? "" : ", "), first = false,
+                      WriteArgument(out, args), 0)...};
+  (void)unused;
+}
+
+// Writes the |size| bytes at |data| in hexadecimal.
+void WriteBytes(std::ostream* out, const void* data, size_t size) {
+  if (!data) {
+    return;
+  }
+  const uint8_t* bytes = static_cast<const uint8_t*>(data);
+  *out << " bytes=" << std::hex << std::setfill('0');
+  for (size_t i = 0; i < size; ++i) {
+    *out << std::setw(2) << static_cast<int>(bytes[i]);
+  }
+  *out << std::dec << std::setfill(' ');
+}
+
+// Writes the |count| values at |values|.
+template <typename T>
+void WriteValues(std::ostream* out, const T* values, size_t count) {
+  if (!values) {
+    return;
+  }
+  *out << " values={";
+  for (size_t i = 0; i < count; ++i) {
+    *out << (i == 0 ? "" : ", ") << +values[i];
+  }
+  *out << "}";
+}
+
+// The number of bytes that glTexImage2D() and glTexSubImage2D() read for an
+// image of the given size, format and type, or 0 if the format is not one
+// that the renderer uploads.
+size_t GetPixelDataSize(
+    GLsizei width, GLsizei height, GLenum format, GLenum type) {
+  size_t bytes_per_pixel = 0;
+  switch (type) {
+    case GL_UNSIGNED_BYTE: {
+      switch (format) {
+        case GL_RGBA: bytes_per_pixel = 4; break;
+        case GL_RGB: bytes_per_pixel = 3; break;
+        case GL_LUMINANCE_ALPHA: bytes_per_pixel = 2; break;
+        case GL_LUMINANCE:
+        case GL_ALPHA: bytes_per_pixel = 1; break;
+        default: return 0;
+      }
+    } break;
+    case GL_UNSIGNED_SHORT_5_6_5:
+    case GL_UNSIGNED_SHORT_4_4_4_4:
+    case GL_UNSIGNED_SHORT_5_5_5_1: bytes_per_pixel = 2; break;
+    default: return 0;
+  }
+  if (width <= 0 || height <= 0) {
+    return 0;
+  }
+
+  // Every row but the last is padded to the unpack alignment.  The state is
+  // queried directly so that the query itself is not recorded.
+  GLint alignment = 4;
+  ::glGetIntegerv(GL_UNPACK_ALIGNMENT, &alignment);
+  size_t row_size = width * bytes_per_pixel;
+  size_t stride = (row_size + alignment - 1) / alignment * alignment;
+  return stride * (height - 1) + row_size;
+}
+
+// Writes the data that a call's pointer arguments point to, for the
+// functions where its size is known from the other arguments.  Only the
+// address of pointer arguments is written for all other functions.
+template <GLFunction kIndex>
+struct RecordedData {
+  template <typename... Args>
+  static void Write(std::ostream*, Args...) {}
+};
+template <>
+struct RecordedData<kGLFunction_glBufferData> {
+  static void Write(std::ostream* out, GLenum, GLsizeiptr size,
+                    const void* data, GLenum) {
+    WriteBytes(out, data, size);
+  }
+};
+template <>
+struct RecordedData<kGLFunction_glBufferSubData> {
+  static void Write(std::ostream* out, GLenum, GLintptr, GLsizeiptr size,
+                    const void* data) {
+    WriteBytes(out, data, size);
+  }
+};
+template <>
+struct RecordedData<kGLFunction_glTexImage2D> {
+  static void Write(std::ostream* out, GLenum, GLint, GLint, GLsizei width,
+                    GLsizei height, GLint, GLenum format, GLenum type,
+                    const void* pixels) {
+    WriteBytes(out, pixels, GetPixelDataSize(width, height, format, type));
+  }
+};
+template <>
+struct RecordedData<kGLFunction_glTexSubImage2D> {
+  static void Write(std::ostream* out, GLenum, GLint, GLint, GLint,
+                    GLsizei width, GLsizei height, GLenum format, GLenum type,
+                    const void* pixels) {
+    WriteBytes(out, pixels, GetPixelDataSize(width, height, format, type));
+  }
+};
+template <>
+struct RecordedData<kGLFunction_glCompressedTexImage2D> {
+  static void Write(std::ostream* out, GLenum, GLint, GLenum, GLsizei,
+                    GLsizei, GLint, GLsizei image_size, const void* data) {
+    WriteBytes(out, data, image_size);
+  }
+};
+template <>
+struct RecordedData<kGLFunction_glShaderSource> {
+  static void Write(std::ostream* out, GLuint, GLsizei count,
+                    const GLchar* const* strings, const GLint* lengths) {
+    for (GLsizei i = 0; i < count; ++i) {
+      *out << " source=" << std::quoted(
+          lengths && lengths[i] >= 0 ? std::string(strings[i], lengths[i])
+                                     : std::string(strings[i]));
+    }
+  }
+};
+
+// The uniform functions that take |count| arrays of |kSize| floats.
+template <int kSize>
+struct RecordedUniformData {
+  static void Write(std::ostream* out, GLint, GLsizei count,
+                    const GLfloat* values) {
+    WriteValues(out, values, count * kSize);
+  }
+};
+template <>
+struct RecordedData<kGLFunction_glUniform1fv> : RecordedUniformData<1> {};
+template <>
+struct RecordedData<kGLFunction_glUniform2fv> : RecordedUniformData<2> {};
+template <>
+struct RecordedData<kGLFunction_glUniform3fv> : RecordedUniformData<3> {};
+template <>
+struct RecordedData<kGLFunction_glUniform4fv> : RecordedUniformData<4> {};
+template <>
+struct RecordedData<kGLFunction_glUniformMatrix4fv> {
+  static void Write(std::ostream* out, GLint, GLsizei count, GLboolean,
+                    const GLfloat* values) {
+    WriteValues(out, values, count * 16);
+  }
+};
+
+// The functions that delete |n| handles.
+struct RecordedDeletedHandles {
+  static void Write(std::ostream* out, GLsizei n, const GLuint* handles) {
+    WriteValues(out, handles, n);
+  }
+};
+template <>
+struct RecordedData<kGLFunction_glDeleteBuffers>
+    : RecordedDeletedHandles {};
+template <>
+struct RecordedData<kGLFunction_glDeleteFramebuffers>
+    : RecordedDeletedHandles {};
+template <>
+struct RecordedData<kGLFunction_glDeleteTextures>
+    : RecordedDeletedHandles {};
+template <>
+struct RecordedData<kGLFunction_glDeleteQueriesEXT>
+    : RecordedDeletedHandles {};
+template <>
+struct RecordedData<kGLFunction_glDeleteVertexArraysOES>
+    : RecordedDeletedHandles {};
+
+// Calls |function| and, for functions that return something, writes the
+// result to |out|.
+template <typename R>
+struct RecordedInvoke {
+  template <typename Function, typename... Args>
+  static R Call(std::ostream* out, Function function, Args... args) {
+    R result = function(args...);
+    *out << " = ";
+    WriteArgument(out, result);
+    return result;
+  }
+};
+template <>
+struct RecordedInvoke<void> {
+  template <typename Function, typename... Args>
+  static void Call(std::ostream*, Function function, Args... args) {
+    function(args...);
+  }
+};
+
+// Instantiated once for each GL function to provide a wrapper for each mode,
+// all of which have the exact signature of the wrapped function.
+template <typename Function, Function kFunction, GLFunction kIndex>
+struct Wrappers;
+
+template <typename R, typename... Args, R (GL_APIENTRY* kFunction)(Args...),
+          GLFunction kIndex>
+struct Wrappers<R (GL_APIENTRY*)(Args...), kFunction, kIndex> {
+  static R GL_APIENTRY Checked(Args... args) {
+    ScopedErrorCheck error_check(kIndex);
+    return kFunction(args...);
+  }
+
+  static R GL_APIENTRY Counting(Args... args) {
+    g_call_counts[kIndex].fetch_add(1, std::memory_order_relaxed);
+    return kFunction(args...);
+  }
+
+  static R GL_APIENTRY Recording(Args... args) {
+    // The call is made while the lock is held so that the recorded order
+    // matches the order in which the calls were made.
+    std::lock_guard<std::mutex> lock(g_recording_mutex);
+    std::ostream* out = &g_recording_stream;
+    *out << GLFunctionName(kIndex) << "(";
+    WriteArguments(out, args...);
+    *out << ")";
+    RecordedData<kIndex>::Write(out, args...);
+    struct EndLine {
+      std::ostream* out;
+      ~EndLine() { *out << "\n"; }
+    } end_line{out};
+    return RecordedInvoke<R>::Call(out, kFunction, args...);
+  }
+};
+
+// Provides a function with a fixed address that calls the extension function
+// loaded into |*kPointer|, so that the Wrappers above apply to extension
+// functions as well.
+template <typename Function, Function* kPointer>
+struct LoadedFunction;
+
+template <typename R, typename... Args, R (GL_APIENTRY** kPointer)(Args...)>
+struct LoadedFunction<R (GL_APIENTRY*)(Args...), kPointer> {
+  static R GL_APIENTRY Call(Args... args) {
+    return (*kPointer)(args...);
+  }
+};
+
+struct DispatchState {
+  GLDispatchMode mode;
+  // Whether to write the counts to stderr in counting mode.
+  bool report_counts;
+  GLDispatch dispatch;
+};
+
+DispatchState MakeDispatchState() {
+  DispatchState state;
+  state.mode = GetModeFromEnvironment();
+  state.report_counts = std::getenv("ENTIFY_GL_REPORT_COUNTS") != nullptr;
+
+#define ENTIFY_GL_LOAD_EXTENSION(name, type) \
+  g_##name = reinterpret_cast<type>(eglGetProcAddress(#name));
+  ENTIFY_GL_EXTENSION_FUNCTIONS(ENTIFY_GL_LOAD_EXTENSION)
+#undef ENTIFY_GL_LOAD_EXTENSION
+
+  switch (state.mode) {
+    case kGLDispatchModeDirect: {
+#define ENTIFY_GL_DIRECT(name) state.dispatch.name = &::name;
+#define ENTIFY_GL_EXTENSION_DIRECT(name, type) state.dispatch.name = g_##name;
+      ENTIFY_GL_FUNCTIONS(ENTIFY_GL_DIRECT)
+      ENTIFY_GL_EXTENSION_FUNCTIONS(ENTIFY_GL_EXTENSION_DIRECT)
+#undef ENTIFY_GL_EXTENSION_DIRECT
+#undef ENTIFY_GL_DIRECT
+    } break;
+    case kGLDispatchModeChecked: {
+#define ENTIFY_GL_CHECKED(name) \
+      state.dispatch.name = &Wrappers< \
+          decltype(&::name), &::name, kGLFunction_##name>::Checked;
+#define ENTIFY_GL_EXTENSION_CHECKED(name, type) \
+      state.dispatch.name = g_##name ? &Wrappers< \
+          type, &LoadedFunction<type, &g_##name>::Call, \
+          kGLFunction_##name>::Checked : nullptr;
+      ENTIFY_GL_FUNCTIONS(ENTIFY_GL_CHECKED)
+      ENTIFY_GL_EXTENSION_FUNCTIONS(ENTIFY_GL_EXTENSION_CHECKED)
+#undef ENTIFY_GL_EXTENSION_CHECKED
+#undef ENTIFY_GL_CHECKED
+    } break;
+    case kGLDispatchModeCounting: {
+#define ENTIFY_GL_COUNTING(name) \
+      state.dispatch.name = &Wrappers< \
+          decltype(&::name), &::name, kGLFunction_##name>::Counting;
+#define ENTIFY_GL_EXTENSION_COUNTING(name, type) \
+      state.dispatch.name = g_##name ? &Wrappers< \
+          type, &LoadedFunction<type, &g_##name>::Call, \
+          kGLFunction_##name>::Counting : nullptr;
+      ENTIFY_GL_FUNCTIONS(ENTIFY_GL_COUNTING)
+      ENTIFY_GL_EXTENSION_FUNCTIONS(ENTIFY_GL_EXTENSION_COUNTING)
+#undef ENTIFY_GL_EXTENSION_COUNTING
+#undef ENTIFY_GL_COUNTING
+    } break;
+    case kGLDispatchModeRecording: {
+      const char* path = std::getenv("ENTIFY_GL_RECORDING_PATH");
+      g_recording_stream.open(path ? path : "entify_gl_calls.txt");
+      assert(g_recording_stream.good());
+#define ENTIFY_GL_RECORDING(name) \
+      state.dispatch.name = &Wrappers< \
+          decltype(&::name), &::name, kGLFunction_##name>::Recording;
+#define ENTIFY_GL_EXTENSION_RECORDING(name, type) \
+      state.dispatch.name = g_##name ? &Wrappers< \
+          type, &LoadedFunction<type, &g_##name>::Call, \
+          kGLFunction_##name>::Recording : nullptr;
+      ENTIFY_GL_FUNCTIONS(ENTIFY_GL_RECORDING)
+      ENTIFY_GL_EXTENSION_FUNCTIONS(ENTIFY_GL_EXTENSION_RECORDING)
+#undef ENTIFY_GL_EXTENSION_RECORDING
+#undef ENTIFY_GL_RECORDING
+    } break;
+  }
+
+  return state;
+}
+
+DispatchState& GetDispatchState() {
+  static DispatchState state = MakeDispatchState();
+  return state;
+}
+
+void ReportCallCounts(int frame_number, const std::vector<uint32_t>& counts) {
+  std::cerr << "GL calls in frame " << frame_number << ":";
+  for (int i = 0; i < kNumGLFunctions; ++i) {
+    if (counts[i] > 0) {
+      std::cerr << " " << kGLFunctionNames[i] << "=" << counts[i];
+    }
+  }
+  std::cerr << std::endl;
+}
+
+}  // namespace
+
+const char* GLFunctionName(GLFunction function) {
+  assert(function >= 0 && function < kNumGLFunctions);
+  return kGLFunctionNames[function];
+}
+
+const GLDispatch& GetGLDispatch() {
+  return GetDispatchState().dispatch;
+}
+
+GLDispatchMode GetGLDispatchMode() {
+  return GetDispatchState().mode;
+}
+
+void SetGLDispatchForTesting(const GLDispatch& dispatch) {
+  GetDispatchState().dispatch = dispatch;
+}
+
+void GLDispatchEndFrame() {
+  int frame_number = g_frame_number.fetch_add(1);
+
+  switch (GetGLDispatchMode()) {
+    case kGLDispatchModeCounting: {
+      std::lock_guard<std::mutex> lock(g_last_frame_mutex);
+      for (int i = 0; i < kNumGLFunctions; ++i) {
+        g_last_frame_call_counts[i] =
+            g_call_counts[i].exchange(0, std::memory_order_relaxed);
+      }
+      if (GetDispatchState().report_counts &&
+          frame_number % kCountingReportInterval == 0) {
+        ReportCallCounts(frame_number, g_last_frame_call_counts);
+      }
+    } break;
+    case kGLDispatchModeRecording: {
+      std::lock_guard<std::mutex> lock(g_recording_mutex);
+      g_recording_stream << "# end of frame " << frame_number << "\n";
+      g_recording_stream.flush();
+    } break;
+    default: break;
+  }
+}
+
+std::vector<uint32_t> GetGLCallCountsForLastFrame() {
+  std::lock_guard<std::mutex> lock(g_last_frame_mutex);
+  return g_last_frame_call_counts;
+}
+
+}  // namespace gles2
+}  // namespace renderer
+}  // namespace entify
@@ -0,0 +1,156 @@
+#ifndef _SRC_ENTIFY_RENDERER_GLES2_GL_DISPATCH_H_
+#define _SRC_ENTIFY_RENDERER_GLES2_GL_DISPATCH_H_
+
+#include <cstdint>
+#include <vector>
+
+#include <GLES2/gl2.h>
+#include <GLES2/gl2ext.h>
+
+// All GL functions called by the renderer.  A function must be listed here
+// in order to be called through GL_CALL().
+#define ENTIFY_GL_FUNCTIONS(X) \
+  X(glActiveTexture) \
+  X(glAttachShader) \
+  X(glBindBuffer) \
+  X(glBindFramebuffer) \
+  X(glBindTexture) \
+  X(glBlendFuncSeparate) \
+  X(glBufferData) \
+  X(glBufferSubData) \
+  X(glCheckFramebufferStatus) \
+  X(glClear) \
+  X(glClearColor) \
+  X(glCompileShader) \
+  X(glCompressedTexImage2D) \
+  X(glCreateProgram) \
+  X(glCreateShader) \
+  X(glDeleteBuffers) \
+  X(glDeleteFramebuffers) \
+  X(glDeleteProgram) \
+  X(glDeleteShader) \
+  X(glDeleteTextures) \
+  X(glDetachShader) \
+  X(glDisable) \
+  X(glDrawArrays) \
+  X(glDrawElements) \
+  X(glEnable) \
+  X(glEnableVertexAttribArray) \
+  X(glFinish) \
+  X(glFlush) \
+  X(glFramebufferTexture2D) \
+  X(glGenBuffers) \
+  X(glGenFramebuffers) \
+  X(glGenTextures) \
+  X(glGenerateMipmap) \
+  X(glGetAttribLocation) \
+  X(glGetIntegerv) \
+  X(glGetProgramInfoLog) \
+  X(glGetProgramiv) \
+  X(glGetShaderInfoLog) \
+  X(glGetShaderiv) \
+  X(glGetString) \
+  X(glGetUniformLocation) \
+  X(glLinkProgram) \
+  X(glPixelStorei) \
+  X(glScissor) \
+  X(glShaderSource) \
+  X(glTexImage2D) \
+  X(glTexParameteri) \
+  X(glTexSubImage2D) \
+  X(glUniform1fv) \
+  X(glUniform1i) \
+  X(glUniform2fv) \
+  X(glUniform3fv) \
+  X(glUniform4fv) \
+  X(glUniformMatrix4fv) \
+  X(glUseProgram) \
+  X(glVertexAttribPointer) \
+  X(glViewport)
+
+// Extension functions called by the renderer, along with their types.  These
+// are loaded through eglGetProcAddress(), and their GLDispatch members are
+// null if the implementation does not provide them.
+#define ENTIFY_GL_EXTENSION_FUNCTIONS(X) \
+  X(glBeginQueryEXT, PFNGLBEGINQUERYEXTPROC) \
+  X(glBindVertexArrayOES, PFNGLBINDVERTEXARRAYOESPROC) \
+  X(glDeleteQueriesEXT, PFNGLDELETEQUERIESEXTPROC) \
+  X(glDeleteVertexArraysOES, PFNGLDELETEVERTEXARRAYSOESPROC) \
+  X(glEndQueryEXT, PFNGLENDQUERYEXTPROC) \
+  X(glGenQueriesEXT, PFNGLGENQUERIESEXTPROC) \
+  X(glGenVertexArraysOES, PFNGLGENVERTEXARRAYSOESPROC) \
+  X(glGetQueryObjectui64vEXT, PFNGLGETQUERYOBJECTUI64VEXTPROC) \
+  X(glGetQueryObjectuivEXT, PFNGLGETQUERYOBJECTUIVEXTPROC)
+
+namespace entify {
+namespace renderer {
+namespace gles2 {
+
+enum GLFunction {
+#define ENTIFY_GL_FUNCTION_ENUM(name) kGLFunction_##name,
+#define ENTIFY_GL_EXTENSION_FUNCTION_ENUM(name, type) kGLFunction_##name,
+  ENTIFY_GL_FUNCTIONS(ENTIFY_GL_FUNCTION_ENUM)
+  ENTIFY_GL_EXTENSION_FUNCTIONS(ENTIFY_GL_EXTENSION_FUNCTION_ENUM)
+#undef ENTIFY_GL_EXTENSION_FUNCTION_ENUM
+#undef ENTIFY_GL_FUNCTION_ENUM
+  kNumGLFunctions,
+};
+
+const char* GLFunctionName(GLFunction function);
+
+// A table of GL entry points.  The members are named after the GL functions
+// they stand in for so that GL_CALL(glFoo(...)) can simply expand to
+// GetGLDispatch().glFoo(...).
+struct GLDispatch {
+#define ENTIFY_GL_DISPATCH_MEMBER(name) decltype(&::name) name;
+#define ENTIFY_GL_EXTENSION_DISPATCH_MEMBER(name, type) type name;
+  ENTIFY_GL_FUNCTIONS(ENTIFY_GL_DISPATCH_MEMBER)
+  ENTIFY_GL_EXTENSION_FUNCTIONS(ENTIFY_GL_EXTENSION_DISPATCH_MEMBER)
+#undef ENTIFY_GL_EXTENSION_DISPATCH_MEMBER
+#undef ENTIFY_GL_DISPATCH_MEMBER
+};
+
+enum GLDispatchMode {
+  // Calls straight into GL.
+  kGLDispatchModeDirect,
+  // Checks glGetError() after each call and asserts that there was no error.
+  kGLDispatchModeChecked,
+  // Counts the calls made to each function during each frame.
+  kGLDispatchModeCounting,
+  // Writes each call and its arguments to a file, along with the data that
+  // pointer arguments point to whenever its size is known from the other
+  // arguments (buffer and texture uploads, uniform values and the handles
+  // being deleted).
+  kGLDispatchModeRecording,
+};
+
+// The mode is chosen once, the first time the dispatch table is used, from
+// the ENTIFY_GL_DISPATCH environment variable ("direct", "checked",
+// "counting" or "recording").  It defaults to checked in debug builds and
+// direct otherwise.  In counting mode the counts are also written to stderr
+// every 60 frames if ENTIFY_GL_REPORT_COUNTS is set.  In recording mode the
+// calls are written to the file named by ENTIFY_GL_RECORDING_PATH, or
+// "entify_gl_calls.txt".
+const GLDispatch& GetGLDispatch();
+GLDispatchMode GetGLDispatchMode();
+
+// Replaces the functions that GL_CALL() calls, e.g. with fakes so that code
+// that makes GL calls can be tested without a context.  The mode is left as
+// it is.  Must not be called while GL calls are being made.
+void SetGLDispatchForTesting(const GLDispatch& dispatch);
+
+// Marks the end of a frame.  In counting mode this makes the current counts
+// available through GetGLCallCountsForLastFrame() and starts counting anew.
+// In recording mode this writes a frame marker.
+void GLDispatchEndFrame();
+
+// Returns the number of calls made to each function during the last
+// completed frame, indexed by GLFunction.  All zero unless in counting mode.
+// These are reported through EntifyFrameStats and EntifyGetGLCallCounts().
+std::vector<uint32_t> GetGLCallCountsForLastFrame();
+
+}  // namespace gles2
+}  // namespace renderer
+}  // namespace entify
+
+#endif  // _SRC_ENTIFY_RENDERER_GLES2_GL_DISPATCH_H_
@@ -0,0 +1,188 @@
+#include "src/renderer/gles2/gpu_timer.h"
+
+#include <cassert>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+#include <EGL/egl.h>
+
+#include "src/renderer/gles2/utils.h"
+
+namespace entify {
+namespace renderer {
+namespace gles2 {
+
+namespace {
+// Bounds the number of queries in flight, in case results stop becoming
+// available.  Passes are not timed while all queries are in use.
+const int kMaxQueries = 256;
+}  // namespace
+
+void GPUTimer::Initialize(const void* context) {
+  context_ = context;
+
+  const char* mode = std::getenv("ENTIFY_GPU_TIMING");
+  if (!mode) {
+    return;
+  }
+
+  if (strcmp(mode, "finish") == 0) {
+    mode_ = kModeFinish;
+  } else if (strcmp(mode, "query") == 0) {
+    if (!HasGLExtension("GL_EXT_disjoint_timer_query")) {
+      std::cerr << "GL_EXT_disjoint_timer_query is not supported, GPU timing "
+                << "is disabled." << std::endl;
+      return;
+    }
+
+    const GLDispatch& dispatch = GetGLDispatch();
+    if (!dispatch.glGenQueriesEXT || !dispatch.glDeleteQueriesEXT ||
+        !dispatch.glBeginQueryEXT || !dispatch.glEndQueryEXT ||
+        !dispatch.glGetQueryObjectuivEXT ||
+        !dispatch.glGetQueryObjectui64vEXT) {
+      std::cerr << "GL_EXT_disjoint_timer_query functions are missing, GPU "
+                << "timing is disabled." << std::endl;
+      return;
+    }
+
+    mode_ = kModeQuery;
+  } else if (strcmp(mode, "off") != 0) {
+    std::cerr << "Unknown ENTIFY_GPU_TIMING mode '" << mode << "'."
+              << std::endl;
+  }
+}
+
+bool GPUTimer::IsOwningContextCurrent() const {
+  return eglGetCurrentContext() == context_;
+}
+
+bool GPUTimer::Begin(EntifyGPUTimingType type, EntifyId id) {
+  if (mode_ == kModeDisabled || active_ || !IsOwningContextCurrent()) {
+    return false;
+  }
+
+  switch (mode_) {
+    case kModeQuery: {
+      if (free_queries_.empty()) {
+        if (num_queries_ >= kMaxQueries) {
+          return false;
+        }
+        GLuint query;
+        GL_CALL(glGenQueriesEXT(1, &query));
+        free_queries_.push_back(query);
+        ++num_queries_;
+      }
+      active_query_ = free_queries_.back();
+      free_queries_.pop_back();
+      GL_CALL(glBeginQueryEXT(GL_TIME_ELAPSED_EXT, active_query_));
+    } break;
+    case kModeFinish: {
+      GL_CALL(glFinish());
+      finish_start_ = std::chrono::steady_clock::now();
+    } break;
+    default: {
+      assert(false);
+    } break;
+  }
+
+  active_ = true;
+  active_timing_ = GPUTiming{frame_number_, type, id, 0.0};
+  return true;
+}
+
+void GPUTimer::End() {
+  assert(active_);
+  active_ = false;
+
+  switch (mode_) {
+    case kModeQuery: {
+      GL_CALL(glEndQueryEXT(GL_TIME_ELAPSED_EXT));
+      pending_queries_.push_back(
+          PendingQuery{active_query_, active_timing_, false});
+    } break;
+    case kModeFinish: {
+      GL_CALL(glFinish());
+      active_timing_.gpu_ms = std::chrono::duration<double, std::milli>(
+          std::chrono::steady_clock::now() - finish_start_).count();
+      finished_timings_.push_back(active_timing_);
+    } break;
+    default: {
+      assert(false);
+    } break;
+  }
+}
+
+void GPUTimer::EndFrame(std::vector<GPUTiming>* timings) {
+  assert(!active_);
+  ++frame_number_;
+
+  if (mode_ == kModeFinish) {
+    timings->insert(timings->end(), finished_timings_.begin(),
+                    finished_timings_.end());
+    finished_timings_.clear();
+    return;
+  }
+  // The results are read back once the owning context is current again.
+  if (mode_ != kModeQuery || !IsOwningContextCurrent()) {
+    return;
+  }
+
+  // A disjoint operation (e.g. a GPU frequency change) makes the results of
+  // the queries in flight meaningless, so they are dropped.
+  GLint disjoint = GL_FALSE;
+  GL_CALL(glGetIntegerv(GL_GPU_DISJOINT_EXT, &disjoint));
+  if (disjoint) {
+    for (PendingQuery& pending_query : pending_queries_) {
+      pending_query.discard = true;
+    }
+  }
+
+  // Queries complete in the order they were issued, so stop at the first
+  // one that is not available yet.
+  size_t num_available = 0;
+  for (const PendingQuery& pending_query : pending_queries_) {
+    GLuint available = GL_FALSE;
+    GL_CALL(glGetQueryObjectuivEXT(
+        pending_query.query, GL_QUERY_RESULT_AVAILABLE_EXT, &available));
+    if (!available) {
+      break;
+    }
+    ++num_available;
+  }
+
+  for (size_t i = 0; i < num_available; ++i) {
+    PendingQuery& pending_query = pending_queries_.front();
+    if (!pending_query.discard) {
+      GLuint64 elapsed_ns = 0;
+      GL_CALL(glGetQueryObjectui64vEXT(
+          pending_query.query, GL_QUERY_RESULT_EXT, &elapsed_ns));
+      pending_query.timing.gpu_ms = elapsed_ns / 1.0e6;
+      timings->push_back(pending_query.timing);
+    }
+    free_queries_.push_back(pending_query.query);
+    pending_queries_.pop_front();
+  }
+}
+
+void GPUTimer::Shutdown() {
+  assert(!active_);
+  // Otherwise they go away with the context.
+  if (mode_ != kModeQuery || !IsOwningContextCurrent()) {
+    return;
+  }
+
+  for (const PendingQuery& pending_query : pending_queries_) {
+    free_queries_.push_back(pending_query.query);
+  }
+  pending_queries_.clear();
+  if (!free_queries_.empty()) {
+    GL_CALL(glDeleteQueriesEXT(free_queries_.size(), free_queries_.data()));
+  }
+  free_queries_.clear();
+  num_queries_ = 0;
+}
+
+}  // namespace gles2
+}  // namespace renderer
+}  // namespace entify
@@ -0,0 +1,99 @@
+#ifndef _SRC_ENTIFY_RENDERER_GLES2_GPU_TIMER_H_
+#define _SRC_ENTIFY_RENDERER_GLES2_GPU_TIMER_H_
+
+#include <chrono>
+#include <deque>
+#include <vector>
+
+#include <GLES2/gl2.h>
+#include <GLES2/gl2ext.h>
+
+#include "src/renderer/gpu_timing.h"
+
+namespace entify {
+namespace renderer {
+namespace gles2 {
+
+// Measures the GPU time of individual passes, as configured by the
+// ENTIFY_GPU_TIMING environment variable (see EntifyGetGPUTimings()).  Query
+// objects are not shared between contexts, so only passes rendered with the
+// backend's own context are timed.  All methods must be called with a
+// context current.
+class GPUTimer {
+ public:
+  // Reads the mode and enables timing for |context|, the EGLContext that is
+  // current.
+  void Initialize(const void* context);
+
+  // Starts timing the work done for the node |id|.  Timed scopes do not
+  // nest, so if a scope is already being timed, timing is disabled or
+  // another context is current, this returns false and End() must not be
+  // called.
+  bool Begin(EntifyGPUTimingType type, EntifyId id);
+  void End();
+
+  // Appends the timings whose results have become available to |timings|
+  // and starts a new frame.  Called once per frame, after the swap.
+  void EndFrame(std::vector<GPUTiming>* timings);
+
+  // Deletes the query objects.
+  void Shutdown();
+
+ private:
+  enum Mode {
+    kModeDisabled,
+    kModeQuery,
+    kModeFinish,
+  };
+
+  struct PendingQuery {
+    GLuint query;
+    GPUTiming timing;
+    // Set if a disjoint operation happened while the query was in flight.
+    bool discard;
+  };
+
+  bool IsOwningContextCurrent() const;
+
+  const void* context_ = nullptr;
+  Mode mode_ = kModeDisabled;
+  int64_t frame_number_ = 0;
+
+  bool active_ = false;
+  GPUTiming active_timing_;
+
+  // Used in kModeQuery.
+  GLuint active_query_ = 0;
+  std::vector<GLuint> free_queries_;
+  // Queries that have ended but whose results were not read back yet,
+  // oldest first.
+  std::deque<PendingQuery> pending_queries_;
+  int num_queries_ = 0;
+
+  // Used in kModeFinish.
+  std::chrono::steady_clock::time_point finish_start_;
+  std::vector<GPUTiming> finished_timings_;
+};
+
+// Times the work done during the lifetime of the object, if |gpu_timer|
+// is not already timing something.
+class ScopedGPUTimer {
+ public:
+  ScopedGPUTimer(GPUTimer* gpu_timer, EntifyGPUTimingType type, EntifyId id)
+      : gpu_timer_(gpu_timer), timed_(gpu_timer->Begin(type, id)) {}
+  ~ScopedGPUTimer() {
+    if (timed_) {
+      gpu_timer_->End();
+    }
+  }
+
+ private:
+  GPUTimer* gpu_timer_;
+  bool timed_;
+};
+
+}  // namespace gles2
+}  // namespace renderer
+}  // namespace entify
+
+#endif  // _SRC_ENTIFY_RENDERER_GLES2_GPU_TIMER_H_
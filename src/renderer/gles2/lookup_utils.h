@@ -20,11 +20,14 @@ std::shared_ptr<T> ExternalReferenceToRenderTree(
 template <typename T>
 std::shared_ptr<T> LookupNode(
     const ExternalReferenceLookup& reference_lookup, EntifyId id) {
-  auto entry_found = reference_lookup.find(id);
-  if (entry_found == reference_lookup.end()) {
-    return nullptr;
-  }
-  return ExternalReferenceToRenderTree<T>(*entry_found->second);
+  // The object is copied out while the lookup entry is locked, so the
+  // returned reference keeps it alive even if it is garbage collected
+  // concurrently.
+  std::shared_ptr<T> node;
+  reference_lookup.Visit(id, [&node](const ExternalReference& reference) {
+    node = ExternalReferenceToRenderTree<T>(reference);
+  });
+  return node;
 }
 
 }  // namespace gles2
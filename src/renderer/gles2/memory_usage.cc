@@ -0,0 +1,252 @@
+#include "src/renderer/gles2/memory_usage.h"
+
+#include <cassert>
+
+#include "src/renderer/gles2/lookup_utils.h"
+#include "src/renderer/gles2/render_tree/draw_call.h"
+#include "src/renderer/gles2/render_tree/draw_sequence.h"
+#include "src/renderer/gles2/render_tree/draw_template.h"
+#include "src/renderer/gles2/render_tree/fragment_shader.h"
+#include "src/renderer/gles2/render_tree/index_buffer.h"
+#include "src/renderer/gles2/render_tree/pipeline.h"
+#include "src/renderer/gles2/render_tree/program.h"
+#include "src/renderer/gles2/render_tree/sampler.h"
+#include "src/renderer/gles2/render_tree/texture.h"
+#include "src/renderer/gles2/render_tree/uniform_values.h"
+#include "src/renderer/gles2/render_tree/vertex_buffer.h"
+#include "src/renderer/gles2/render_tree/vertex_shader.h"
+
+namespace entify {
+namespace renderer {
+namespace gles2 {
+
+namespace {
+template <typename T>
+int64_t VectorBytes(const std::vector<T>& vector) {
+  return vector.capacity() * sizeof(T);
+}
+
+NodeMemoryUsage MakeNodeMemoryUsage(
+    EntifyNodeType node_type, int64_t cpu_bytes, int64_t gpu_bytes) {
+  NodeMemoryUsage usage;
+  usage.node_type = node_type;
+  usage.cpu_bytes = cpu_bytes;
+  usage.gpu_bytes = gpu_bytes;
+  return usage;
+}
+
+NodeMemoryUsage EstimateVertexBuffer(
+    const render_tree::VertexBuffer& vertex_buffer) {
+  // Transient data only occupies the stream buffer while it is drawn.
+  int64_t gpu_bytes = vertex_buffer.transient() ? 0 :
+      static_cast<int64_t>(vertex_buffer.num_vertices()) *
+          vertex_buffer.stride_in_bytes();
+  if (const auto& index_buffer = vertex_buffer.welded_index_buffer()) {
+    gpu_bytes += index_buffer->size_in_bytes();
+  }
+
+  return MakeNodeMemoryUsage(
+      kEntifyNodeTypeVertexBuffer,
+      // The layout is shared with other vertex buffers.
+      sizeof(vertex_buffer) + VectorBytes(vertex_buffer.data()),
+      gpu_bytes);
+}
+
+NodeMemoryUsage EstimateIndexBuffer(
+    const render_tree::IndexBuffer& index_buffer) {
+  return MakeNodeMemoryUsage(
+      kEntifyNodeTypeIndexBuffer, sizeof(index_buffer),
+      index_buffer.size_in_bytes());
+}
+
+NodeMemoryUsage EstimateUniformValues(
+    const render_tree::UniformValues& uniform_values) {
+  return MakeNodeMemoryUsage(
+      kEntifyNodeTypeUniformValues,
+      sizeof(uniform_values) + VectorBytes(uniform_values.types()) +
+          VectorBytes(uniform_values.data()) +
+          VectorBytes(uniform_values.samplers()),
+      0);
+}
+
+// The size of compiled shaders and linked programs is not observable through
+// GLES2, so only their CPU side is accounted for.
+NodeMemoryUsage EstimateVertexShader(
+    const render_tree::VertexShader& vertex_shader) {
+  int64_t cpu_bytes = sizeof(vertex_shader) +
+                      VectorBytes(vertex_shader.input_types()) +
+                      VectorBytes(vertex_shader.output_types()) +
+                      VectorBytes(vertex_shader.uniform_types());
+  for (const auto& name : vertex_shader.vertex_attribute_names()) {
+    cpu_bytes += sizeof(name) + name.capacity();
+  }
+  for (const auto& name : vertex_shader.uniform_names()) {
+    cpu_bytes += sizeof(name) + name.capacity();
+  }
+  return MakeNodeMemoryUsage(kEntifyNodeTypeVertexShader, cpu_bytes, 0);
+}
+
+NodeMemoryUsage EstimateFragmentShader(
+    const render_tree::FragmentShader& fragment_shader) {
+  int64_t cpu_bytes = sizeof(fragment_shader) +
+                      VectorBytes(fragment_shader.input_types()) +
+                      VectorBytes(fragment_shader.uniform_types());
+  for (const auto& name : fragment_shader.uniform_names()) {
+    cpu_bytes += sizeof(name) + name.capacity();
+  }
+  return MakeNodeMemoryUsage(kEntifyNodeTypeFragmentShader, cpu_bytes, 0);
+}
+
+NodeMemoryUsage EstimatePipeline(const render_tree::Pipeline& pipeline) {
+  const render_tree::Program& program = *pipeline.program();
+  return MakeNodeMemoryUsage(
+      kEntifyNodeTypePipeline,
+      sizeof(pipeline) + sizeof(program) +
+          VectorBytes(program.vertex_attribute_indices()) +
+          VectorBytes(program.vertex_uniform_locations()) +
+          VectorBytes(program.fragment_uniform_locations()),
+      0);
+}
+
+NodeMemoryUsage EstimateDrawTree(const render_tree::DrawTree& draw_tree) {
+  switch (draw_tree.type()) {
+    case render_tree::DrawTree::kTypeDrawCall: {
+      return MakeNodeMemoryUsage(
+          kEntifyNodeTypeDrawTree, sizeof(render_tree::DrawCall), 0);
+    } break;
+    case render_tree::DrawTree::kTypeDrawSequence: {
+      const auto& draw_sequence =
+          static_cast<const render_tree::DrawSequence&>(draw_tree);
+      return MakeNodeMemoryUsage(
+          kEntifyNodeTypeDrawTree,
+          sizeof(draw_sequence) + VectorBytes(draw_sequence.sequence()) +
+              (draw_sequence.cached_draw_calls()
+                   ? VectorBytes(*draw_sequence.cached_draw_calls())
+                   : 0) +
+              VectorBytes(draw_sequence.child_draw_call_counts()),
+          0);
+    } break;
+    case render_tree::DrawTree::kTypeDrawSet: {
+      assert(false);  // Not implemented.
+    } break;
+    case render_tree::DrawTree::kTypeDrawTemplate: {
+      const auto& draw_template =
+          static_cast<const render_tree::DrawTemplate&>(draw_tree);
+      int64_t cpu_bytes = sizeof(draw_template) +
+                          VectorBytes(draw_template.draw_calls()) +
+                          VectorBytes(draw_template.parameters()) +
+                          VectorBytes(draw_template.bound_uniform_values());
+      for (const auto& bound : draw_template.bound_uniform_values()) {
+        cpu_bytes += VectorBytes(bound.draw_call_indices);
+      }
+      return MakeNodeMemoryUsage(kEntifyNodeTypeDrawTree, cpu_bytes, 0);
+    } break;
+    case render_tree::DrawTree::kTypeDrawTemplateInstance: {
+      const auto& instance =
+          static_cast<const render_tree::DrawTemplateInstance&>(draw_tree);
+      int64_t cpu_bytes = sizeof(instance) +
+                          VectorBytes(instance.draw_calls()) +
+                          VectorBytes(instance.uniform_values()) +
+                          VectorBytes(instance.patched_draw_calls()) +
+                          instance.patched_draw_calls().size() *
+                              sizeof(render_tree::DrawCall);
+      for (const auto& uniform_values : instance.uniform_values()) {
+        cpu_bytes += sizeof(*uniform_values) +
+                     VectorBytes(uniform_values->types()) +
+                     VectorBytes(uniform_values->data()) +
+                     VectorBytes(uniform_values->samplers());
+      }
+      return MakeNodeMemoryUsage(kEntifyNodeTypeDrawTree, cpu_bytes, 0);
+    } break;
+  }
+
+  assert(false);
+  return NodeMemoryUsage();
+}
+
+NodeMemoryUsage EstimateSampler(const render_tree::Sampler& sampler) {
+  return MakeNodeMemoryUsage(kEntifyNodeTypeSampler, sizeof(sampler), 0);
+}
+
+// A full chain of mipmaps adds a third to the size of the image.
+int64_t AddMipmapBytes(const render_tree::Texture& texture,
+                       int64_t image_bytes) {
+  return texture.has_mipmaps() ? image_bytes + image_bytes / 3 : image_bytes;
+}
+
+NodeMemoryUsage EstimateTexture(const render_tree::Texture& texture) {
+  int64_t num_pixels =
+      static_cast<int64_t>(texture.width_in_pixels()) *
+      texture.height_in_pixels();
+
+  if (auto pixel_data =
+          dynamic_cast<const render_tree::PixelData*>(&texture)) {
+    // The pixel data is only kept on the GPU once it has been uploaded,
+    // except by double buffered textures, which also keep a CPU copy,
+    // padded rows and all.  Atlased images count the size of their region
+    // of the page.
+    int64_t image_bytes = render_tree::PixelTypeImageSizeInBytes(
+        pixel_data->pixel_type(), pixel_data->width_in_pixels(),
+        pixel_data->height_in_pixels());
+    int64_t texture_bytes = AddMipmapBytes(texture, image_bytes);
+    if (pixel_data->double_buffered()) {
+      return MakeNodeMemoryUsage(
+          kEntifyNodeTypePixelData,
+          sizeof(*pixel_data) + pixel_data->shadow_size_in_bytes(),
+          2 * texture_bytes);
+    }
+    return MakeNodeMemoryUsage(
+        kEntifyNodeTypePixelData, sizeof(*pixel_data), texture_bytes);
+  } else if (auto render_target =
+                 dynamic_cast<const render_tree::RenderTarget*>(&texture)) {
+    return MakeNodeMemoryUsage(
+        kEntifyNodeTypeRenderTarget, sizeof(*render_target),
+        AddMipmapBytes(texture,
+                       num_pixels * render_tree::PixelTypeBytesPerPixel(
+                                        render_target->pixel_type())));
+  }
+
+  assert(false);
+  return NodeMemoryUsage();
+}
+}  // namespace
+
+NodeMemoryUsage EstimateMemoryUsage(const ExternalReference& reference) {
+  stdext::TypeId type_id = reference.type_id();
+  if (type_id == stdext::GetTypeId<render_tree::VertexBuffer>()) {
+    return EstimateVertexBuffer(
+        *ExternalReferenceToRenderTree<render_tree::VertexBuffer>(reference));
+  } else if (type_id == stdext::GetTypeId<render_tree::IndexBuffer>()) {
+    return EstimateIndexBuffer(
+        *ExternalReferenceToRenderTree<render_tree::IndexBuffer>(reference));
+  } else if (type_id == stdext::GetTypeId<render_tree::UniformValues>()) {
+    return EstimateUniformValues(
+        *ExternalReferenceToRenderTree<render_tree::UniformValues>(reference));
+  } else if (type_id == stdext::GetTypeId<render_tree::VertexShader>()) {
+    return EstimateVertexShader(
+        *ExternalReferenceToRenderTree<render_tree::VertexShader>(reference));
+  } else if (type_id == stdext::GetTypeId<render_tree::FragmentShader>()) {
+    return EstimateFragmentShader(
+        *ExternalReferenceToRenderTree<render_tree::FragmentShader>(
+            reference));
+  } else if (type_id == stdext::GetTypeId<render_tree::Pipeline>()) {
+    return EstimatePipeline(
+        *ExternalReferenceToRenderTree<render_tree::Pipeline>(reference));
+  } else if (type_id == stdext::GetTypeId<render_tree::DrawTree>()) {
+    return EstimateDrawTree(
+        *ExternalReferenceToRenderTree<render_tree::DrawTree>(reference));
+  } else if (type_id == stdext::GetTypeId<render_tree::Sampler>()) {
+    return EstimateSampler(
+        *ExternalReferenceToRenderTree<render_tree::Sampler>(reference));
+  } else if (type_id == stdext::GetTypeId<render_tree::Texture>()) {
+    return EstimateTexture(
+        *ExternalReferenceToRenderTree<render_tree::Texture>(reference));
+  }
+
+  assert(false);
+  return NodeMemoryUsage();
+}
+
+}  // namespace gles2
+}  // namespace renderer
+}  // namespace entify
@@ -0,0 +1,19 @@
+#ifndef _SRC_ENTIFY_RENDERER_GLES2_MEMORY_USAGE_H_
+#define _SRC_ENTIFY_RENDERER_GLES2_MEMORY_USAGE_H_
+
+#include "src/external_reference.h"
+
+namespace entify {
+namespace renderer {
+namespace gles2 {
+
+// Estimates the CPU and GPU memory held by the render tree node referenced by
+// |reference|.  Memory held by the node's children is not included, since
+// they are accounted for as nodes of their own.
+NodeMemoryUsage EstimateMemoryUsage(const ExternalReference& reference);
+
+}  // namespace gles2
+}  // namespace renderer
+}  // namespace entify
+
+#endif  // _SRC_ENTIFY_RENDERER_GLES2_MEMORY_USAGE_H_
@@ -0,0 +1,207 @@
+#include "src/renderer/gles2/mesh_optimizer.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <string>
+#include <unordered_map>
+
+namespace entify {
+namespace renderer {
+namespace gles2 {
+
+namespace {
+// The modelled size of the post-transform vertex cache.  Real caches vary in
+// size and policy, but the ordering is not very sensitive to the exact size.
+const int kCacheSize = 32;
+
+// How desirable it is to use a vertex next, given its position in the
+// modelled LRU cache (-1 if it is not in it) and the number of triangles
+// that still use it.  The constants are the ones from Forsyth's paper.
+float VertexScore(int cache_position, int remaining_triangles) {
+  if (remaining_triangles == 0) {
+    return -1.0f;
+  }
+
+  float score = 0.0f;
+  if (cache_position >= 0) {
+    if (cache_position < 3) {
+      // The vertices of the last triangle get a fixed score, so that the
+      // next triangle does not simply reuse the same edge.
+      score = 0.75f;
+    } else {
+      score = std::pow(
+          1.0f - static_cast<float>(cache_position - 3) / (kCacheSize - 3),
+          1.5f);
+    }
+  }
+
+  // Favour vertices with few triangles left, so that they are finished off
+  // and do not need to be transformed again later.
+  score += 2.0f / std::sqrt(static_cast<float>(remaining_triangles));
+  return score;
+}
+}  // namespace
+
+void WeldVertices(const char* data, int32_t num_vertices,
+                  int32_t stride_in_bytes, std::vector<char>* unique_data,
+                  std::vector<uint32_t>* indices) {
+  std::unordered_map<std::string, uint32_t> unique_indices;
+  unique_indices.reserve(num_vertices);
+  unique_data->clear();
+  indices->clear();
+  indices->reserve(num_vertices);
+
+  for (int32_t i = 0; i < num_vertices; ++i) {
+    const char* vertex = data + i * stride_in_bytes;
+    auto inserted = unique_indices.emplace(
+        std::string(vertex, stride_in_bytes), unique_indices.size());
+    if (inserted.second) {
+      unique_data->insert(unique_data->end(), vertex,
+                          vertex + stride_in_bytes);
+    }
+    indices->push_back(inserted.first->second);
+  }
+}
+
+void OptimizeVertexCache(std::vector<uint32_t>* indices,
+                         int32_t num_vertices) {
+  if (indices->size() % 3 != 0 || indices->empty()) {
+    return;
+  }
+  const size_t num_triangles = indices->size() / 3;
+
+  // The triangles that use each vertex, as ranges into |adjacency|.  The
+  // ranges shrink as triangles are emitted.
+  std::vector<uint32_t> remaining(num_vertices, 0);
+  for (uint32_t index : *indices) {
+    assert(index < static_cast<uint32_t>(num_vertices));
+    ++remaining[index];
+  }
+  std::vector<uint32_t> adjacency_begin(num_vertices + 1, 0);
+  for (int32_t i = 0; i < num_vertices; ++i) {
+    adjacency_begin[i + 1] = adjacency_begin[i] + remaining[i];
+  }
+  std::vector<uint32_t> adjacency(indices->size());
+  {
+    std::vector<uint32_t> fill(adjacency_begin.begin(),
+                               adjacency_begin.end() - 1);
+    for (size_t i = 0; i < indices->size(); ++i) {
+      adjacency[fill[(*indices)[i]]++] = i / 3;
+    }
+  }
+
+  std::vector<int> cache_position(num_vertices, -1);
+  std::vector<float> vertex_score(num_vertices);
+  for (int32_t i = 0; i < num_vertices; ++i) {
+    vertex_score[i] = VertexScore(-1, remaining[i]);
+  }
+  std::vector<float> triangle_score(num_triangles);
+  std::vector<bool> emitted(num_triangles, false);
+  for (size_t i = 0; i < num_triangles; ++i) {
+    triangle_score[i] = vertex_score[(*indices)[i * 3]] +
+                        vertex_score[(*indices)[i * 3 + 1]] +
+                        vertex_score[(*indices)[i * 3 + 2]];
+  }
+
+  std::vector<uint32_t> output;
+  output.reserve(indices->size());
+  std::vector<uint32_t> cache;
+  std::vector<uint32_t> new_cache;
+  cache.reserve(kCacheSize + 3);
+  new_cache.reserve(kCacheSize + 3);
+
+  // Used to find a new starting triangle when none of the triangles around
+  // the cached vertices are left.
+  size_t next_unemitted = 0;
+  int64_t best_triangle = -1;
+  for (size_t emitted_count = 0; emitted_count < num_triangles;
+       ++emitted_count) {
+    if (best_triangle < 0) {
+      while (emitted[next_unemitted]) {
+        ++next_unemitted;
+      }
+      best_triangle = next_unemitted;
+    }
+
+    emitted[best_triangle] = true;
+    const uint32_t* triangle = indices->data() + best_triangle * 3;
+    new_cache.assign(triangle, triangle + 3);
+    for (int i = 0; i < 3; ++i) {
+      uint32_t vertex = triangle[i];
+      output.push_back(vertex);
+
+      // Remove the triangle from the vertex's adjacency.
+      uint32_t* begin = adjacency.data() + adjacency_begin[vertex];
+      uint32_t* end = begin + remaining[vertex];
+      *std::find(begin, end, static_cast<uint32_t>(best_triangle)) =
+          *(end - 1);
+      --remaining[vertex];
+    }
+    for (uint32_t vertex : cache) {
+      if (std::find(triangle, triangle + 3, vertex) == triangle + 3) {
+        new_cache.push_back(vertex);
+      }
+    }
+
+    // Rescore the vertices whose cache position changed, including the ones
+    // that just fell out of the cache, and the triangles around them.
+    for (size_t i = 0; i < new_cache.size(); ++i) {
+      uint32_t vertex = new_cache[i];
+      cache_position[vertex] =
+          i < static_cast<size_t>(kCacheSize) ? static_cast<int>(i) : -1;
+      float score = VertexScore(cache_position[vertex], remaining[vertex]);
+      float delta = score - vertex_score[vertex];
+      vertex_score[vertex] = score;
+      const uint32_t* begin = adjacency.data() + adjacency_begin[vertex];
+      for (const uint32_t* t = begin; t != begin + remaining[vertex]; ++t) {
+        triangle_score[*t] += delta;
+      }
+    }
+    if (new_cache.size() > static_cast<size_t>(kCacheSize)) {
+      new_cache.resize(kCacheSize);
+    }
+    cache.swap(new_cache);
+
+    // The next triangle is the best one that uses a cached vertex.
+    best_triangle = -1;
+    float best_score = -1.0f;
+    for (uint32_t vertex : cache) {
+      const uint32_t* begin = adjacency.data() + adjacency_begin[vertex];
+      for (const uint32_t* t = begin; t != begin + remaining[vertex]; ++t) {
+        if (triangle_score[*t] > best_score) {
+          best_score = triangle_score[*t];
+          best_triangle = *t;
+        }
+      }
+    }
+  }
+
+  indices->swap(output);
+}
+
+int32_t OptimizeVertexFetch(std::vector<uint32_t>* indices,
+                            std::vector<char>* data, int32_t stride_in_bytes) {
+  int32_t num_vertices = data->size() / stride_in_bytes;
+  const uint32_t kUnassigned = static_cast<uint32_t>(-1);
+  std::vector<uint32_t> remap(num_vertices, kUnassigned);
+  std::vector<char> reordered;
+  reordered.reserve(data->size());
+
+  uint32_t next_index = 0;
+  for (uint32_t& index : *indices) {
+    if (remap[index] == kUnassigned) {
+      remap[index] = next_index++;
+      const char* vertex = data->data() + index * stride_in_bytes;
+      reordered.insert(reordered.end(), vertex, vertex + stride_in_bytes);
+    }
+    index = remap[index];
+  }
+
+  data->swap(reordered);
+  return next_index;
+}
+
+}  // namespace gles2
+}  // namespace renderer
+}  // namespace entify
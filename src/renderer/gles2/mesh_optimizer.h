@@ -0,0 +1,40 @@
+#ifndef _SRC_ENTIFY_RENDERER_GLES2_MESH_OPTIMIZER_H_
+#define _SRC_ENTIFY_RENDERER_GLES2_MESH_OPTIMIZER_H_
+
+#include <cstdint>
+#include <vector>
+
+namespace entify {
+namespace renderer {
+namespace gles2 {
+
+// Ingest-time passes that make indexed geometry cheaper to draw.  They are
+// run once, when a node is created, and never while rendering.
+
+// Merges the bitwise identical vertices among the |num_vertices| vertices of
+// |stride_in_bytes| bytes each at |data|.  The distinct vertices are written
+// to |unique_data|, and |indices| receives, for each input vertex, the index
+// of its copy there.
+void WeldVertices(const char* data, int32_t num_vertices,
+                  int32_t stride_in_bytes, std::vector<char>* unique_data,
+                  std::vector<uint32_t>* indices);
+
+// Reorders the triangles of the triangle list |indices|, which refer to
+// |num_vertices| vertices, so that consecutive triangles tend to reuse
+// vertices that are still in the GPU's post-transform vertex cache.  This is
+// Tom Forsyth's "Linear-Speed Vertex Cache Optimisation".  Lists whose length
+// is not a multiple of three are left alone.
+void OptimizeVertexCache(std::vector<uint32_t>* indices, int32_t num_vertices);
+
+// Renumbers the vertices in the order that |indices| first refers to them,
+// and reorders the vertices at |data| to match, so that vertices are fetched
+// from memory roughly sequentially.  Vertices that are not referenced are
+// dropped, and the new number of vertices is returned.
+int32_t OptimizeVertexFetch(std::vector<uint32_t>* indices,
+                            std::vector<char>* data, int32_t stride_in_bytes);
+
+}  // namespace gles2
+}  // namespace renderer
+}  // namespace entify
+
+#endif  // _SRC_ENTIFY_RENDERER_GLES2_MESH_OPTIMIZER_H_
@@ -0,0 +1,201 @@
+#include "src/renderer/gles2/mesh_optimizer.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <deque>
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace entify {
+namespace renderer {
+namespace gles2 {
+
+namespace {
+struct Vertex {
+  float x;
+  float y;
+  float u;
+};
+const int32_t kStride = sizeof(Vertex);
+
+std::vector<char> ToBytes(const std::vector<Vertex>& vertices) {
+  std::vector<char> bytes(vertices.size() * kStride);
+  memcpy(bytes.data(), vertices.data(), bytes.size());
+  return bytes;
+}
+
+Vertex VertexAt(const std::vector<char>& data, uint32_t index) {
+  Vertex vertex;
+  memcpy(&vertex, data.data() + index * kStride, kStride);
+  return vertex;
+}
+
+// A triangle by the values of its vertices, rotated so that the smallest
+// comes first, which keeps the winding order.
+typedef std::array<std::array<float, 3>, 3> Triangle;
+
+std::vector<Triangle> Triangles(const std::vector<uint32_t>& indices,
+                                const std::vector<char>& data) {
+  std::vector<Triangle> triangles;
+  for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+    Triangle triangle;
+    for (int corner = 0; corner < 3; ++corner) {
+      Vertex vertex = VertexAt(data, indices[i + corner]);
+      triangle[corner] = {{vertex.x, vertex.y, vertex.u}};
+    }
+    std::rotate(triangle.begin(),
+                std::min_element(triangle.begin(), triangle.end()),
+                triangle.end());
+    triangles.push_back(triangle);
+  }
+  std::sort(triangles.begin(), triangles.end());
+  return triangles;
+}
+
+// A grid of |size| x |size| quads as an unindexed triangle list, with its
+// triangles in a shuffled order.
+std::vector<Vertex> MakeShuffledGrid(int size) {
+  std::vector<std::array<Vertex, 3>> triangles;
+  for (int y = 0; y < size; ++y) {
+    for (int x = 0; x < size; ++x) {
+      float x0 = static_cast<float>(x);
+      float y0 = static_cast<float>(y);
+      Vertex corners[4] = {
+        {x0, y0, 0.0f}, {x0 + 1, y0, 0.0f},
+        {x0, y0 + 1, 0.0f}, {x0 + 1, y0 + 1, 0.0f},
+      };
+      triangles.push_back({{corners[0], corners[1], corners[2]}});
+      triangles.push_back({{corners[2], corners[1], corners[3]}});
+    }
+  }
+  std::mt19937 random(1234);
+  std::shuffle(triangles.begin(), triangles.end(), random);
+
+  std::vector<Vertex> vertices;
+  for (const auto& triangle : triangles) {
+    vertices.insert(vertices.end(), triangle.begin(), triangle.end());
+  }
+  return vertices;
+}
+
+// The number of vertices that a FIFO post-transform cache of |cache_size|
+// entries has to transform for |indices|.
+int CountCacheMisses(const std::vector<uint32_t>& indices, int cache_size) {
+  std::deque<uint32_t> cache;
+  int misses = 0;
+  for (uint32_t index : indices) {
+    if (std::find(cache.begin(), cache.end(), index) == cache.end()) {
+      ++misses;
+      cache.push_back(index);
+      if (cache.size() > static_cast<size_t>(cache_size)) {
+        cache.pop_front();
+      }
+    }
+  }
+  return misses;
+}
+}  // namespace
+
+TEST(MeshOptimizerTests, WeldVerticesMergesIdenticalVertices) {
+  std::vector<char> data = ToBytes({
+    {0, 0, 0}, {1, 0, 0}, {0, 0, 0}, {1, 0, 1}, {1, 0, 0}, {0, 0, 0},
+  });
+  std::vector<char> unique_data;
+  std::vector<uint32_t> indices;
+  WeldVertices(data.data(), 6, kStride, &unique_data, &indices);
+
+  // Unique vertices keep the order of their first occurrence.
+  EXPECT_EQ(ToBytes({{0, 0, 0}, {1, 0, 0}, {1, 0, 1}}), unique_data);
+  EXPECT_EQ(std::vector<uint32_t>({0, 1, 0, 2, 1, 0}), indices);
+}
+
+TEST(MeshOptimizerTests, WeldVerticesComparesBits) {
+  // 0 and -0 compare equal as floats, but are different vertices.
+  std::vector<char> data = ToBytes({{0.0f, 0, 0}, {-0.0f, 0, 0}});
+  std::vector<char> unique_data;
+  std::vector<uint32_t> indices;
+  WeldVertices(data.data(), 2, kStride, &unique_data, &indices);
+
+  EXPECT_EQ(data, unique_data);
+  EXPECT_EQ(std::vector<uint32_t>({0, 1}), indices);
+}
+
+TEST(MeshOptimizerTests, OptimizeVertexCacheKeepsTriangles) {
+  std::vector<char> data = ToBytes(MakeShuffledGrid(16));
+  std::vector<char> unique_data;
+  std::vector<uint32_t> indices;
+  WeldVertices(data.data(), static_cast<int32_t>(data.size() / kStride),
+               kStride, &unique_data, &indices);
+  int32_t num_vertices = static_cast<int32_t>(unique_data.size() / kStride);
+  EXPECT_EQ(17 * 17, num_vertices);
+
+  std::vector<uint32_t> optimized = indices;
+  OptimizeVertexCache(&optimized, num_vertices);
+  ASSERT_EQ(indices.size(), optimized.size());
+  EXPECT_EQ(Triangles(indices, unique_data),
+            Triangles(optimized, unique_data));
+
+  // A grid is close to the ideal of transforming each vertex once, even
+  // for a smaller cache than the one modelled.
+  EXPECT_LT(CountCacheMisses(optimized, 16),
+            CountCacheMisses(indices, 16) / 2);
+  EXPECT_LT(CountCacheMisses(optimized, 16), num_vertices * 3 / 2);
+}
+
+TEST(MeshOptimizerTests, OptimizeVertexCacheLeavesPartialListsAlone) {
+  std::vector<uint32_t> indices = {2, 1, 0, 0, 1};
+  OptimizeVertexCache(&indices, 3);
+  EXPECT_EQ(std::vector<uint32_t>({2, 1, 0, 0, 1}), indices);
+
+  std::vector<uint32_t> empty;
+  OptimizeVertexCache(&empty, 0);
+  EXPECT_TRUE(empty.empty());
+}
+
+TEST(MeshOptimizerTests, OptimizeVertexFetchRenumbersInFirstUseOrder) {
+  std::vector<char> data = ToBytes({
+    {0, 0, 0}, {1, 0, 0}, {2, 0, 0}, {3, 0, 0}, {4, 0, 0},
+  });
+  // Vertex 1 is not referenced.
+  std::vector<uint32_t> indices = {4, 2, 0, 0, 2, 3};
+  EXPECT_EQ(4, OptimizeVertexFetch(&indices, &data, kStride));
+
+  EXPECT_EQ(std::vector<uint32_t>({0, 1, 2, 2, 1, 3}), indices);
+  EXPECT_EQ(ToBytes({{4, 0, 0}, {2, 0, 0}, {0, 0, 0}, {3, 0, 0}}), data);
+}
+
+TEST(MeshOptimizerTests, OptimizedMeshesDrawTheSameTriangles) {
+  std::vector<char> data = ToBytes(MakeShuffledGrid(8));
+  std::vector<uint32_t> unindexed(data.size() / kStride);
+  for (size_t i = 0; i < unindexed.size(); ++i) {
+    unindexed[i] = static_cast<uint32_t>(i);
+  }
+  std::vector<Triangle> expected = Triangles(unindexed, data);
+
+  std::vector<char> unique_data;
+  std::vector<uint32_t> indices;
+  WeldVertices(data.data(), static_cast<int32_t>(unindexed.size()), kStride,
+               &unique_data, &indices);
+  OptimizeVertexCache(&indices,
+                      static_cast<int32_t>(unique_data.size() / kStride));
+  int32_t num_vertices =
+      OptimizeVertexFetch(&indices, &unique_data, kStride);
+
+  EXPECT_EQ(9 * 9, num_vertices);
+  EXPECT_EQ(static_cast<size_t>(num_vertices * kStride), unique_data.size());
+  EXPECT_EQ(expected, Triangles(indices, unique_data));
+  // Vertices are fetched in order, so each index is at most one past the
+  // largest one before it.
+  uint32_t end = 0;
+  for (uint32_t index : indices) {
+    EXPECT_LE(index, end);
+    end = std::max(end, index + 1);
+  }
+}
+
+}  // namespace gles2
+}  // namespace renderer
+}  // namespace entify
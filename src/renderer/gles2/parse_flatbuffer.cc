@@ -5,13 +5,16 @@
 #include "src/renderer/gles2/lookup_utils.h"
 #include "src/renderer/gles2/render_tree/draw_call.h"
 #include "src/renderer/gles2/render_tree/draw_sequence.h"
+#include "src/renderer/gles2/render_tree/draw_template.h"
 #include "src/renderer/gles2/render_tree/fragment_shader.h"
+#include "src/renderer/gles2/render_tree/index_buffer.h"
 #include "src/renderer/gles2/render_tree/pipeline.h"
 #include "src/renderer/gles2/render_tree/program.h"
 #include "src/renderer/gles2/render_tree/types.h"
 #include "src/renderer/gles2/render_tree/uniform_values.h"
 #include "src/renderer/gles2/render_tree/vertex_buffer.h"
 #include "src/renderer/gles2/render_tree/vertex_shader.h"
+#include "src/renderer/gles2/static_batcher.h"
 
 namespace entify {
 namespace renderer {
@@ -41,6 +44,46 @@ render_tree::Type FromProtoType(PrimitiveType in) {
         return render_tree::TypeUInt8V4;
     case PrimitiveType_Sampler:
         return render_tree::TypeSampler;
+    case PrimitiveType_Float16V1:
+        return render_tree::TypeFloat16V1;
+    case PrimitiveType_Float16V2:
+        return render_tree::TypeFloat16V2;
+    case PrimitiveType_Float16V3:
+        return render_tree::TypeFloat16V3;
+    case PrimitiveType_Float16V4:
+        return render_tree::TypeFloat16V4;
+    case PrimitiveType_Int16V1:
+        return render_tree::TypeInt16V1;
+    case PrimitiveType_Int16V2:
+        return render_tree::TypeInt16V2;
+    case PrimitiveType_Int16V3:
+        return render_tree::TypeInt16V3;
+    case PrimitiveType_Int16V4:
+        return render_tree::TypeInt16V4;
+    case PrimitiveType_UInt16V1:
+        return render_tree::TypeUInt16V1;
+    case PrimitiveType_UInt16V2:
+        return render_tree::TypeUInt16V2;
+    case PrimitiveType_UInt16V3:
+        return render_tree::TypeUInt16V3;
+    case PrimitiveType_UInt16V4:
+        return render_tree::TypeUInt16V4;
+    case PrimitiveType_UNorm8V1:
+        return render_tree::TypeUNorm8V1;
+    case PrimitiveType_UNorm8V2:
+        return render_tree::TypeUNorm8V2;
+    case PrimitiveType_UNorm8V3:
+        return render_tree::TypeUNorm8V3;
+    case PrimitiveType_UNorm8V4:
+        return render_tree::TypeUNorm8V4;
+    case PrimitiveType_SNorm16V1:
+        return render_tree::TypeSNorm16V1;
+    case PrimitiveType_SNorm16V2:
+        return render_tree::TypeSNorm16V2;
+    case PrimitiveType_SNorm16V3:
+        return render_tree::TypeSNorm16V3;
+    case PrimitiveType_SNorm16V4:
+        return render_tree::TypeSNorm16V4;
   }
 
   return render_tree::TypeInvalid;
@@ -67,15 +110,16 @@ FromNamedProtoTypeTuple(
   out.second.reserve(in->size());
   for (const auto& i : *in) {
     out.first.push_back(i->name()->str());
-    out.second.push_back(FromProtoType(i->type()));        
+    out.second.push_back(render_tree::MakeTypeWithArrayLength(
+        FromProtoType(i->type()), i->array_length()));
   }
   return std::move(out);
 }
 
 ParseOutput ParseGLSLVertexShader(
-    const GLSLVertexShader* glsl_vertex_shader) {
+    Device* device, const GLSLVertexShader* glsl_vertex_shader) {
   auto shader = std::make_shared<render_tree::VertexShader>(
-      glsl_vertex_shader->source()->str(),
+      device, glsl_vertex_shader->source()->str(),
       FromNamedProtoTypeTuple(glsl_vertex_shader->input_types()),
       FromProtoTypeTuple(glsl_vertex_shader->output_types()),
       FromNamedProtoTypeTuple(glsl_vertex_shader->uniform_types()));
@@ -87,9 +131,9 @@ ParseOutput ParseGLSLVertexShader(
 }
 
 ParseOutput ParseGLSLFragmentShader(
-    const GLSLFragmentShader* glsl_fragment_shader) {
+    Device* device, const GLSLFragmentShader* glsl_fragment_shader) {
   auto shader = std::make_shared<render_tree::FragmentShader>(
-      glsl_fragment_shader->source()->str(),
+      device, glsl_fragment_shader->source()->str(),
       FromProtoTypeTuple(glsl_fragment_shader->input_types()),
       FromNamedProtoTypeTuple(glsl_fragment_shader->uniform_types()));
   if (!shader->error().empty()) {
@@ -100,18 +144,45 @@ ParseOutput ParseGLSLFragmentShader(
 }
 
 ParseOutput ParseVertexBuffer(
-    const VertexBuffer* vertex_buffer) {
+    Device* device, const VertexBuffer* vertex_buffer) {
   std::vector<int32_t> data_offsets;
   data_offsets.reserve(vertex_buffer->offsets()->size());
   std::copy(vertex_buffer->offsets()->begin(), vertex_buffer->offsets()->end(),
             std::back_inserter(data_offsets));
 
-  return std::make_shared<render_tree::VertexBuffer>(
-      reinterpret_cast<const char*>(vertex_buffer->data()->data()),
+  auto parsed_vertex_buffer = std::make_shared<render_tree::VertexBuffer>(
+      device, reinterpret_cast<const char*>(vertex_buffer->data()->data()),
       vertex_buffer->data()->size(),
       vertex_buffer->stride_in_bytes(),
       std::move(data_offsets),
-      FromProtoTypeTuple(vertex_buffer->types()));
+      FromProtoTypeTuple(vertex_buffer->types()),
+      vertex_buffer->transient(), vertex_buffer->weld_vertices());
+  if (!parsed_vertex_buffer->error().empty()) {
+    return ParseOutput(parsed_vertex_buffer->error());
+  }
+  return ParseOutput(parsed_vertex_buffer);
+}
+
+GLenum FromProtoIndexType(IndexType in) {
+  switch (in) {
+    case IndexType_UInt8: return GL_UNSIGNED_BYTE;
+    case IndexType_UInt16: return GL_UNSIGNED_SHORT;
+    default: break;
+  }
+
+  return GL_NONE;
+}
+
+ParseOutput ParseIndexBuffer(
+    Device* device, const IndexBuffer* index_buffer) {
+  auto parsed_index_buffer = std::make_shared<render_tree::IndexBuffer>(
+      device, FromProtoIndexType(index_buffer->type()),
+      reinterpret_cast<const char*>(index_buffer->data()->data()),
+      index_buffer->data()->size(), index_buffer->optimize_vertex_cache());
+  if (!parsed_index_buffer->error().empty()) {
+    return ParseOutput(parsed_index_buffer->error());
+  }
+  return ParseOutput(parsed_index_buffer);
 }
 
 std::vector<std::shared_ptr<render_tree::Sampler>> ParseRepeatedSamplerField(
@@ -137,54 +208,127 @@ ParseOutput ParseUniformValues(
     const ExternalReferenceLookup& reference_lookup) {
   std::vector<char> data(
       uniform_values->data()->begin(), uniform_values->data()->end());
-  return std::make_shared<render_tree::UniformValues>(
-      FromProtoTypeTuple(uniform_values->types()), std::move(data),
+  render_tree::TypeTuple types = FromProtoTypeTuple(uniform_values->types());
+  const auto* array_lengths = uniform_values->array_lengths();
+  if (array_lengths && array_lengths->size() > 0) {
+    if (array_lengths->size() != types.size()) {
+      return ParseOutput(
+          "UniformValues must have an array length for each of its types.");
+    }
+    for (size_t i = 0; i < types.size(); ++i) {
+      types[i] = render_tree::MakeTypeWithArrayLength(
+          types[i], array_lengths->Get(i));
+    }
+  }
+  auto parsed_uniform_values = std::make_shared<render_tree::UniformValues>(
+      std::move(types), std::move(data),
       ParseRepeatedSamplerField(uniform_values->sampler_ids(),
-                                reference_lookup));
+                                reference_lookup),
+      uniform_values->updatable());
+  if (!parsed_uniform_values->error().empty()) {
+    return ParseOutput(parsed_uniform_values->error());
+  }
+  return ParseOutput(parsed_uniform_values);
+}
+
+render_tree::PixelType FromProtoPixelType(PixelType in) {
+  switch (in) {
+    case PixelType_RGB: return render_tree::kPixelTypeRGB;
+    case PixelType_RGBA : return render_tree::kPixelTypeRGBA;
+    case PixelType_Luminance: return render_tree::kPixelTypeLuminance;
+    case PixelType_Alpha: return render_tree::kPixelTypeAlpha;
+    case PixelType_LuminanceAlpha:
+        return render_tree::kPixelTypeLuminanceAlpha;
+    case PixelType_RGB565: return render_tree::kPixelTypeRGB565;
+    case PixelType_RGBA4444: return render_tree::kPixelTypeRGBA4444;
+    case PixelType_RGBA5551: return render_tree::kPixelTypeRGBA5551;
+    case PixelType_ETC1: return render_tree::kPixelTypeETC1;
+    case PixelType_ETC2RGB: return render_tree::kPixelTypeETC2RGB;
+    case PixelType_ETC2RGBA: return render_tree::kPixelTypeETC2RGBA;
+  }
+
+  assert(false);
+  return static_cast<render_tree::PixelType>(0);
 }
 
 std::shared_ptr<render_tree::Texture> ParseRenderTarget(
-    const RenderTarget* render_target,
+    Device* device, EntifyId id, const RenderTarget* render_target,
     const ExternalReferenceLookup& reference_lookup) {
   auto draw_tree = LookupNode<render_tree::DrawTree>(
       reference_lookup, render_target->draw_tree_id());
   assert(draw_tree);
 
   return std::make_shared<render_tree::RenderTarget>(
-      render_target->width_in_pixels(), render_target->height_in_pixels(),
-      draw_tree);
+      device, id, render_target->width_in_pixels(),
+      render_target->height_in_pixels(),
+      FromProtoPixelType(render_target->pixel_type()),
+      render_target->generate_mipmaps(), draw_tree);
 }
 
-render_tree::PixelType FromProtoPixelType(PixelType in) {
+render_tree::PixelOrigin FromProtoPixelOrigin(PixelOrigin in) {
   switch (in) {
-    case PixelType_RGB: return render_tree::kPixelTypeRGB;
-    case PixelType_RGBA : return render_tree::kPixelTypeRGBA;
+    case PixelOrigin_BottomLeft: return render_tree::kPixelOriginBottomLeft;
+    case PixelOrigin_TopLeft: return render_tree::kPixelOriginTopLeft;
+    default: break;
   }
 
   assert(false);
-  return static_cast<render_tree::PixelType>(0);
+  return render_tree::kPixelOriginBottomLeft;
 }
 
-std::shared_ptr<render_tree::Texture> ParsePixelData(
-    const PixelData* pixel_data) {
+// The flatbuffers enum is hidden by the renderer's own ChannelOrder.
+ChannelOrder FromProtoChannelOrder(renderer::ChannelOrder in) {
+  switch (in) {
+    case ChannelOrder_RGBA: return kChannelOrderRGBA;
+    case ChannelOrder_BGRA: return kChannelOrderBGRA;
+    case ChannelOrder_ARGB: return kChannelOrderARGB;
+    default: break;
+  }
+
+  assert(false);
+  return kChannelOrderRGBA;
+}
+
+render_tree::PixelImage PreparePixelData(
+    const Device* device, const PixelData* pixel_data) {
+  render_tree::PixelLayout layout;
+  layout.origin = FromProtoPixelOrigin(pixel_data->origin());
+  layout.channel_order = FromProtoChannelOrder(pixel_data->channel_order());
+  layout.straight_alpha = pixel_data->straight_alpha();
+
   std::vector<char> data(
       pixel_data->data()->begin(), pixel_data->data()->end());
-  return std::make_shared<render_tree::PixelData>(
-      pixel_data->width_in_pixels(), pixel_data->height_in_pixels(),
+  return render_tree::PreparePixelImage(
+      device, pixel_data->width_in_pixels(), pixel_data->height_in_pixels(),
       pixel_data->stride_in_bytes(),
-      FromProtoPixelType(pixel_data->pixel_type()),
-      std::move(data));
+      FromProtoPixelType(pixel_data->pixel_type()), layout,
+      std::move(data), pixel_data->updatable(),
+      pixel_data->double_buffered(), pixel_data->compress(),
+      pixel_data->generate_mipmaps(), pixel_data->atlas());
 }
 
+ParseOutput ParsePixelData(Device* device, render_tree::PixelImage* image) {
+  auto parsed_pixel_data =
+      std::make_shared<render_tree::PixelData>(device, std::move(*image));
+  if (!parsed_pixel_data->error().empty()) {
+    return ParseOutput(parsed_pixel_data->error());
+  }
+  // Textures are referenced by their base class.
+  return ParseOutput(
+      std::static_pointer_cast<render_tree::Texture>(parsed_pixel_data));
+}
+
+// |pixel_image| is the prepared image of a PixelData texture.
 ParseOutput ParseTexture(
-    const Texture* texture,
+    Device* device, EntifyId id, const Texture* texture,
+    render_tree::PixelImage* pixel_image,
     const ExternalReferenceLookup& reference_lookup) {
   switch (texture->texture_type()) {
     case TextureUnion_pixel_data:
-      return ParsePixelData(texture->texture_as_pixel_data());
+      return ParsePixelData(device, pixel_image);
     case TextureUnion_render_target:
       return ParseRenderTarget(
-        texture->texture_as_render_target(), reference_lookup);
+        device, id, texture->texture_as_render_target(), reference_lookup);
     default:
       assert(false);
   }
@@ -205,6 +349,14 @@ GLenum FromProtoSamplerFilterType(SamplerFilterType in) {
   switch (in) {
     case SamplerFilterType_TypeLinear: return GL_LINEAR;
     case SamplerFilterType_TypeNearest: return GL_NEAREST;
+    case SamplerFilterType_TypeNearestMipmapNearest:
+      return GL_NEAREST_MIPMAP_NEAREST;
+    case SamplerFilterType_TypeLinearMipmapNearest:
+      return GL_LINEAR_MIPMAP_NEAREST;
+    case SamplerFilterType_TypeNearestMipmapLinear:
+      return GL_NEAREST_MIPMAP_LINEAR;
+    case SamplerFilterType_TypeLinearMipmapLinear:
+      return GL_LINEAR_MIPMAP_LINEAR;
   }
   assert(false);
   return 0;
@@ -216,6 +368,10 @@ ParseOutput ParseSampler(
   auto texture = LookupNode<render_tree::Texture>(
       reference_lookup, sampler->texture_id());
   assert(texture);
+  if (sampler->mag_filter() != SamplerFilterType_TypeLinear &&
+      sampler->mag_filter() != SamplerFilterType_TypeNearest) {
+    return ParseOutput("A Sampler's mag filter can not use mipmaps.");
+  }
   return std::make_shared<render_tree::Sampler>(
       texture,
       FromProtoSamplerWrapType(sampler->wrap_s()),
@@ -236,8 +392,21 @@ GLenum FromProtoBlendCoefficient(BlendCoefficient in) {
   return 0;
 }
 
+GLenum FromProtoPrimitiveMode(PrimitiveMode in) {
+  switch (in) {
+    case PrimitiveMode_Triangles: return GL_TRIANGLES;
+    case PrimitiveMode_TriangleStrip: return GL_TRIANGLE_STRIP;
+    case PrimitiveMode_TriangleFan: return GL_TRIANGLE_FAN;
+    case PrimitiveMode_Lines: return GL_LINES;
+    case PrimitiveMode_LineStrip: return GL_LINE_STRIP;
+    case PrimitiveMode_LineLoop: return GL_LINE_LOOP;
+    case PrimitiveMode_Points: return GL_POINTS;
+    default: return GL_NONE;
+  }
+}
+
 ParseOutput ParsePipeline(
-    const Pipeline* pipeline,
+    Device* device, const Pipeline* pipeline,
     const ExternalReferenceLookup& reference_lookup) {
   auto vertex_shader = LookupNode<render_tree::VertexShader>(
       reference_lookup, pipeline->vertex_shader_id());
@@ -248,7 +417,8 @@ ParseOutput ParsePipeline(
   assert(fragment_shader);
 
   auto program =
-      std::make_shared<render_tree::Program>(vertex_shader, fragment_shader);
+      std::make_shared<render_tree::Program>(
+          device, vertex_shader, fragment_shader);
 
   if (!program->error().empty()) {
     return ParseOutput(program->error());
@@ -263,11 +433,15 @@ ParseOutput ParsePipeline(
       pipeline->blend_parameters()->src_alpha());
   params.blend.dst_alpha = FromProtoBlendCoefficient(
       pipeline->blend_parameters()->dst_alpha());
+  params.primitive_mode = FromProtoPrimitiveMode(pipeline->primitive_mode());
+  if (params.primitive_mode == GL_NONE) {
+    return ParseOutput("Pipeline has an invalid primitive mode.");
+  }
 
   return std::make_shared<render_tree::Pipeline>(program, params);
 }
 
-std::shared_ptr<render_tree::DrawTree> ParseDrawCall(
+ParseOutput ParseDrawCall(
     const DrawCall* draw_call,
     const ExternalReferenceLookup& reference_lookup) {
   auto pipeline = LookupNode<render_tree::Pipeline>(
@@ -284,8 +458,21 @@ std::shared_ptr<render_tree::DrawTree> ParseDrawCall(
   auto fragment_uniform_values = LookupNode<render_tree::UniformValues>(
       reference_lookup, draw_call->fragment_uniform_values_id());
 
-  return std::make_shared<render_tree::DrawCall>(
-      pipeline, vertex_buffer, vertex_uniform_values, fragment_uniform_values);
+  auto index_buffer = LookupNode<render_tree::IndexBuffer>(
+      reference_lookup, draw_call->index_buffer_id());
+  if (!index_buffer && draw_call->index_buffer_id() != 0) {
+    return ParseOutput(
+        "A DrawCall's index buffer id does not refer to an IndexBuffer.");
+  }
+
+  auto parsed_draw_call = std::make_shared<render_tree::DrawCall>(
+      pipeline, vertex_buffer, vertex_uniform_values, fragment_uniform_values,
+      index_buffer);
+  if (!parsed_draw_call->error().empty()) {
+    return ParseOutput(parsed_draw_call->error());
+  }
+  return ParseOutput(
+      std::static_pointer_cast<render_tree::DrawTree>(parsed_draw_call));
 }
 
 std::vector<std::shared_ptr<render_tree::DrawTree>> MapTreeIdsToVector(
@@ -304,17 +491,72 @@ std::shared_ptr<render_tree::DrawTree> ParseDrawSequence(
     const DrawSequence* draw_sequence,
     const ExternalReferenceLookup& reference_lookup) {  
   return std::make_shared<render_tree::DrawSequence>(
-      MapTreeIdsToVector(draw_sequence->draw_tree_ids(), reference_lookup));
+      MapTreeIdsToVector(draw_sequence->draw_tree_ids(), reference_lookup),
+      draw_sequence->updatable());
 }
 
 std::shared_ptr<render_tree::DrawTree> ParseDrawSet(
     const DrawSet* draw_set,
     const ExternalReferenceLookup& reference_lookup) {
-  return std::make_shared<render_tree::DrawSequence>(
-      MapTreeIdsToVector(draw_set->draw_tree_ids(), reference_lookup));
+  auto draw_trees =
+      MapTreeIdsToVector(draw_set->draw_tree_ids(), reference_lookup);
+  GroupBatchableDrawCalls(&draw_trees);
+  return std::make_shared<render_tree::DrawSequence>(std::move(draw_trees));
 }
 
-ParseOutput ParseDrawTree(
+ParseOutput ParseDrawTemplate(
+    const DrawTemplate* draw_template,
+    const ExternalReferenceLookup& reference_lookup) {
+  auto draw_tree = LookupNode<render_tree::DrawTree>(
+      reference_lookup, draw_template->draw_tree_id());
+  assert(draw_tree);
+
+  std::vector<render_tree::DrawTemplate::ParameterBinding> bindings;
+  if (draw_template->parameters()) {
+    bindings.reserve(draw_template->parameters()->size());
+    for (const DrawTemplateParameter* parameter :
+             *draw_template->parameters()) {
+      bindings.push_back(render_tree::DrawTemplate::ParameterBinding{
+          parameter->name()->str(),
+          LookupNode<render_tree::UniformValues>(
+              reference_lookup, parameter->uniform_values_id()),
+          parameter->uniform_index()});
+    }
+  }
+
+  auto parsed_draw_template =
+      std::make_shared<render_tree::DrawTemplate>(draw_tree, bindings);
+  if (!parsed_draw_template->error().empty()) {
+    return ParseOutput(parsed_draw_template->error());
+  }
+  return ParseOutput(
+      std::static_pointer_cast<render_tree::DrawTree>(parsed_draw_template));
+}
+
+ParseOutput ParseDrawTemplateInstance(
+    const DrawTemplateInstance* draw_template_instance,
+    const ExternalReferenceLookup& reference_lookup) {
+  auto draw_template = LookupNode<render_tree::DrawTree>(
+      reference_lookup, draw_template_instance->draw_template_id());
+  assert(draw_template);
+  if (draw_template->type() != render_tree::DrawTree::kTypeDrawTemplate) {
+    return ParseOutput(
+        "DrawTemplateInstance does not refer to a DrawTemplate.");
+  }
+
+  auto instance = std::make_shared<render_tree::DrawTemplateInstance>(
+      std::static_pointer_cast<render_tree::DrawTemplate>(draw_template),
+      reinterpret_cast<const char*>(
+          draw_template_instance->parameters()->data()),
+      draw_template_instance->parameters()->size());
+  if (!instance->error().empty()) {
+    return ParseOutput(instance->error());
+  }
+  return ParseOutput(
+      std::static_pointer_cast<render_tree::DrawTree>(instance));
+}
+
+ParseOutput ParseDrawTreeOfType(
     const DrawTree* draw_tree,
     const ExternalReferenceLookup& reference_lookup) {
   switch (draw_tree->draw_tree_type()) {
@@ -327,6 +569,12 @@ ParseOutput ParseDrawTree(
     case DrawTreeUnion_draw_set:
       return ParseDrawSet(
           draw_tree->draw_tree_as_draw_set(), reference_lookup);
+    case DrawTreeUnion_draw_template:
+      return ParseDrawTemplate(
+          draw_tree->draw_tree_as_draw_template(), reference_lookup);
+    case DrawTreeUnion_draw_template_instance:
+      return ParseDrawTemplateInstance(
+          draw_tree->draw_tree_as_draw_template_instance(), reference_lookup);
     default:
       assert(false);
   }
@@ -334,31 +582,65 @@ ParseOutput ParseDrawTree(
   return ParseOutput("Unknown DrawTree type.");
 }
 
+ParseOutput ParseDrawTree(
+    EntifyId id, const DrawTree* draw_tree,
+    const ExternalReferenceLookup& reference_lookup) {
+  ParseOutput output = ParseDrawTreeOfType(draw_tree, reference_lookup);
+  if (output.value) {
+    // Draw trees are registered by their base class.
+    static_cast<render_tree::DrawTree*>(output.value->object().get())
+        ->set_id(id);
+  }
+  return output;
+}
+
 }  // namespace
 
-ParseOutput ParseFlatBuffer(
-    const ExternalReferenceLookup& reference_lookup,
-    const char* data, size_t data_size) {
+PreparedFlatBuffer::PreparedFlatBuffer() {}
+PreparedFlatBuffer::~PreparedFlatBuffer() {}
+
+void PrepareFlatBuffer(const Device* device, const char* data,
+                       size_t data_size, PreparedFlatBuffer* prepared) {
+  prepared->data = data;
+
   const RendererNode* renderer_node =
       flatbuffers::GetRoot<entify::renderer::RendererNode>(data);
+  if (renderer_node->renderer_node_type() == RendererNodeUnion_texture) {
+    const Texture* texture = renderer_node->renderer_node_as_texture();
+    if (texture->texture_type() == TextureUnion_pixel_data) {
+      prepared->pixel_image.reset(new render_tree::PixelImage(
+          PreparePixelData(device, texture->texture_as_pixel_data())));
+    }
+  }
+  prepared->needs_context =
+      renderer_node->renderer_node_type() !=
+          RendererNodeUnion_uniform_values &&
+      renderer_node->renderer_node_type() != RendererNodeUnion_sampler;
+}
+
+ParseOutput ParseFlatBuffer(
+    Device* device, const ExternalReferenceLookup& reference_lookup,
+    EntifyId id, PreparedFlatBuffer* prepared) {
+  const RendererNode* renderer_node =
+      flatbuffers::GetRoot<entify::renderer::RendererNode>(prepared->data);
 
   switch(renderer_node->renderer_node_type()) {
     case RendererNodeUnion_glsl_vertex_shader: {
       return ParseGLSLVertexShader(
-          renderer_node->renderer_node_as_glsl_vertex_shader());
+          device, renderer_node->renderer_node_as_glsl_vertex_shader());
     } break;
     case RendererNodeUnion_glsl_fragment_shader: {
       return ParseGLSLFragmentShader(
-          renderer_node->renderer_node_as_glsl_fragment_shader());
+          device, renderer_node->renderer_node_as_glsl_fragment_shader());
     } break;
     case RendererNodeUnion_pipeline: {
       return ParsePipeline(
-          renderer_node->renderer_node_as_pipeline(),
+          device, renderer_node->renderer_node_as_pipeline(),
           reference_lookup);
     } break;
     case RendererNodeUnion_vertex_buffer: {
       return ParseVertexBuffer(
-          renderer_node->renderer_node_as_vertex_buffer());
+          device, renderer_node->renderer_node_as_vertex_buffer());
     } break;
     case RendererNodeUnion_uniform_values: {
       return ParseUniformValues(
@@ -367,8 +649,8 @@ ParseOutput ParseFlatBuffer(
     } break;
     case RendererNodeUnion_texture: {
       return ParseTexture(
-          renderer_node->renderer_node_as_texture(),
-          reference_lookup);
+          device, id, renderer_node->renderer_node_as_texture(),
+          prepared->pixel_image.get(), reference_lookup);
     } break;
     case RendererNodeUnion_sampler: {
       return ParseSampler(
@@ -377,9 +659,13 @@ ParseOutput ParseFlatBuffer(
     } break;
     case RendererNodeUnion_draw_tree: {
       return ParseDrawTree(
-          renderer_node->renderer_node_as_draw_tree(),
+          id, renderer_node->renderer_node_as_draw_tree(),
           reference_lookup);
     } break;
+    case RendererNodeUnion_index_buffer: {
+      return ParseIndexBuffer(
+          device, renderer_node->renderer_node_as_index_buffer());
+    } break;
   };
 
   assert(false);
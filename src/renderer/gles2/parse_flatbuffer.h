@@ -4,16 +4,43 @@
 #include <memory>
 
 #include "src/external_reference.h"
+#include "src/renderer/gles2/device.h"
 #include "src/renderer/parse_output.h"
 
 namespace entify {
 namespace renderer {
 namespace gles2 {
 
+namespace render_tree {
+struct PixelImage;
+}  // namespace render_tree
+
+// A node whose CPU work, such as converting and compressing pixel data, is
+// already done.  The flat buffer itself must outlive it.
+struct PreparedFlatBuffer {
+  PreparedFlatBuffer();
+  ~PreparedFlatBuffer();
+
+  const char* data = nullptr;
+  // Set if the node is a PixelData.
+  std::unique_ptr<render_tree::PixelImage> pixel_image;
+  // Whether parsing the node makes GL calls, and so must happen while a
+  // context is current.  UniformValues and Samplers only refer to nodes that
+  // do not change once created, so they are parsed without one.
+  bool needs_context = true;
+};
+
+// Does the part of parsing a node that needs no context, so that it does
+// not hold up other threads' GL work.  |device| is only asked what it
+// supports.
+void PrepareFlatBuffer(const Device* device, const char* data,
+                       size_t data_size, PreparedFlatBuffer* prepared);
+
+// Parses a node prepared by PrepareFlatBuffer().
 // This function assumes that it is called while a context is current.
 ParseOutput ParseFlatBuffer(
-    const ExternalReferenceLookup& reference_lookup,
-    const char* data, size_t data_size);
+    Device* device, const ExternalReferenceLookup& reference_lookup,
+    EntifyId id, PreparedFlatBuffer* prepared);
 
 }  // namespace gles2
 }  // namespace renderer
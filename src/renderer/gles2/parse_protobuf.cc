@@ -7,13 +7,16 @@
 #include "src/renderer/gles2/lookup_utils.h"
 #include "src/renderer/gles2/render_tree/draw_call.h"
 #include "src/renderer/gles2/render_tree/draw_sequence.h"
+#include "src/renderer/gles2/render_tree/draw_template.h"
 #include "src/renderer/gles2/render_tree/fragment_shader.h"
+#include "src/renderer/gles2/render_tree/index_buffer.h"
 #include "src/renderer/gles2/render_tree/pipeline.h"
 #include "src/renderer/gles2/render_tree/program.h"
 #include "src/renderer/gles2/render_tree/types.h"
 #include "src/renderer/gles2/render_tree/uniform_values.h"
 #include "src/renderer/gles2/render_tree/vertex_buffer.h"
 #include "src/renderer/gles2/render_tree/vertex_shader.h"
+#include "src/renderer/gles2/static_batcher.h"
 
 namespace entify {
 namespace renderer {
@@ -43,6 +46,46 @@ render_tree::Type FromProtoType(int32_t in) {
         return render_tree::TypeUInt8V4;
     case entify_renderer::PrimitiveTypeSampler:
         return render_tree::TypeSampler;
+    case entify_renderer::PrimitiveTypeFloat16V1:
+        return render_tree::TypeFloat16V1;
+    case entify_renderer::PrimitiveTypeFloat16V2:
+        return render_tree::TypeFloat16V2;
+    case entify_renderer::PrimitiveTypeFloat16V3:
+        return render_tree::TypeFloat16V3;
+    case entify_renderer::PrimitiveTypeFloat16V4:
+        return render_tree::TypeFloat16V4;
+    case entify_renderer::PrimitiveTypeInt16V1:
+        return render_tree::TypeInt16V1;
+    case entify_renderer::PrimitiveTypeInt16V2:
+        return render_tree::TypeInt16V2;
+    case entify_renderer::PrimitiveTypeInt16V3:
+        return render_tree::TypeInt16V3;
+    case entify_renderer::PrimitiveTypeInt16V4:
+        return render_tree::TypeInt16V4;
+    case entify_renderer::PrimitiveTypeUInt16V1:
+        return render_tree::TypeUInt16V1;
+    case entify_renderer::PrimitiveTypeUInt16V2:
+        return render_tree::TypeUInt16V2;
+    case entify_renderer::PrimitiveTypeUInt16V3:
+        return render_tree::TypeUInt16V3;
+    case entify_renderer::PrimitiveTypeUInt16V4:
+        return render_tree::TypeUInt16V4;
+    case entify_renderer::PrimitiveTypeUNorm8V1:
+        return render_tree::TypeUNorm8V1;
+    case entify_renderer::PrimitiveTypeUNorm8V2:
+        return render_tree::TypeUNorm8V2;
+    case entify_renderer::PrimitiveTypeUNorm8V3:
+        return render_tree::TypeUNorm8V3;
+    case entify_renderer::PrimitiveTypeUNorm8V4:
+        return render_tree::TypeUNorm8V4;
+    case entify_renderer::PrimitiveTypeSNorm16V1:
+        return render_tree::TypeSNorm16V1;
+    case entify_renderer::PrimitiveTypeSNorm16V2:
+        return render_tree::TypeSNorm16V2;
+    case entify_renderer::PrimitiveTypeSNorm16V3:
+        return render_tree::TypeSNorm16V3;
+    case entify_renderer::PrimitiveTypeSNorm16V4:
+        return render_tree::TypeSNorm16V4;
   }
 
   return render_tree::TypeInvalid;
@@ -52,6 +95,22 @@ render_tree::PixelType FromProtoPixelType(int32_t in) {
   switch (in) {
     case entify_renderer::PixelTypeRGB: return render_tree::kPixelTypeRGB;
     case entify_renderer::PixelTypeRGBA: return render_tree::kPixelTypeRGBA;
+    case entify_renderer::PixelTypeLuminance:
+        return render_tree::kPixelTypeLuminance;
+    case entify_renderer::PixelTypeAlpha: return render_tree::kPixelTypeAlpha;
+    case entify_renderer::PixelTypeLuminanceAlpha:
+        return render_tree::kPixelTypeLuminanceAlpha;
+    case entify_renderer::PixelTypeRGB565:
+        return render_tree::kPixelTypeRGB565;
+    case entify_renderer::PixelTypeRGBA4444:
+        return render_tree::kPixelTypeRGBA4444;
+    case entify_renderer::PixelTypeRGBA5551:
+        return render_tree::kPixelTypeRGBA5551;
+    case entify_renderer::PixelTypeETC1: return render_tree::kPixelTypeETC1;
+    case entify_renderer::PixelTypeETC2RGB:
+        return render_tree::kPixelTypeETC2RGB;
+    case entify_renderer::PixelTypeETC2RGBA:
+        return render_tree::kPixelTypeETC2RGBA;
   }
 
   assert(false);
@@ -75,23 +134,50 @@ FromNamedProtoTypeTuple(
   out.second.reserve(in.named_types_size());
   for (const auto& i : in.named_types()) {
     out.first.push_back(i.name());
-    out.second.push_back(FromProtoType(i.type()));        
+    out.second.push_back(render_tree::MakeTypeWithArrayLength(
+        FromProtoType(i.type()), i.array_length()));
   }
   return std::move(out);
 }
 
-std::shared_ptr<render_tree::VertexBuffer> ParseVertexBuffer(
-    const entify_renderer::VertexBuffer& vertex_buffer) {
+ParseOutput ParseVertexBuffer(
+    Device* device, const entify_renderer::VertexBuffer& vertex_buffer) {
   std::vector<int32_t> data_offsets;
   data_offsets.reserve(vertex_buffer.offsets_size());
   std::copy(vertex_buffer.offsets().begin(), vertex_buffer.offsets().end(),
             std::back_inserter(data_offsets));
 
-  return std::make_shared<render_tree::VertexBuffer>(
-      vertex_buffer.data().c_str(), vertex_buffer.data().size(),
+  auto parsed_vertex_buffer = std::make_shared<render_tree::VertexBuffer>(
+      device, vertex_buffer.data().c_str(), vertex_buffer.data().size(),
       vertex_buffer.stride_in_bytes(),
       std::move(data_offsets),
-      FromProtoTypeTuple(vertex_buffer.types()));
+      FromProtoTypeTuple(vertex_buffer.types()),
+      vertex_buffer.transient(), vertex_buffer.weld_vertices());
+  if (!parsed_vertex_buffer->error().empty()) {
+    return ParseOutput(parsed_vertex_buffer->error());
+  }
+  return ParseOutput(parsed_vertex_buffer);
+}
+
+GLenum FromProtoIndexType(int32_t in) {
+  switch (in) {
+    case entify_renderer::IndexTypeUInt8: return GL_UNSIGNED_BYTE;
+    case entify_renderer::IndexTypeUInt16: return GL_UNSIGNED_SHORT;
+  }
+
+  return GL_NONE;
+}
+
+ParseOutput ParseIndexBuffer(
+    Device* device, const entify_renderer::IndexBuffer& index_buffer) {
+  auto parsed_index_buffer = std::make_shared<render_tree::IndexBuffer>(
+      device, FromProtoIndexType(index_buffer.type()),
+      index_buffer.data().c_str(), index_buffer.data().size(),
+      index_buffer.optimize_vertex_cache());
+  if (!parsed_index_buffer->error().empty()) {
+    return ParseOutput(parsed_index_buffer->error());
+  }
+  return ParseOutput(parsed_index_buffer);
 }
 
 std::vector<std::shared_ptr<render_tree::Sampler>> ParseRepeatedSamplerField(
@@ -109,33 +195,59 @@ std::vector<std::shared_ptr<render_tree::Sampler>> ParseRepeatedSamplerField(
   return samplers;
 }
 
-std::shared_ptr<render_tree::UniformValues> ParseUniformValues(
+ParseOutput ParseUniformValues(
     const entify_renderer::UniformValues& uniform_values,
     const ExternalReferenceLookup& reference_lookup) {
   std::vector<char> data(
       uniform_values.data().begin(), uniform_values.data().end());
-  return std::make_shared<render_tree::UniformValues>(
-      FromProtoTypeTuple(uniform_values.types()), std::move(data),
+  render_tree::TypeTuple types = FromProtoTypeTuple(uniform_values.types());
+  if (uniform_values.array_lengths_size() > 0) {
+    if (static_cast<size_t>(uniform_values.array_lengths_size()) !=
+            types.size()) {
+      return ParseOutput(
+          "UniformValues must have an array length for each of its types.");
+    }
+    for (size_t i = 0; i < types.size(); ++i) {
+      types[i] = render_tree::MakeTypeWithArrayLength(
+          types[i], uniform_values.array_lengths(i));
+    }
+  }
+  auto parsed_uniform_values = std::make_shared<render_tree::UniformValues>(
+      std::move(types), std::move(data),
       ParseRepeatedSamplerField(uniform_values.sampler_ids(),
-                                reference_lookup));
+                                reference_lookup),
+      uniform_values.updatable());
+  if (!parsed_uniform_values->error().empty()) {
+    return ParseOutput(parsed_uniform_values->error());
+  }
+  return ParseOutput(parsed_uniform_values);
 }
 
-std::shared_ptr<render_tree::VertexShader> ParseGLSLVertexShader(
+ParseOutput ParseGLSLVertexShader(
+    Device* device,
     const entify_renderer::GLSLVertexShader& glsl_vertex_shader) {
-
-  return std::make_shared<render_tree::VertexShader>(
-      glsl_vertex_shader.source(),
+  auto shader = std::make_shared<render_tree::VertexShader>(
+      device, glsl_vertex_shader.source(),
       FromNamedProtoTypeTuple(glsl_vertex_shader.input_types()),
       FromProtoTypeTuple(glsl_vertex_shader.output_types()),
       FromNamedProtoTypeTuple(glsl_vertex_shader.uniform_types()));
+  if (!shader->error().empty()) {
+    return ParseOutput(shader->error());
+  }
+  return ParseOutput(shader);
 }
 
-std::shared_ptr<render_tree::FragmentShader> ParseGLSLFragmentShader(
+ParseOutput ParseGLSLFragmentShader(
+    Device* device,
     const entify_renderer::GLSLFragmentShader& glsl_fragment_shader) {
-  return std::make_shared<render_tree::FragmentShader>(
-      glsl_fragment_shader.source(),
+  auto shader = std::make_shared<render_tree::FragmentShader>(
+      device, glsl_fragment_shader.source(),
       FromProtoTypeTuple(glsl_fragment_shader.input_types()),
       FromNamedProtoTypeTuple(glsl_fragment_shader.uniform_types()));
+  if (!shader->error().empty()) {
+    return ParseOutput(shader->error());
+  }
+  return ParseOutput(shader);
 }
 
 namespace {
@@ -150,10 +262,24 @@ GLenum FromProtoBlendCoefficient(int32_t in) {
   assert(false);
   return 0;
 }
+
+GLenum FromProtoPrimitiveMode(int32_t in) {
+  switch (in) {
+    case entify_renderer::PrimitiveModeTriangles: return GL_TRIANGLES;
+    case entify_renderer::PrimitiveModeTriangleStrip: return GL_TRIANGLE_STRIP;
+    case entify_renderer::PrimitiveModeTriangleFan: return GL_TRIANGLE_FAN;
+    case entify_renderer::PrimitiveModeLines: return GL_LINES;
+    case entify_renderer::PrimitiveModeLineStrip: return GL_LINE_STRIP;
+    case entify_renderer::PrimitiveModeLineLoop: return GL_LINE_LOOP;
+    case entify_renderer::PrimitiveModePoints: return GL_POINTS;
+  }
+  assert(false);
+  return 0;
+}
 }  // namespace
 
 std::shared_ptr<render_tree::Pipeline> ParsePipeline(
-    const entify_renderer::Pipeline& pipeline,
+    Device* device, const entify_renderer::Pipeline& pipeline,
     const ExternalReferenceLookup& reference_lookup) {
   auto vertex_shader = LookupNode<render_tree::VertexShader>(
       reference_lookup, pipeline.vertex_shader_id());
@@ -164,7 +290,8 @@ std::shared_ptr<render_tree::Pipeline> ParsePipeline(
   assert(fragment_shader);
 
   auto program =
-      std::make_shared<render_tree::Program>(vertex_shader, fragment_shader);
+      std::make_shared<render_tree::Program>(
+          device, vertex_shader, fragment_shader);
 
   render_tree::Pipeline::Params params;
   params.blend.src_color = FromProtoBlendCoefficient(
@@ -175,11 +302,12 @@ std::shared_ptr<render_tree::Pipeline> ParsePipeline(
       pipeline.blend_parameters().src_alpha());
   params.blend.dst_alpha = FromProtoBlendCoefficient(
       pipeline.blend_parameters().dst_alpha());
+  params.primitive_mode = FromProtoPrimitiveMode(pipeline.primitive_mode());
 
   return std::make_shared<render_tree::Pipeline>(program, params);
 }
 
-std::shared_ptr<render_tree::DrawCall> ParseDrawCall(
+ParseOutput ParseDrawCall(
     const entify_renderer::DrawCall& draw_call,
     const ExternalReferenceLookup& reference_lookup) {
   auto pipeline = LookupNode<render_tree::Pipeline>(
@@ -196,8 +324,21 @@ std::shared_ptr<render_tree::DrawCall> ParseDrawCall(
   auto fragment_uniform_values = LookupNode<render_tree::UniformValues>(
       reference_lookup, draw_call.fragment_uniform_values_id());
 
-  return std::make_shared<render_tree::DrawCall>(
-      pipeline, vertex_buffer, vertex_uniform_values, fragment_uniform_values);
+  auto index_buffer = LookupNode<render_tree::IndexBuffer>(
+      reference_lookup, draw_call.index_buffer_id());
+  if (!index_buffer && draw_call.has_index_buffer_id()) {
+    return ParseOutput(
+        "A DrawCall's index buffer id does not refer to an IndexBuffer.");
+  }
+
+  auto parsed_draw_call = std::make_shared<render_tree::DrawCall>(
+      pipeline, vertex_buffer, vertex_uniform_values, fragment_uniform_values,
+      index_buffer);
+  if (!parsed_draw_call->error().empty()) {
+    return ParseOutput(parsed_draw_call->error());
+  }
+  return ParseOutput(
+      std::static_pointer_cast<render_tree::DrawTree>(parsed_draw_call));
 }
 
 std::vector<std::shared_ptr<render_tree::DrawTree>> ParseRepeatedDrawTreeField(
@@ -220,15 +361,17 @@ std::shared_ptr<render_tree::DrawSequence> ParseDrawSequence(
     const ExternalReferenceLookup& reference_lookup) {
   return std::make_shared<render_tree::DrawSequence>(
       ParseRepeatedDrawTreeField(
-          draw_sequence.draw_tree_ids(), reference_lookup));
+          draw_sequence.draw_tree_ids(), reference_lookup),
+      draw_sequence.updatable());
 }
 
 std::shared_ptr<render_tree::DrawSequence> ParseDrawSet(
     const entify_renderer::DrawSet& draw_set,
     const ExternalReferenceLookup& reference_lookup) {
-  return std::make_shared<render_tree::DrawSequence>(
-      ParseRepeatedDrawTreeField(
-          draw_set.draw_tree_ids(), reference_lookup));
+  auto draw_trees = ParseRepeatedDrawTreeField(
+      draw_set.draw_tree_ids(), reference_lookup);
+  GroupBatchableDrawCalls(&draw_trees);
+  return std::make_shared<render_tree::DrawSequence>(std::move(draw_trees));
 }
 
 namespace {
@@ -245,18 +388,31 @@ GLenum FromProtoSamplerFilterType(int32_t in) {
   switch (in) {
     case entify_renderer::SamplerFilterTypeLinear: return GL_LINEAR;
     case entify_renderer::SamplerFilterTypeNearest: return GL_NEAREST;
+    case entify_renderer::SamplerFilterTypeNearestMipmapNearest:
+      return GL_NEAREST_MIPMAP_NEAREST;
+    case entify_renderer::SamplerFilterTypeLinearMipmapNearest:
+      return GL_LINEAR_MIPMAP_NEAREST;
+    case entify_renderer::SamplerFilterTypeNearestMipmapLinear:
+      return GL_NEAREST_MIPMAP_LINEAR;
+    case entify_renderer::SamplerFilterTypeLinearMipmapLinear:
+      return GL_LINEAR_MIPMAP_LINEAR;
   }
   assert(false);
   return 0;
 }
 }  // namespace
 
-std::shared_ptr<render_tree::Sampler> ParseSampler(
+ParseOutput ParseSampler(
     const entify_renderer::Sampler& sampler,
     const ExternalReferenceLookup& reference_lookup) {
   auto texture = LookupNode<render_tree::Texture>(
       reference_lookup, sampler.texture_id());
   assert(texture);
+  // Mipmaps only apply to minification.
+  if (sampler.mag_filter() != entify_renderer::SamplerFilterTypeLinear &&
+      sampler.mag_filter() != entify_renderer::SamplerFilterTypeNearest) {
+    return ParseOutput("A Sampler's mag filter can not use mipmaps.");
+  }
   return std::make_shared<render_tree::Sampler>(
       texture,
       FromProtoSamplerWrapType(sampler.wrap_s()),
@@ -265,24 +421,92 @@ std::shared_ptr<render_tree::Sampler> ParseSampler(
       FromProtoSamplerFilterType(sampler.mag_filter()));
 }
 
-std::shared_ptr<render_tree::DrawTree> ParseDrawTree(
+ParseOutput ParseDrawTemplate(
+    const entify_renderer::DrawTemplate& draw_template,
+    const ExternalReferenceLookup& reference_lookup) {
+  auto draw_tree = LookupNode<render_tree::DrawTree>(
+      reference_lookup, draw_template.draw_tree_id());
+  assert(draw_tree);
+
+  std::vector<render_tree::DrawTemplate::ParameterBinding> bindings;
+  bindings.reserve(draw_template.parameters_size());
+  for (const auto& parameter : draw_template.parameters()) {
+    bindings.push_back(render_tree::DrawTemplate::ParameterBinding{
+        parameter.name(),
+        LookupNode<render_tree::UniformValues>(
+            reference_lookup, parameter.uniform_values_id()),
+        parameter.uniform_index()});
+  }
+
+  auto parsed_draw_template =
+      std::make_shared<render_tree::DrawTemplate>(draw_tree, bindings);
+  if (!parsed_draw_template->error().empty()) {
+    return ParseOutput(parsed_draw_template->error());
+  }
+  return ParseOutput(
+      std::static_pointer_cast<render_tree::DrawTree>(parsed_draw_template));
+}
+
+ParseOutput ParseDrawTemplateInstance(
+    const entify_renderer::DrawTemplateInstance& draw_template_instance,
+    const ExternalReferenceLookup& reference_lookup) {
+  auto draw_template = LookupNode<render_tree::DrawTree>(
+      reference_lookup, draw_template_instance.draw_template_id());
+  assert(draw_template);
+  if (draw_template->type() != render_tree::DrawTree::kTypeDrawTemplate) {
+    return ParseOutput(
+        "DrawTemplateInstance does not refer to a DrawTemplate.");
+  }
+
+  auto instance = std::make_shared<render_tree::DrawTemplateInstance>(
+      std::static_pointer_cast<render_tree::DrawTemplate>(draw_template),
+      draw_template_instance.parameters().data(),
+      draw_template_instance.parameters().size());
+  if (!instance->error().empty()) {
+    return ParseOutput(instance->error());
+  }
+  return ParseOutput(
+      std::static_pointer_cast<render_tree::DrawTree>(instance));
+}
+
+ParseOutput ParseDrawTreeOfType(
     const entify_renderer::DrawTree& draw_tree,
     const ExternalReferenceLookup& reference_lookup) {
   switch (draw_tree.DerivedType_case()) {
     case entify_renderer::DrawTree::kDrawCall:
       return ParseDrawCall(draw_tree.draw_call(), reference_lookup);
     case entify_renderer::DrawTree::kDrawSequence:
-      return ParseDrawSequence(draw_tree.draw_sequence(), reference_lookup);
+      return ParseOutput(std::shared_ptr<render_tree::DrawTree>(
+          ParseDrawSequence(draw_tree.draw_sequence(), reference_lookup)));
     case entify_renderer::DrawTree::kDrawSet:
-      return ParseDrawSet(draw_tree.draw_set(), reference_lookup);
+      return ParseOutput(std::shared_ptr<render_tree::DrawTree>(
+          ParseDrawSet(draw_tree.draw_set(), reference_lookup)));
+    case entify_renderer::DrawTree::kDrawTemplate:
+      return ParseDrawTemplate(draw_tree.draw_template(), reference_lookup);
+    case entify_renderer::DrawTree::kDrawTemplateInstance:
+      return ParseDrawTemplateInstance(
+          draw_tree.draw_template_instance(), reference_lookup);
     default:
       assert(false);
   }
 
-  return nullptr;
+  return ParseOutput("Unknown DrawTree type.");
+}
+
+ParseOutput ParseDrawTree(
+    EntifyId id, const entify_renderer::DrawTree& draw_tree,
+    const ExternalReferenceLookup& reference_lookup) {
+  ParseOutput output = ParseDrawTreeOfType(draw_tree, reference_lookup);
+  if (output.value) {
+    // Draw trees are registered by their base class.
+    static_cast<render_tree::DrawTree*>(output.value->object().get())
+        ->set_id(id);
+  }
+  return output;
 }
 
-std::shared_ptr<render_tree::RenderTarget> ParseRenderTarget(
+std::shared_ptr<render_tree::Texture> ParseRenderTarget(
+    Device* device, EntifyId id,
     const entify_renderer::RenderTarget& render_target,
     const ExternalReferenceLookup& reference_lookup) {
   auto draw_tree = LookupNode<render_tree::DrawTree>(
@@ -290,75 +514,141 @@ std::shared_ptr<render_tree::RenderTarget> ParseRenderTarget(
   assert(draw_tree);
 
   return std::make_shared<render_tree::RenderTarget>(
-      render_target.width_in_pixels(), render_target.height_in_pixels(),
-      draw_tree);
+      device, id, render_target.width_in_pixels(),
+      render_target.height_in_pixels(),
+      FromProtoPixelType(render_target.pixel_type()),
+      render_target.generate_mipmaps(), draw_tree);
+}
+
+render_tree::PixelOrigin FromProtoPixelOrigin(int32_t in) {
+  switch (in) {
+    case entify_renderer::PixelOriginBottomLeft:
+        return render_tree::kPixelOriginBottomLeft;
+    case entify_renderer::PixelOriginTopLeft:
+        return render_tree::kPixelOriginTopLeft;
+  }
+
+  assert(false);
+  return render_tree::kPixelOriginBottomLeft;
+}
+
+ChannelOrder FromProtoChannelOrder(int32_t in) {
+  switch (in) {
+    case entify_renderer::ChannelOrderRGBA: return kChannelOrderRGBA;
+    case entify_renderer::ChannelOrderBGRA: return kChannelOrderBGRA;
+    case entify_renderer::ChannelOrderARGB: return kChannelOrderARGB;
+  }
+
+  assert(false);
+  return kChannelOrderRGBA;
 }
 
-std::shared_ptr<render_tree::PixelData> ParsePixelData(
-    const entify_renderer::PixelData& pixel_data) {
+render_tree::PixelImage PreparePixelData(
+    const Device* device, const entify_renderer::PixelData& pixel_data) {
+  render_tree::PixelLayout layout;
+  layout.origin = FromProtoPixelOrigin(pixel_data.origin());
+  layout.channel_order = FromProtoChannelOrder(pixel_data.channel_order());
+  layout.straight_alpha = pixel_data.straight_alpha();
+
   std::vector<char> data(
       pixel_data.data().begin(), pixel_data.data().end());
-  return std::make_shared<render_tree::PixelData>(
-      pixel_data.width_in_pixels(), pixel_data.height_in_pixels(),
+  return render_tree::PreparePixelImage(
+      device, pixel_data.width_in_pixels(), pixel_data.height_in_pixels(),
       pixel_data.stride_in_bytes(), FromProtoPixelType(pixel_data.pixel_type()),
-      std::move(data));
+      layout, std::move(data), pixel_data.updatable(),
+      pixel_data.double_buffered(), pixel_data.compress(),
+      pixel_data.generate_mipmaps(), pixel_data.atlas());
 }
 
+ParseOutput ParsePixelData(Device* device, render_tree::PixelImage* image) {
+  auto parsed_pixel_data =
+      std::make_shared<render_tree::PixelData>(device, std::move(*image));
+  if (!parsed_pixel_data->error().empty()) {
+    return ParseOutput(parsed_pixel_data->error());
+  }
+  // Textures are referenced by their base class.
+  return ParseOutput(
+      std::static_pointer_cast<render_tree::Texture>(parsed_pixel_data));
+}
 
-std::shared_ptr<render_tree::Texture> ParseTexture(
-    const entify_renderer::Texture& texture,
+// |pixel_image| is the prepared image of a PixelData texture.
+ParseOutput ParseTexture(
+    Device* device, EntifyId id, const entify_renderer::Texture& texture,
+    render_tree::PixelImage* pixel_image,
     const ExternalReferenceLookup& reference_lookup) {
   switch (texture.DerivedType_case()) {
     case entify_renderer::Texture::kRenderTarget:
-      return ParseRenderTarget(texture.render_target(), reference_lookup);
+      return ParseRenderTarget(
+          device, id, texture.render_target(), reference_lookup);
     case entify_renderer::Texture::kPixelData:
-      return ParsePixelData(texture.pixel_data());
+      return ParsePixelData(device, pixel_image);
     default:
       assert(false);
   }
 
-  return nullptr;
+  return ParseOutput("Unknown Texture type.");
 }
 }   // namespace
 
+PreparedProtocolBuffer::PreparedProtocolBuffer() {}
+PreparedProtocolBuffer::~PreparedProtocolBuffer() {}
+
+void PrepareProtocolBuffer(const Device* device, const char* data,
+                           size_t data_size,
+                           PreparedProtocolBuffer* prepared) {
+  prepared->node.reset(new entify_renderer::RendererNode());
+  prepared->node->ParseFromArray(data, data_size);
+
+  const entify_renderer::RendererNode& node = *prepared->node;
+  if (node.DerivedType_case() ==
+          entify_renderer::RendererNode::kTexture &&
+      node.texture().DerivedType_case() ==
+          entify_renderer::Texture::kPixelData) {
+    prepared->pixel_image.reset(new render_tree::PixelImage(
+        PreparePixelData(device, node.texture().pixel_data())));
+    // The image holds its own copy of the data.
+    prepared->node->mutable_texture()->mutable_pixel_data()->clear_data();
+  }
+  prepared->needs_context =
+      node.DerivedType_case() !=
+          entify_renderer::RendererNode::kUniformValues &&
+      node.DerivedType_case() != entify_renderer::RendererNode::kSampler;
+}
+
 ParseOutput ParseProtocolBuffer(
-    const ExternalReferenceLookup& reference_lookup,
-    const char* data, size_t data_size) {
-  entify_renderer::RendererNode node;
-  node.ParseFromArray(data, data_size);
+    Device* device, const ExternalReferenceLookup& reference_lookup,
+    EntifyId id, PreparedProtocolBuffer* prepared) {
+  const entify_renderer::RendererNode& node = *prepared->node;
 
   switch (node.DerivedType_case()) {
     case entify_renderer::RendererNode::kVertexBuffer: {
-      return ParseOutput(
-          ParseVertexBuffer(node.vertex_buffer()));
+      return ParseVertexBuffer(device, node.vertex_buffer());
     } break;
     case entify_renderer::RendererNode::kUniformValues: {
-      return ParseOutput(
-          ParseUniformValues(node.uniform_values(), reference_lookup));
+      return ParseUniformValues(node.uniform_values(), reference_lookup);
     } break;
     case entify_renderer::RendererNode::kGlslVertexShader: {
-      return ParseOutput(
-          ParseGLSLVertexShader(node.glsl_vertex_shader()));
+      return ParseGLSLVertexShader(device, node.glsl_vertex_shader());
     } break;
     case entify_renderer::RendererNode::kGlslFragmentShader: {
-      return ParseOutput(
-          ParseGLSLFragmentShader(node.glsl_fragment_shader()));
+      return ParseGLSLFragmentShader(device, node.glsl_fragment_shader());
     } break;
     case entify_renderer::RendererNode::kPipeline: {
       return ParseOutput(
-          ParsePipeline(node.pipeline(), reference_lookup));
+          ParsePipeline(device, node.pipeline(), reference_lookup));
     } break;
     case entify_renderer::RendererNode::kDrawTree: {
-      return ParseOutput(
-          ParseDrawTree(node.draw_tree(), reference_lookup));
+      return ParseDrawTree(id, node.draw_tree(), reference_lookup);
     } break;
     case entify_renderer::RendererNode::kSampler: {
-      return ParseOutput(
-          ParseSampler(node.sampler(), reference_lookup));
+      return ParseSampler(node.sampler(), reference_lookup);
     } break;
     case entify_renderer::RendererNode::kTexture: {
-      return ParseOutput(
-          ParseTexture(node.texture(), reference_lookup));
+      return ParseTexture(device, id, node.texture(),
+                          prepared->pixel_image.get(), reference_lookup);
+    } break;
+    case entify_renderer::RendererNode::kIndexBuffer: {
+      return ParseIndexBuffer(device, node.index_buffer());
     } break;
     default:
       assert(false);
@@ -0,0 +1,153 @@
+#include "src/renderer/gles2/pixel_conversion.h"
+
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+
+namespace entify {
+namespace renderer {
+namespace gles2 {
+
+namespace {
+// Multiplies the 8-bit |value| by |alpha| / 255, rounded to nearest.
+template <typename T>
+T MultiplyByAlpha(T value, T alpha) {
+  T product = value * alpha + 128u;
+  return (product + (product >> 8)) >> 8;
+}
+
+#if defined(__GNUC__) && defined(__BYTE_ORDER__) && \
+    __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+// GCC and Clang lower generic vectors to SSE2 on x86 and to NEON on ARM.
+// Each lane holds one RGBA pixel, loaded as a little endian value, so the
+// same source converts 4 pixels at a time on both.
+typedef uint32_t Uint32x4 __attribute__((vector_size(16)));
+#define ENTIFY_CONVERT_PIXEL_VECTORS
+
+Uint32x4 ConvertToRGBA(Uint32x4 pixels, ChannelOrder channel_order,
+                       bool premultiply_alpha) {
+  switch (channel_order) {
+    case kChannelOrderRGBA:
+      break;
+    case kChannelOrderBGRA:
+      pixels = (pixels & 0xff00ff00u) | ((pixels >> 16) & 0xffu) |
+               ((pixels & 0xffu) << 16);
+      break;
+    case kChannelOrderARGB:
+      pixels = (pixels >> 8) | (pixels << 24);
+      break;
+  }
+
+  if (premultiply_alpha) {
+    Uint32x4 alpha = pixels >> 24;
+    Uint32x4 result = pixels & 0xff000000u;
+    for (int shift = 0; shift < 24; shift += 8) {
+      result |= MultiplyByAlpha<Uint32x4>((pixels >> shift) & 0xffu, alpha)
+                << shift;
+    }
+    pixels = result;
+  }
+  return pixels;
+}
+#endif
+
+void ConvertRGBARow(const uint8_t* in, int width_in_pixels,
+                    ChannelOrder channel_order, bool premultiply_alpha,
+                    uint8_t* out) {
+  int x = 0;
+#if defined(ENTIFY_CONVERT_PIXEL_VECTORS)
+  for (; x + 4 <= width_in_pixels; x += 4) {
+    Uint32x4 pixels;
+    memcpy(&pixels, in + 4 * x, sizeof(pixels));
+    pixels = ConvertToRGBA(pixels, channel_order, premultiply_alpha);
+    memcpy(out + 4 * x, &pixels, sizeof(pixels));
+  }
+#endif
+
+  // The positions of R, G, B and A in the input pixels.
+  static const int kChannelPositions[3][4] = {
+    {0, 1, 2, 3},
+    {2, 1, 0, 3},
+    {1, 2, 3, 0},
+  };
+  const int* positions = kChannelPositions[channel_order];
+  for (; x < width_in_pixels; ++x) {
+    const uint8_t* pixel = in + 4 * x;
+    uint32_t alpha = pixel[positions[3]];
+    for (int c = 0; c < 3; ++c) {
+      uint32_t value = pixel[positions[c]];
+      out[4 * x + c] = static_cast<uint8_t>(
+          premultiply_alpha ? MultiplyByAlpha<uint32_t>(value, alpha) :
+                              value);
+    }
+    out[4 * x + 3] = static_cast<uint8_t>(alpha);
+  }
+}
+
+void ConvertBGRRow(const uint8_t* in, int width_in_pixels, uint8_t* out) {
+  for (int x = 0; x < width_in_pixels; ++x) {
+    out[3 * x] = in[3 * x + 2];
+    out[3 * x + 1] = in[3 * x + 1];
+    out[3 * x + 2] = in[3 * x];
+  }
+}
+}  // namespace
+
+void ConvertPixelRows(const char* data, int width_in_pixels, int num_rows,
+                      int stride_in_bytes, int bytes_per_pixel,
+                      bool reverse_rows, ChannelOrder channel_order,
+                      bool premultiply_alpha, char* out) {
+  assert(bytes_per_pixel == 4 || !premultiply_alpha);
+  assert(bytes_per_pixel == 4 || bytes_per_pixel == 3 ||
+         channel_order == kChannelOrderRGBA);
+  assert(bytes_per_pixel != 3 || channel_order != kChannelOrderARGB);
+
+  int row_size = width_in_pixels * bytes_per_pixel;
+  for (int row = 0; row < num_rows; ++row) {
+    const uint8_t* in_row = reinterpret_cast<const uint8_t*>(data) +
+        static_cast<int64_t>(reverse_rows ? num_rows - 1 - row : row) *
+            stride_in_bytes;
+    uint8_t* out_row =
+        reinterpret_cast<uint8_t*>(out) + static_cast<int64_t>(row) * row_size;
+    if (bytes_per_pixel == 4 &&
+        (channel_order != kChannelOrderRGBA || premultiply_alpha)) {
+      ConvertRGBARow(in_row, width_in_pixels, channel_order,
+                     premultiply_alpha, out_row);
+    } else if (bytes_per_pixel == 3 && channel_order == kChannelOrderBGRA) {
+      ConvertBGRRow(in_row, width_in_pixels, out_row);
+    } else {
+      memcpy(out_row, in_row, row_size);
+    }
+  }
+}
+
+void DownsamplePixels(const char* data, int width_in_pixels,
+                      int height_in_pixels, int bytes_per_pixel, char* out) {
+  int out_width = width_in_pixels > 1 ? width_in_pixels / 2 : 1;
+  int out_height = height_in_pixels > 1 ? height_in_pixels / 2 : 1;
+  int stride = width_in_pixels * bytes_per_pixel;
+  // Images that are 1 pixel wide or high are only averaged in the other
+  // direction.
+  int next_column = width_in_pixels > 1 ? bytes_per_pixel : 0;
+  int next_row = height_in_pixels > 1 ? stride : 0;
+
+  const uint8_t* in = reinterpret_cast<const uint8_t*>(data);
+  uint8_t* out_pixels = reinterpret_cast<uint8_t*>(out);
+  for (int y = 0; y < out_height; ++y) {
+    const uint8_t* in_row = in + static_cast<int64_t>(2 * y) * stride;
+    uint8_t* out_row =
+        out_pixels + static_cast<int64_t>(y) * out_width * bytes_per_pixel;
+    for (int i = 0; i < out_width * bytes_per_pixel; ++i) {
+      const uint8_t* top_left =
+          in_row + (i / bytes_per_pixel) * 2 * bytes_per_pixel +
+          i % bytes_per_pixel;
+      out_row[i] = static_cast<uint8_t>(
+          (top_left[0] + top_left[next_column] + top_left[next_row] +
+           top_left[next_row + next_column] + 2) >> 2);
+    }
+  }
+}
+
+}  // namespace gles2
+}  // namespace renderer
+}  // namespace entify
@@ -0,0 +1,39 @@
+#ifndef _SRC_ENTIFY_RENDERER_GLES2_PIXEL_CONVERSION_H_
+#define _SRC_ENTIFY_RENDERER_GLES2_PIXEL_CONVERSION_H_
+
+namespace entify {
+namespace renderer {
+namespace gles2 {
+
+// The order of the channels of 8-bit RGB and RGBA pixels in memory.  Without
+// alpha, kChannelOrderBGRA stands for BGR, and kChannelOrderARGB is invalid.
+enum ChannelOrder {
+  kChannelOrderRGBA,
+  kChannelOrderBGRA,
+  kChannelOrderARGB,
+};
+
+// Rewrites the |num_rows| rows of |width_in_pixels| pixels of
+// |bytes_per_pixel| bytes each at |data|, which are |stride_in_bytes| apart,
+// into the tightly packed rows that GL takes at |out|.  The rows are written
+// in reverse if |reverse_rows| is set.  RGB and RGBA pixels, which are 3 and
+// 4 bytes, have their channels reordered from |channel_order| to RGBA, and
+// with |premultiply_alpha|, RGBA pixels also have their colors multiplied by
+// their alpha.  Other pixels must keep the defaults.
+void ConvertPixelRows(const char* data, int width_in_pixels, int num_rows,
+                      int stride_in_bytes, int bytes_per_pixel,
+                      bool reverse_rows, ChannelOrder channel_order,
+                      bool premultiply_alpha, char* out);
+
+// Writes the next mipmap of the tightly packed image at |data|, whose pixels
+// are |bytes_per_pixel| 8-bit channels, to |out|.  The mipmap is half the
+// size, rounded down to at least 1, and each of its pixels averages the 2x2
+// pixels that it covers.
+void DownsamplePixels(const char* data, int width_in_pixels,
+                      int height_in_pixels, int bytes_per_pixel, char* out);
+
+}  // namespace gles2
+}  // namespace renderer
+}  // namespace entify
+
+#endif  // _SRC_ENTIFY_RENDERER_GLES2_PIXEL_CONVERSION_H_
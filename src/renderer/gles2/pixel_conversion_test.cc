@@ -0,0 +1,209 @@
+#include "src/renderer/gles2/pixel_conversion.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace entify {
+namespace renderer {
+namespace gles2 {
+
+namespace {
+struct ConversionCase {
+  const char* name;
+  int width_in_pixels;
+  int num_rows;
+  int stride_in_bytes;
+  int bytes_per_pixel;
+  bool reverse_rows;
+  ChannelOrder channel_order;
+  bool premultiply_alpha;
+  std::vector<uint8_t> in;
+  std::vector<uint8_t> expected;
+};
+
+// Bytes marked 0xee are row padding, which must not be copied.
+const ConversionCase kConversionCases[] = {
+  {"RGBA is copied", 2, 1, 8, 4, false, kChannelOrderRGBA, false,
+   {1, 2, 3, 4, 5, 6, 7, 8},
+   {1, 2, 3, 4, 5, 6, 7, 8}},
+  {"padding at the end of rows is skipped", 1, 2, 6, 4, false,
+   kChannelOrderRGBA, false,
+   {1, 2, 3, 4, 0xee, 0xee,
+    5, 6, 7, 8},
+   {1, 2, 3, 4, 5, 6, 7, 8}},
+  {"reversed rows put the last row first", 1, 3, 4, 4, true,
+   kChannelOrderRGBA, false,
+   {1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3},
+   {3, 3, 3, 3, 2, 2, 2, 2, 1, 1, 1, 1}},
+  {"reversed rows skip their padding", 2, 2, 7, 3, true, kChannelOrderRGBA,
+   false,
+   {1, 2, 3, 4, 5, 6, 0xee,
+    7, 8, 9, 10, 11, 12},
+   {7, 8, 9, 10, 11, 12, 1, 2, 3, 4, 5, 6}},
+  {"BGRA is swizzled", 2, 1, 8, 4, false, kChannelOrderBGRA, false,
+   {3, 2, 1, 4, 7, 6, 5, 8},
+   {1, 2, 3, 4, 5, 6, 7, 8}},
+  {"ARGB is swizzled", 2, 1, 8, 4, false, kChannelOrderARGB, false,
+   {4, 1, 2, 3, 8, 5, 6, 7},
+   {1, 2, 3, 4, 5, 6, 7, 8}},
+  {"BGR is swizzled", 2, 1, 6, 3, false, kChannelOrderBGRA, false,
+   {3, 2, 1, 6, 5, 4},
+   {1, 2, 3, 4, 5, 6}},
+  {"single channel pixels are copied", 3, 2, 4, 1, true, kChannelOrderRGBA,
+   false,
+   {1, 2, 3, 0xee,
+    4, 5, 6},
+   {4, 5, 6, 1, 2, 3}},
+  {"premultiplied colors round to nearest", 4, 1, 16, 4, false,
+   kChannelOrderRGBA, true,
+   {255, 128, 1, 255,
+    255, 128, 1, 0,
+    255, 128, 2, 128,
+    200, 100, 50, 51},
+   {255, 128, 1, 255,
+    0, 0, 0, 0,
+    128, 64, 1, 128,
+    40, 20, 10, 51}},
+  {"premultiplied ARGB takes alpha from the first byte", 1, 1, 4, 4, false,
+   kChannelOrderARGB, true,
+   {128, 255, 128, 2},
+   {128, 64, 1, 128}},
+  {"premultiplied BGRA keeps the rows reversed", 1, 2, 4, 4, true,
+   kChannelOrderBGRA, true,
+   {0, 0, 255, 255,
+    2, 128, 255, 128},
+   {128, 64, 1, 128, 255, 0, 0, 255}},
+};
+
+std::vector<uint8_t> Convert(const ConversionCase& test_case) {
+  std::vector<uint8_t> out(test_case.width_in_pixels * test_case.num_rows *
+                           test_case.bytes_per_pixel);
+  ConvertPixelRows(reinterpret_cast<const char*>(test_case.in.data()),
+                   test_case.width_in_pixels, test_case.num_rows,
+                   test_case.stride_in_bytes, test_case.bytes_per_pixel,
+                   test_case.reverse_rows, test_case.channel_order,
+                   test_case.premultiply_alpha,
+                   reinterpret_cast<char*>(out.data()));
+  return out;
+}
+
+// The RGBA pixel at the start of |pixel| in |channel_order|, converted one
+// channel at a time.
+std::vector<uint8_t> ReferenceRGBA(const uint8_t* pixel,
+                                   ChannelOrder channel_order,
+                                   bool premultiply_alpha) {
+  static const int kChannelPositions[3][4] = {
+    {0, 1, 2, 3},
+    {2, 1, 0, 3},
+    {1, 2, 3, 0},
+  };
+  const int* positions = kChannelPositions[channel_order];
+  int alpha = pixel[positions[3]];
+  std::vector<uint8_t> rgba;
+  for (int c = 0; c < 3; ++c) {
+    int value = pixel[positions[c]];
+    rgba.push_back(static_cast<uint8_t>(
+        premultiply_alpha ? (value * alpha * 2 + 255) / (255 * 2) : value));
+  }
+  rgba.push_back(static_cast<uint8_t>(alpha));
+  return rgba;
+}
+}  // namespace
+
+TEST(PixelConversionTests, ConvertPixelRows) {
+  for (const ConversionCase& test_case : kConversionCases) {
+    EXPECT_EQ(test_case.expected, Convert(test_case)) << test_case.name;
+  }
+}
+
+TEST(PixelConversionTests, ConvertedRowsMatchPerPixelConversion) {
+  // Rows of up to 9 pixels cover both the pixels that are converted 4 at a
+  // time and the ones left over.
+  const ChannelOrder kChannelOrders[] = {
+    kChannelOrderRGBA, kChannelOrderBGRA, kChannelOrderARGB,
+  };
+  const int kNumRows = 3;
+  for (int width = 1; width <= 9; ++width) {
+    int stride = width * 4 + 5;
+    std::vector<uint8_t> in(stride * kNumRows);
+    for (size_t i = 0; i < in.size(); ++i) {
+      in[i] = static_cast<uint8_t>(i * 37 + 11);
+    }
+    for (ChannelOrder channel_order : kChannelOrders) {
+      for (bool premultiply_alpha : {false, true}) {
+        for (bool reverse_rows : {false, true}) {
+          std::vector<uint8_t> expected;
+          for (int row = 0; row < kNumRows; ++row) {
+            int in_row = reverse_rows ? kNumRows - 1 - row : row;
+            for (int x = 0; x < width; ++x) {
+              std::vector<uint8_t> pixel = ReferenceRGBA(
+                  &in[in_row * stride + x * 4], channel_order,
+                  premultiply_alpha);
+              expected.insert(expected.end(), pixel.begin(), pixel.end());
+            }
+          }
+
+          ConversionCase test_case = {
+            "", width, kNumRows, stride, 4, reverse_rows, channel_order,
+            premultiply_alpha, in, {}};
+          EXPECT_EQ(expected, Convert(test_case))
+              << "width " << width << " channel order " << channel_order
+              << (premultiply_alpha ? " premultiplied" : "")
+              << (reverse_rows ? " reversed" : "");
+        }
+      }
+    }
+  }
+}
+
+TEST(PixelConversionTests, DownsamplePixels) {
+  struct DownsampleCase {
+    const char* name;
+    int width_in_pixels;
+    int height_in_pixels;
+    int bytes_per_pixel;
+    std::vector<uint8_t> in;
+    std::vector<uint8_t> expected;
+  };
+  const DownsampleCase kCases[] = {
+    {"2x2 pixels average to one, rounded to nearest", 2, 2, 2,
+     {0, 10, 1, 20,
+      2, 30, 3, 41},
+     {2, 25}},
+    {"odd sizes drop the last column and row", 3, 3, 1,
+     {4, 8, 99,
+      12, 16, 99,
+      99, 99, 99},
+     {10}},
+    {"one pixel high images average pairs", 4, 1, 1,
+     {10, 20, 30, 41},
+     {15, 36}},
+    {"one pixel wide images average pairs", 1, 4, 1,
+     {10, 20, 30, 41},
+     {15, 36}},
+    {"one pixel stays as it is", 1, 1, 3,
+     {1, 2, 3},
+     {1, 2, 3}},
+  };
+
+  for (const DownsampleCase& test_case : kCases) {
+    int out_width =
+        test_case.width_in_pixels > 1 ? test_case.width_in_pixels / 2 : 1;
+    int out_height =
+        test_case.height_in_pixels > 1 ? test_case.height_in_pixels / 2 : 1;
+    std::vector<uint8_t> out(out_width * out_height *
+                             test_case.bytes_per_pixel);
+    DownsamplePixels(reinterpret_cast<const char*>(test_case.in.data()),
+                     test_case.width_in_pixels, test_case.height_in_pixels,
+                     test_case.bytes_per_pixel,
+                     reinterpret_cast<char*>(out.data()));
+    EXPECT_EQ(test_case.expected, out) << test_case.name;
+  }
+}
+
+}  // namespace gles2
+}  // namespace renderer
+}  // namespace entify
@@ -1,16 +1,24 @@
 #include "src/renderer/gles2/render.h"
 
+#include <algorithm>
 #include <cassert>
+#include <chrono>
+#include <cstdint>
+#include <utility>
+#include <vector>
 
 #include "src/renderer/gles2/render_tree/draw_call.h"
 #include "src/renderer/gles2/render_tree/draw_sequence.h"
+#include "src/renderer/gles2/render_tree/draw_template.h"
 #include "src/renderer/gles2/render_tree/fragment_shader.h"
+#include "src/renderer/gles2/render_tree/index_buffer.h"
 #include "src/renderer/gles2/render_tree/program.h"
 #include "src/renderer/gles2/render_tree/types.h"
 #include "src/renderer/gles2/render_tree/uniform_values.h"
 #include "src/renderer/gles2/render_tree/vertex_buffer.h"
 #include "src/renderer/gles2/render_tree/vertex_shader.h"
 #include "src/renderer/gles2/utils.h"
+#include "src/trace_log/trace_log.h"
 
 namespace entify {
 namespace renderer {
@@ -29,31 +37,38 @@ void SetBlendOptions(const render_tree::Pipeline::Params::Blend& blend) {
   }
 }
 
-void UseProgram(const std::shared_ptr<render_tree::Program>& program) {
+void UseProgram(const std::shared_ptr<render_tree::Program>& program,
+                EntifyFrameStats* stats) {
   GL_CALL(glUseProgram(program->handle()));
+  ++stats->program_switches;
 }
 
-void WriteUniformData(render_tree::Type type, GLint location, const char* data) {
-  switch(type) {
+void WriteUniformData(render_tree::Type type, GLint location, const char* data,
+                      EntifyFrameStats* stats) {
+  ++stats->uniform_uploads;
+  // Arrays are uploaded with a single call for all of their elements.
+  GLsizei count = std::max(1, render_tree::TypeArrayLength(type));
+  switch(render_tree::TypeArrayElementType(type)) {
     case render_tree::TypeFloat32V1: {
       GL_CALL(glUniform1fv(
-          location, 1, reinterpret_cast<const GLfloat*>(data)));
+          location, count, reinterpret_cast<const GLfloat*>(data)));
     } break;
     case render_tree::TypeFloat32V2: {
       GL_CALL(glUniform2fv(
-          location, 1, reinterpret_cast<const GLfloat*>(data)));
+          location, count, reinterpret_cast<const GLfloat*>(data)));
     } break;
     case render_tree::TypeFloat32V3: {
       GL_CALL(glUniform3fv(
-          location, 1, reinterpret_cast<const GLfloat*>(data)));
+          location, count, reinterpret_cast<const GLfloat*>(data)));
     } break;
     case render_tree::TypeFloat32V4: {
       GL_CALL(glUniform4fv(
-          location, 1, reinterpret_cast<const GLfloat*>(data)));
+          location, count, reinterpret_cast<const GLfloat*>(data)));
     } break;
     case render_tree::TypeFloat32M44: {
       GL_CALL(glUniformMatrix4fv(
-          location, 1, GL_FALSE, reinterpret_cast<const GLfloat*>(data)));
+          location, count, GL_FALSE,
+          reinterpret_cast<const GLfloat*>(data)));
     } break;
     default: {
       assert(false);
@@ -61,87 +76,201 @@ void WriteUniformData(render_tree::Type type, GLint location, const char* data)
   }
 }
 
+// Sets a parameter of the bound texture, unless |*current| shows that it
+// already has |value|.
+void SetTextureParameter(GLenum name, GLenum value, GLenum* current) {
+  if (*current != value) {
+    GL_CALL(glTexParameteri(GL_TEXTURE_2D, name, value));
+    *current = value;
+  }
+}
+
+// |bound_textures| holds the texture bound to each texture unit during the
+// pass, or 0 where that is not known yet.  Textures that share an atlas page
+// share its handle, so samplers of those only bind it once.  The sampler
+// uniform itself was pointed at its texture unit when the program was
+// linked.  |uv_transform| is the UV transform last uploaded for the sampler.
 void SetSampler(
-    GLint location, int sampler_index,
-    const std::shared_ptr<render_tree::Sampler>& sampler) {
+    GLint uv_transform_location, render_tree::UVTransform* uv_transform,
+    int sampler_index, const std::shared_ptr<render_tree::Sampler>& sampler,
+    std::vector<GLuint>* bound_textures, EntifyFrameStats* stats) {
+  const auto& texture = sampler->texture();
   GL_CALL(glActiveTexture(GL_TEXTURE0 + sampler_index));
-  GL_CALL(glBindTexture(GL_TEXTURE_2D, sampler->texture()->handle()));
-
-  GL_CALL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, sampler->wrap_s()));
-  GL_CALL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, sampler->wrap_t()));
-  GL_CALL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER,
-                          sampler->min_filter()));
-  GL_CALL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER,
-                          sampler->mag_filter()));
+  if (bound_textures->size() <= static_cast<size_t>(sampler_index)) {
+    bound_textures->resize(sampler_index + 1, 0);
+  }
+  if ((*bound_textures)[sampler_index] != texture->handle()) {
+    GL_CALL(glBindTexture(GL_TEXTURE_2D, texture->handle()));
+    (*bound_textures)[sampler_index] = texture->handle();
+    ++stats->texture_binds;
+  }
 
-  GL_CALL(glUniform1i(location, sampler_index));
+  TextureParameters* parameters = texture->parameters();
+  SetTextureParameter(
+      GL_TEXTURE_WRAP_S, sampler->wrap_s(), &parameters->wrap_s);
+  SetTextureParameter(
+      GL_TEXTURE_WRAP_T, sampler->wrap_t(), &parameters->wrap_t);
+  SetTextureParameter(
+      GL_TEXTURE_MIN_FILTER, sampler->min_filter(), &parameters->min_filter);
+  SetTextureParameter(
+      GL_TEXTURE_MAG_FILTER, sampler->mag_filter(), &parameters->mag_filter);
+
+  if (uv_transform_location != -1 &&
+      *uv_transform != texture->uv_transform()) {
+    *uv_transform = texture->uv_transform();
+    GLfloat value[] = {uv_transform->scale_x, uv_transform->scale_y,
+                       uv_transform->offset_x, uv_transform->offset_y};
+    GL_CALL(glUniform4fv(uv_transform_location, 1, value));
+    ++stats->uniform_uploads;
+  }
 }
 
 void WriteUniformsData(
     const render_tree::TypeTuple& types,
-    const std::vector<GLint>& locations, const char* data,
-    const std::vector<std::shared_ptr<render_tree::Sampler>>& samplers) {
+    const std::vector<GLint>& locations,
+    const std::vector<GLint>& uv_transform_locations,
+    std::vector<render_tree::UVTransform>* uv_transforms, const char* data,
+    const std::vector<std::shared_ptr<render_tree::Sampler>>& samplers,
+    std::vector<GLuint>* bound_textures, EntifyFrameStats* stats) {
   int data_offset = 0;
   int sampler_index = 0;
   for (size_t i = 0; i < types.size(); ++i) {
     const render_tree::Type& type = types[i];
 
     if (type == render_tree::TypeSampler) {
-      SetSampler(locations[i], sampler_index, samplers[sampler_index]);
+      SetSampler(uv_transform_locations[sampler_index],
+                 &(*uv_transforms)[sampler_index], sampler_index,
+                 samplers[sampler_index], bound_textures, stats);
       ++sampler_index;
     } else {
-      WriteUniformData(type, locations[i], data + data_offset);
+      WriteUniformData(type, locations[i], data + data_offset, stats);
       data_offset += TypeToSize(type);
     }
   }
 }
 
 void SetVertexShaderUniforms(
-    const std::vector<GLint>& locations,
-    const std::shared_ptr<render_tree::UniformValues>& vertex_shader_uniforms) {
+    render_tree::Program* program,
+    const std::shared_ptr<render_tree::UniformValues>& vertex_shader_uniforms,
+    std::vector<GLuint>* bound_textures, EntifyFrameStats* stats) {
   if (!vertex_shader_uniforms) {
     return;
   }
 
   WriteUniformsData(vertex_shader_uniforms->types(), 
-                    locations,
+                    program->vertex_uniform_locations(),
+                    program->vertex_uv_transform_locations(),
+                    program->vertex_uv_transforms(),
                     vertex_shader_uniforms->data().data(),
-                    vertex_shader_uniforms->samplers());
+                    vertex_shader_uniforms->samplers(), bound_textures,
+                    stats);
 }
 
 void SetFragmentShaderUniforms(
-    const std::vector<GLint>& locations,
+    render_tree::Program* program,
     const std::shared_ptr<render_tree::UniformValues>&
-        fragment_shader_uniforms) {
+        fragment_shader_uniforms,
+    std::vector<GLuint>* bound_textures, EntifyFrameStats* stats) {
   if (!fragment_shader_uniforms) {
     return;
   }
 
   WriteUniformsData(fragment_shader_uniforms->types(), 
-                    locations,
+                    program->fragment_uniform_locations(),
+                    program->fragment_uv_transform_locations(),
+                    program->fragment_uv_transforms(),
                     fragment_shader_uniforms->data().data(),
-                    fragment_shader_uniforms->samplers());
+                    fragment_shader_uniforms->samplers(), bound_textures,
+                    stats);
+}
+
+// The vertex that the attribute pointers are set up to start at.  Indexed
+// draws can not be given a first vertex, so their attributes have to start
+// at the vertex buffer's first vertex within its GL buffer.
+int32_t VertexAttributesBase(const render_tree::DrawCall* draw_call) {
+  return draw_call->index_buffer() ?
+      draw_call->vertex_buffer()->first_vertex() : 0;
 }
 
 void SetVertexBuffer(
     const std::vector<GLint>& indices,
-    const std::shared_ptr<render_tree::VertexBuffer>& vertex_buffer) {
+    const std::shared_ptr<render_tree::VertexBuffer>& vertex_buffer,
+    int32_t base_vertex, EntifyFrameStats* stats) {
   GL_CALL(glBindBuffer(GL_ARRAY_BUFFER, vertex_buffer->handle()));
+  ++stats->buffer_binds;
 
   const render_tree::TypeTuple& types = vertex_buffer->types();
   const std::vector<int32_t>& data_offsets = vertex_buffer->data_offsets();
+  intptr_t base_offset =
+      static_cast<intptr_t>(base_vertex) * vertex_buffer->stride_in_bytes();
   for (size_t i = 0; i < types.size(); ++i) {
     GL_CALL(glEnableVertexAttribArray(indices[i]));
     GL_CALL(glVertexAttribPointer(
         indices[i], TypeToComponentCount(types[i]), TypeToGLType(types[i]),
-        GL_FALSE, vertex_buffer->stride_in_bytes(),
-        reinterpret_cast<void*>(data_offsets[i])));
+        TypeIsNormalized(types[i]) ? GL_TRUE : GL_FALSE,
+        vertex_buffer->stride_in_bytes(),
+        reinterpret_cast<void*>(base_offset + data_offsets[i])));
+  }
+}
+
+// Whether |draw_call| can be drawn with the vertex attributes that were set
+// up for |previous_draw_call|.  This is the case if their vertex buffers share
+// a GL buffer and layout, and the attributes are bound to the same indices
+// and start at the same vertex.
+bool SharesVertexAttributes(const render_tree::DrawCall* previous_draw_call,
+                            const render_tree::DrawCall* draw_call) {
+  const auto& previous_vertex_buffer = previous_draw_call->vertex_buffer();
+  const auto& vertex_buffer = draw_call->vertex_buffer();
+  if (previous_vertex_buffer->handle() != vertex_buffer->handle() ||
+      previous_vertex_buffer->layout() != vertex_buffer->layout() ||
+      VertexAttributesBase(previous_draw_call) !=
+          VertexAttributesBase(draw_call)) {
+    return false;
+  }
+
+  const auto& previous_program = previous_draw_call->pipeline()->program();
+  const auto& program = draw_call->pipeline()->program();
+  return previous_program == program ||
+         previous_program->vertex_attribute_indices() ==
+             program->vertex_attribute_indices();
+}
+
+// Binds the cached vertex array object for the vertex attributes and index
+// buffer of |draw_call|, setting it up first if it is new, and pointing its
+// attributes at the first vertex of |draw_call| if they start elsewhere.
+void BindVertexArray(VertexArrayCache* vertex_arrays,
+                     const render_tree::DrawCall* draw_call,
+                     EntifyFrameStats* stats) {
+  const auto& attribute_indices =
+      draw_call->pipeline()->program()->vertex_attribute_indices();
+  const auto& vertex_buffer = draw_call->vertex_buffer();
+  const auto& index_buffer = draw_call->index_buffer();
+
+  VertexArrayCache::Key key;
+  key.buffer = vertex_buffer->handle();
+  key.layout = vertex_buffer->layout();
+  key.element_buffer = index_buffer ? index_buffer->handle() : 0;
+  key.attribute_indices = attribute_indices;
+  int32_t base_vertex = VertexAttributesBase(draw_call);
+  VertexArrayCache::BindResult result = vertex_arrays->Bind(key, base_vertex);
+  if (result == VertexArrayCache::kBound) {
+    ++stats->buffer_binds;
+    return;
+  }
+
+  SetVertexBuffer(attribute_indices, vertex_buffer, base_vertex, stats);
+  if (result == VertexArrayCache::kCreated && index_buffer) {
+    GL_CALL(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, index_buffer->handle()));
+    ++stats->buffer_binds;
   }
 }
 
+// |vertex_arrays| is null if vertex array objects are not to be used.
 void TransitionToGLState(
     const render_tree::DrawCall* previous_draw_call,
-    const render_tree::DrawCall* draw_call) {
+    const render_tree::DrawCall* draw_call,
+    VertexArrayCache* vertex_arrays, std::vector<GLuint>* bound_textures,
+    EntifyFrameStats* stats) {
   bool pipeline_dirty = !previous_draw_call ||
                         previous_draw_call->pipeline() != draw_call->pipeline();
 
@@ -162,91 +291,280 @@ void TransitionToGLState(
                   != draw_call->pipeline()->program()->fragment_shader());
 
   if (program_dirty) {
-    UseProgram(draw_call->pipeline()->program());
+    UseProgram(draw_call->pipeline()->program(), stats);
   }
 
   if (program_dirty ||
       previous_draw_call->vertex_uniform_values() !=
           draw_call->vertex_uniform_values()) {
     SetVertexShaderUniforms(
-        draw_call->pipeline()->program()->vertex_uniform_locations(),
-        draw_call->vertex_uniform_values());
+        draw_call->pipeline()->program().get(),
+        draw_call->vertex_uniform_values(), bound_textures, stats);
   }
 
   if (program_dirty ||
       previous_draw_call->fragment_uniform_values() !=
       draw_call->fragment_uniform_values()) {
     SetFragmentShaderUniforms(
-        draw_call->pipeline()->program()->fragment_uniform_locations(),
-        draw_call->fragment_uniform_values());
+        draw_call->pipeline()->program().get(),
+        draw_call->fragment_uniform_values(), bound_textures, stats);
+  }
+
+  bool vertex_attributes_dirty =
+      !previous_draw_call ||
+      !SharesVertexAttributes(previous_draw_call, draw_call);
+  // Draws that are not indexed do not care which index buffer is bound.
+  const auto& index_buffer = draw_call->index_buffer();
+  bool index_buffer_dirty =
+      index_buffer && (!previous_draw_call ||
+                       previous_draw_call->index_buffer() != index_buffer);
+
+  if (vertex_arrays) {
+    if (vertex_attributes_dirty || index_buffer_dirty) {
+      BindVertexArray(vertex_arrays, draw_call, stats);
+    }
+    return;
   }
 
-  if (!previous_draw_call ||
-      previous_draw_call->vertex_buffer() != draw_call->vertex_buffer()) {
+  if (vertex_attributes_dirty) {
     SetVertexBuffer(
         draw_call->pipeline()->program()->vertex_attribute_indices(),
-        draw_call->vertex_buffer());
+        draw_call->vertex_buffer(), VertexAttributesBase(draw_call), stats);
+  }
+  if (index_buffer_dirty) {
+    GL_CALL(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, index_buffer->handle()));
+    ++stats->buffer_binds;
   }
 }
 
-const render_tree::DrawCall* RenderDrawTree(
-    const render_tree::DrawCall* previous_draw_call,
-    const render_tree::DrawTree* draw_tree);
-
-const render_tree::DrawCall* RenderDrawCall(
-    const render_tree::DrawCall* previous_draw_call,
-    const render_tree::DrawCall* draw_call) {
-  TransitionToGLState(previous_draw_call, draw_call);
-
-  GL_CALL(glDrawArrays(
-      GL_TRIANGLES, 0, draw_call->vertex_buffer()->num_vertices()));
+// Issues the draw calls in [|begin|, |end|).  |*previous_draw_call| is the
+// draw call that was issued before them, or nullptr, and is updated to the
+// last one issued.
+void ExecuteDrawCalls(
+    const render_tree::DrawCall* const* begin,
+    const render_tree::DrawCall* const* end,
+    const render_tree::DrawCall** previous_draw_call,
+    VertexArrayCache* vertex_arrays, std::vector<GLuint>* bound_textures,
+    EntifyFrameStats* stats) {
+  for (auto iter = begin; iter != end; ++iter) {
+    const render_tree::DrawCall* draw_call = *iter;
+    TransitionToGLState(*previous_draw_call, draw_call, vertex_arrays,
+                        bound_textures, stats);
+
+    const auto& vertex_buffer = draw_call->vertex_buffer();
+    const auto& index_buffer = draw_call->index_buffer();
+    GLenum mode = draw_call->pipeline()->params().primitive_mode;
+    int32_t num_vertices;
+    if (index_buffer) {
+      num_vertices = index_buffer->num_indices();
+      GL_CALL(glDrawElements(
+          mode, num_vertices, index_buffer->type(), nullptr));
+    } else {
+      num_vertices = vertex_buffer->num_vertices();
+      GL_CALL(glDrawArrays(
+          mode, vertex_buffer->first_vertex(), num_vertices));
+    }
+    ++stats->draw_calls;
+    stats->vertices += num_vertices;
 
-  return draw_call;
+    *previous_draw_call = draw_call;
+  }
 }
 
-const render_tree::DrawCall* RenderDrawSequence(
-    const render_tree::DrawCall* previous_draw_call,
-    const render_tree::DrawSequence* draw_sequence) {
-  const render_tree::DrawCall* last_draw_call = previous_draw_call;
-
-  for (const auto& draw_tree : draw_sequence->sequence()) {
-    last_draw_call = RenderDrawTree(last_draw_call, draw_tree.get());
+// Streams the data of the transient vertex buffers drawn by |draw_calls|
+// for the pass that is about to draw them.
+void StreamTransientVertexBuffers(
+    StreamVertexBuffer* stream,
+    const std::vector<const render_tree::DrawCall*>& draw_calls) {
+  stream->Begin();
+  for (const render_tree::DrawCall* draw_call : draw_calls) {
+    const auto& vertex_buffer = draw_call->vertex_buffer();
+    if (vertex_buffer->transient()) {
+      vertex_buffer->Stream(stream);
+    }
   }
+  stream->End();
+}
 
-  return last_draw_call;
+double MillisecondsBetween(std::chrono::steady_clock::time_point start,
+                           std::chrono::steady_clock::time_point end) {
+  return std::chrono::duration<double, std::milli>(end - start).count();
 }
+}  // namespace
 
-const render_tree::DrawCall* RenderDrawTree(
-    const render_tree::DrawCall* previous_draw_call,
-    const render_tree::DrawTree* draw_tree) {
+void FlattenDrawTree(const render_tree::DrawTree* draw_tree,
+                     std::vector<const render_tree::DrawCall*>* draw_calls) {
   switch (draw_tree->type()) {
     case render_tree::DrawTree::kTypeDrawCall: {
-      return RenderDrawCall(
-          previous_draw_call,
+      draw_calls->push_back(
           static_cast<const render_tree::DrawCall*>(draw_tree));
     } break;
     case render_tree::DrawTree::kTypeDrawSequence: {
-      return RenderDrawSequence(
-          previous_draw_call,
-          static_cast<const render_tree::DrawSequence*>(draw_tree));
+      const auto* draw_sequence =
+          static_cast<const render_tree::DrawSequence*>(draw_tree);
+      if (auto cached_draw_calls = draw_sequence->cached_draw_calls()) {
+        draw_calls->insert(draw_calls->end(), cached_draw_calls->begin(),
+                           cached_draw_calls->end());
+      } else {
+        for (const auto& child : draw_sequence->sequence()) {
+          FlattenDrawTree(child.get(), draw_calls);
+        }
+      }
     } break;
     case render_tree::DrawTree::kTypeDrawSet: {
       assert(false);  // Not implemented.
     } break;
+    case render_tree::DrawTree::kTypeDrawTemplate: {
+      const auto& template_draw_calls =
+          static_cast<const render_tree::DrawTemplate*>(draw_tree)->
+              draw_calls();
+      draw_calls->insert(draw_calls->end(), template_draw_calls.begin(),
+                         template_draw_calls.end());
+    } break;
+    case render_tree::DrawTree::kTypeDrawTemplateInstance: {
+      const auto& instance_draw_calls =
+          static_cast<const render_tree::DrawTemplateInstance*>(draw_tree)->
+              draw_calls();
+      draw_calls->insert(draw_calls->end(), instance_draw_calls.begin(),
+                         instance_draw_calls.end());
+    } break;
   }
+}
 
-  return nullptr;
+bool ContainsDrawTree(const render_tree::DrawTree* draw_tree,
+                      const render_tree::DrawTree* target) {
+  if (draw_tree == target) {
+    return true;
+  }
+
+  switch (draw_tree->type()) {
+    case render_tree::DrawTree::kTypeDrawCall: {
+      return false;
+    } break;
+    case render_tree::DrawTree::kTypeDrawSequence: {
+      for (const auto& child :
+               static_cast<const render_tree::DrawSequence*>(draw_tree)->
+                   sequence()) {
+        if (ContainsDrawTree(child.get(), target)) {
+          return true;
+        }
+      }
+      return false;
+    } break;
+    case render_tree::DrawTree::kTypeDrawSet: {
+      assert(false);  // Not implemented.
+    } break;
+    case render_tree::DrawTree::kTypeDrawTemplate: {
+      return ContainsDrawTree(
+          static_cast<const render_tree::DrawTemplate*>(draw_tree)->
+              draw_tree().get(),
+          target);
+    } break;
+    case render_tree::DrawTree::kTypeDrawTemplateInstance: {
+      return ContainsDrawTree(
+          static_cast<const render_tree::DrawTemplateInstance*>(draw_tree)->
+              draw_template().get(),
+          target);
+    } break;
+  }
+
+  assert(false);
+  return false;
 }
-}  // namespace
 
-void Render(int width, int height,
+void Render(Device* device, int width, int height,
             const std::shared_ptr<render_tree::DrawTree>& draw_tree) {
-  GL_CALL(glViewport(0, 0, width, height));
-  GL_CALL(glScissor(0, 0, width, height));
-  GL_CALL(glClearColor(0.0f, 0.0f, 0.0f, 0.0f));
-  GL_CALL(glClear(GL_COLOR_BUFFER_BIT));
+  EntifyFrameStats* stats = device->frame_stats();
+
+  // The tree is walked up front so that the time spent traversing it can be
+  // told apart from the time spent issuing GL commands.
+  auto walk_start = std::chrono::steady_clock::now();
+  std::vector<const render_tree::DrawCall*> draw_calls;
+  // The GPU time of each child of a top level DrawSequence is measured
+  // separately.  Each is paired with the end of its range of draw calls.
+  std::vector<std::pair<const render_tree::DrawTree*, size_t>> timed_trees;
+  {
+    ScopedTraceEvent trace_event("gles2", "WalkDrawTree");
+    if (draw_tree->type() == render_tree::DrawTree::kTypeDrawSequence) {
+      const auto* draw_sequence =
+          static_cast<const render_tree::DrawSequence*>(draw_tree.get());
+      const auto& sequence = draw_sequence->sequence();
+      if (auto cached_draw_calls = draw_sequence->cached_draw_calls()) {
+        draw_calls = *cached_draw_calls;
+        size_t end = 0;
+        for (size_t i = 0; i < sequence.size(); ++i) {
+          end += draw_sequence->child_draw_call_counts()[i];
+          timed_trees.emplace_back(sequence[i].get(), end);
+        }
+      } else {
+        for (const auto& child : sequence) {
+          FlattenDrawTree(child.get(), &draw_calls);
+          timed_trees.emplace_back(child.get(), draw_calls.size());
+        }
+      }
+    } else {
+      FlattenDrawTree(draw_tree.get(), &draw_calls);
+      timed_trees.emplace_back(draw_tree.get(), draw_calls.size());
+    }
+  }
+  {
+    ScopedTraceEvent trace_event("gles2", "BatchDrawCalls");
+    std::vector<const render_tree::DrawCall*> batched_draw_calls;
+    std::vector<size_t> sources;
+    batched_draw_calls.reserve(draw_calls.size());
+    sources.reserve(draw_calls.size());
+    device->static_batcher()->BatchDrawCalls(
+        draw_calls.data(), draw_calls.data() + draw_calls.size(),
+        &batched_draw_calls, &sources);
+    draw_calls.swap(batched_draw_calls);
+
+    // A batch may span several timed trees, in which case its time is
+    // accounted to the tree that it starts in.
+    size_t end = 0;
+    for (auto& timed_tree : timed_trees) {
+      while (end < sources.size() && sources[end] < timed_tree.second) {
+        ++end;
+      }
+      timed_tree.second = end;
+    }
+  }
+
+  auto execute_start = std::chrono::steady_clock::now();
+  {
+    ScopedTraceEvent trace_event("gles2", "ExecuteDrawCalls");
+    trace_event.AddArg("draw_calls", draw_calls.size());
+
+    StreamTransientVertexBuffers(device->stream_vertex_buffer(), draw_calls);
+
+    GL_CALL(glViewport(0, 0, width, height));
+    GL_CALL(glScissor(0, 0, width, height));
+    GL_CALL(glClearColor(0.0f, 0.0f, 0.0f, 0.0f));
+    GL_CALL(glClear(GL_COLOR_BUFFER_BIT));
+
+    VertexArrayCache* vertex_arrays =
+        device->vertex_array_cache()->BeginPass() ?
+            device->vertex_array_cache() : nullptr;
+    const render_tree::DrawCall* previous_draw_call = nullptr;
+    std::vector<GLuint> bound_textures;
+    size_t begin = 0;
+    for (const auto& timed_tree : timed_trees) {
+      ScopedGPUTimer gpu_timer(
+          device->gpu_timer(), kEntifyGPUTimingTypeDrawTree,
+          timed_tree.first->id());
+      ExecuteDrawCalls(draw_calls.data() + begin,
+                       draw_calls.data() + timed_tree.second,
+                       &previous_draw_call, vertex_arrays, &bound_textures,
+                       stats);
+      begin = timed_tree.second;
+    }
+    if (vertex_arrays) {
+      vertex_arrays->EndPass();
+    }
+  }
+  auto execute_end = std::chrono::steady_clock::now();
 
-  RenderDrawTree(nullptr, draw_tree.get());
+  stats->tree_walk_ms += MillisecondsBetween(walk_start, execute_start);
+  stats->gl_submission_ms += MillisecondsBetween(execute_start, execute_end);
 }
 
 }  // namespace gles2
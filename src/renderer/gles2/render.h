@@ -2,14 +2,28 @@
 #define _SRC_ENTIFY_RENDERER_GLES2_RENDER_H_
 
 #include <memory>
+#include <vector>
 
+#include "src/renderer/gles2/device.h"
+#include "src/renderer/gles2/render_tree/draw_call.h"
 #include "src/renderer/gles2/render_tree/draw_tree.h"
 
 namespace entify {
 namespace renderer {
 namespace gles2 {
 
-void Render(int width, int height,
+// Appends the draw calls of |draw_tree| to |draw_calls| in the order in
+// which they are to be issued.
+void FlattenDrawTree(const render_tree::DrawTree* draw_tree,
+                     std::vector<const render_tree::DrawCall*>* draw_calls);
+
+// Returns true if |target| is |draw_tree| or one of its descendants.
+bool ContainsDrawTree(const render_tree::DrawTree* draw_tree,
+                      const render_tree::DrawTree* target);
+
+// Renders |draw_tree| into the currently bound framebuffer, accounting the
+// work to |device|'s frame stats.
+void Render(Device* device, int width, int height,
             const std::shared_ptr<render_tree::DrawTree>& draw_tree);
 
 }  // namespace gles2
@@ -1,7 +1,10 @@
 #include "src/renderer/gles2/render_tree/draw_call.h"
 
 #include <cassert>
+#include <string>
+#include <vector>
 
+#include "src/renderer/gles2/render_tree/sampler.h"
 #include "src/renderer/gles2/render_tree/types.h"
 
 namespace entify {
@@ -9,15 +12,68 @@ namespace renderer {
 namespace gles2 {
 namespace render_tree {
 
+namespace {
+// Returns an error if one of the samplers of |uniform_values| samples an
+// atlased texture, but the shader with |uniform_names| and |uniform_types|
+// declares no UV transform for it, without which it would sample the whole
+// atlas page, or if the sampler wraps or mipmaps the texture.
+std::string CheckUVTransforms(
+    const std::vector<std::string>& uniform_names,
+    const TypeTuple& uniform_types,
+    const std::vector<GLint>& uv_transform_locations,
+    const UniformValues* uniform_values) {
+  if (!uniform_values) {
+    return "";
+  }
+
+  size_t sampler_index = 0;
+  for (size_t i = 0; i < uniform_types.size(); ++i) {
+    if (uniform_types[i] != TypeSampler) {
+      continue;
+    }
+    const Sampler& sampler = *uniform_values->samplers()[sampler_index];
+    GLint uv_transform_location = uv_transform_locations[sampler_index];
+    ++sampler_index;
+    if (!sampler.texture()->atlased()) {
+      continue;
+    }
+
+    if (uv_transform_location == -1) {
+      return "DrawCall samples an atlased texture with '" +
+             uniform_names[i] + "', but its shader does not declare the "
+             "vec4 uniform '" + uniform_names[i] + "_uv_transform'.";
+    }
+    // Wrapping would reach into the neighbouring images, and mipmaps would
+    // blend them in.
+    if (sampler.wrap_s() != GL_CLAMP_TO_EDGE ||
+        sampler.wrap_t() != GL_CLAMP_TO_EDGE) {
+      return "DrawCall samples an atlased texture with '" +
+             uniform_names[i] + "', but its sampler does not clamp both "
+             "coordinates to the edge.";
+    }
+    if (sampler.requested_min_filter() != GL_NEAREST &&
+        sampler.requested_min_filter() != GL_LINEAR) {
+      return "DrawCall samples an atlased texture with '" +
+             uniform_names[i] + "', but its sampler has a mipmapped min "
+             "filter.";
+    }
+  }
+  return "";
+}
+}  // namespace
+
 DrawCall::DrawCall(
     const std::shared_ptr<Pipeline>& pipeline,
     const std::shared_ptr<VertexBuffer>& vertex_buffer,
     const std::shared_ptr<UniformValues>& vertex_uniform_values,
-    const std::shared_ptr<UniformValues>& fragment_uniform_values)
+    const std::shared_ptr<UniformValues>& fragment_uniform_values,
+    const std::shared_ptr<IndexBuffer>& index_buffer)
     : DrawTree(DrawTree::kTypeDrawCall), pipeline_(pipeline),
       vertex_buffer_(vertex_buffer),
       vertex_uniform_values_(vertex_uniform_values),
-      fragment_uniform_values_(fragment_uniform_values) {
+      fragment_uniform_values_(fragment_uniform_values),
+      index_buffer_(index_buffer ?
+          index_buffer : vertex_buffer->welded_index_buffer()) {
   // Do type checking.
   assert(pipeline->program()->vertex_shader()->input_types() ==
              vertex_buffer->types());
@@ -33,6 +89,40 @@ DrawCall::DrawCall(
   } else {
     assert(pipeline->program()->fragment_shader()->uniform_types().empty());
   }
+
+  if (index_buffer_ != vertex_buffer_->welded_index_buffer() &&
+      vertex_buffer_->welded_index_buffer()) {
+    error_ = "DrawCall has an index buffer, but its vertex buffer was "
+             "welded, which renumbers the vertices.";
+  } else if (index_buffer_ && index_buffer_->num_referenced_vertices() >
+                                  vertex_buffer_->num_vertices()) {
+    error_ = "DrawCall index buffer refers to " +
+             std::to_string(index_buffer_->num_referenced_vertices()) +
+             " vertices, but the vertex buffer only has " +
+             std::to_string(vertex_buffer_->num_vertices()) + ".";
+  } else if (pipeline_->params().primitive_mode != GL_TRIANGLES &&
+             (vertex_buffer_->welded_index_buffer() ||
+              (index_buffer_ && index_buffer_->vertex_cache_optimized()))) {
+    // Both reorder the triangles of a triangle list.
+    error_ = "DrawCall indices were optimized for the vertex cache, so its "
+             "pipeline must draw triangles.";
+  }
+
+  const Program& program = *pipeline_->program();
+  if (error_.empty()) {
+    error_ = CheckUVTransforms(
+        program.vertex_shader()->uniform_names(),
+        program.vertex_shader()->uniform_types(),
+        program.vertex_uv_transform_locations(),
+        vertex_uniform_values_.get());
+  }
+  if (error_.empty()) {
+    error_ = CheckUVTransforms(
+        program.fragment_shader()->uniform_names(),
+        program.fragment_shader()->uniform_types(),
+        program.fragment_uv_transform_locations(),
+        fragment_uniform_values_.get());
+  }
 }
 
 }  // namespace render_tree
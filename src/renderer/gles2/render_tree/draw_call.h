@@ -2,10 +2,12 @@
 #define _SRC_ENTIFY_RENDERER_GLES2_RENDER_TREE_DRAW_CALL_H_
 
 #include <memory>
+#include <string>
 
 #include <GLES2/gl2.h>
 
 #include "src/renderer/gles2/render_tree/draw_tree.h"
+#include "src/renderer/gles2/render_tree/index_buffer.h"
 #include "src/renderer/gles2/render_tree/pipeline.h"
 #include "src/renderer/gles2/render_tree/vertex_buffer.h"
 #include "src/renderer/gles2/render_tree/uniform_values.h"
@@ -20,7 +22,8 @@ class DrawCall : public DrawTree {
   DrawCall(const std::shared_ptr<Pipeline>& pipeline,
            const std::shared_ptr<VertexBuffer>& vertex_buffer,
            const std::shared_ptr<UniformValues>& vertex_uniform_values,
-           const std::shared_ptr<UniformValues>& fragment_uniform_values);
+           const std::shared_ptr<UniformValues>& fragment_uniform_values,
+           const std::shared_ptr<IndexBuffer>& index_buffer = nullptr);
 
   ~DrawCall() {}
 
@@ -36,12 +39,22 @@ class DrawCall : public DrawTree {
   const std::shared_ptr<UniformValues>& fragment_uniform_values() const {
     return fragment_uniform_values_;
   }
+  // The indices to draw the vertex buffer through, or null to draw its
+  // vertices in order.  This is the vertex buffer's own index buffer if it
+  // was welded.
+  const std::shared_ptr<IndexBuffer>& index_buffer() const {
+    return index_buffer_;
+  }
+
+  const std::string& error() const { return error_; }
 
  private:
   std::shared_ptr<Pipeline> pipeline_;
   std::shared_ptr<VertexBuffer> vertex_buffer_;
   std::shared_ptr<UniformValues> vertex_uniform_values_;
   std::shared_ptr<UniformValues> fragment_uniform_values_;
+  std::shared_ptr<IndexBuffer> index_buffer_;
+  std::string error_;
 };
 
 }  // namespace render_tree
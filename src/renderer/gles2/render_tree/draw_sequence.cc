@@ -0,0 +1,131 @@
+#include "src/renderer/gles2/render_tree/draw_sequence.h"
+
+#include <cassert>
+#include <numeric>
+
+#include "src/renderer/gles2/render.h"
+
+namespace entify {
+namespace renderer {
+namespace gles2 {
+namespace render_tree {
+
+namespace {
+// DrawTemplates and their instances are flattened when they are created, so
+// only sequences can change what is drawn below them.
+bool CanChange(const DrawTree* draw_tree) {
+  return draw_tree->type() == DrawTree::kTypeDrawSequence &&
+         static_cast<const DrawSequence*>(draw_tree)->
+             contains_updatable_sequence();
+}
+}  // namespace
+
+DrawSequence::DrawSequence(
+    std::vector<std::shared_ptr<DrawTree>>&& sequence, bool updatable)
+    : DrawTree(kTypeDrawSequence), sequence_(std::move(sequence)),
+      updatable_(updatable), num_changeable_children_(0),
+      has_cached_draw_calls_(false) {
+  for (const auto& child : sequence_) {
+    if (CanChange(child.get())) {
+      ++num_changeable_children_;
+    }
+  }
+  UpdateCacheState();
+}
+
+bool DrawSequence::Insert(
+    size_t index, const std::shared_ptr<DrawTree>& draw_tree) {
+  assert(updatable_);
+  if (index > sequence_.size()) {
+    return false;
+  }
+
+  sequence_.insert(sequence_.begin() + index, draw_tree);
+  if (CanChange(draw_tree.get())) {
+    ++num_changeable_children_;
+  }
+  SpliceCachedDrawCalls(index, false, draw_tree.get());
+  UpdateCacheState();
+  return true;
+}
+
+bool DrawSequence::Remove(size_t index) {
+  assert(updatable_);
+  if (index >= sequence_.size()) {
+    return false;
+  }
+
+  if (CanChange(sequence_[index].get())) {
+    --num_changeable_children_;
+  }
+  sequence_.erase(sequence_.begin() + index);
+  SpliceCachedDrawCalls(index, true, nullptr);
+  UpdateCacheState();
+  return true;
+}
+
+bool DrawSequence::Replace(
+    size_t index, const std::shared_ptr<DrawTree>& draw_tree) {
+  assert(updatable_);
+  if (index >= sequence_.size()) {
+    return false;
+  }
+
+  if (CanChange(sequence_[index].get())) {
+    --num_changeable_children_;
+  }
+  if (CanChange(draw_tree.get())) {
+    ++num_changeable_children_;
+  }
+  sequence_[index] = draw_tree;
+  SpliceCachedDrawCalls(index, true, draw_tree.get());
+  UpdateCacheState();
+  return true;
+}
+
+void DrawSequence::SpliceCachedDrawCalls(
+    size_t index, bool remove, const DrawTree* insert) {
+  if (!has_cached_draw_calls_) {
+    return;
+  }
+
+  auto first = cached_draw_calls_.begin() + std::accumulate(
+      child_draw_call_counts_.begin(),
+      child_draw_call_counts_.begin() + index, size_t(0));
+  if (remove) {
+    first = cached_draw_calls_.erase(
+        first, first + child_draw_call_counts_[index]);
+    child_draw_call_counts_.erase(child_draw_call_counts_.begin() + index);
+  }
+  if (insert) {
+    std::vector<const DrawCall*> draw_calls;
+    FlattenDrawTree(insert, &draw_calls);
+    cached_draw_calls_.insert(first, draw_calls.begin(), draw_calls.end());
+    child_draw_call_counts_.insert(
+        child_draw_call_counts_.begin() + index, draw_calls.size());
+  }
+}
+
+void DrawSequence::UpdateCacheState() {
+  bool should_cache = updatable_ && num_changeable_children_ == 0;
+  if (should_cache == has_cached_draw_calls_) {
+    return;
+  }
+
+  has_cached_draw_calls_ = should_cache;
+  cached_draw_calls_.clear();
+  child_draw_call_counts_.clear();
+  if (has_cached_draw_calls_) {
+    child_draw_call_counts_.reserve(sequence_.size());
+    for (const auto& child : sequence_) {
+      size_t begin = cached_draw_calls_.size();
+      FlattenDrawTree(child.get(), &cached_draw_calls_);
+      child_draw_call_counts_.push_back(cached_draw_calls_.size() - begin);
+    }
+  }
+}
+
+}  // namespace render_tree
+}  // namespace gles2
+}  // namespace renderer
+}  // namespace entify
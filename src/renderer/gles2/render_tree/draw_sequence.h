@@ -2,9 +2,11 @@
 #define _SRC_ENTIFY_RENDERER_GLES2_RENDER_TREE_DRAW_SEQUENCE_H_
 
 #include <memory>
+#include <vector>
 
 #include <GLES2/gl2.h>
 
+#include "src/renderer/gles2/render_tree/draw_call.h"
 #include "src/renderer/gles2/render_tree/draw_tree.h"
 
 namespace entify {
@@ -14,16 +16,59 @@ namespace render_tree {
 
 class DrawSequence : public DrawTree {
  public:
-  DrawSequence(std::vector<std::shared_ptr<DrawTree>>&& sequence)
-      : DrawTree(kTypeDrawSequence), sequence_(std::move(sequence)) {}
+  // If |updatable| is set, children can later be inserted, removed and
+  // replaced in place.
+  DrawSequence(std::vector<std::shared_ptr<DrawTree>>&& sequence,
+               bool updatable = false);
   ~DrawSequence() {}
 
   const std::vector<std::shared_ptr<DrawTree>>& sequence() const {
     return sequence_;
   }
 
+  bool updatable() const { return updatable_; }
+  // Whether this sequence, or any sequence below it, is updatable, i.e.
+  // whether the draw calls of the sequence can change.
+  bool contains_updatable_sequence() const {
+    return updatable_ || num_changeable_children_ > 0;
+  }
+
+  // Edits of updatable sequences.  |draw_tree| must not contain this
+  // sequence.  Return false, leaving the sequence as it is, if |index| is
+  // out of range.
+  bool Insert(size_t index, const std::shared_ptr<DrawTree>& draw_tree);
+  bool Remove(size_t index);
+  bool Replace(size_t index, const std::shared_ptr<DrawTree>& draw_tree);
+
+  // An updatable sequence none of whose children can change keeps its
+  // flattened draw calls up to date through edits, so that they do not need
+  // to be gathered from the tree every frame.  Returns nullptr if there is no
+  // such list.
+  const std::vector<const DrawCall*>* cached_draw_calls() const {
+    return has_cached_draw_calls_ ? &cached_draw_calls_ : nullptr;
+  }
+  // The number of entries that each child has in cached_draw_calls().
+  const std::vector<size_t>& child_draw_call_counts() const {
+    return child_draw_call_counts_;
+  }
+
  private:
+  // Updates the cached draw calls, if there are any, for the removal of the
+  // child at |index| if |remove| is set, followed by the insertion of
+  // |insert| at |index| if it is not null.
+  void SpliceCachedDrawCalls(size_t index, bool remove,
+                             const DrawTree* insert);
+  // Starts or stops caching draw calls as the children change.
+  void UpdateCacheState();
+
   std::vector<std::shared_ptr<DrawTree>> sequence_;
+  bool updatable_;
+  // The number of children whose draw calls can change.
+  int num_changeable_children_;
+
+  bool has_cached_draw_calls_;
+  std::vector<const DrawCall*> cached_draw_calls_;
+  std::vector<size_t> child_draw_call_counts_;
 };
 
 }  // namespace render_tree
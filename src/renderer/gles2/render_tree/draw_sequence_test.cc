@@ -0,0 +1,256 @@
+#include "src/renderer/gles2/render_tree/draw_sequence.h"
+
+#include <memory>
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "src/renderer/gles2/device.h"
+#include "src/renderer/gles2/fake_gl_for_testing.h"
+#include "src/renderer/gles2/render.h"
+#include "src/renderer/gles2/render_tree/fragment_shader.h"
+#include "src/renderer/gles2/render_tree/program.h"
+#include "src/renderer/gles2/render_tree/vertex_shader.h"
+
+namespace entify {
+namespace renderer {
+namespace gles2 {
+namespace render_tree {
+
+namespace {
+typedef std::vector<std::shared_ptr<DrawTree>> DrawTrees;
+
+// Flattens |draw_tree| without using any cached draw calls.
+void FlattenWithoutCache(const DrawTree* draw_tree,
+                         std::vector<const DrawCall*>* draw_calls) {
+  if (draw_tree->type() == DrawTree::kTypeDrawCall) {
+    draw_calls->push_back(static_cast<const DrawCall*>(draw_tree));
+    return;
+  }
+  ASSERT_EQ(DrawTree::kTypeDrawSequence, draw_tree->type());
+  for (const auto& child :
+       static_cast<const DrawSequence*>(draw_tree)->sequence()) {
+    FlattenWithoutCache(child.get(), draw_calls);
+  }
+}
+
+std::vector<const DrawCall*> FlattenWithoutCache(const DrawTree* draw_tree) {
+  std::vector<const DrawCall*> draw_calls;
+  FlattenWithoutCache(draw_tree, &draw_calls);
+  return draw_calls;
+}
+
+// Checks that the cached draw calls of |sequence| and the counts of its
+// children agree with flattening the tree from scratch.
+void ExpectCacheIsUpToDate(const DrawSequence& sequence) {
+  const std::vector<const DrawCall*>* cached = sequence.cached_draw_calls();
+  ASSERT_NE(nullptr, cached);
+  EXPECT_EQ(FlattenWithoutCache(&sequence), *cached);
+
+  ASSERT_EQ(sequence.sequence().size(),
+            sequence.child_draw_call_counts().size());
+  for (size_t i = 0; i < sequence.sequence().size(); ++i) {
+    EXPECT_EQ(FlattenWithoutCache(sequence.sequence()[i].get()).size(),
+              sequence.child_draw_call_counts()[i]);
+  }
+
+  std::vector<const DrawCall*> flattened;
+  FlattenDrawTree(&sequence, &flattened);
+  EXPECT_EQ(*cached, flattened);
+}
+
+class DrawSequenceTests : public ::testing::Test {
+ protected:
+  DrawSequenceTests() {
+    auto vertex_shader = std::make_shared<VertexShader>(
+        &device_, "",
+        std::make_pair(std::vector<std::string>{"a_position"},
+                       TypeTuple{TypeFloat32V2}),
+        TypeTuple{}, std::make_pair(std::vector<std::string>{}, TypeTuple{}));
+    auto fragment_shader = std::make_shared<FragmentShader>(
+        &device_, "", TypeTuple{},
+        std::make_pair(std::vector<std::string>{}, TypeTuple{}));
+    Pipeline::Params params;
+    params.blend = {GL_ONE, GL_ZERO, GL_ONE, GL_ZERO};
+    params.primitive_mode = GL_TRIANGLES;
+    pipeline_ = std::make_shared<Pipeline>(
+        std::make_shared<Program>(&device_, vertex_shader, fragment_shader),
+        params);
+
+    const float kVertices[6] = {0, 0, 1, 0, 0, 1};
+    vertex_buffer_ = std::make_shared<VertexBuffer>(
+        &device_, reinterpret_cast<const char*>(kVertices),
+        sizeof(kVertices), 8, std::vector<int32_t>{0},
+        TypeTuple{TypeFloat32V2});
+  }
+
+  std::shared_ptr<DrawTree> MakeDrawCall() {
+    return std::make_shared<DrawCall>(
+        pipeline_, vertex_buffer_, nullptr, nullptr);
+  }
+
+  // A sequence of |num_draw_calls| new draw calls.
+  std::shared_ptr<DrawSequence> MakeSequence(size_t num_draw_calls,
+                                             bool updatable = false) {
+    DrawTrees children;
+    for (size_t i = 0; i < num_draw_calls; ++i) {
+      children.push_back(MakeDrawCall());
+    }
+    return std::make_shared<DrawSequence>(std::move(children), updatable);
+  }
+
+  ScopedFakeGL fake_gl_;
+  Device device_;
+  std::shared_ptr<Pipeline> pipeline_;
+  std::shared_ptr<VertexBuffer> vertex_buffer_;
+};
+}  // namespace
+
+TEST_F(DrawSequenceTests, OnlyUpdatableSequencesCacheDrawCalls) {
+  EXPECT_EQ(nullptr, MakeSequence(3)->cached_draw_calls());
+
+  std::shared_ptr<DrawSequence> sequence = MakeSequence(3, true);
+  EXPECT_EQ(3u, sequence->cached_draw_calls()->size());
+  ExpectCacheIsUpToDate(*sequence);
+}
+
+TEST_F(DrawSequenceTests, InsertKeepsTheCacheUpToDate) {
+  DrawSequence sequence(DrawTrees(), true);
+  ExpectCacheIsUpToDate(sequence);
+
+  // Into an empty sequence, then at the end, the front and the middle.
+  EXPECT_TRUE(sequence.Insert(0, MakeDrawCall()));
+  ExpectCacheIsUpToDate(sequence);
+  EXPECT_TRUE(sequence.Insert(1, MakeSequence(3)));
+  ExpectCacheIsUpToDate(sequence);
+  EXPECT_TRUE(sequence.Insert(0, MakeSequence(2)));
+  ExpectCacheIsUpToDate(sequence);
+  EXPECT_TRUE(sequence.Insert(2, MakeSequence(0)));
+  ExpectCacheIsUpToDate(sequence);
+  EXPECT_TRUE(sequence.Insert(2, MakeDrawCall()));
+  ExpectCacheIsUpToDate(sequence);
+
+  EXPECT_EQ(5u, sequence.sequence().size());
+  EXPECT_EQ(7u, sequence.cached_draw_calls()->size());
+}
+
+TEST_F(DrawSequenceTests, RemoveKeepsTheCacheUpToDate) {
+  DrawSequence sequence(
+      DrawTrees{MakeSequence(2), MakeDrawCall(), MakeSequence(3),
+                MakeDrawCall(), MakeSequence(1)},
+      true);
+
+  // From the middle, the end and the front, until it is empty.
+  EXPECT_TRUE(sequence.Remove(2));
+  ExpectCacheIsUpToDate(sequence);
+  EXPECT_TRUE(sequence.Remove(3));
+  ExpectCacheIsUpToDate(sequence);
+  EXPECT_TRUE(sequence.Remove(0));
+  ExpectCacheIsUpToDate(sequence);
+  EXPECT_TRUE(sequence.Remove(1));
+  ExpectCacheIsUpToDate(sequence);
+  EXPECT_TRUE(sequence.Remove(0));
+  ExpectCacheIsUpToDate(sequence);
+  EXPECT_TRUE(sequence.cached_draw_calls()->empty());
+}
+
+TEST_F(DrawSequenceTests, ReplaceKeepsTheCacheUpToDate) {
+  DrawSequence sequence(
+      DrawTrees{MakeDrawCall(), MakeSequence(2), MakeDrawCall()}, true);
+
+  // With more, fewer and the same number of draw calls.
+  EXPECT_TRUE(sequence.Replace(0, MakeSequence(4)));
+  ExpectCacheIsUpToDate(sequence);
+  EXPECT_TRUE(sequence.Replace(1, MakeSequence(0)));
+  ExpectCacheIsUpToDate(sequence);
+  EXPECT_TRUE(sequence.Replace(2, MakeDrawCall()));
+  ExpectCacheIsUpToDate(sequence);
+  EXPECT_EQ(5u, sequence.cached_draw_calls()->size());
+}
+
+TEST_F(DrawSequenceTests, OutOfRangeEditsChangeNothing) {
+  DrawSequence sequence(DrawTrees{MakeDrawCall(), MakeSequence(2)}, true);
+  std::vector<const DrawCall*> before = *sequence.cached_draw_calls();
+
+  EXPECT_FALSE(sequence.Insert(3, MakeDrawCall()));
+  EXPECT_FALSE(sequence.Remove(2));
+  EXPECT_FALSE(sequence.Replace(2, MakeDrawCall()));
+  EXPECT_FALSE(sequence.Insert(static_cast<size_t>(-1), MakeDrawCall()));
+  EXPECT_FALSE(sequence.Remove(static_cast<size_t>(-1)));
+
+  EXPECT_EQ(2u, sequence.sequence().size());
+  EXPECT_EQ(before, *sequence.cached_draw_calls());
+  ExpectCacheIsUpToDate(sequence);
+
+  DrawSequence empty(DrawTrees(), true);
+  EXPECT_FALSE(empty.Remove(0));
+  EXPECT_FALSE(empty.Replace(0, MakeDrawCall()));
+  ExpectCacheIsUpToDate(empty);
+}
+
+TEST_F(DrawSequenceTests, UpdatableChildrenStopTheCaching) {
+  DrawSequence sequence(DrawTrees{MakeDrawCall(), MakeSequence(2)}, true);
+
+  std::shared_ptr<DrawSequence> child = MakeSequence(1, true);
+  EXPECT_TRUE(sequence.Insert(1, child));
+  EXPECT_EQ(nullptr, sequence.cached_draw_calls());
+  EXPECT_TRUE(sequence.contains_updatable_sequence());
+
+  // Edits of the child show up in the parent, which flattens it each time.
+  EXPECT_TRUE(child->Insert(0, MakeSequence(3)));
+  std::vector<const DrawCall*> flattened;
+  FlattenDrawTree(&sequence, &flattened);
+  EXPECT_EQ(FlattenWithoutCache(&sequence), flattened);
+  EXPECT_EQ(7u, flattened.size());
+
+  // Other edits while the caching is off are picked up once it is back on.
+  EXPECT_TRUE(sequence.Remove(0));
+  EXPECT_TRUE(sequence.Insert(2, MakeSequence(2)));
+  EXPECT_TRUE(sequence.Remove(0));
+  ExpectCacheIsUpToDate(sequence);
+  EXPECT_EQ(4u, sequence.cached_draw_calls()->size());
+
+  // Replacing a plain child with an updatable one stops it again, and
+  // replacing it back restarts it.
+  EXPECT_TRUE(sequence.Replace(0, MakeSequence(1, true)));
+  EXPECT_EQ(nullptr, sequence.cached_draw_calls());
+  EXPECT_TRUE(sequence.Replace(0, MakeDrawCall()));
+  ExpectCacheIsUpToDate(sequence);
+}
+
+TEST_F(DrawSequenceTests, RandomEditsKeepTheCacheUpToDate) {
+  DrawSequence sequence(DrawTrees(), true);
+  std::mt19937 random(42);
+  for (int i = 0; i < 500; ++i) {
+    size_t size = sequence.sequence().size();
+    // Indices up to two past the end, so that some edits are out of range.
+    size_t index = std::uniform_int_distribution<size_t>(0, size + 2)(random);
+    std::shared_ptr<DrawTree> draw_tree =
+        random() % 2 ? MakeDrawCall() : MakeSequence(random() % 4);
+    bool in_range = false;
+    switch (random() % 3) {
+      case 0: {
+        in_range = sequence.Insert(index, draw_tree);
+        EXPECT_EQ(index <= size, in_range);
+      } break;
+      case 1: {
+        in_range = sequence.Remove(index);
+        EXPECT_EQ(index < size, in_range);
+      } break;
+      case 2: {
+        in_range = sequence.Replace(index, draw_tree);
+        EXPECT_EQ(index < size, in_range);
+      } break;
+    }
+    ExpectCacheIsUpToDate(sequence);
+    if (HasFailure()) {
+      FAIL() << "after edit " << i;
+    }
+  }
+}
+
+}  // namespace render_tree
+}  // namespace gles2
+}  // namespace renderer
+}  // namespace entify
@@ -0,0 +1,171 @@
+#include "src/renderer/gles2/render_tree/draw_template.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <string>
+
+#include "src/renderer/gles2/render.h"
+#include "src/renderer/gles2/render_tree/draw_sequence.h"
+#include "src/renderer/gles2/render_tree/types.h"
+
+namespace entify {
+namespace renderer {
+namespace gles2 {
+namespace render_tree {
+
+namespace {
+bool UsesUniformValues(const DrawCall* draw_call,
+                       const UniformValues* uniform_values) {
+  return draw_call->vertex_uniform_values().get() == uniform_values ||
+         draw_call->fragment_uniform_values().get() == uniform_values;
+}
+}  // namespace
+
+DrawTemplate::DrawTemplate(const std::shared_ptr<DrawTree>& draw_tree,
+                           const std::vector<ParameterBinding>& bindings)
+    : DrawTree(kTypeDrawTemplate), draw_tree_(draw_tree),
+      parameters_size_in_bytes_(0) {
+  // The flattened draw calls point into the draw tree, so it must not be
+  // able to change underneath them.
+  if (draw_tree_->type() == kTypeDrawSequence &&
+      static_cast<const DrawSequence*>(draw_tree_.get())->
+          contains_updatable_sequence()) {
+    error_ = "A DrawTemplate's draw tree can not contain an updatable "
+             "DrawSequence.";
+    return;
+  }
+
+  FlattenDrawTree(draw_tree_.get(), &draw_calls_);
+
+  parameters_.reserve(bindings.size());
+  for (const auto& binding : bindings) {
+    if (!binding.uniform_values) {
+      error_ = "DrawTemplate parameter '" + binding.name +
+               "' does not refer to a UniformValues node.";
+      return;
+    }
+
+    const TypeTuple& types = binding.uniform_values->types();
+    if (binding.uniform_index < 0 ||
+        binding.uniform_index >= static_cast<int>(types.size())) {
+      error_ = "DrawTemplate parameter '" + binding.name +
+               "' has an out of range uniform index.";
+      return;
+    }
+    if (types[binding.uniform_index] == TypeSampler) {
+      error_ = "DrawTemplate parameter '" + binding.name +
+               "' is bound to a sampler, which is not supported.";
+      return;
+    }
+
+    auto bound = std::find_if(
+        bound_uniform_values_.begin(), bound_uniform_values_.end(),
+        [&binding](const BoundUniformValues& x) {
+          return x.uniform_values == binding.uniform_values;
+        });
+    if (bound == bound_uniform_values_.end()) {
+      BoundUniformValues new_bound;
+      new_bound.uniform_values = binding.uniform_values;
+      for (size_t i = 0; i < draw_calls_.size(); ++i) {
+        if (UsesUniformValues(draw_calls_[i], binding.uniform_values.get())) {
+          new_bound.draw_call_indices.push_back(i);
+        }
+      }
+      if (new_bound.draw_call_indices.empty()) {
+        error_ = "DrawTemplate parameter '" + binding.name +
+                 "' is bound to UniformValues that the template's draw tree "
+                 "does not use.";
+        return;
+      }
+      bound = bound_uniform_values_.insert(
+          bound_uniform_values_.end(), std::move(new_bound));
+    }
+
+    // Samplers have no data, so they are skipped when locating the value.
+    size_t data_offset = 0;
+    for (int i = 0; i < binding.uniform_index; ++i) {
+      if (types[i] != TypeSampler) {
+        data_offset += TypeToSize(types[i]);
+      }
+    }
+
+    Parameter parameter;
+    parameter.name = binding.name;
+    parameter.bound_uniform_values_index =
+        bound - bound_uniform_values_.begin();
+    parameter.data_offset_in_bytes = data_offset;
+    parameter.size_in_bytes = TypeToSize(types[binding.uniform_index]);
+    parameter.block_offset_in_bytes = parameters_size_in_bytes_;
+    parameters_size_in_bytes_ += parameter.size_in_bytes;
+    parameters_.push_back(parameter);
+  }
+}
+
+DrawTemplateInstance::DrawTemplateInstance(
+    const std::shared_ptr<DrawTemplate>& draw_template,
+    const char* parameters, size_t parameters_size)
+    : DrawTree(kTypeDrawTemplateInstance), draw_template_(draw_template),
+      draw_calls_(draw_template->draw_calls()) {
+  if (parameters_size != draw_template_->parameters_size_in_bytes()) {
+    error_ = "DrawTemplateInstance parameters are " +
+             std::to_string(parameters_size) + " bytes, but the template "
+             "expects " +
+             std::to_string(draw_template_->parameters_size_in_bytes()) +
+             ".";
+    return;
+  }
+
+  const auto& bound_uniform_values = draw_template_->bound_uniform_values();
+  std::vector<std::vector<char>> data;
+  data.reserve(bound_uniform_values.size());
+  for (const auto& bound : bound_uniform_values) {
+    data.push_back(bound.uniform_values->data());
+  }
+  for (const auto& parameter : draw_template_->parameters()) {
+    memcpy(data[parameter.bound_uniform_values_index].data() +
+               parameter.data_offset_in_bytes,
+           parameters + parameter.block_offset_in_bytes,
+           parameter.size_in_bytes);
+  }
+
+  uniform_values_.reserve(bound_uniform_values.size());
+  for (size_t i = 0; i < bound_uniform_values.size(); ++i) {
+    const UniformValues& original = *bound_uniform_values[i].uniform_values;
+    uniform_values_.push_back(std::make_shared<UniformValues>(
+        TypeTuple(original.types()), std::move(data[i]),
+        std::vector<std::shared_ptr<Sampler>>(original.samplers()), false));
+  }
+
+  auto substitute = [this, &bound_uniform_values](
+      const std::shared_ptr<UniformValues>& uniform_values) {
+    for (size_t i = 0; i < bound_uniform_values.size(); ++i) {
+      if (bound_uniform_values[i].uniform_values == uniform_values) {
+        return uniform_values_[i];
+      }
+    }
+    return uniform_values;
+  };
+
+  for (const auto& bound : bound_uniform_values) {
+    for (size_t index : bound.draw_call_indices) {
+      const DrawCall* draw_call = draw_calls_[index];
+      if (draw_call != draw_template_->draw_calls()[index]) {
+        // Already patched because it also uses another bound node.
+        continue;
+      }
+      auto patched = std::make_shared<DrawCall>(
+          draw_call->pipeline(), draw_call->vertex_buffer(),
+          substitute(draw_call->vertex_uniform_values()),
+          substitute(draw_call->fragment_uniform_values()),
+          draw_call->index_buffer());
+      draw_calls_[index] = patched.get();
+      patched_draw_calls_.push_back(patched);
+    }
+  }
+}
+
+}  // namespace render_tree
+}  // namespace gles2
+}  // namespace renderer
+}  // namespace entify
@@ -0,0 +1,121 @@
+#ifndef _SRC_ENTIFY_RENDERER_GLES2_RENDER_TREE_DRAW_TEMPLATE_H_
+#define _SRC_ENTIFY_RENDERER_GLES2_RENDER_TREE_DRAW_TEMPLATE_H_
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "src/renderer/gles2/render_tree/draw_call.h"
+#include "src/renderer/gles2/render_tree/draw_tree.h"
+#include "src/renderer/gles2/render_tree/uniform_values.h"
+
+namespace entify {
+namespace renderer {
+namespace gles2 {
+namespace render_tree {
+
+// A draw tree that is flattened into its list of draw calls once, when it is
+// created, and that declares named parameters which each stand in for one
+// uniform value used by those draw calls.  DrawTemplateInstances reuse the
+// flattened list and only supply new values for the parameters.
+class DrawTemplate : public DrawTree {
+ public:
+  // Binds a parameter to the |uniform_index|th value of |uniform_values|,
+  // which must be used by the template's draw tree.
+  struct ParameterBinding {
+    std::string name;
+    std::shared_ptr<UniformValues> uniform_values;
+    int uniform_index;
+  };
+
+  struct Parameter {
+    std::string name;
+    // Index into bound_uniform_values().
+    size_t bound_uniform_values_index;
+    // Where the value lives within the UniformValues' data.
+    size_t data_offset_in_bytes;
+    size_t size_in_bytes;
+    // Where the value lives within an instance's parameter block.
+    size_t block_offset_in_bytes;
+  };
+
+  // A UniformValues node that at least one parameter is bound to.
+  struct BoundUniformValues {
+    std::shared_ptr<UniformValues> uniform_values;
+    // The indices into draw_calls() of the draw calls that use it.
+    std::vector<size_t> draw_call_indices;
+  };
+
+  DrawTemplate(const std::shared_ptr<DrawTree>& draw_tree,
+               const std::vector<ParameterBinding>& bindings);
+  ~DrawTemplate() {}
+
+  const std::shared_ptr<DrawTree>& draw_tree() const { return draw_tree_; }
+  const std::vector<const DrawCall*>& draw_calls() const {
+    return draw_calls_;
+  }
+  const std::vector<Parameter>& parameters() const { return parameters_; }
+  const std::vector<BoundUniformValues>& bound_uniform_values() const {
+    return bound_uniform_values_;
+  }
+
+  // The size of the parameter block that instances must provide, which holds
+  // the parameters' values packed in the order they were declared.
+  size_t parameters_size_in_bytes() const {
+    return parameters_size_in_bytes_;
+  }
+
+  const std::string& error() const { return error_; }
+
+ private:
+  std::shared_ptr<DrawTree> draw_tree_;
+  std::vector<const DrawCall*> draw_calls_;
+  std::vector<Parameter> parameters_;
+  std::vector<BoundUniformValues> bound_uniform_values_;
+  size_t parameters_size_in_bytes_;
+  std::string error_;
+};
+
+// A DrawTemplate drawn with a specific set of parameter values.  Creating an
+// instance copies only the UniformValues that parameters are bound to, and
+// the draw calls that use them; everything else in the template's draw call
+// list is shared.
+class DrawTemplateInstance : public DrawTree {
+ public:
+  DrawTemplateInstance(const std::shared_ptr<DrawTemplate>& draw_template,
+                       const char* parameters, size_t parameters_size);
+  ~DrawTemplateInstance() {}
+
+  const std::shared_ptr<DrawTemplate>& draw_template() const {
+    return draw_template_;
+  }
+  const std::vector<const DrawCall*>& draw_calls() const {
+    return draw_calls_;
+  }
+  const std::vector<std::shared_ptr<UniformValues>>& uniform_values() const {
+    return uniform_values_;
+  }
+  const std::vector<std::shared_ptr<DrawCall>>& patched_draw_calls() const {
+    return patched_draw_calls_;
+  }
+
+  const std::string& error() const { return error_; }
+
+ private:
+  std::shared_ptr<DrawTemplate> draw_template_;
+  // Copies of the template's bound_uniform_values() with the parameter values
+  // written into them, in the same order.
+  std::vector<std::shared_ptr<UniformValues>> uniform_values_;
+  // The draw calls of the template that use |uniform_values_| in place of the
+  // originals.
+  std::vector<std::shared_ptr<DrawCall>> patched_draw_calls_;
+  std::vector<const DrawCall*> draw_calls_;
+  std::string error_;
+};
+
+}  // namespace render_tree
+}  // namespace gles2
+}  // namespace renderer
+}  // namespace entify
+
+#endif  // _SRC_ENTIFY_RENDERER_GLES2_RENDER_TREE_DRAW_TEMPLATE_H_
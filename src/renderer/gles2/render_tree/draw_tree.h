@@ -1,6 +1,8 @@
 #ifndef _SRC_ENTIFY_RENDERER_GLES2_RENDER_TREE_DRAW_TREE_H_
 #define _SRC_ENTIFY_RENDERER_GLES2_RENDER_TREE_DRAW_TREE_H_
 
+#include "entify/registry.h"
+
 namespace entify {
 namespace renderer {
 namespace gles2 {
@@ -12,6 +14,8 @@ class DrawTree {
     kTypeDrawCall,
     kTypeDrawSequence,
     kTypeDrawSet,
+    kTypeDrawTemplate,
+    kTypeDrawTemplateInstance,
   };
 
   DrawTree(Type type) : type_(type) {}
@@ -20,8 +24,13 @@ class DrawTree {
 
   const Type type() const { return type_; }
 
+  // The id that the node was created with, which GPU timings refer to.
+  EntifyId id() const { return id_; }
+  void set_id(EntifyId id) { id_ = id; }
+
  private:
   Type type_;
+  EntifyId id_ = 0;
 };
 
 }  // namespace render_tree
@@ -1,5 +1,6 @@
 #include "src/renderer/gles2/render_tree/fragment_shader.h"
 #include "src/renderer/gles2/utils.h"
+#include "src/trace_log/trace_log.h"
 
 namespace entify {
 namespace renderer {
@@ -7,17 +8,22 @@ namespace gles2 {
 namespace render_tree {
 
 FragmentShader::FragmentShader(
-      const std::string& source, TypeTuple&& input_types,
+      Device* device, const std::string& source, TypeTuple&& input_types,
       std::pair<std::vector<std::string>, TypeTuple>&& uniform_types)
-      : input_types_(input_types),
+      : device_(device), input_types_(input_types),
         uniform_types_(std::move(uniform_types.second)),
         uniform_names_(std::move(uniform_types.first)) {
   assert(uniform_types_.size() == uniform_names_.size());
-  handle_ = glCreateShader(GL_FRAGMENT_SHADER);
+  ScopedTraceEvent trace_event("gles2", "CompileFragmentShader");
+  handle_ = GL_CALL(glCreateShader(GL_FRAGMENT_SHADER));
   const char* source_c_str = source.c_str();
   GL_CALL(glShaderSource(handle_, 1, &source_c_str, NULL));
   GL_CALL(glCompileShader(handle_));
   error_ = CheckForShaderCompileErrors(handle_, source_c_str);
+  if (error_.empty() && !AreValidUniformTypes(uniform_types_)) {
+    error_ = "Uniforms must be samplers, or floats, vectors of floats or "
+             "mat4s, or arrays of up to 8388607 of those.";
+  }
 }
 
 }  // namespace render_tree
@@ -7,6 +7,7 @@
 
 #include <GLES2/gl2.h>
 
+#include "src/renderer/gles2/device.h"
 #include "src/renderer/gles2/render_tree/types.h"
 
 namespace entify {
@@ -17,10 +18,11 @@ namespace render_tree {
 class FragmentShader {
  public:
   FragmentShader(
-      const std::string& source, TypeTuple&& input_types,
+      Device* device, const std::string& source, TypeTuple&& input_types,
       std::pair<std::vector<std::string>, TypeTuple>&& uniform_types);
   ~FragmentShader() {
-    glDeleteShader(handle_);
+    device_->deletion_queue()->Enqueue(
+        DeletionQueue::kHandleTypeShader, handle_);
   }
 
   GLuint handle() const { return handle_; }
@@ -34,6 +36,7 @@ class FragmentShader {
   const std::string& error() const { return error_; }
 
  private:
+  Device* device_;
   GLuint handle_;
   TypeTuple input_types_;
   TypeTuple uniform_types_;
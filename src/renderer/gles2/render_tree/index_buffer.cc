@@ -0,0 +1,103 @@
+#include "src/renderer/gles2/render_tree/index_buffer.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+#include "src/renderer/gles2/mesh_optimizer.h"
+#include "src/renderer/gles2/utils.h"
+
+namespace entify {
+namespace renderer {
+namespace gles2 {
+namespace render_tree {
+
+namespace {
+int32_t IndexTypeToSize(GLenum type) {
+  switch (type) {
+    case GL_UNSIGNED_BYTE: return sizeof(uint8_t);
+    case GL_UNSIGNED_SHORT: return sizeof(uint16_t);
+    default: return 0;
+  }
+}
+
+template <typename T>
+std::vector<uint32_t> DecodeIndices(const char* data, int32_t num_indices) {
+  std::vector<uint32_t> indices(num_indices);
+  for (int32_t i = 0; i < num_indices; ++i) {
+    T index;
+    memcpy(&index, data + i * sizeof(T), sizeof(T));
+    indices[i] = index;
+  }
+  return indices;
+}
+
+template <typename T>
+std::vector<T> EncodeIndices(const std::vector<uint32_t>& indices) {
+  return std::vector<T>(indices.begin(), indices.end());
+}
+}  // namespace
+
+IndexBuffer::IndexBuffer(Device* device, GLenum type, const char* data,
+                         int32_t num_bytes, bool optimize_vertex_cache)
+    : device_(device), handle_(0), type_(type), num_indices_(0),
+      num_referenced_vertices_(0),
+      vertex_cache_optimized_(optimize_vertex_cache) {
+  int32_t index_size = IndexTypeToSize(type_);
+  if (index_size == 0) {
+    error_ = "IndexBuffer has an invalid index type.";
+    return;
+  }
+  if (num_bytes % index_size != 0) {
+    error_ = "IndexBuffer data is " + std::to_string(num_bytes) +
+             " bytes, which is not a whole number of indices.";
+    return;
+  }
+
+  std::vector<uint32_t> indices = type_ == GL_UNSIGNED_BYTE ?
+      DecodeIndices<uint8_t>(data, num_bytes / index_size) :
+      DecodeIndices<uint16_t>(data, num_bytes / index_size);
+  if (optimize_vertex_cache && !indices.empty()) {
+    OptimizeVertexCache(
+        &indices, *std::max_element(indices.begin(), indices.end()) + 1);
+  }
+  Upload(indices);
+}
+
+IndexBuffer::IndexBuffer(Device* device, const std::vector<uint32_t>& indices)
+    : device_(device), handle_(0), num_indices_(0),
+      num_referenced_vertices_(0), vertex_cache_optimized_(false) {
+  uint32_t max_index = indices.empty() ?
+      0 : *std::max_element(indices.begin(), indices.end());
+  assert(max_index <= 0xffff);
+  type_ = max_index <= 0xff ? GL_UNSIGNED_BYTE : GL_UNSIGNED_SHORT;
+  Upload(indices);
+}
+
+int32_t IndexBuffer::size_in_bytes() const {
+  return num_indices_ * IndexTypeToSize(type_);
+}
+
+void IndexBuffer::Upload(const std::vector<uint32_t>& indices) {
+  num_indices_ = indices.size();
+  num_referenced_vertices_ = indices.empty() ?
+      0 : *std::max_element(indices.begin(), indices.end()) + 1;
+
+  GL_CALL(glGenBuffers(1, &handle_));
+  GL_CALL(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, handle_));
+  if (type_ == GL_UNSIGNED_BYTE) {
+    std::vector<uint8_t> encoded = EncodeIndices<uint8_t>(indices);
+    GL_CALL(glBufferData(GL_ELEMENT_ARRAY_BUFFER, encoded.size(),
+                         encoded.data(), GL_STATIC_DRAW));
+  } else {
+    std::vector<uint16_t> encoded = EncodeIndices<uint16_t>(indices);
+    GL_CALL(glBufferData(
+        GL_ELEMENT_ARRAY_BUFFER, encoded.size() * sizeof(uint16_t),
+        encoded.data(), GL_STATIC_DRAW));
+  }
+}
+
+}  // namespace render_tree
+}  // namespace gles2
+}  // namespace renderer
+}  // namespace entify
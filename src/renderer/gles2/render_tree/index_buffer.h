@@ -0,0 +1,69 @@
+#ifndef _SRC_ENTIFY_RENDERER_GLES2_RENDER_TREE_INDEX_BUFFER_H_
+#define _SRC_ENTIFY_RENDERER_GLES2_RENDER_TREE_INDEX_BUFFER_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <GLES2/gl2.h>
+
+#include "src/renderer/gles2/device.h"
+
+namespace entify {
+namespace renderer {
+namespace gles2 {
+namespace render_tree {
+
+// A list of vertex indices that DrawCalls can draw their vertex buffer
+// through with glDrawElements(), so that vertices shared by several
+// primitives only need to be stored and transformed once.
+class IndexBuffer {
+ public:
+  // |data| holds |num_bytes| bytes of indices of |type|, which is
+  // GL_UNSIGNED_BYTE or GL_UNSIGNED_SHORT.  If |optimize_vertex_cache| is
+  // set, the indices are taken to be a triangle list, and the triangles are
+  // reordered for the GPU's vertex cache.
+  IndexBuffer(Device* device, GLenum type, const char* data,
+              int32_t num_bytes, bool optimize_vertex_cache);
+  // Stores |indices| with the smallest type that fits them.
+  IndexBuffer(Device* device, const std::vector<uint32_t>& indices);
+  ~IndexBuffer() {
+    if (handle_ != 0) {
+      device_->deletion_queue()->Enqueue(
+          DeletionQueue::kHandleTypeBuffer, handle_);
+    }
+  }
+
+  GLuint handle() const { return handle_; }
+  GLenum type() const { return type_; }
+  int32_t num_indices() const { return num_indices_; }
+  // The number of vertices that the indices require the vertex buffer to
+  // have, i.e. the largest index plus one.
+  int32_t num_referenced_vertices() const {
+    return num_referenced_vertices_;
+  }
+  int32_t size_in_bytes() const;
+  // Whether the triangles were reordered for the vertex cache, in which case
+  // the indices can only be drawn as a triangle list.
+  bool vertex_cache_optimized() const { return vertex_cache_optimized_; }
+
+  const std::string& error() const { return error_; }
+
+ private:
+  void Upload(const std::vector<uint32_t>& indices);
+
+  Device* device_;
+  GLuint handle_;
+  GLenum type_;
+  int32_t num_indices_;
+  int32_t num_referenced_vertices_;
+  bool vertex_cache_optimized_;
+  std::string error_;
+};
+
+}  // namespace render_tree
+}  // namespace gles2
+}  // namespace renderer
+}  // namespace entify
+
+#endif  // _SRC_ENTIFY_RENDERER_GLES2_RENDER_TREE_INDEX_BUFFER_H_
@@ -31,6 +31,9 @@ class Pipeline {
     };
 
     Blend blend;
+    // The mode that draw calls made with this pipeline pass to glDrawArrays()
+    // and glDrawElements(), e.g. GL_TRIANGLES or GL_POINTS.
+    GLenum primitive_mode;
   };
 
   Pipeline(const std::shared_ptr<Program>& program,
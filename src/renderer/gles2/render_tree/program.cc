@@ -1,6 +1,7 @@
 #include "src/renderer/gles2/render_tree/program.h"
 
 #include "src/renderer/gles2/utils.h"
+#include "src/trace_log/trace_log.h"
 
 #include <iostream>
 
@@ -9,13 +10,46 @@ namespace renderer {
 namespace gles2 {
 namespace render_tree {
 
+namespace {
+// Shaders that sample atlased textures declare a vec4 uniform for each
+// sampler, named after it with a "_uv_transform" suffix, which is not one of
+// their uniform types.  Returns its location for each sampler, or -1.
+std::vector<GLint> GetUVTransformLocations(
+    GLuint program, const std::vector<std::string>& uniform_names,
+    const TypeTuple& uniform_types) {
+  std::vector<GLint> locations;
+  for (size_t i = 0; i < uniform_types.size(); ++i) {
+    if (uniform_types[i] == TypeSampler) {
+      locations.push_back(GL_CALL(glGetUniformLocation(
+          program, (uniform_names[i] + "_uv_transform").c_str())));
+    }
+  }
+  return locations;
+}
+
+// Assigns the texture units of the sampler uniforms at |locations|, in order
+// of the samplers, which never change for the program.
+void SetSamplerUnits(const std::vector<GLint>& locations,
+                     const TypeTuple& uniform_types) {
+  int sampler_index = 0;
+  for (size_t i = 0; i < uniform_types.size(); ++i) {
+    if (uniform_types[i] == TypeSampler) {
+      GL_CALL(glUniform1i(locations[i], sampler_index));
+      ++sampler_index;
+    }
+  }
+}
+}  // namespace
+
 Program::Program(
+    Device* device,
     const std::shared_ptr<VertexShader>& vertex_shader,
     const std::shared_ptr<FragmentShader>& fragment_shader)
-    : vertex_shader_(vertex_shader), fragment_shader_(fragment_shader) {
+    : device_(device), vertex_shader_(vertex_shader), fragment_shader_(fragment_shader) {
   assert(vertex_shader_->output_types() == fragment_shader_->input_types());
+  ScopedTraceEvent trace_event("gles2", "LinkProgram");
 
-  handle_ = glCreateProgram();
+  handle_ = GL_CALL(glCreateProgram());
   GL_CALL(glAttachShader(handle_, vertex_shader_->handle()));
   GL_CALL(glAttachShader(handle_, fragment_shader_->handle()));
 
@@ -43,7 +77,7 @@ Program::Program(
   vertex_attribute_indices_.reserve(
       vertex_shader_->vertex_attribute_names().size());
   for (const auto& name : vertex_shader_->vertex_attribute_names()) {
-    GLint index = glGetAttribLocation(handle_, name.c_str());
+    GLint index = GL_CALL(glGetAttribLocation(handle_, name.c_str()));
     if (index == -1) {
       error_ = "Could not find attribute '" + name + "'.";
       return;
@@ -54,7 +88,8 @@ Program::Program(
   // Now resolve uniform locations.
   vertex_uniform_locations_.reserve(vertex_shader_->uniform_names().size());
   for (const auto& name : vertex_shader_->uniform_names()) {
-    GLint location = glGetUniformLocation(handle_, name.c_str());
+    GLint location =
+        GL_CALL(glGetUniformLocation(handle_, name.c_str()));
     if (location == -1) {
       error_ =  "Could not find vertex uniform '" + name + "'.";
       return;
@@ -64,13 +99,35 @@ Program::Program(
 
   fragment_uniform_locations_.reserve(fragment_shader_->uniform_names().size());
   for (const auto& name : fragment_shader_->uniform_names()) {
-    GLint location = glGetUniformLocation(handle_, name.c_str());
+    GLint location =
+        GL_CALL(glGetUniformLocation(handle_, name.c_str()));
     if (location == -1) {
       error_ = "Could not find fragment uniform '" + name + "'.";
       return;
     }
     fragment_uniform_locations_.push_back(location);
   }
+
+  vertex_uv_transform_locations_ = GetUVTransformLocations(
+      handle_, vertex_shader_->uniform_names(),
+      vertex_shader_->uniform_types());
+  fragment_uv_transform_locations_ = GetUVTransformLocations(
+      handle_, fragment_shader_->uniform_names(),
+      fragment_shader_->uniform_types());
+
+  // Uniforms start out as zeros, which no UV transform is.
+  UVTransform zero;
+  zero.scale_x = 0.0f;
+  zero.scale_y = 0.0f;
+  vertex_uv_transforms_.resize(vertex_uv_transform_locations_.size(), zero);
+  fragment_uv_transforms_.resize(
+      fragment_uv_transform_locations_.size(), zero);
+
+  GL_CALL(glUseProgram(handle_));
+  SetSamplerUnits(vertex_uniform_locations_, vertex_shader_->uniform_types());
+  SetSamplerUnits(
+      fragment_uniform_locations_, fragment_shader_->uniform_types());
+  GL_CALL(glUseProgram(0));
 }
 
 }  // namespace render_tree
@@ -5,7 +5,9 @@
 
 #include <GLES2/gl2.h>
 
+#include "src/renderer/gles2/device.h"
 #include "src/renderer/gles2/render_tree/fragment_shader.h"
+#include "src/renderer/gles2/render_tree/texture.h"
 #include "src/renderer/gles2/render_tree/vertex_shader.h"
 
 namespace entify {
@@ -15,10 +17,12 @@ namespace render_tree {
 
 class Program {
  public:
-  Program(const std::shared_ptr<VertexShader>& vertex_shader,
+  Program(Device* device,
+          const std::shared_ptr<VertexShader>& vertex_shader,
           const std::shared_ptr<FragmentShader>& fragment_shader);
   ~Program() {
-    glDeleteProgram(handle_);
+    device_->deletion_queue()->Enqueue(
+        DeletionQueue::kHandleTypeProgram, handle_);
   }
 
   const std::shared_ptr<VertexShader>& vertex_shader() const {
@@ -42,15 +46,38 @@ class Program {
     return fragment_uniform_locations_;
   }
 
+  // The location of the UV transform of each sampler uniform, in order, or
+  // -1 for those whose shader does not declare one.
+  const std::vector<GLint>& vertex_uv_transform_locations() const {
+    return vertex_uv_transform_locations_;
+  }
+  const std::vector<GLint>& fragment_uv_transform_locations() const {
+    return fragment_uv_transform_locations_;
+  }
+  // The UV transform last uploaded for each sampler, in the same order, so
+  // that it is only uploaded again when it changes.
+  std::vector<UVTransform>* vertex_uv_transforms() {
+    return &vertex_uv_transforms_;
+  }
+  std::vector<UVTransform>* fragment_uv_transforms() {
+    return &fragment_uv_transforms_;
+  }
+
   const std::string error() const { return error_; }
 
  private:
+  Device* device_;
+
   std::shared_ptr<VertexShader> vertex_shader_;
   std::shared_ptr<FragmentShader> fragment_shader_;
 
   std::vector<GLint> vertex_attribute_indices_;
   std::vector<GLint> vertex_uniform_locations_;
   std::vector<GLint> fragment_uniform_locations_;
+  std::vector<GLint> vertex_uv_transform_locations_;
+  std::vector<GLint> fragment_uv_transform_locations_;
+  std::vector<UVTransform> vertex_uv_transforms_;
+  std::vector<UVTransform> fragment_uv_transforms_;
 
   GLuint handle_;
 
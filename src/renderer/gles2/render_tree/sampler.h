@@ -17,20 +17,40 @@ class Sampler {
           GLenum wrap_s, GLenum wrap_t,
           GLenum min_filter, GLenum mag_filter)
       : texture_(texture), wrap_s_(wrap_s), wrap_t_(wrap_t),
-        min_filter_(min_filter), mag_filter_(mag_filter) {}
+        min_filter_(texture->has_mipmaps() ? min_filter :
+                                             GetBaseFilter(min_filter)),
+        requested_min_filter_(min_filter), mag_filter_(mag_filter) {}
   ~Sampler() {}
 
   const std::shared_ptr<Texture>& texture() const { return texture_; }
   GLenum wrap_s() const { return wrap_s_; }
   GLenum wrap_t() const { return wrap_t_; }
   GLenum min_filter() const { return min_filter_; }
+  // The min filter as it was given, before falling back to the base filter.
+  GLenum requested_min_filter() const { return requested_min_filter_; }
   GLenum mag_filter() const { return mag_filter_; }
 
  private:
+  // GL does not sample textures without mipmaps at all with a mipmapped min
+  // filter, so those fall back to filtering the full size image.
+  static GLenum GetBaseFilter(GLenum filter) {
+    switch (filter) {
+      case GL_NEAREST_MIPMAP_NEAREST:
+      case GL_NEAREST_MIPMAP_LINEAR:
+        return GL_NEAREST;
+      case GL_LINEAR_MIPMAP_NEAREST:
+      case GL_LINEAR_MIPMAP_LINEAR:
+        return GL_LINEAR;
+      default:
+        return filter;
+    }
+  }
+
   std::shared_ptr<Texture> texture_;
   GLenum wrap_s_;
   GLenum wrap_t_;
   GLenum min_filter_;
+  GLenum requested_min_filter_;
   GLenum mag_filter_;
 };
 
@@ -1,7 +1,15 @@
 #include "src/renderer/gles2/render_tree/texture.h"
 
+#include <algorithm>
+#include <cstring>
+#include <string>
+
+#include <GLES2/gl2ext.h>
+
+#include "src/renderer/gles2/etc_codec.h"
 #include "src/renderer/gles2/render.h"
 #include "src/renderer/gles2/utils.h"
+#include "src/trace_log/trace_log.h"
 
 namespace entify {
 namespace renderer {
@@ -9,10 +17,29 @@ namespace gles2 {
 namespace render_tree {
 
 namespace {
-int PixelTypeBytesPerPixel(PixelType pixel_type) {
+// Only defined by GLES3, but GLES2 implementations that can sample ETC2 list
+// them in GL_COMPRESSED_TEXTURE_FORMATS.
+const GLenum kGLCompressedRGB8ETC2 = 0x9274;
+const GLenum kGLCompressedRGBA8ETC2EAC = 0x9278;
+
+ETCFormat ConvertToETCFormat(PixelType pixel_type) {
   switch (pixel_type) {
-    case kPixelTypeRGB: return 3;
-    case kPixelTypeRGBA: return 4;
+    case kPixelTypeETC1: return kETCFormatETC1;
+    case kPixelTypeETC2RGB: return kETCFormatETC2RGB;
+    case kPixelTypeETC2RGBA: return kETCFormatETC2RGBA;
+    default: break;
+  }
+
+  assert(false);
+  return kETCFormatETC1;
+}
+
+GLenum ConvertToGLCompressedFormat(PixelType pixel_type) {
+  switch (pixel_type) {
+    case kPixelTypeETC1: return GL_ETC1_RGB8_OES;
+    case kPixelTypeETC2RGB: return kGLCompressedRGB8ETC2;
+    case kPixelTypeETC2RGBA: return kGLCompressedRGBA8ETC2EAC;
+    default: break;
   }
 
   assert(false);
@@ -23,22 +50,242 @@ GLenum ConvertToGLPixelType(PixelType pixel_type) {
   switch (pixel_type) {
     case kPixelTypeRGB: return GL_RGB;
     case kPixelTypeRGBA: return GL_RGBA;
+    case kPixelTypeLuminance: return GL_LUMINANCE;
+    case kPixelTypeAlpha: return GL_ALPHA;
+    case kPixelTypeLuminanceAlpha: return GL_LUMINANCE_ALPHA;
+    case kPixelTypeRGB565: return GL_RGB;
+    case kPixelTypeRGBA4444: return GL_RGBA;
+    case kPixelTypeRGBA5551: return GL_RGBA;
+    case kPixelTypeETC1:
+    case kPixelTypeETC2RGB:
+    case kPixelTypeETC2RGBA:
+      break;
   }
 
   assert(false);
   return 0;
 }
+
+// The GL type of the data of each pixel, or of each of its components.
+GLenum ConvertToGLPixelDataType(PixelType pixel_type) {
+  switch (pixel_type) {
+    case kPixelTypeRGB565: return GL_UNSIGNED_SHORT_5_6_5;
+    case kPixelTypeRGBA4444: return GL_UNSIGNED_SHORT_4_4_4_4;
+    case kPixelTypeRGBA5551: return GL_UNSIGNED_SHORT_5_5_5_1;
+    default: return GL_UNSIGNED_BYTE;
+  }
+}
+
+// The GL_UNPACK_ALIGNMENT that makes GL read rows of |row_size| bytes that
+// are |stride_in_bytes| apart, or 0 if there is none.
+int GetUnpackAlignment(int row_size, int stride_in_bytes) {
+  for (int alignment = 1; alignment <= 8; alignment *= 2) {
+    if ((row_size + alignment - 1) / alignment * alignment ==
+            stride_in_bytes) {
+      return alignment;
+    }
+  }
+  return 0;
+}
+
+bool IsPowerOfTwo(int value) {
+  return value > 0 && (value & (value - 1)) == 0;
+}
+
+// GLES2 only has mipmaps for power of two sizes, unless GL_OES_texture_npot
+// lifts that.
+bool CanHaveMipmaps(const Device* device, int width_in_pixels,
+                    int height_in_pixels) {
+  return device->supports_npot_mipmaps() ||
+         (IsPowerOfTwo(width_in_pixels) && IsPowerOfTwo(height_in_pixels));
+}
+
+// The size of the mipmap after one that is |size| pixels wide or high.
+int NextMipmapSize(int size) {
+  return std::max(size / 2, 1);
+}
+
+void AllocateTexture(PixelType pixel_type, int width_in_pixels,
+                     int height_in_pixels) {
+  GL_CALL(glTexImage2D(
+      GL_TEXTURE_2D, 0, ConvertToGLPixelType(pixel_type), width_in_pixels,
+      height_in_pixels, 0, ConvertToGLPixelType(pixel_type),
+      ConvertToGLPixelDataType(pixel_type), NULL));
+}
+
+// Returns an error if the layout or the stride of |image| can not be used
+// with its pixel type, or if |data_size| is too small.
+std::string CheckLayout(const PixelImage& image, int64_t data_size) {
+  int row_size =
+      PixelTypeRowSizeInBytes(image.pixel_type, image.width_in_pixels);
+  if (PixelTypeIsCompressed(image.pixel_type)) {
+    if (image.stride_in_bytes != row_size || !image.layout.IsGLLayout()) {
+      return "Compressed PixelData must hold tightly packed rows of blocks, "
+             "starting at the bottom left.";
+    }
+    if (data_size != PixelTypeImageSizeInBytes(image.pixel_type,
+                                               image.width_in_pixels,
+                                               image.height_in_pixels)) {
+      return "PixelData's data is not the size of its compressed image.";
+    }
+    return "";
+  }
+
+  if (image.stride_in_bytes < row_size) {
+    return "PixelData's stride of " + std::to_string(image.stride_in_bytes) +
+           " bytes is smaller than a row of " + std::to_string(row_size) +
+           " bytes.";
+  }
+  if (image.height_in_pixels > 0 &&
+      data_size < static_cast<int64_t>(image.stride_in_bytes) *
+                          (image.height_in_pixels - 1) + row_size) {
+    return "PixelData's data is smaller than its image.";
+  }
+  if (image.layout.channel_order != kChannelOrderRGBA &&
+      !(image.pixel_type == kPixelTypeRGBA ||
+        (image.pixel_type == kPixelTypeRGB &&
+         image.layout.channel_order != kChannelOrderARGB))) {
+    return "PixelData's channel order does not apply to its pixel type.";
+  }
+  if (image.layout.straight_alpha && image.pixel_type != kPixelTypeRGBA) {
+    return "Only RGBA PixelData can have straight alpha.";
+  }
+  return "";
+}
+
+// Encodes |image|, whose data must be tightly packed rows in the GL layout,
+// with the compressed format that |device| supports best, if any.  If
+// |mipmaps| is set, the image is also downsampled into each of its mipmaps,
+// which are encoded into its |compressed_mipmaps|.
+void Compress(const Device* device, bool mipmaps, PixelImage* image) {
+  PixelType compressed_pixel_type;
+  if (image->pixel_type == kPixelTypeRGB &&
+      device->supports_compressed_texture_format(GL_ETC1_RGB8_OES)) {
+    compressed_pixel_type = kPixelTypeETC1;
+  } else if (image->pixel_type == kPixelTypeRGB &&
+             device->supports_compressed_texture_format(
+                 kGLCompressedRGB8ETC2)) {
+    compressed_pixel_type = kPixelTypeETC2RGB;
+  } else if (image->pixel_type == kPixelTypeRGBA &&
+             device->supports_compressed_texture_format(
+                 kGLCompressedRGBA8ETC2EAC)) {
+    compressed_pixel_type = kPixelTypeETC2RGBA;
+  } else {
+    return;
+  }
+
+  ScopedTraceEvent trace_event("gles2", "CompressTexture");
+  ETCFormat format = ConvertToETCFormat(compressed_pixel_type);
+  std::vector<char> blocks;
+  EncodeETC(format, image->data.data(), image->width_in_pixels,
+            image->height_in_pixels, &blocks);
+
+  if (mipmaps) {
+    // Each mipmap is downsampled from the uncompressed one before it.
+    int bytes_per_pixel = PixelTypeBytesPerPixel(image->pixel_type);
+    std::vector<char> pixels = std::move(image->data);
+    int width = image->width_in_pixels;
+    int height = image->height_in_pixels;
+    while (width > 1 || height > 1) {
+      int mipmap_width = NextMipmapSize(width);
+      int mipmap_height = NextMipmapSize(height);
+      std::vector<char> mipmap_pixels(
+          static_cast<size_t>(mipmap_width) * mipmap_height *
+          bytes_per_pixel);
+      DownsamplePixels(pixels.data(), width, height, bytes_per_pixel,
+                       mipmap_pixels.data());
+      image->compressed_mipmaps.emplace_back();
+      EncodeETC(format, mipmap_pixels.data(), mipmap_width, mipmap_height,
+                &image->compressed_mipmaps.back());
+      pixels = std::move(mipmap_pixels);
+      width = mipmap_width;
+      height = mipmap_height;
+    }
+  }
+
+  image->data = std::move(blocks);
+  image->pixel_type = compressed_pixel_type;
+  image->stride_in_bytes =
+      PixelTypeRowSizeInBytes(image->pixel_type, image->width_in_pixels);
+}
+
+void Decompress(PixelImage* image) {
+  ScopedTraceEvent trace_event("gles2", "DecompressTexture");
+  std::vector<char> pixels;
+  DecodeETC(ConvertToETCFormat(image->pixel_type), image->data.data(),
+            image->width_in_pixels, image->height_in_pixels, &pixels);
+  image->data = std::move(pixels);
+  image->pixel_type = image->pixel_type == kPixelTypeETC2RGBA ?
+      kPixelTypeRGBA : kPixelTypeRGB;
+  image->stride_in_bytes =
+      PixelTypeRowSizeInBytes(image->pixel_type, image->width_in_pixels);
+  image->unpack_alignment = 1;
+}
 }  // namespace
 
+bool PixelTypeIsCompressed(PixelType pixel_type) {
+  return pixel_type == kPixelTypeETC1 || pixel_type == kPixelTypeETC2RGB ||
+         pixel_type == kPixelTypeETC2RGBA;
+}
+
+int PixelTypeBytesPerPixel(PixelType pixel_type) {
+  switch (pixel_type) {
+    case kPixelTypeRGB: return 3;
+    case kPixelTypeRGBA: return 4;
+    case kPixelTypeLuminance: return 1;
+    case kPixelTypeAlpha: return 1;
+    case kPixelTypeLuminanceAlpha: return 2;
+    case kPixelTypeRGB565: return 2;
+    case kPixelTypeRGBA4444: return 2;
+    case kPixelTypeRGBA5551: return 2;
+    case kPixelTypeETC1:
+    case kPixelTypeETC2RGB:
+    case kPixelTypeETC2RGBA:
+      break;
+  }
+
+  assert(false);
+  return 0;
+}
+
+int PixelTypeRowSizeInBytes(PixelType pixel_type, int width_in_pixels) {
+  if (PixelTypeIsCompressed(pixel_type)) {
+    return ETCRowSizeInBytes(ConvertToETCFormat(pixel_type), width_in_pixels);
+  }
+  return width_in_pixels * PixelTypeBytesPerPixel(pixel_type);
+}
+
+int64_t PixelTypeImageSizeInBytes(PixelType pixel_type, int width_in_pixels,
+                                  int height_in_pixels) {
+  if (PixelTypeIsCompressed(pixel_type)) {
+    return ETCImageSizeInBytes(ConvertToETCFormat(pixel_type),
+                               width_in_pixels, height_in_pixels);
+  }
+  return static_cast<int64_t>(
+             PixelTypeRowSizeInBytes(pixel_type, width_in_pixels)) *
+         height_in_pixels;
+}
+
 RenderTarget::RenderTarget(
-    int width_in_pixels, int height_in_pixels,
+    Device* device, EntifyId id, int width_in_pixels, int height_in_pixels,
+    PixelType pixel_type, bool generate_mipmaps,
     const std::shared_ptr<DrawTree>& draw_tree)
-    : Texture(width_in_pixels, height_in_pixels) {
+    : Texture(width_in_pixels, height_in_pixels), device_(device),
+      pixel_type_(pixel_type),
+      has_mipmaps_(
+          generate_mipmaps &&
+          CanHaveMipmaps(device, width_in_pixels, height_in_pixels)) {
+  ScopedTraceEvent trace_event("gles2", "RenderTargetPass");
+  trace_event.AddArg("width", width_in_pixels);
+  trace_event.AddArg("height", height_in_pixels);
+
+  if (PixelTypeIsCompressed(pixel_type_)) {
+    pixel_type_ = kPixelTypeRGBA;
+  }
+
   GL_CALL(glGenTextures(1, &texture_handle_));
   GL_CALL(glBindTexture(GL_TEXTURE_2D, texture_handle_));
-  GL_CALL(glTexImage2D(
-      GL_TEXTURE_2D, 0, GL_RGBA, width_in_pixels, height_in_pixels, 0,
-      GL_RGBA, GL_UNSIGNED_BYTE, NULL));
+  AllocateTexture(pixel_type_, width_in_pixels, height_in_pixels);
 
   GLuint framebuffer_handle;
   GL_CALL(glGenFramebuffers(1, &framebuffer_handle));
@@ -48,41 +295,330 @@ RenderTarget::RenderTarget(
       texture_handle_, 0));
 
   GLenum status;
-  status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+  status = GL_CALL(glCheckFramebufferStatus(GL_FRAMEBUFFER));
+  if (status != GL_FRAMEBUFFER_COMPLETE && pixel_type_ != kPixelTypeRGBA) {
+    // GLES2 only guarantees that the 16-bit formats can be rendered to, and
+    // never the luminance and alpha ones.  The texture is reallocated in
+    // place, which keeps it attached.
+    pixel_type_ = kPixelTypeRGBA;
+    AllocateTexture(pixel_type_, width_in_pixels, height_in_pixels);
+    status = GL_CALL(glCheckFramebufferStatus(GL_FRAMEBUFFER));
+  }
   assert(status == GL_FRAMEBUFFER_COMPLETE);
 
-  Render(width_in_pixels, height_in_pixels, draw_tree);
+  {
+    ScopedGPUTimer gpu_timer(
+        device_->gpu_timer(), kEntifyGPUTimingTypeRenderTarget, id);
+    Render(device_, width_in_pixels, height_in_pixels, draw_tree);
+  }
+  ++device_->frame_stats()->render_target_passes;
 
   GL_CALL(glBindFramebuffer(GL_FRAMEBUFFER, 0));
   GL_CALL(glDeleteFramebuffers(1, &framebuffer_handle));
+
+  if (has_mipmaps_) {
+    GL_CALL(glBindTexture(GL_TEXTURE_2D, texture_handle_));
+    GL_CALL(glGenerateMipmap(GL_TEXTURE_2D));
+    GL_CALL(glBindTexture(GL_TEXTURE_2D, 0));
+  }
 }
 
 RenderTarget::~RenderTarget() {
-  GL_CALL(glDeleteTextures(1, &texture_handle_));
+  device_->deletion_queue()->Enqueue(
+      DeletionQueue::kHandleTypeTexture, texture_handle_);
+}
+
+PixelImage PreparePixelImage(
+    const Device* device, int width_in_pixels, int height_in_pixels,
+    int stride_in_bytes, PixelType pixel_type, const PixelLayout& layout,
+    std::vector<char>&& data, bool updatable, bool double_buffered,
+    bool compress, bool generate_mipmaps, bool atlas) {
+  PixelImage image;
+  image.width_in_pixels = width_in_pixels;
+  image.height_in_pixels = height_in_pixels;
+  image.stride_in_bytes = stride_in_bytes;
+  image.pixel_type = pixel_type;
+  image.layout = layout;
+  image.updatable = updatable;
+  image.double_buffered = updatable && double_buffered;
+
+  image.error = CheckLayout(image, data.size());
+  if (!image.error.empty()) {
+    return image;
+  }
+  // Neither ETC extension allows compressed textures to be partially
+  // overwritten.
+  if (PixelTypeIsCompressed(pixel_type) && updatable) {
+    image.error = "Compressed PixelData can not be updatable.";
+    return image;
+  }
+
+  ScopedTraceEvent trace_event("gles2", "PrepareTexture");
+  trace_event.AddArg("width", width_in_pixels);
+  trace_event.AddArg("height", height_in_pixels);
+  trace_event.AddArg("bytes", data.size());
+
+  // Atlas regions are uploaded once, without mipmaps, so only images that
+  // need nothing more can be packed.
+  image.atlas = atlas && pixel_type == kPixelTypeRGBA && !updatable &&
+                !compress && !generate_mipmaps &&
+                width_in_pixels <= TextureAtlas::kMaxImageSizeInPixels &&
+                height_in_pixels <= TextureAtlas::kMaxImageSizeInPixels;
+
+  // GL skips the padding of rows that are padded to its unpack alignment, so
+  // those can be uploaded as they are.  Anything else is converted to
+  // tightly packed rows in the GL layout, as is everything to be compressed
+  // or atlased.
+  int row_size = PixelTypeRowSizeInBytes(pixel_type, width_in_pixels);
+  image.unpack_alignment = GetUnpackAlignment(row_size, stride_in_bytes);
+  if (!layout.IsGLLayout() || image.unpack_alignment == 0 ||
+      ((compress || image.atlas) && image.unpack_alignment != 1)) {
+    ScopedTraceEvent convert_trace_event("gles2", "ConvertTexture");
+    std::vector<char> converted(
+        static_cast<size_t>(row_size) * height_in_pixels);
+    ConvertPixelRows(data.data(), width_in_pixels, height_in_pixels,
+                     stride_in_bytes, PixelTypeBytesPerPixel(pixel_type),
+                     layout.origin == kPixelOriginTopLeft,
+                     layout.channel_order, layout.straight_alpha,
+                     converted.data());
+    data = std::move(converted);
+    image.stride_in_bytes = row_size;
+    image.unpack_alignment = 1;
+  }
+  image.data = std::move(data);
+
+  // GL can not generate the mipmaps of compressed textures, so those are
+  // encoded along with the image, if it is compressed here.
+  generate_mipmaps = generate_mipmaps &&
+      CanHaveMipmaps(device, width_in_pixels, height_in_pixels);
+  if (compress && !updatable) {
+    Compress(device, generate_mipmaps, &image);
+  }
+  if (PixelTypeIsCompressed(image.pixel_type) &&
+      !device->supports_compressed_texture_format(
+          ConvertToGLCompressedFormat(image.pixel_type))) {
+    Decompress(&image);
+  }
+  image.has_mipmaps =
+      generate_mipmaps && (!PixelTypeIsCompressed(image.pixel_type) ||
+                           !image.compressed_mipmaps.empty());
+  return image;
 }
 
-PixelData::PixelData(
-    int width_in_pixels, int height_in_pixels, int stride_in_bytes,
-    PixelType pixel_type, std::vector<char>&& data)
-    : Texture(width_in_pixels, height_in_pixels),
-      stride_in_bytes_(stride_in_bytes), pixel_type_(pixel_type) {
-  // Only tightly packed rows are supported right now.
-  assert(stride_in_bytes_ ==
-             width_in_pixels * PixelTypeBytesPerPixel(pixel_type_));
+PixelData::PixelData(Device* device, PixelImage&& image)
+    : Texture(image.width_in_pixels, image.height_in_pixels),
+      device_(device), error_(std::move(image.error)),
+      stride_in_bytes_(image.stride_in_bytes),
+      pixel_type_(image.pixel_type), layout_(image.layout),
+      updatable_(image.updatable), double_buffered_(image.double_buffered),
+      has_mipmaps_(image.has_mipmaps), handles_{0, 0}, front_(0) {
+  if (!error_.empty()) {
+    return;
+  }
+
+  ScopedTraceEvent trace_event("gles2", "UploadTexture");
+  trace_event.AddArg("width", width_in_pixels());
+  trace_event.AddArg("height", height_in_pixels());
+  trace_event.AddArg("bytes", image.data.size());
+
+  if (image.atlas) {
+    atlas_allocation_ = device_->texture_atlas()->Allocate(
+        image.data.data(), width_in_pixels(), height_in_pixels());
+    if (atlased()) {
+      handles_[0] = atlas_allocation_.handle;
+      return;
+    }
+  }
 
-  GL_CALL(glGenTextures(1, &handle_));
-  GL_CALL(glBindTexture(GL_TEXTURE_2D, handle_));
+  GL_CALL(glPixelStorei(GL_UNPACK_ALIGNMENT, image.unpack_alignment));
 
-  GL_CALL(glTexImage2D(GL_TEXTURE_2D, 0, ConvertToGLPixelType(pixel_type_),
-                       width_in_pixels, height_in_pixels, 0,
-                       ConvertToGLPixelType(pixel_type_),
-                       GL_UNSIGNED_BYTE, data.data()));
+  int num_handles = double_buffered_ ? 2 : 1;
+  GL_CALL(glGenTextures(num_handles, handles_));
+  for (int i = 0; i < num_handles; ++i) {
+    GL_CALL(glBindTexture(GL_TEXTURE_2D, handles_[i]));
+    if (PixelTypeIsCompressed(pixel_type_)) {
+      GL_CALL(glCompressedTexImage2D(
+          GL_TEXTURE_2D, 0, ConvertToGLCompressedFormat(pixel_type_),
+          width_in_pixels(), height_in_pixels(), 0, image.data.size(),
+          image.data.data()));
+      int mipmap_width = width_in_pixels();
+      int mipmap_height = height_in_pixels();
+      for (size_t level = 0; level < image.compressed_mipmaps.size();
+           ++level) {
+        mipmap_width = NextMipmapSize(mipmap_width);
+        mipmap_height = NextMipmapSize(mipmap_height);
+        GL_CALL(glCompressedTexImage2D(
+            GL_TEXTURE_2D, level + 1,
+            ConvertToGLCompressedFormat(pixel_type_), mipmap_width,
+            mipmap_height, 0, image.compressed_mipmaps[level].size(),
+            image.compressed_mipmaps[level].data()));
+      }
+    } else {
+      GL_CALL(glTexImage2D(
+          GL_TEXTURE_2D, 0, ConvertToGLPixelType(pixel_type_),
+          width_in_pixels(), height_in_pixels(), 0,
+          ConvertToGLPixelType(pixel_type_),
+          ConvertToGLPixelDataType(pixel_type_), image.data.data()));
+      if (has_mipmaps_) {
+        GL_CALL(glGenerateMipmap(GL_TEXTURE_2D));
+      }
+    }
+  }
 
   GL_CALL(glBindTexture(GL_TEXTURE_2D, 0));
+
+  if (double_buffered_) {
+    shadow_ = std::move(image.data);
+  }
 }
 
 PixelData::~PixelData() {
-  GL_CALL(glDeleteTextures(1, &handle_));
+  if (!error_.empty()) {
+    return;
+  }
+  if (atlased()) {
+    device_->texture_atlas()->Free(atlas_allocation_);
+    return;
+  }
+  device_->deletion_queue()->Enqueue(
+      DeletionQueue::kHandleTypeTexture, handles_[0]);
+  if (double_buffered_) {
+    device_->deletion_queue()->Enqueue(
+        DeletionQueue::kHandleTypeTexture, handles_[1]);
+  }
+}
+
+TextureParameters* PixelData::parameters() {
+  return atlased() ? &atlas_allocation_.page->parameters :
+                     &parameters_[front_];
+}
+
+UVTransform PixelData::uv_transform() const {
+  UVTransform transform;
+  if (atlased()) {
+    float page_size = TextureAtlas::kPageSizeInPixels;
+    transform.scale_x = atlas_allocation_.width_in_pixels / page_size;
+    transform.scale_y = atlas_allocation_.height_in_pixels / page_size;
+    transform.offset_x = atlas_allocation_.x / page_size;
+    transform.offset_y = atlas_allocation_.y / page_size;
+  }
+  return transform;
+}
+
+int PixelData::bytes_per_pixel() const {
+  return PixelTypeBytesPerPixel(pixel_type_);
+}
+
+void PixelData::Region::Add(const Region& other) {
+  if (other.empty()) {
+    return;
+  }
+  if (empty()) {
+    *this = other;
+    return;
+  }
+  x0 = std::min(x0, other.x0);
+  y0 = std::min(y0, other.y0);
+  x1 = std::max(x1, other.x1);
+  y1 = std::max(y1, other.y1);
+}
+
+void PixelData::UpdateRegion(int x, int y, int width, int height,
+                             int stride_in_bytes, const char* data) {
+  assert(updatable_);
+  assert(x >= 0 && y >= 0 && width >= 0 && height >= 0);
+  assert(x + width <= width_in_pixels() && y + height <= height_in_pixels());
+  assert(stride_in_bytes >= width * bytes_per_pixel());
+
+  ScopedTraceEvent trace_event("gles2", "UpdateTexture");
+  trace_event.AddArg("width", width);
+  trace_event.AddArg("height", height);
+
+  // The region is converted to the GL layout, which also moves its origin to
+  // the bottom left.
+  std::vector<char> converted;
+  if (!layout_.IsGLLayout()) {
+    converted.resize(static_cast<size_t>(width) * height * bytes_per_pixel());
+    ConvertPixelRows(data, width, height, stride_in_bytes, bytes_per_pixel(),
+                     layout_.origin == kPixelOriginTopLeft,
+                     layout_.channel_order, layout_.straight_alpha,
+                     converted.data());
+    data = converted.data();
+    stride_in_bytes = width * bytes_per_pixel();
+    if (layout_.origin == kPixelOriginTopLeft) {
+      y = height_in_pixels() - y - height;
+    }
+  }
+
+  Region region;
+  region.x0 = x;
+  region.y0 = y;
+  region.x1 = x + width;
+  region.y1 = y + height;
+  if (region.empty()) {
+    return;
+  }
+
+  if (!double_buffered_) {
+    UploadRegion(handles_[0], region, stride_in_bytes, data);
+    return;
+  }
+
+  int row_size = width * bytes_per_pixel();
+  for (int row = 0; row < height; ++row) {
+    memcpy(shadow_.data() + (y + row) * stride_in_bytes_ +
+               x * bytes_per_pixel(),
+           data + row * stride_in_bytes, row_size);
+  }
+
+  // The back buffer is brought up to date and updated in one upload from the
+  // shadow copy.
+  stale_.Add(region);
+  UploadRegion(handles_[1 - front_], stale_, stride_in_bytes_,
+               shadow_.data() + stale_.y0 * stride_in_bytes_ +
+                   stale_.x0 * bytes_per_pixel());
+  stale_ = Region();
+  updated_.Add(region);
+}
+
+void PixelData::SwapBuffers() {
+  if (!double_buffered_ || updated_.empty()) {
+    return;
+  }
+
+  front_ = 1 - front_;
+  // The new back buffer has none of the updates that went to the other one.
+  stale_ = updated_;
+  updated_ = Region();
+}
+
+void PixelData::UploadRegion(GLuint handle, const Region& region,
+                             int stride_in_bytes, const char* data) {
+  int width = region.x1 - region.x0;
+  int height = region.y1 - region.y0;
+  int row_size = width * bytes_per_pixel();
+
+  // GLES2 can not unpack rows with padding between them, so those are
+  // packed first.
+  std::vector<char> packed;
+  if (stride_in_bytes != row_size) {
+    packed.resize(static_cast<size_t>(row_size) * height);
+    for (int row = 0; row < height; ++row) {
+      memcpy(packed.data() + row * row_size, data + row * stride_in_bytes,
+             row_size);
+    }
+    data = packed.data();
+  }
+
+  GL_CALL(glPixelStorei(GL_UNPACK_ALIGNMENT, 1));
+  GL_CALL(glBindTexture(GL_TEXTURE_2D, handle));
+  GL_CALL(glTexSubImage2D(GL_TEXTURE_2D, 0, region.x0, region.y0, width,
+                          height, ConvertToGLPixelType(pixel_type_),
+                          ConvertToGLPixelDataType(pixel_type_), data));
+  if (has_mipmaps_) {
+    GL_CALL(glGenerateMipmap(GL_TEXTURE_2D));
+  }
+  GL_CALL(glBindTexture(GL_TEXTURE_2D, 0));
 }
 
 }  // namespace render_tree
@@ -1,13 +1,18 @@
 #ifndef _SRC_ENTIFY_RENDERER_GLES2_RENDER_TREE_TEXTURE_H_
 #define _SRC_ENTIFY_RENDERER_GLES2_RENDER_TREE_TEXTURE_H_
 
+#include <cstdint>
 #include <memory>
+#include <string>
 #include <vector>
 
 #include <GLES2/gl2.h>
 
+#include "src/renderer/gles2/device.h"
+#include "src/renderer/gles2/pixel_conversion.h"
 #include "src/renderer/gles2/render_tree/draw_tree.h"
 #include "src/renderer/gles2/render_tree/types.h"
+#include "src/renderer/gles2/texture_atlas.h"
 
 namespace entify {
 namespace renderer {
@@ -17,6 +22,119 @@ namespace render_tree {
 enum PixelType {
   kPixelTypeRGB,
   kPixelTypeRGBA,
+  kPixelTypeLuminance,
+  kPixelTypeAlpha,
+  kPixelTypeLuminanceAlpha,
+  // Packed into one native endian 16-bit value per pixel.
+  kPixelTypeRGB565,
+  kPixelTypeRGBA4444,
+  kPixelTypeRGBA5551,
+  // Compressed in blocks of 4x4 pixels, see etc_codec.h.
+  kPixelTypeETC1,
+  kPixelTypeETC2RGB,
+  kPixelTypeETC2RGBA,
+};
+
+// Which corner of the image the first pixel of the data is.  GL takes the
+// bottom left, while most image files start at the top left.
+enum PixelOrigin {
+  kPixelOriginBottomLeft,
+  kPixelOriginTopLeft,
+};
+
+// How the pixels in a PixelData's data are arranged, beyond their stride.
+// Data that is not in the layout that GL takes is converted when it is
+// uploaded.
+struct PixelLayout {
+  PixelOrigin origin = kPixelOriginBottomLeft;
+  // Only RGB and RGBA pixels may have their channels in another order.
+  ChannelOrder channel_order = kChannelOrderRGBA;
+  // If set, the colors of RGBA pixels are not yet multiplied by their alpha.
+  bool straight_alpha = false;
+
+  bool IsGLLayout() const {
+    return origin == kPixelOriginBottomLeft &&
+           channel_order == kChannelOrderRGBA && !straight_alpha;
+  }
+};
+
+bool PixelTypeIsCompressed(PixelType pixel_type);
+// Not defined for compressed types.
+int PixelTypeBytesPerPixel(PixelType pixel_type);
+// The size of a tightly packed row of pixels, or for compressed types, of a
+// row of blocks.
+int PixelTypeRowSizeInBytes(PixelType pixel_type, int width_in_pixels);
+int64_t PixelTypeImageSizeInBytes(PixelType pixel_type, int width_in_pixels,
+                                  int height_in_pixels);
+
+// The image of a PixelData, ready to be uploaded.  Preparing it does all of
+// the CPU work of creating a PixelData, i.e. checking, converting and
+// compressing the data, which needs no context, so that it can be done
+// without holding up the GL work of other threads.
+struct PixelImage {
+  // Non-empty if no PixelData can be created from the image.
+  std::string error;
+  int width_in_pixels = 0;
+  int height_in_pixels = 0;
+  int stride_in_bytes = 0;
+  // The GL_UNPACK_ALIGNMENT that makes GL skip the padding of the rows.
+  int unpack_alignment = 1;
+  // The format to upload, which may differ from the one that was given.
+  PixelType pixel_type = kPixelTypeRGBA;
+  // The layout that the data was given in, and that updates are given in.
+  // |data| itself is in the GL layout.
+  PixelLayout layout;
+  std::vector<char> data;
+  // If the renderer compressed the image, its encoded mipmaps, from the
+  // largest.
+  std::vector<std::vector<char>> compressed_mipmaps;
+  bool updatable = false;
+  bool double_buffered = false;
+  bool has_mipmaps = false;
+  // Whether to try to pack the image into an atlas page.
+  bool atlas = false;
+};
+
+// Prepares the image of a PixelData.  |device| is only asked what it
+// supports, so no context needs to be current.
+// If |updatable| is set, regions of the texture can later be overwritten
+// with UpdateRegion().  If |double_buffered| is also set, updates are
+// written to a second texture that only replaces the sampled one once
+// SwapBuffers() is called, so frames that are already submitted never
+// sample a partially updated image.
+// If |compress| is set, RGB and RGBA images that are not updatable are
+// compressed, provided that the device supports a suitable format.
+// Compressed images that the device does not support are decompressed.
+// Rows may be |stride_in_bytes| apart, with padding between them, and are
+// laid out as described by |layout|, except for compressed images, which
+// must be tightly packed rows of blocks in the GL layout.
+// If |generate_mipmaps| is set, mipmaps are generated where the device
+// allows it for the texture's size, except for images that were given
+// compressed.  Images compressed by the renderer have each mipmap
+// downsampled and encoded.
+// If |atlas| is set, small RGBA images that none of the other options
+// apply to are packed into a page of the device's TextureAtlas.
+PixelImage PreparePixelImage(
+    const Device* device, int width_in_pixels, int height_in_pixels,
+    int stride_in_bytes, PixelType pixel_type, const PixelLayout& layout,
+    std::vector<char>&& data, bool updatable, bool double_buffered,
+    bool compress, bool generate_mipmaps, bool atlas);
+
+// Maps the texture coordinates of a texture to those of its GL texture,
+// as uv * scale + offset.  Only textures that share an atlas page need one.
+struct UVTransform {
+  float scale_x = 1.0f;
+  float scale_y = 1.0f;
+  float offset_x = 0.0f;
+  float offset_y = 0.0f;
+
+  bool operator==(const UVTransform& other) const {
+    return scale_x == other.scale_x && scale_y == other.scale_y &&
+           offset_x == other.offset_x && offset_y == other.offset_y;
+  }
+  bool operator!=(const UVTransform& other) const {
+    return !(*this == other);
+  }
 };
 
 class Texture {
@@ -30,6 +148,14 @@ class Texture {
   int height_in_pixels() const { return height_in_pixels_; }
 
   virtual GLuint handle() const = 0;
+  // The parameters last set on handle(), which textures that share it share.
+  virtual TextureParameters* parameters() = 0;
+  // Whether the texture has a full chain of mipmaps.
+  virtual bool has_mipmaps() const = 0;
+  // Whether the texture is a region of an atlas page, which shaders can only
+  // sample with uv_transform().
+  virtual bool atlased() const { return false; }
+  virtual UVTransform uv_transform() const { return UVTransform(); }
 
  private:
   int width_in_pixels_;
@@ -38,30 +164,111 @@ class Texture {
 
 class RenderTarget : public Texture {
  public:
-  RenderTarget(int width_in_pixels, int height_in_pixels,
+  // Formats that the implementation can not render to, which includes the
+  // luminance, alpha and compressed formats on GLES2, fall back to
+  // kPixelTypeRGBA.  If |generate_mipmaps| is set, mipmaps are generated
+  // from the rendered image where the device allows it for its size.  |id|
+  // is the id of the node, which the GPU timing of the pass refers to.
+  RenderTarget(Device* device, EntifyId id, int width_in_pixels,
+               int height_in_pixels,
+               PixelType pixel_type, bool generate_mipmaps,
                const std::shared_ptr<DrawTree>& draw_tree);
   ~RenderTarget();
 
   GLuint handle() const override { return texture_handle_; }
+  TextureParameters* parameters() override { return &parameters_; }
+  bool has_mipmaps() const override { return has_mipmaps_; }
+  // The format that was allocated, which may differ from the requested one.
+  PixelType pixel_type() const { return pixel_type_; }
 
  private:
+  Device* device_;
   GLuint texture_handle_;
+  TextureParameters parameters_;
+  PixelType pixel_type_;
+  bool has_mipmaps_;
 };
 
 class PixelData : public Texture {
  public:
-  PixelData(int width_in_pixels, int height_in_pixels, int stride_in_bytes,
-          PixelType pixel_type, std::vector<char>&& data);
+  // Uploads |image|, see PreparePixelImage().  If the image has an error,
+  // the PixelData takes it on.
+  PixelData(Device* device, PixelImage&& image);
   ~PixelData();
 
+  // Non-empty if the texture could not be created.
+  const std::string& error() const { return error_; }
+
   int stride_in_bytes() const { return stride_in_bytes_; }
+  // The format of the texture on the GPU, which may differ from the one
+  // that it was created with.
   PixelType pixel_type() const { return pixel_type_; }
-  GLuint handle() const override { return handle_; }
+  int bytes_per_pixel() const;
+  GLuint handle() const override { return handles_[front_]; }
+  TextureParameters* parameters() override;
+  bool has_mipmaps() const override { return has_mipmaps_; }
+  bool atlased() const override { return atlas_allocation_.page != nullptr; }
+  UVTransform uv_transform() const override;
+
+  bool updatable() const { return updatable_; }
+  bool double_buffered() const { return double_buffered_; }
+  // The size of the CPU copy of the image that double buffered textures
+  // keep, which has the rows |stride_in_bytes()| apart.
+  int64_t shadow_size_in_bytes() const { return shadow_.size(); }
+
+  // Overwrites the |width| x |height| region with its first pixel at
+  // (|x|, |y|) with |data|, whose rows are |stride_in_bytes| apart.  The
+  // region must lie within the texture.  The coordinates and |data| are in
+  // the layout that the texture was created with.  Mipmaps are regenerated
+  // from the whole image.
+  void UpdateRegion(int x, int y, int width, int height, int stride_in_bytes,
+                    const char* data);
+
+  // For double buffered textures, makes the updates since the last call
+  // visible.  Does nothing if there were none.
+  void SwapBuffers();
 
  private:
+  // A rectangle of pixels, empty if |x1| <= |x0|.
+  struct Region {
+    int x0 = 0;
+    int y0 = 0;
+    int x1 = 0;
+    int y1 = 0;
+
+    bool empty() const { return x1 <= x0 || y1 <= y0; }
+    void Add(const Region& other);
+  };
+
+  // Uploads |region| to |handle| from |data|, which points at the region's
+  // top left pixel and has rows |stride_in_bytes| apart.
+  void UploadRegion(GLuint handle, const Region& region, int stride_in_bytes,
+                    const char* data);
+
+  Device* device_;
+  std::string error_;
   int stride_in_bytes_;
   PixelType pixel_type_;
-  GLuint handle_;
+  // The layout of the data passed to UpdateRegion().
+  PixelLayout layout_;
+  bool updatable_;
+  bool double_buffered_;
+  bool has_mipmaps_;
+  // The second handle is only used if |double_buffered_| is set.
+  GLuint handles_[2];
+  TextureParameters parameters_[2];
+  int front_;
+  // The region of the atlas page that |handles_[0]| refers to, if atlased.
+  TextureAtlas::Allocation atlas_allocation_;
+
+  // The remaining members are only used if |double_buffered_| is set.
+  // A copy of the latest image, from which the back buffer is brought up to
+  // date with the updates that went to the other buffer.
+  std::vector<char> shadow_;
+  // The regions updated in the back buffer since the last swap.
+  Region updated_;
+  // The regions that the back buffer is missing.
+  Region stale_;
 };
 
 }  // namespace render_tree
@@ -2,14 +2,20 @@
 #define _SRC_ENTIFY_RENDERER_GLES2_RENDER_TREE_TYPES_H_
 
 #include <cassert>
+#include <cstdint>
 #include <vector>
 
+#include <GLES2/gl2.h>
+#include <GLES2/gl2ext.h>
+
 namespace entify {
 namespace renderer {
 namespace gles2 {
 namespace render_tree {
 
-enum Type {
+// A fixed-length uniform array has the type of its elements combined with
+// its length, see MakeArrayType().  Sized, so that those values are valid.
+enum Type : int32_t {
   TypeInvalid,
 
   TypeFloat32V1,
@@ -22,6 +28,28 @@ enum Type {
   TypeUInt8V3,
   TypeUInt8V4,
   TypeSampler,
+
+  // Vertex attribute only types.
+  TypeFloat16V1,
+  TypeFloat16V2,
+  TypeFloat16V3,
+  TypeFloat16V4,
+  TypeInt16V1,
+  TypeInt16V2,
+  TypeInt16V3,
+  TypeInt16V4,
+  TypeUInt16V1,
+  TypeUInt16V2,
+  TypeUInt16V3,
+  TypeUInt16V4,
+  TypeUNorm8V1,
+  TypeUNorm8V2,
+  TypeUNorm8V3,
+  TypeUNorm8V4,
+  TypeSNorm16V1,
+  TypeSNorm16V2,
+  TypeSNorm16V3,
+  TypeSNorm16V4,
 };
 
 inline GLenum TypeToGLType(Type type) {
@@ -35,6 +63,26 @@ inline GLenum TypeToGLType(Type type) {
     case TypeUInt8V2: return GL_UNSIGNED_BYTE;
     case TypeUInt8V3: return GL_UNSIGNED_BYTE;
     case TypeUInt8V4: return GL_UNSIGNED_BYTE;
+    case TypeFloat16V1: return GL_HALF_FLOAT_OES;
+    case TypeFloat16V2: return GL_HALF_FLOAT_OES;
+    case TypeFloat16V3: return GL_HALF_FLOAT_OES;
+    case TypeFloat16V4: return GL_HALF_FLOAT_OES;
+    case TypeInt16V1: return GL_SHORT;
+    case TypeInt16V2: return GL_SHORT;
+    case TypeInt16V3: return GL_SHORT;
+    case TypeInt16V4: return GL_SHORT;
+    case TypeUInt16V1: return GL_UNSIGNED_SHORT;
+    case TypeUInt16V2: return GL_UNSIGNED_SHORT;
+    case TypeUInt16V3: return GL_UNSIGNED_SHORT;
+    case TypeUInt16V4: return GL_UNSIGNED_SHORT;
+    case TypeUNorm8V1: return GL_UNSIGNED_BYTE;
+    case TypeUNorm8V2: return GL_UNSIGNED_BYTE;
+    case TypeUNorm8V3: return GL_UNSIGNED_BYTE;
+    case TypeUNorm8V4: return GL_UNSIGNED_BYTE;
+    case TypeSNorm16V1: return GL_SHORT;
+    case TypeSNorm16V2: return GL_SHORT;
+    case TypeSNorm16V3: return GL_SHORT;
+    case TypeSNorm16V4: return GL_SHORT;
     default:
       assert(false);
       return 0;
@@ -45,6 +93,9 @@ inline int GLTypeToComponentSize(GLenum gl_type) {
   switch (gl_type) {
     case GL_FLOAT: return 4;
     case GL_UNSIGNED_BYTE: return 1;
+    case GL_HALF_FLOAT_OES: return 2;
+    case GL_SHORT: return 2;
+    case GL_UNSIGNED_SHORT: return 2;
     default:
       assert(false);
       return -1;
@@ -62,18 +113,127 @@ inline int TypeToComponentCount(Type type) {
     case TypeUInt8V2: return 2;
     case TypeUInt8V3: return 3;
     case TypeUInt8V4: return 4;
+    case TypeFloat16V1: return 1;
+    case TypeFloat16V2: return 2;
+    case TypeFloat16V3: return 3;
+    case TypeFloat16V4: return 4;
+    case TypeInt16V1: return 1;
+    case TypeInt16V2: return 2;
+    case TypeInt16V3: return 3;
+    case TypeInt16V4: return 4;
+    case TypeUInt16V1: return 1;
+    case TypeUInt16V2: return 2;
+    case TypeUInt16V3: return 3;
+    case TypeUInt16V4: return 4;
+    case TypeUNorm8V1: return 1;
+    case TypeUNorm8V2: return 2;
+    case TypeUNorm8V3: return 3;
+    case TypeUNorm8V4: return 4;
+    case TypeSNorm16V1: return 1;
+    case TypeSNorm16V2: return 2;
+    case TypeSNorm16V3: return 3;
+    case TypeSNorm16V4: return 4;
     default:
       assert(false);
       return -1;
   }
 }
 
+// The length of an array type is stored in the bits above the element type,
+// so that arrays of different lengths are different types.
+const int kTypeArrayLengthShift = 8;
+// The longest array whose length fits above the element type.
+const int32_t kMaxTypeArrayLength = (1 << (31 - kTypeArrayLengthShift)) - 1;
+
+inline Type MakeArrayType(Type element_type, int32_t length) {
+  assert(length > 0 && length <= kMaxTypeArrayLength);
+  return static_cast<Type>(element_type | (length << kTypeArrayLengthShift));
+}
+
+// The type of the elements of array type |type|, or |type| itself if it is
+// not an array.
+inline Type TypeArrayElementType(Type type) {
+  return static_cast<Type>(type & ((1 << kTypeArrayLengthShift) - 1));
+}
+
+// 0 if |type| is not an array.
+inline int32_t TypeArrayLength(Type type) {
+  return type >> kTypeArrayLengthShift;
+}
+
+// Uniform arrays can only hold floats, vectors of floats or mat4s.
+inline bool IsValidArrayElementType(Type type) {
+  switch (type) {
+    case TypeFloat32V1:
+    case TypeFloat32V2:
+    case TypeFloat32V3:
+    case TypeFloat32V4:
+    case TypeFloat32M44:
+      return true;
+    default:
+      return false;
+  }
+}
+
 inline int TypeToSize(Type type) {
+  if (TypeArrayLength(type) > 0) {
+    return TypeToSize(TypeArrayElementType(type)) * TypeArrayLength(type);
+  }
   return GLTypeToComponentSize(TypeToGLType(type)) * TypeToComponentCount(type);
 }
 
+// Whether the integer components of a vertex attribute of type |type| are
+// mapped to [0, 1] (unsigned) or [-1, 1] (signed) rather than converted to
+// floats as they are.
+inline bool TypeIsNormalized(Type type) {
+  switch (type) {
+    case TypeUNorm8V1:
+    case TypeUNorm8V2:
+    case TypeUNorm8V3:
+    case TypeUNorm8V4:
+    case TypeSNorm16V1:
+    case TypeSNorm16V2:
+    case TypeSNorm16V3:
+    case TypeSNorm16V4:
+      return true;
+    default:
+      return false;
+  }
+}
+
+inline bool TypeIsHalfFloat(Type type) {
+  return type == TypeFloat16V1 || type == TypeFloat16V2 ||
+         type == TypeFloat16V3 || type == TypeFloat16V4;
+}
+
 using TypeTuple = std::vector<Type>;
 
+// The array type of |length| |element_type|s, or |element_type| itself if
+// |length| is not positive.  TypeInvalid if the array is too long to be
+// represented.
+inline Type MakeTypeWithArrayLength(Type element_type, int32_t length) {
+  if (length <= 0) {
+    return element_type;
+  }
+  if (length > kMaxTypeArrayLength) {
+    return TypeInvalid;
+  }
+  return MakeArrayType(element_type, length);
+}
+
+// Whether every type in |types| can be a uniform: a sampler, or a float,
+// vector of floats or mat4, or an array of those.  The other types can only
+// be vertex attributes.  TypeInvalid is never valid.
+inline bool AreValidUniformTypes(const TypeTuple& types) {
+  for (Type type : types) {
+    if (type != TypeSampler &&
+        !IsValidArrayElementType(TypeArrayElementType(type))) {
+      return false;
+    }
+  }
+  return true;
+}
+
 }  // namespace render_tree
 }  // namespace gles2
 }  // namespace renderer
@@ -1,6 +1,10 @@
 #ifndef _SRC_ENTIFY_RENDERER_GLES2_RENDER_TREE_UNIFORM_VALUES_H_
 #define _SRC_ENTIFY_RENDERER_GLES2_RENDER_TREE_UNIFORM_VALUES_H_
 
+#include <algorithm>
+#include <cassert>
+#include <string>
+
 #include <GLES2/gl2.h>
 
 #include "src/renderer/gles2/render_tree/sampler.h"
@@ -14,8 +18,31 @@ namespace render_tree {
 class UniformValues {
  public:
   UniformValues(TypeTuple&& types, std::vector<char>&& data,
-                std::vector<std::shared_ptr<Sampler>>&& samplers)
-      : types_(types), data_(data), samplers_(std::move(samplers)) {}
+                std::vector<std::shared_ptr<Sampler>>&& samplers,
+                bool updatable)
+      : types_(types), data_(data), samplers_(std::move(samplers)),
+        updatable_(updatable) {
+    if (!AreValidUniformTypes(types_)) {
+      error_ = "UniformValues types must be samplers, or floats, vectors of "
+               "floats or mat4s, or arrays of up to 8388607 of those.";
+      return;
+    }
+    size_t data_size = 0;
+    size_t num_samplers = 0;
+    for (Type type : types_) {
+      if (type == TypeSampler) {
+        ++num_samplers;
+      } else {
+        data_size += TypeToSize(type);
+      }
+    }
+    if (data_.size() < data_size) {
+      error_ = "UniformValues data is too small for its types.";
+    } else if (samplers_.size() != num_samplers) {
+      error_ = "UniformValues must have a sampler for each of its sampler "
+               "types.";
+    }
+  }
   ~UniformValues() {}
 
   const TypeTuple& types() const { return types_; }
@@ -24,10 +51,23 @@ class UniformValues {
     return samplers_;
   }
 
+  bool updatable() const { return updatable_; }
+  // Overwrites the values of an updatable node.  |data| must be the same
+  // size as the current data.
+  void UpdateData(const char* data, size_t data_size) {
+    assert(updatable_);
+    assert(data_size == data_.size());
+    std::copy(data, data + data_size, data_.begin());
+  }
+
+  const std::string& error() const { return error_; }
+
  private:
   TypeTuple types_;
   std::vector<char> data_;
   std::vector<std::shared_ptr<Sampler>> samplers_;
+  bool updatable_;
+  std::string error_;
 };
 
 }  // namespace render_tree
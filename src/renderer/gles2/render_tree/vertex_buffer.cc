@@ -1,7 +1,10 @@
 #include "src/renderer/gles2/render_tree/vertex_buffer.h"
 
+#include <cassert>
+
 #include <GLES2/gl2.h>
 
+#include "src/renderer/gles2/mesh_optimizer.h"
 #include "src/renderer/gles2/utils.h"
 
 namespace entify {
@@ -9,23 +12,78 @@ namespace renderer {
 namespace gles2 {
 namespace render_tree {
 
-VertexBuffer::VertexBuffer(const char* data, int32_t num_bytes,
-                           int32_t stride_in_bytes,
+VertexBuffer::VertexBuffer(Device* device, const char* data,
+                           int32_t num_bytes, int32_t stride_in_bytes,
                            std::vector<int32_t>&& data_offsets,
-                           TypeTuple&& types)
-    : stride_in_bytes_(stride_in_bytes),
-      num_vertices_(num_bytes / stride_in_bytes),
-      types_(std::move(types)),
-      data_offsets_(std::move(data_offsets)) {
+                           TypeTuple&& types, bool transient,
+                           bool weld_vertices, bool batchable)
+    : device_(device),
+      layout_(device->vertex_buffer_pool()->GetLayout(
+          stride_in_bytes, types, data_offsets)),
+      transient_(transient), stream_pass_(-1) {
   int components_size_sum = 0;
-  for (const auto& type : types_) {
+  for (const auto& type : layout_->types) {
     components_size_sum += TypeToSize(type);
   }
-  assert(components_size_sum == stride_in_bytes_);
+  assert(components_size_sum == stride_in_bytes);
+
+  for (const auto& type : layout_->types) {
+    if (TypeIsHalfFloat(type) && !device->supports_half_float_vertices()) {
+      error_ = "VertexBuffer has half float attributes, which require "
+               "GL_OES_vertex_half_float.";
+      return;
+    }
+  }
+
+  int32_t num_vertices = num_bytes / stride_in_bytes;
+
+  std::vector<char> welded_data;
+  if (weld_vertices && num_vertices > 0) {
+    std::vector<uint32_t> indices;
+    WeldVertices(data, num_vertices, stride_in_bytes, &welded_data, &indices);
+    int32_t num_unique_vertices = welded_data.size() / stride_in_bytes;
+    // Indices are at most 16 bits wide in GLES2, and there is nothing to gain
+    // if no vertices were merged.
+    if (num_unique_vertices <= 0x10000 &&
+        num_unique_vertices < num_vertices) {
+      OptimizeVertexCache(&indices, num_unique_vertices);
+      num_vertices = OptimizeVertexFetch(
+          &indices, &welded_data, stride_in_bytes);
+      data = welded_data.data();
+      welded_index_buffer_ = std::make_shared<IndexBuffer>(device, indices);
+    }
+  }
+
+  int32_t num_bytes_used = num_vertices * stride_in_bytes;
+  if (transient_ ||
+      (batchable && !welded_index_buffer_ &&
+       num_bytes_used <=
+           StaticBatcher::kMaxBatchedVertexBufferSizeInBytes &&
+       device_->static_batcher()->ReserveVertexData(num_bytes_used))) {
+    data_.assign(data, data + num_bytes_used);
+  }
+
+  if (transient_) {
+    allocation_.handle = 0;
+    allocation_.first_vertex = 0;
+    allocation_.num_vertices = num_vertices;
+    allocation_.page = nullptr;
+  } else {
+    allocation_ = device_->vertex_buffer_pool()->Allocate(
+        layout_, data, num_vertices);
+  }
+}
+
+void VertexBuffer::Stream(StreamVertexBuffer* stream) {
+  assert(transient_);
+  if (stream_pass_ == stream->pass()) {
+    return;
+  }
 
-  GL_CALL(glGenBuffers(1, &handle_));
-  GL_CALL(glBindBuffer(GL_ARRAY_BUFFER, handle_));
-  GL_CALL(glBufferData(GL_ARRAY_BUFFER, num_bytes, data, GL_STATIC_DRAW));
+  stream_pass_ = stream->pass();
+  allocation_.first_vertex = stream->Append(
+      data_.data(), data_.size(), stride_in_bytes());
+  allocation_.handle = stream->handle();
 }
 
 }  // namespace render_tree
@@ -1,35 +1,86 @@
 #ifndef _SRC_ENTIFY_RENDERER_GLES2_RENDER_TREE_VERTEX_BUFFER_H_
 #define _SRC_ENTIFY_RENDERER_GLES2_RENDER_TREE_VERTEX_BUFFER_H_
 
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
 #include <GLES2/gl2.h>
 
+#include "src/renderer/gles2/device.h"
+#include "src/renderer/gles2/render_tree/index_buffer.h"
 #include "src/renderer/gles2/render_tree/types.h"
+#include "src/renderer/gles2/static_batcher.h"
+#include "src/renderer/gles2/stream_vertex_buffer.h"
+#include "src/renderer/gles2/vertex_buffer_pool.h"
 
 namespace entify {
 namespace renderer {
 namespace gles2 {
 namespace render_tree {
 
+// The vertices of small vertex buffers are stored in a GL buffer that is
+// shared with other vertex buffers of the same layout, starting at
+// first_vertex().  Transient vertex buffers keep their data on the CPU and
+// are streamed into the device's StreamVertexBuffer by each pass that draws
+// them.  Small vertex buffers that are |batchable| also keep a copy of their
+// data, so that the StaticBatcher can merge them, unless the copies already
+// kept use up its budget.  Welded vertex buffers have their duplicate
+// vertices merged and are drawn through an index buffer of their own.
 class VertexBuffer {
  public:
-  VertexBuffer(const char* data, int32_t num_bytes, int32_t stride_in_bytes,
-               std::vector<int32_t>&& data_offsets, TypeTuple&& types);
+  VertexBuffer(Device* device, const char* data, int32_t num_bytes,
+               int32_t stride_in_bytes, std::vector<int32_t>&& data_offsets,
+               TypeTuple&& types, bool transient = false,
+               bool weld_vertices = false, bool batchable = true);
   ~VertexBuffer() {
-    glDeleteBuffers(1, &handle_);
+    if (!transient_ && error_.empty()) {
+      device_->vertex_buffer_pool()->Free(allocation_);
+      device_->static_batcher()->ReleaseVertexData(data_.size());
+    }
+  }
+
+  // For transient vertex buffers, these refer to where the data was
+  // streamed to by the last call to Stream().
+  GLuint handle() const { return allocation_.handle; }
+  int32_t first_vertex() const { return allocation_.first_vertex; }
+  int32_t num_vertices() const { return allocation_.num_vertices; }
+  // Vertex buffers with equal layouts share the same layout object.
+  const VertexBufferPool::Layout* layout() const { return layout_; }
+  int32_t stride_in_bytes() const { return layout_->stride_in_bytes; }
+  const TypeTuple& types() const { return layout_->types; }
+  const std::vector<int32_t>& data_offsets() const {
+    return layout_->data_offsets;
   }
 
-  GLuint handle() const { return handle_; }
-  int32_t num_vertices() const { return num_vertices_; }
-  int32_t stride_in_bytes() const { return stride_in_bytes_; }
-  const TypeTuple& types() const { return types_; }
-  const std::vector<int32_t>& data_offsets() const { return data_offsets_; }
+  // If the vertex buffer was welded, the indices that reproduce the original
+  // sequence of vertices, otherwise null.
+  const std::shared_ptr<IndexBuffer>& welded_index_buffer() const {
+    return welded_index_buffer_;
+  }
+
+  bool transient() const { return transient_; }
+  // The vertex data, if it was kept on the CPU, otherwise empty.
+  const std::vector<char>& data() const { return data_; }
+  // Adds the data of a transient vertex buffer to the current pass of
+  // |stream|, unless it is already there.  Must be called during each pass
+  // that draws the buffer, before any of the draws.
+  void Stream(StreamVertexBuffer* stream);
+
+  const std::string& error() const { return error_; }
 
  private:
-  GLuint handle_;
-  int32_t num_vertices_;
-  int32_t stride_in_bytes_;
-  TypeTuple types_;
-  std::vector<int32_t> data_offsets_;
+  Device* device_;
+  const VertexBufferPool::Layout* layout_;
+  VertexBufferPool::Allocation allocation_;
+  std::shared_ptr<IndexBuffer> welded_index_buffer_;
+
+  bool transient_;
+  std::vector<char> data_;
+  // The StreamVertexBuffer pass that the data was last added to.
+  int64_t stream_pass_;
+  std::string error_;
 };
 
 }  // namespace render_tree
@@ -7,6 +7,7 @@
 
 #include <GLES2/gl2.h>
 
+#include "src/renderer/gles2/device.h"
 #include "src/renderer/gles2/render_tree/types.h"
 
 namespace entify {
@@ -17,12 +18,13 @@ namespace render_tree {
 class VertexShader {
  public:
   VertexShader(
-      const std::string& source,
+      Device* device, const std::string& source,
       std::pair<std::vector<std::string>, TypeTuple>&& input_types,
       TypeTuple&& output_types,
       std::pair<std::vector<std::string>, TypeTuple>&& uniform_types);
   ~VertexShader() {
-    glDeleteShader(handle_);
+    device_->deletion_queue()->Enqueue(
+        DeletionQueue::kHandleTypeShader, handle_);
   }
 
   GLuint handle() const { return handle_; }
@@ -40,6 +42,7 @@ class VertexShader {
   const std::string& error() const { return error_; }
 
  private:
+  Device* device_;
   GLuint handle_;
   TypeTuple input_types_;
   std::vector<std::string> vertex_attribute_names_;
@@ -0,0 +1,228 @@
+#include "src/renderer/gles2/static_batcher.h"
+
+#include <cassert>
+#include <map>
+#include <tuple>
+
+#include "src/renderer/gles2/render_tree/draw_call.h"
+#include "src/renderer/gles2/render_tree/vertex_buffer.h"
+
+namespace entify {
+namespace renderer {
+namespace gles2 {
+
+namespace {
+// Batches that have not been drawn for this many frames are dropped.  More
+// than one, so that batches survive when windows are submitted in turn.
+const int64_t kMaxUnusedFrames = 4;
+
+// Runs are merged once they were drawn in this many frames.
+const int64_t kMinFramesDrawnBeforeMerging = 3;
+
+// Only lists of primitives can be concatenated.  Each vertex buffer must hold
+// whole primitives, or the primitives of the ones after it would shift.
+int32_t VerticesPerPrimitive(GLenum primitive_mode) {
+  switch (primitive_mode) {
+    case GL_TRIANGLES: return 3;
+    case GL_LINES: return 2;
+    case GL_POINTS: return 1;
+    default: return 0;
+  }
+}
+
+bool IsBatchable(const render_tree::DrawCall* draw_call) {
+  const auto& vertex_buffer = draw_call->vertex_buffer();
+  int32_t vertices_per_primitive = VerticesPerPrimitive(
+      draw_call->pipeline()->params().primitive_mode);
+  return vertices_per_primitive > 0 && !draw_call->index_buffer() &&
+         !vertex_buffer->transient() && !vertex_buffer->data().empty() &&
+         vertex_buffer->num_vertices() % vertices_per_primitive == 0;
+}
+
+bool CanBatchTogether(const render_tree::DrawCall* a,
+                      const render_tree::DrawCall* b) {
+  return a->pipeline() == b->pipeline() &&
+         a->vertex_uniform_values() == b->vertex_uniform_values() &&
+         a->fragment_uniform_values() == b->fragment_uniform_values() &&
+         a->vertex_buffer()->layout() == b->vertex_buffer()->layout();
+}
+}  // namespace
+
+StaticBatcher::~StaticBatcher() {}
+
+size_t StaticBatcher::KeyHash::operator()(
+    const std::vector<const void*>& key) const {
+  size_t hash = key.size();
+  for (const void* node : key) {
+    hash ^= std::hash<const void*>()(node) + 0x9e3779b9 + (hash << 6) +
+            (hash >> 2);
+  }
+  return hash;
+}
+
+void StaticBatcher::BatchDrawCalls(
+    const render_tree::DrawCall* const* begin,
+    const render_tree::DrawCall* const* end,
+    std::vector<const render_tree::DrawCall*>* draw_calls,
+    std::vector<size_t>* sources) {
+  std::vector<const void*> key;
+  auto run_begin = begin;
+  while (run_begin != end) {
+    auto run_end = run_begin + 1;
+    if (IsBatchable(*run_begin)) {
+      while (run_end != end && IsBatchable(*run_end) &&
+             CanBatchTogether(*run_begin, *run_end)) {
+        ++run_end;
+      }
+    }
+    if (run_end - run_begin < 2) {
+      sources->push_back(run_begin - begin);
+      draw_calls->push_back(*run_begin);
+      run_begin = run_end;
+      continue;
+    }
+
+    const render_tree::DrawCall* first = *run_begin;
+    key.clear();
+    key.push_back(first->pipeline().get());
+    key.push_back(first->vertex_uniform_values().get());
+    key.push_back(first->fragment_uniform_values().get());
+    for (auto iter = run_begin; iter != run_end; ++iter) {
+      key.push_back((*iter)->vertex_buffer().get());
+    }
+
+    // Until a run is merged, its entry does not hold its nodes, so a new run
+    // that reuses their addresses may inherit its count of frames.  This
+    // only makes it get merged sooner.
+    auto batch = batches_.find(key);
+    if (batch == batches_.end()) {
+      batch = batches_.emplace(key, Batch()).first;
+    }
+    if (batch->second.last_used_frame != frame_) {
+      batch->second.last_used_frame = frame_;
+      ++batch->second.num_frames_drawn;
+    }
+    if (!batch->second.draw_call &&
+        batch->second.num_frames_drawn >= kMinFramesDrawnBeforeMerging) {
+      MakeBatch(run_begin, run_end, &batch->second);
+    }
+
+    if (batch->second.draw_call) {
+      sources->push_back(run_begin - begin);
+      draw_calls->push_back(batch->second.draw_call.get());
+    } else {
+      for (auto iter = run_begin; iter != run_end; ++iter) {
+        sources->push_back(iter - begin);
+        draw_calls->push_back(*iter);
+      }
+    }
+
+    run_begin = run_end;
+  }
+}
+
+void StaticBatcher::MakeBatch(
+    const render_tree::DrawCall* const* begin,
+    const render_tree::DrawCall* const* end, Batch* batch) {
+  const render_tree::DrawCall* first = *begin;
+  const auto& first_vertex_buffer = first->vertex_buffer();
+
+  std::vector<char> data;
+  for (auto iter = begin; iter != end; ++iter) {
+    const auto& vertex_buffer = (*iter)->vertex_buffer();
+    data.insert(data.end(), vertex_buffer->data().begin(),
+                vertex_buffer->data().end());
+    batch->vertex_buffers.push_back(vertex_buffer);
+  }
+
+  // The merged buffer is neither transient nor welded, and is never merged
+  // again, so it does not keep a copy of its data.
+  auto vertex_buffer = std::make_shared<render_tree::VertexBuffer>(
+      device_, data.data(), static_cast<int32_t>(data.size()),
+      first_vertex_buffer->stride_in_bytes(),
+      std::vector<int32_t>(first_vertex_buffer->data_offsets()),
+      render_tree::TypeTuple(first_vertex_buffer->types()), false, false,
+      false);
+  batch->draw_call = std::make_shared<render_tree::DrawCall>(
+      first->pipeline(), vertex_buffer, first->vertex_uniform_values(),
+      first->fragment_uniform_values(), nullptr);
+  assert(batch->draw_call->error().empty());
+
+  batch->gpu_bytes = static_cast<int64_t>(data.size());
+  gpu_bytes_.fetch_add(batch->gpu_bytes, std::memory_order_relaxed);
+}
+
+void StaticBatcher::EndFrame() {
+  for (auto iter = batches_.begin(); iter != batches_.end();) {
+    if (frame_ - iter->second.last_used_frame >= kMaxUnusedFrames) {
+      gpu_bytes_.fetch_sub(
+          iter->second.gpu_bytes, std::memory_order_relaxed);
+      iter = batches_.erase(iter);
+    } else {
+      ++iter;
+    }
+  }
+  ++frame_;
+}
+
+void StaticBatcher::Shutdown() {
+  batches_.clear();
+  gpu_bytes_.store(0, std::memory_order_relaxed);
+}
+
+bool StaticBatcher::ReserveVertexData(int64_t num_bytes) {
+  int64_t kept_bytes = kept_vertex_data_bytes_.fetch_add(
+      num_bytes, std::memory_order_relaxed) + num_bytes;
+  if (kept_bytes > kMaxKeptVertexDataInBytes) {
+    kept_vertex_data_bytes_.fetch_sub(num_bytes, std::memory_order_relaxed);
+    return false;
+  }
+  return true;
+}
+
+void StaticBatcher::ReleaseVertexData(int64_t num_bytes) {
+  kept_vertex_data_bytes_.fetch_sub(num_bytes, std::memory_order_relaxed);
+}
+
+void GroupBatchableDrawCalls(
+    std::vector<std::shared_ptr<render_tree::DrawTree>>* draw_trees) {
+  typedef std::tuple<const void*, const void*, const void*, const void*>
+      GroupKey;
+  // Each group holds a draw tree that is not a batchable draw call, or the
+  // batchable draw calls that share a key, in the order they were found.
+  std::vector<std::vector<std::shared_ptr<render_tree::DrawTree>>> groups;
+  std::map<GroupKey, size_t> group_indices;
+
+  for (auto& draw_tree : *draw_trees) {
+    const auto* draw_call =
+        draw_tree->type() == render_tree::DrawTree::kTypeDrawCall ?
+            static_cast<const render_tree::DrawCall*>(draw_tree.get()) :
+            nullptr;
+    if (!draw_call || !IsBatchable(draw_call)) {
+      groups.emplace_back();
+      groups.back().push_back(std::move(draw_tree));
+      continue;
+    }
+
+    GroupKey key(draw_call->pipeline().get(),
+                 draw_call->vertex_uniform_values().get(),
+                 draw_call->fragment_uniform_values().get(),
+                 draw_call->vertex_buffer()->layout());
+    auto group_index = group_indices.emplace(key, groups.size()).first;
+    if (group_index->second == groups.size()) {
+      groups.emplace_back();
+    }
+    groups[group_index->second].push_back(std::move(draw_tree));
+  }
+
+  draw_trees->clear();
+  for (auto& group : groups) {
+    for (auto& draw_tree : group) {
+      draw_trees->push_back(std::move(draw_tree));
+    }
+  }
+}
+
+}  // namespace gles2
+}  // namespace renderer
+}  // namespace entify
@@ -0,0 +1,112 @@
+#ifndef _SRC_ENTIFY_RENDERER_GLES2_STATIC_BATCHER_H_
+#define _SRC_ENTIFY_RENDERER_GLES2_STATIC_BATCHER_H_
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace entify {
+namespace renderer {
+namespace gles2 {
+
+class Device;
+
+namespace render_tree {
+class DrawCall;
+class DrawTree;
+class VertexBuffer;
+}  // namespace render_tree
+
+// Merges runs of consecutive draw calls that share a pipeline and uniform
+// values, and only differ in their vertex buffers, into single draw calls
+// whose vertex buffer holds the vertices of the whole run.  A merged vertex
+// buffer is cached, keyed by the nodes of the draw calls it replaces.  A run
+// is only merged once it was drawn unchanged in a few frames, so that runs
+// which are edited all the time do not create a new buffer each frame, and
+// is then drawn with one glDrawArrays() for as long as it keeps being drawn.
+// Unless noted otherwise, methods must be called with a context current.
+class StaticBatcher {
+ public:
+  // Vertex buffers up to this size keep a copy of their data on the CPU so
+  // that it can be merged, as GL buffers can not be read back in GLES2.
+  static const int32_t kMaxBatchedVertexBufferSizeInBytes = 4 * 1024;
+  // The most memory that the copies of all vertex buffers together may take.
+  // Vertex buffers that are created while it is used up are not merged.
+  static const int64_t kMaxKeptVertexDataInBytes = 16 * 1024 * 1024;
+
+  explicit StaticBatcher(Device* device)
+      : device_(device), frame_(0), kept_vertex_data_bytes_(0),
+        gpu_bytes_(0) {}
+  ~StaticBatcher();
+
+  // Appends the draw calls in [|begin|, |end|) to |draw_calls|, with each run
+  // of draw calls that can be batched replaced by a single draw call.  For
+  // each draw call appended, the offset from |begin| of the first draw call
+  // that it stands for is appended to |sources|.  The batched draw calls are
+  // valid until the next call to EndFrame().
+  void BatchDrawCalls(const render_tree::DrawCall* const* begin,
+                      const render_tree::DrawCall* const* end,
+                      std::vector<const render_tree::DrawCall*>* draw_calls,
+                      std::vector<size_t>* sources);
+
+  // Drops the batches that have not been drawn for a few frames.
+  void EndFrame();
+  // Drops all batches.  Called when the device is torn down.
+  void Shutdown();
+
+  // Reserves room for a vertex buffer to keep |num_bytes| of its data on the
+  // CPU, returning false if that would exceed kMaxKeptVertexDataInBytes.
+  // Reserved room must be given back with ReleaseVertexData().  These may be
+  // called without a context current.
+  bool ReserveVertexData(int64_t num_bytes);
+  void ReleaseVertexData(int64_t num_bytes);
+
+  // The GPU memory held by the merged vertex buffers.  May be called from any
+  // thread.
+  int64_t gpu_bytes() const {
+    return gpu_bytes_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  struct KeyHash {
+    size_t operator()(const std::vector<const void*>& key) const;
+  };
+
+  // Until the run has been drawn in enough frames to be merged, only counts
+  // the frames.
+  struct Batch {
+    // Held so that the nodes the batch was keyed by are not freed, and their
+    // addresses reused, while the batch is cached.
+    std::vector<std::shared_ptr<render_tree::VertexBuffer>> vertex_buffers;
+    std::shared_ptr<render_tree::DrawCall> draw_call;
+    int64_t gpu_bytes = 0;
+    int64_t num_frames_drawn = 0;
+    int64_t last_used_frame = -1;
+  };
+
+  void MakeBatch(const render_tree::DrawCall* const* begin,
+                 const render_tree::DrawCall* const* end, Batch* batch);
+
+  Device* device_;
+  int64_t frame_;
+  // Keyed by the pipeline, vertex and fragment uniform values, and the
+  // vertex buffers of the run, in order.
+  std::unordered_map<std::vector<const void*>, Batch, KeyHash> batches_;
+  std::atomic<int64_t> kept_vertex_data_bytes_;
+  std::atomic<int64_t> gpu_bytes_;
+};
+
+// The children of a DrawSet may be drawn in any order, so this reorders
+// |draw_trees| such that draw calls which StaticBatcher could merge are next
+// to each other: each such draw call is moved up to follow the first one it
+// could be merged with.  The order is otherwise kept.
+void GroupBatchableDrawCalls(
+    std::vector<std::shared_ptr<render_tree::DrawTree>>* draw_trees);
+
+}  // namespace gles2
+}  // namespace renderer
+}  // namespace entify
+
+#endif  // _SRC_ENTIFY_RENDERER_GLES2_STATIC_BATCHER_H_
@@ -0,0 +1,68 @@
+#include "src/renderer/gles2/stream_vertex_buffer.h"
+
+#include <cassert>
+#include <algorithm>
+#include <cstring>
+
+#include "src/renderer/gles2/utils.h"
+
+namespace entify {
+namespace renderer {
+namespace gles2 {
+
+void StreamVertexBuffer::Begin() {
+  current_ = (current_ + 1) % kRingSize;
+  ++pass_;
+  staging_.clear();
+}
+
+int32_t StreamVertexBuffer::Append(
+    const char* data, int32_t num_bytes, int32_t stride_in_bytes) {
+  assert(stride_in_bytes > 0);
+  if (handles_[current_] == 0) {
+    GL_CALL(glGenBuffers(1, &handles_[current_]));
+  }
+
+  // Vertices are addressed by index when drawing, so each block of data must
+  // start at a multiple of its stride.
+  size_t first_vertex =
+      (staging_.size() + stride_in_bytes - 1) / stride_in_bytes;
+  size_t offset = first_vertex * stride_in_bytes;
+  staging_.resize(offset + num_bytes);
+  if (num_bytes > 0) {
+    memcpy(staging_.data() + offset, data, num_bytes);
+  }
+  return static_cast<int32_t>(first_vertex);
+}
+
+void StreamVertexBuffer::End() {
+  if (staging_.empty()) {
+    return;
+  }
+
+  GL_CALL(glBindBuffer(GL_ARRAY_BUFFER, handles_[current_]));
+  size_t& capacity = capacities_[current_];
+  if (capacity < staging_.size()) {
+    // Grow geometrically so that the buffer settles on a size quickly.
+    capacity = std::max(capacity * 2, staging_.size());
+  }
+  // Respecifying the storage orphans the previous contents, which may still
+  // be in use by draws from a few passes ago, instead of waiting for them.
+  GL_CALL(glBufferData(GL_ARRAY_BUFFER, capacity, nullptr, GL_STREAM_DRAW));
+  GL_CALL(glBufferSubData(GL_ARRAY_BUFFER, 0, staging_.size(),
+                          staging_.data()));
+}
+
+void StreamVertexBuffer::Shutdown() {
+  for (int i = 0; i < kRingSize; ++i) {
+    if (handles_[i] != 0) {
+      deletion_queue_->Enqueue(DeletionQueue::kHandleTypeBuffer, handles_[i]);
+      handles_[i] = 0;
+      capacities_[i] = 0;
+    }
+  }
+}
+
+}  // namespace gles2
+}  // namespace renderer
+}  // namespace entify
@@ -0,0 +1,61 @@
+#ifndef _SRC_ENTIFY_RENDERER_GLES2_STREAM_VERTEX_BUFFER_H_
+#define _SRC_ENTIFY_RENDERER_GLES2_STREAM_VERTEX_BUFFER_H_
+
+#include <cstdint>
+#include <vector>
+
+#include <GLES2/gl2.h>
+
+#include "src/renderer/gles2/deletion_queue.h"
+
+namespace entify {
+namespace renderer {
+namespace gles2 {
+
+// A small ring of GL buffers that the data of transient vertex buffers is
+// streamed into.  Each render pass gathers the data of the transient vertex
+// buffers it draws and uploads it to the next buffer of the ring in one go,
+// orphaning what that buffer held before, so that transient geometry never
+// needs GL buffers of its own.  All methods must be called with a context
+// current.
+class StreamVertexBuffer {
+ public:
+  explicit StreamVertexBuffer(DeletionQueue* deletion_queue)
+      : deletion_queue_(deletion_queue) {}
+
+  // Starts gathering the data for a new pass.
+  void Begin();
+  // Adds |num_bytes| of vertex data to the pass and returns the index of its
+  // first vertex within the buffer, in units of |stride_in_bytes|.
+  int32_t Append(const char* data, int32_t num_bytes, int32_t stride_in_bytes);
+  // Uploads the data added since Begin() to handle().
+  void End();
+
+  // The buffer that the current pass's data is uploaded to.  Only valid once
+  // data has been added to the pass.
+  GLuint handle() const { return handles_[current_]; }
+  // Identifies the current pass, so that data that is drawn more than once
+  // in a pass only needs to be added once.
+  int64_t pass() const { return pass_; }
+
+  // Releases the buffers.  Called when the device is torn down.
+  void Shutdown();
+
+ private:
+  static const int kRingSize = 3;
+
+  DeletionQueue* deletion_queue_;
+
+  GLuint handles_[kRingSize] = {};
+  size_t capacities_[kRingSize] = {};
+  int current_ = 0;
+  int64_t pass_ = 0;
+
+  std::vector<char> staging_;
+};
+
+}  // namespace gles2
+}  // namespace renderer
+}  // namespace entify
+
+#endif  // _SRC_ENTIFY_RENDERER_GLES2_STREAM_VERTEX_BUFFER_H_
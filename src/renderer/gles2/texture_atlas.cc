@@ -0,0 +1,223 @@
+#include "src/renderer/gles2/texture_atlas.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <iterator>
+
+#include "src/renderer/gles2/utils.h"
+
+namespace entify {
+namespace renderer {
+namespace gles2 {
+
+namespace {
+// The pixels copied around each image.
+const int kBorderInPixels = 1;
+// Shelf heights are rounded up to a multiple of this, so that images of
+// about the same height share shelves.
+const int kShelfHeightAlignment = 8;
+const int kBytesPerPixel = 4;
+const int64_t kPageSizeInBytes =
+    static_cast<int64_t>(TextureAtlas::kPageSizeInPixels) *
+    TextureAtlas::kPageSizeInPixels * kBytesPerPixel;
+
+// Copies the image into the middle of |padded|, and its edge pixels into
+// the border around it.
+void PadImage(const char* pixels, int width, int height,
+              std::vector<char>* padded) {
+  int padded_width = width + 2 * kBorderInPixels;
+  int padded_height = height + 2 * kBorderInPixels;
+  padded->resize(
+      static_cast<size_t>(padded_width) * padded_height * kBytesPerPixel);
+  for (int y = 0; y < padded_height; ++y) {
+    int source_y =
+        std::min(std::max(y - kBorderInPixels, 0), height - 1);
+    const char* source_row =
+        pixels + static_cast<size_t>(source_y) * width * kBytesPerPixel;
+    char* row = padded->data() +
+                static_cast<size_t>(y) * padded_width * kBytesPerPixel;
+    memcpy(row, source_row, kBytesPerPixel);
+    memcpy(row + kBorderInPixels * kBytesPerPixel, source_row,
+           width * kBytesPerPixel);
+    memcpy(row + (padded_width - 1) * kBytesPerPixel,
+           source_row + (width - 1) * kBytesPerPixel, kBytesPerPixel);
+  }
+}
+}  // namespace
+
+TextureAtlas::Allocation TextureAtlas::Allocate(
+    const char* pixels, int width_in_pixels, int height_in_pixels) {
+  Allocation allocation;
+  if (width_in_pixels <= 0 || height_in_pixels <= 0 ||
+      width_in_pixels > kMaxImageSizeInPixels ||
+      height_in_pixels > kMaxImageSizeInPixels) {
+    return allocation;
+  }
+
+  int padded_width = width_in_pixels + 2 * kBorderInPixels;
+  int padded_height = height_in_pixels + 2 * kBorderInPixels;
+  int x, y;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto& page : pages_) {
+      if (AllocateFromPage(page.get(), padded_width, padded_height, &x, &y)) {
+        allocation.page = page.get();
+        break;
+      }
+    }
+
+    if (!allocation.page) {
+      std::unique_ptr<Page> page(new Page());
+      page->used_height = 0;
+      page->num_allocations = 0;
+      GL_CALL(glGenTextures(1, &page->handle));
+      GL_CALL(glBindTexture(GL_TEXTURE_2D, page->handle));
+      GL_CALL(glTexImage2D(
+          GL_TEXTURE_2D, 0, GL_RGBA, kPageSizeInPixels, kPageSizeInPixels, 0,
+          GL_RGBA, GL_UNSIGNED_BYTE, nullptr));
+      bool allocated = AllocateFromPage(
+          page.get(), padded_width, padded_height, &x, &y);
+      assert(allocated);
+      (void)allocated;
+      allocation.page = page.get();
+      pages_.push_back(std::move(page));
+      gpu_bytes_ += kPageSizeInBytes;
+    }
+    ++allocation.page->num_allocations;
+  }
+  gpu_bytes_ -= static_cast<int64_t>(width_in_pixels) * height_in_pixels *
+                kBytesPerPixel;
+
+  allocation.handle = allocation.page->handle;
+  allocation.x = x + kBorderInPixels;
+  allocation.y = y + kBorderInPixels;
+  allocation.width_in_pixels = width_in_pixels;
+  allocation.height_in_pixels = height_in_pixels;
+
+  std::vector<char> padded;
+  PadImage(pixels, width_in_pixels, height_in_pixels, &padded);
+  GL_CALL(glPixelStorei(GL_UNPACK_ALIGNMENT, 4));
+  GL_CALL(glBindTexture(GL_TEXTURE_2D, allocation.handle));
+  GL_CALL(glTexSubImage2D(GL_TEXTURE_2D, 0, x, y, padded_width,
+                          padded_height, GL_RGBA, GL_UNSIGNED_BYTE,
+                          padded.data()));
+  GL_CALL(glBindTexture(GL_TEXTURE_2D, 0));
+  return allocation;
+}
+
+bool TextureAtlas::AllocateFromPage(
+    Page* page, int width, int height, int* x, int* y) {
+  int shelf_height = (height + kShelfHeightAlignment - 1) /
+                     kShelfHeightAlignment * kShelfHeightAlignment;
+
+  // Shelves of the same height first, then a new shelf, and once the page is
+  // out of rows, the lowest of the taller shelves.
+  Shelf* found = nullptr;
+  std::map<int, int>::iterator found_span;
+  for (Shelf& shelf : page->shelves) {
+    if (shelf.height < shelf_height ||
+        (found && shelf.height >= found->height)) {
+      continue;
+    }
+    auto span = std::find_if(
+        shelf.free_spans.begin(), shelf.free_spans.end(),
+        [width](const std::pair<const int, int>& span) {
+          return span.second >= width;
+        });
+    if (span != shelf.free_spans.end()) {
+      found = &shelf;
+      found_span = span;
+    }
+  }
+
+  if ((!found || found->height != shelf_height) &&
+      page->used_height + shelf_height <= kPageSizeInPixels) {
+    Shelf shelf;
+    shelf.y = page->used_height;
+    shelf.height = shelf_height;
+    shelf.free_spans[0] = kPageSizeInPixels;
+    page->used_height += shelf_height;
+    page->shelves.push_back(std::move(shelf));
+    found = &page->shelves.back();
+    found_span = found->free_spans.begin();
+  }
+
+  if (!found) {
+    return false;
+  }
+
+  *x = found_span->first;
+  *y = found->y;
+  int remaining = found_span->second - width;
+  found->free_spans.erase(found_span);
+  if (remaining > 0) {
+    found->free_spans[*x + width] = remaining;
+  }
+  return true;
+}
+
+void TextureAtlas::Free(const Allocation& allocation) {
+  if (!allocation.page) {
+    return;
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  Page* page = allocation.page;
+  gpu_bytes_ += static_cast<int64_t>(allocation.width_in_pixels) *
+                allocation.height_in_pixels * kBytesPerPixel;
+
+  int padded_y = allocation.y - kBorderInPixels;
+  auto shelf = std::find_if(
+      page->shelves.begin(), page->shelves.end(),
+      [padded_y](const Shelf& x) { return x.y == padded_y; });
+  assert(shelf != page->shelves.end());
+
+  int first = allocation.x - kBorderInPixels;
+  int count = allocation.width_in_pixels + 2 * kBorderInPixels;
+  auto next = shelf->free_spans.lower_bound(first);
+  if (next != shelf->free_spans.end() && first + count == next->first) {
+    count += next->second;
+    next = shelf->free_spans.erase(next);
+  }
+  if (next != shelf->free_spans.begin()) {
+    auto previous = std::prev(next);
+    if (previous->first + previous->second == first) {
+      first = previous->first;
+      count += previous->second;
+      shelf->free_spans.erase(previous);
+    }
+  }
+  shelf->free_spans[first] = count;
+
+  // Empty shelves at the top of the page give their rows back, so that they
+  // can be reused for shelves of another height.
+  while (!page->shelves.empty() &&
+         page->shelves.back().free_spans.size() == 1 &&
+         page->shelves.back().free_spans.begin()->second ==
+             kPageSizeInPixels) {
+    page->used_height -= page->shelves.back().height;
+    page->shelves.pop_back();
+  }
+
+  // Keep the last page even when it is empty, like VertexBufferPool does.
+  --page->num_allocations;
+  if (page->num_allocations == 0 && pages_.size() > 1) {
+    deletion_queue_->Enqueue(DeletionQueue::kHandleTypeTexture, page->handle);
+    gpu_bytes_ -= kPageSizeInBytes;
+    pages_.erase(std::find_if(
+        pages_.begin(), pages_.end(),
+        [page](const std::unique_ptr<Page>& x) { return x.get() == page; }));
+  }
+}
+
+void TextureAtlas::Shutdown() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (const auto& page : pages_) {
+    deletion_queue_->Enqueue(DeletionQueue::kHandleTypeTexture, page->handle);
+  }
+}
+
+}  // namespace gles2
+}  // namespace renderer
+}  // namespace entify
@@ -0,0 +1,113 @@
+#ifndef _SRC_ENTIFY_RENDERER_GLES2_TEXTURE_ATLAS_H_
+#define _SRC_ENTIFY_RENDERER_GLES2_TEXTURE_ATLAS_H_
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <GLES2/gl2.h>
+
+#include "src/renderer/gles2/deletion_queue.h"
+
+namespace entify {
+namespace renderer {
+namespace gles2 {
+
+// The wrap modes and filters of a GL texture, as last set by the renderer,
+// so that samplers which agree with them do not set them again.  These
+// start out at GL's defaults.
+struct TextureParameters {
+  GLenum wrap_s = GL_REPEAT;
+  GLenum wrap_t = GL_REPEAT;
+  GLenum min_filter = GL_NEAREST_MIPMAP_LINEAR;
+  GLenum mag_filter = GL_LINEAR;
+};
+
+// Packs small RGBA images into large shared GL textures, so that draw calls
+// which sample different images from the same page do not have to bind a
+// texture in between.  Each page is filled with shelves, rows of images of
+// about the same height, and each image is surrounded by a border of copies
+// of its edge pixels, so that linear filtering at its edges does not pick up
+// its neighbors.  Allocating assumes that a context is current, while
+// freeing may happen on any thread.
+class TextureAtlas {
+ public:
+  // Images wider or higher than this are not packed.
+  static const int kMaxImageSizeInPixels = 128;
+  // The width and height of each page.
+  static const int kPageSizeInPixels = 1024;
+
+  struct Page;
+
+  struct Allocation {
+    // The page's texture, or 0 if nothing was allocated.
+    GLuint handle = 0;
+    // The bottom left pixel of the image within the page.
+    int x = 0;
+    int y = 0;
+    int width_in_pixels = 0;
+    int height_in_pixels = 0;
+    Page* page = nullptr;
+  };
+
+  explicit TextureAtlas(DeletionQueue* deletion_queue)
+      : deletion_queue_(deletion_queue), gpu_bytes_(0) {}
+
+  // Finds room for the |width_in_pixels| x |height_in_pixels| image and
+  // uploads |pixels|, which are tightly packed RGBA rows in the GL layout.
+  // Returns an empty allocation if the image is too large to be packed.
+  Allocation Allocate(const char* pixels, int width_in_pixels,
+                      int height_in_pixels);
+  void Free(const Allocation& allocation);
+
+  // Releases the pages that are left.  Called when the device is torn down.
+  void Shutdown();
+
+  // The GPU memory of the pages that the images packed into them do not
+  // account for, i.e. their borders and the free room.  May be called from
+  // any thread.
+  int64_t gpu_bytes() const {
+    return gpu_bytes_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  // A row of the page, whose free spans are kept like the free ranges of a
+  // VertexBufferPool page.
+  struct Shelf {
+    int y;
+    int height;
+    // Maps the first column of each free span to its width, with adjacent
+    // spans merged.
+    std::map<int, int> free_spans;
+  };
+
+  // Takes a span of |width| columns from one of the shelves of |page| that
+  // fit |height| rows, adding a new shelf if there is room and none does.
+  // Returns false if the page is full.
+  bool AllocateFromPage(Page* page, int width, int height, int* x, int* y);
+
+  DeletionQueue* deletion_queue_;
+
+  std::mutex mutex_;
+  std::vector<std::unique_ptr<Page>> pages_;
+  std::atomic<int64_t> gpu_bytes_;
+};
+
+struct TextureAtlas::Page {
+  GLuint handle;
+  // Shared by all of the images packed into the page.
+  TextureParameters parameters;
+  std::vector<Shelf> shelves;
+  // The height of the page that shelves have been added to.
+  int used_height;
+  int num_allocations;
+};
+
+}  // namespace gles2
+}  // namespace renderer
+}  // namespace entify
+
+#endif  // _SRC_ENTIFY_RENDERER_GLES2_TEXTURE_ATLAS_H_
@@ -0,0 +1,223 @@
+#include "src/renderer/gles2/texture_atlas.h"
+
+#include <cstdint>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "src/renderer/gles2/deletion_queue.h"
+#include "src/renderer/gles2/fake_gl_for_testing.h"
+
+namespace entify {
+namespace renderer {
+namespace gles2 {
+
+namespace {
+const int kMaxSize = TextureAtlas::kMaxImageSizeInPixels;
+const int kPageSize = TextureAtlas::kPageSizeInPixels;
+const int64_t kPageSizeInBytes =
+    static_cast<int64_t>(kPageSize) * kPageSize * 4;
+
+// The last image uploaded with glTexSubImage2D().
+struct Upload {
+  GLint x = 0;
+  GLint y = 0;
+  GLsizei width = 0;
+  GLsizei height = 0;
+  std::vector<uint32_t> pixels;
+};
+Upload g_last_upload;
+
+void GL_APIENTRY RecordTexSubImage2D(
+    GLenum, GLint, GLint x, GLint y, GLsizei width, GLsizei height, GLenum,
+    GLenum, const void* pixels) {
+  g_last_upload.x = x;
+  g_last_upload.y = y;
+  g_last_upload.width = width;
+  g_last_upload.height = height;
+  const uint32_t* begin = static_cast<const uint32_t*>(pixels);
+  g_last_upload.pixels.assign(begin, begin + width * height);
+}
+
+class TextureAtlasTests : public ::testing::Test {
+ protected:
+  TextureAtlasTests() : atlas_(&deletion_queue_) {
+    GLDispatch dispatch = GetGLDispatch();
+    dispatch.glTexSubImage2D = &RecordTexSubImage2D;
+    SetGLDispatchForTesting(dispatch);
+  }
+
+  // Allocates an image whose pixels are numbered from 1, row by row.
+  TextureAtlas::Allocation Allocate(int width, int height) {
+    std::vector<uint32_t> pixels(width * height);
+    for (size_t i = 0; i < pixels.size(); ++i) {
+      pixels[i] = static_cast<uint32_t>(i + 1);
+    }
+    return atlas_.Allocate(
+        reinterpret_cast<const char*>(pixels.data()), width, height);
+  }
+
+  ScopedFakeGL fake_gl_;
+  DeletionQueue deletion_queue_;
+  TextureAtlas atlas_;
+};
+}  // namespace
+
+TEST_F(TextureAtlasTests, ImagesLargerThanTheLimitAreNotPacked) {
+  EXPECT_NE(nullptr, Allocate(kMaxSize, kMaxSize).page);
+  EXPECT_NE(nullptr, Allocate(1, 1).page);
+
+  for (const auto& size : std::vector<std::pair<int, int>>{
+           {kMaxSize + 1, 1}, {1, kMaxSize + 1}, {0, 1}, {1, 0}}) {
+    TextureAtlas::Allocation allocation = Allocate(size.first, size.second);
+    EXPECT_EQ(nullptr, allocation.page);
+    EXPECT_EQ(0u, allocation.handle);
+  }
+}
+
+TEST_F(TextureAtlasTests, ImagesAreSurroundedByACopyOfTheirEdges) {
+  TextureAtlas::Allocation allocation = Allocate(3, 2);
+  EXPECT_EQ(1, allocation.x);
+  EXPECT_EQ(1, allocation.y);
+  EXPECT_EQ(3, allocation.width_in_pixels);
+  EXPECT_EQ(2, allocation.height_in_pixels);
+
+  // The image is uploaded with a one pixel border.
+  EXPECT_EQ(0, g_last_upload.x);
+  EXPECT_EQ(0, g_last_upload.y);
+  EXPECT_EQ(5, g_last_upload.width);
+  EXPECT_EQ(4, g_last_upload.height);
+  EXPECT_EQ(std::vector<uint32_t>({1, 1, 2, 3, 3,
+                                   1, 1, 2, 3, 3,
+                                   4, 4, 5, 6, 6,
+                                   4, 4, 5, 6, 6}),
+            g_last_upload.pixels);
+
+  // The next image leaves room for both borders.
+  TextureAtlas::Allocation next = Allocate(2, 2);
+  EXPECT_EQ(allocation.x + 3 + 2, next.x);
+  EXPECT_EQ(allocation.y, next.y);
+  EXPECT_EQ(next.x - 1, g_last_upload.x);
+}
+
+TEST_F(TextureAtlasTests, ShelfHeightsAreAlignedToEightPixels) {
+  // 5 and 6 pixel high images, 7 and 8 with their borders, share a shelf.
+  TextureAtlas::Allocation a = Allocate(10, 5);
+  TextureAtlas::Allocation b = Allocate(10, 6);
+  EXPECT_EQ(a.y, b.y);
+  EXPECT_EQ(a.x + 12, b.x);
+
+  // A 7 pixel high image does not fit into 8 rows with its border.
+  TextureAtlas::Allocation c = Allocate(10, 7);
+  EXPECT_EQ(a.y + 8, c.y);
+  EXPECT_EQ(1, c.x);
+
+  const TextureAtlas::Page* page = a.page;
+  ASSERT_EQ(2u, page->shelves.size());
+  EXPECT_EQ(8, page->shelves[0].height);
+  EXPECT_EQ(16, page->shelves[1].height);
+  EXPECT_EQ(24, page->used_height);
+
+  // Once a shelf of the image's height exists, it is used again.
+  TextureAtlas::Allocation d = Allocate(4, 1);
+  EXPECT_EQ(a.y, d.y);
+  EXPECT_EQ(b.x + 12, d.x);
+}
+
+TEST_F(TextureAtlasTests, FullPagesRollOverToANewPage) {
+  // With their borders, 7 of the largest images fit into each of the 7
+  // shelves of 136 rows.
+  const int kImagesPerPage = 7 * 7;
+  std::vector<TextureAtlas::Allocation> allocations;
+  for (int i = 0; i < kImagesPerPage; ++i) {
+    allocations.push_back(Allocate(kMaxSize, kMaxSize));
+    EXPECT_EQ(allocations[0].page, allocations.back().page);
+  }
+  EXPECT_EQ(1, fake_gl_.calls(kGLFunction_glTexImage2D));
+
+  TextureAtlas::Allocation overflow = Allocate(kMaxSize, kMaxSize);
+  EXPECT_NE(allocations[0].page, overflow.page);
+  EXPECT_NE(allocations[0].handle, overflow.handle);
+  EXPECT_EQ(1, overflow.x);
+  EXPECT_EQ(1, overflow.y);
+  EXPECT_EQ(2, fake_gl_.calls(kGLFunction_glTexImage2D));
+
+  // Small images still fit into the rows left at the top of the first page.
+  TextureAtlas::Allocation small = Allocate(4, 4);
+  EXPECT_EQ(allocations[0].page, small.page);
+  EXPECT_EQ(7 * 136 + 1, small.y);
+
+  // Only the room that no image uses is counted for the pages.
+  int64_t image_bytes =
+      (kImagesPerPage + 1) * static_cast<int64_t>(kMaxSize) * kMaxSize * 4 +
+      4 * 4 * 4;
+  EXPECT_EQ(2 * kPageSizeInBytes - image_bytes, atlas_.gpu_bytes());
+}
+
+TEST_F(TextureAtlasTests, FreedRoomIsReused) {
+  TextureAtlas::Allocation a = Allocate(10, 10);
+  TextureAtlas::Allocation b = Allocate(10, 10);
+  Allocate(10, 10);
+
+  atlas_.Free(b);
+  TextureAtlas::Allocation d = Allocate(10, 10);
+  EXPECT_EQ(b.x, d.x);
+  EXPECT_EQ(b.y, d.y);
+
+  // Freed spans merge, so that a wider image fits where two were.
+  atlas_.Free(a);
+  atlas_.Free(d);
+  TextureAtlas::Allocation e = Allocate(22, 10);
+  EXPECT_EQ(a.x, e.x);
+  EXPECT_EQ(a.y, e.y);
+}
+
+TEST_F(TextureAtlasTests, EmptyShelvesAtTheTopGiveBackTheirRows) {
+  TextureAtlas::Allocation a = Allocate(10, 5);
+  TextureAtlas::Allocation b = Allocate(10, 100);
+  const TextureAtlas::Page* page = a.page;
+  EXPECT_EQ(8 + 104, page->used_height);
+
+  atlas_.Free(b);
+  EXPECT_EQ(8, page->used_height);
+  EXPECT_EQ(1u, page->shelves.size());
+
+  // The rows are used for a shelf of another height.
+  TextureAtlas::Allocation c = Allocate(10, 20);
+  EXPECT_EQ(8 + 1, c.y);
+}
+
+TEST_F(TextureAtlasTests, EmptyPagesAreReleasedExceptTheLastOne) {
+  const int kImagesPerPage = 7 * 7;
+  std::vector<TextureAtlas::Allocation> allocations;
+  for (int i = 0; i < kImagesPerPage; ++i) {
+    allocations.push_back(Allocate(kMaxSize, kMaxSize));
+  }
+  TextureAtlas::Allocation overflow = Allocate(kMaxSize, kMaxSize);
+  EXPECT_EQ(2 * kPageSizeInBytes -
+                (kImagesPerPage + 1) * kMaxSize * kMaxSize * 4,
+            atlas_.gpu_bytes());
+
+  for (const TextureAtlas::Allocation& allocation : allocations) {
+    atlas_.Free(allocation);
+  }
+  EXPECT_EQ(1u, deletion_queue_.size());
+  EXPECT_EQ(kPageSizeInBytes - kMaxSize * kMaxSize * 4, atlas_.gpu_bytes());
+
+  // The remaining page is reused from the start once it is empty too.
+  atlas_.Free(overflow);
+  EXPECT_EQ(1u, deletion_queue_.size());
+  EXPECT_EQ(kPageSizeInBytes, atlas_.gpu_bytes());
+  TextureAtlas::Allocation reused = Allocate(kMaxSize, kMaxSize);
+  EXPECT_EQ(overflow.page, reused.page);
+  EXPECT_EQ(1, reused.x);
+  EXPECT_EQ(1, reused.y);
+  EXPECT_EQ(2, fake_gl_.calls(kGLFunction_glTexImage2D));
+
+  atlas_.Shutdown();
+  EXPECT_EQ(2u, deletion_queue_.size());
+}
+
+}  // namespace gles2
+}  // namespace renderer
+}  // namespace entify
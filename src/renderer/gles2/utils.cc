@@ -1,6 +1,7 @@
 #include "src/renderer/gles2/utils.h"
 
 #include <cassert>
+#include <cstring>
 #include <iomanip>
 #include <sstream>
 #include <vector>
@@ -55,6 +56,31 @@ std::string CheckForShaderCompileErrors(
   return std::string();
 }
 
+bool ExtensionListContains(const char* extensions, const char* extension) {
+  if (!extensions) {
+    return false;
+  }
+
+  size_t extension_length = strlen(extension);
+  for (const char* found = strstr(extensions, extension); found;
+       found = strstr(found + extension_length, extension)) {
+    // Make sure we matched a whole extension name and not only a prefix of
+    // one.
+    bool starts_name = found == extensions || found[-1] == ' ';
+    char next = found[extension_length];
+    if (starts_name && (next == ' ' || next == '\0')) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool HasGLExtension(const char* extension) {
+  return ExtensionListContains(
+      reinterpret_cast<const char*>(GL_CALL(glGetString(GL_EXTENSIONS))),
+      extension);
+}
+
 }  // namespace gles2
 }  // namespace renderer
 }  // namespace entify
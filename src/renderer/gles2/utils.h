@@ -8,6 +8,8 @@
 #include <EGL/egl.h>
 #include <GLES2/gl2.h>
 
+#include "src/renderer/gles2/gl_dispatch.h"
+
 #define ASSERT_NO_EGL_ERROR \
   do { \
     EGLint error = eglGetError(); \
@@ -21,18 +23,12 @@
   x; \
   ASSERT_NO_EGL_ERROR
 
-#define ASSERT_NO_GL_ERROR \
-  do { \
-    EGLint error = glGetError(); \
-    if (error != GL_NO_ERROR) { \
-      std::cerr << "GL Error: " << error << std::endl; \
-      assert(false); \
-    } \
-  } while (false)
-
+// Calls a GL function through the dispatch table (see gl_dispatch.h), which
+// depending on its mode may check for errors, count or record the call.
+// Since this is an expression, it can also be used for functions that return
+// a value, e.g. "GLuint handle = GL_CALL(glCreateProgram());".
 #define GL_CALL(x) \
-  x; \
-  ASSERT_NO_GL_ERROR
+  (::entify::renderer::gles2::GetGLDispatch().x)
 
 namespace entify {
 namespace renderer {
@@ -41,6 +37,13 @@ namespace gles2 {
 std::string CheckForShaderCompileErrors(
     GLuint shader_handle, const std::string& source);
 
+// Returns true if |extension| is one of the names in the space separated
+// |extensions| list.  |extensions| may be NULL.
+bool ExtensionListContains(const char* extensions, const char* extension);
+
+// Returns true if the current GL context supports |extension|.
+bool HasGLExtension(const char* extension);
+
 }  // namespace gles2
 }  // namespace renderer
 }  // namespace entify
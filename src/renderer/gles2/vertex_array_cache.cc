@@ -0,0 +1,112 @@
+#include "src/renderer/gles2/vertex_array_cache.h"
+
+#include <algorithm>
+#include <cassert>
+
+#include <EGL/egl.h>
+
+#include "src/renderer/gles2/utils.h"
+
+namespace entify {
+namespace renderer {
+namespace gles2 {
+
+VertexArrayCache::VertexArrayCache(DeletionQueue* deletion_queue) {
+  deletion_queue->set_buffer_deletion_callback(
+      [this](const std::vector<GLuint>& handles) {
+        OnBuffersDeleted(handles);
+      });
+}
+
+void VertexArrayCache::Initialize(const void* context) {
+  if (!HasGLExtension("GL_OES_vertex_array_object")) {
+    return;
+  }
+
+  const GLDispatch& dispatch = GetGLDispatch();
+  if (dispatch.glGenVertexArraysOES && dispatch.glBindVertexArrayOES &&
+      dispatch.glDeleteVertexArraysOES) {
+    context_ = context;
+  }
+}
+
+bool VertexArrayCache::IsOwningContextCurrent() const {
+  return context_ && eglGetCurrentContext() == context_;
+}
+
+bool VertexArrayCache::BeginPass() {
+  if (!IsOwningContextCurrent()) {
+    return false;
+  }
+  DeletePendingVertexArrays();
+  return true;
+}
+
+void VertexArrayCache::EndPass() {
+  GL_CALL(glBindVertexArrayOES(0));
+}
+
+VertexArrayCache::BindResult VertexArrayCache::Bind(
+    const Key& key, int32_t base_vertex) {
+  auto found = vertex_arrays_.find(key);
+  if (found != vertex_arrays_.end()) {
+    GL_CALL(glBindVertexArrayOES(found->second.handle));
+    if (found->second.base_vertex != base_vertex) {
+      found->second.base_vertex = base_vertex;
+      return kBaseVertexChanged;
+    }
+    return kBound;
+  }
+
+  VertexArray vertex_array;
+  GL_CALL(glGenVertexArraysOES(1, &vertex_array.handle));
+  GL_CALL(glBindVertexArrayOES(vertex_array.handle));
+  vertex_array.base_vertex = base_vertex;
+  vertex_arrays_.emplace(key, vertex_array);
+  return kCreated;
+}
+
+void VertexArrayCache::OnBuffersDeleted(const std::vector<GLuint>& handles) {
+  // A vertex array object keeps the buffers it refers to alive, and their
+  // handles may be reused for new buffers, so it must go with them.
+  for (auto iter = vertex_arrays_.begin(); iter != vertex_arrays_.end();) {
+    const Key& key = iter->first;
+    if (std::find(handles.begin(), handles.end(), key.buffer) !=
+            handles.end() ||
+        (key.element_buffer != 0 &&
+         std::find(handles.begin(), handles.end(), key.element_buffer) !=
+             handles.end())) {
+      pending_deletions_.push_back(iter->second.handle);
+      iter = vertex_arrays_.erase(iter);
+    } else {
+      ++iter;
+    }
+  }
+
+  if (IsOwningContextCurrent()) {
+    DeletePendingVertexArrays();
+  }
+}
+
+void VertexArrayCache::DeletePendingVertexArrays() {
+  if (!pending_deletions_.empty()) {
+    GL_CALL(glDeleteVertexArraysOES(
+        pending_deletions_.size(), pending_deletions_.data()));
+    pending_deletions_.clear();
+  }
+}
+
+void VertexArrayCache::Shutdown() {
+  for (const auto& vertex_array : vertex_arrays_) {
+    pending_deletions_.push_back(vertex_array.second.handle);
+  }
+  vertex_arrays_.clear();
+  // Otherwise they go away with the context.
+  if (IsOwningContextCurrent()) {
+    DeletePendingVertexArrays();
+  }
+}
+
+}  // namespace gles2
+}  // namespace renderer
+}  // namespace entify
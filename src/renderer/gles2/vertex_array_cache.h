@@ -0,0 +1,101 @@
+#ifndef _SRC_ENTIFY_RENDERER_GLES2_VERTEX_ARRAY_CACHE_H_
+#define _SRC_ENTIFY_RENDERER_GLES2_VERTEX_ARRAY_CACHE_H_
+
+#include <cstdint>
+#include <map>
+#include <tuple>
+#include <vector>
+
+#include <GLES2/gl2.h>
+#include <GLES2/gl2ext.h>
+
+#include "src/renderer/gles2/deletion_queue.h"
+#include "src/renderer/gles2/vertex_buffer_pool.h"
+
+namespace entify {
+namespace renderer {
+namespace gles2 {
+
+// Caches a vertex array object (GL_OES_vertex_array_object) for each
+// combination of program attribute indices, vertex buffer and index buffer
+// that is drawn, so that switching between them takes a single bind instead
+// of setting up every attribute again.  Indexed draws of vertex buffers that
+// share a GL buffer start their attribute pointers at different vertices, so
+// those pointers are set up again on the same object when they change, rather
+// than creating an object for every vertex buffer.  Vertex array objects are
+// not shared between contexts, so they are only used with the backend's own
+// context; passes rendered with other contexts, or without the extension,
+// must set up the attributes themselves.  All methods must be called with a
+// context current.
+class VertexArrayCache {
+ public:
+  // The state that a vertex array object captures.
+  struct Key {
+    bool operator<(const Key& rhs) const {
+      return std::tie(buffer, layout, element_buffer, attribute_indices) <
+             std::tie(rhs.buffer, rhs.layout, rhs.element_buffer,
+                      rhs.attribute_indices);
+    }
+
+    GLuint buffer;
+    const VertexBufferPool::Layout* layout;
+    // 0 if the draws are not indexed.
+    GLuint element_buffer;
+    std::vector<GLint> attribute_indices;
+  };
+
+  explicit VertexArrayCache(DeletionQueue* deletion_queue);
+
+  // Enables the cache for |context|, the EGLContext that is current, if it
+  // supports the extension.
+  void Initialize(const void* context);
+
+  // Returns true if vertex array objects can be used by the pass that is
+  // about to be rendered, which must then call EndPass().
+  bool BeginPass();
+  // Restores the default vertex array, so that buffer bindings made outside
+  // of passes do not change a cached vertex array object.
+  void EndPass();
+
+  enum BindResult {
+    // The object was bound as it was.
+    kBound,
+    // The caller must set up the attribute pointers again.
+    kBaseVertexChanged,
+    // The caller must set up the attributes and element array buffer.
+    kCreated,
+  };
+
+  // Binds the vertex array object for |key|, whose attribute pointers are to
+  // start at |base_vertex|, creating it if there is none yet.
+  BindResult Bind(const Key& key, int32_t base_vertex);
+
+  // Deletes all vertex array objects.  Called when the device is torn down.
+  void Shutdown();
+
+ private:
+  // Forgets the vertex array objects that refer to the buffers in
+  // |handles|, which are about to be deleted.
+  void OnBuffersDeleted(const std::vector<GLuint>& handles);
+  void DeletePendingVertexArrays();
+
+  bool IsOwningContextCurrent() const;
+
+  const void* context_ = nullptr;
+
+  struct VertexArray {
+    GLuint handle;
+    // The vertex that the attribute pointers were last set up to start at.
+    int32_t base_vertex;
+  };
+
+  std::map<Key, VertexArray> vertex_arrays_;
+  // Vertex array objects to be deleted once the owning context is current.
+  std::vector<GLuint> pending_deletions_;
+};
+
+}  // namespace gles2
+}  // namespace renderer
+}  // namespace entify
+
+#endif  // _SRC_ENTIFY_RENDERER_GLES2_VERTEX_ARRAY_CACHE_H_
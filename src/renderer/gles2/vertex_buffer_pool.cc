@@ -0,0 +1,179 @@
+#include "src/renderer/gles2/vertex_buffer_pool.h"
+
+#include <algorithm>
+#include <cassert>
+#include <iterator>
+
+#include "src/renderer/gles2/utils.h"
+
+namespace entify {
+namespace renderer {
+namespace gles2 {
+
+namespace {
+// The size of each shared buffer.
+const int32_t kPageSizeInBytes = 256 * 1024;
+// Vertex buffers larger than this get a GL buffer of their own.
+const int32_t kMaxPooledSizeInBytes = 16 * 1024;
+}  // namespace
+
+const VertexBufferPool::Layout* VertexBufferPool::GetLayout(
+    int32_t stride_in_bytes, const render_tree::TypeTuple& types,
+    const std::vector<int32_t>& data_offsets) {
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  // There are only ever a handful of distinct layouts.
+  for (const auto& entry : layouts_) {
+    if (entry->layout.stride_in_bytes == stride_in_bytes &&
+        entry->layout.types == types &&
+        entry->layout.data_offsets == data_offsets) {
+      return &entry->layout;
+    }
+  }
+
+  std::unique_ptr<LayoutEntry> entry(new LayoutEntry());
+  entry->layout.stride_in_bytes = stride_in_bytes;
+  entry->layout.types = types;
+  entry->layout.data_offsets = data_offsets;
+  layouts_.push_back(std::move(entry));
+  return &layouts_.back()->layout;
+}
+
+VertexBufferPool::Allocation VertexBufferPool::Allocate(
+    const Layout* layout, const char* data, int32_t num_vertices) {
+  int32_t num_bytes = num_vertices * layout->stride_in_bytes;
+
+  if (num_vertices <= 0 || num_bytes > kMaxPooledSizeInBytes) {
+    Allocation allocation;
+    GL_CALL(glGenBuffers(1, &allocation.handle));
+    allocation.first_vertex = 0;
+    allocation.num_vertices = num_vertices;
+    allocation.page = nullptr;
+
+    GL_CALL(glBindBuffer(GL_ARRAY_BUFFER, allocation.handle));
+    GL_CALL(glBufferData(GL_ARRAY_BUFFER, num_bytes, data, GL_STATIC_DRAW));
+    return allocation;
+  }
+
+  Allocation allocation;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto entry = std::find_if(
+        layouts_.begin(), layouts_.end(),
+        [layout](const std::unique_ptr<LayoutEntry>& x) {
+          return &x->layout == layout;
+        });
+    assert(entry != layouts_.end());
+    allocation = AllocateFromPages(entry->get(), num_vertices);
+  }
+
+  GL_CALL(glBindBuffer(GL_ARRAY_BUFFER, allocation.handle));
+  GL_CALL(glBufferSubData(
+      GL_ARRAY_BUFFER, allocation.first_vertex * layout->stride_in_bytes,
+      num_bytes, data));
+  return allocation;
+}
+
+VertexBufferPool::Allocation VertexBufferPool::AllocateFromPages(
+    LayoutEntry* entry, int32_t num_vertices) {
+  Allocation allocation;
+  allocation.num_vertices = num_vertices;
+
+  for (const auto& page : entry->pages) {
+    auto free_range = std::find_if(
+        page->free_ranges.begin(), page->free_ranges.end(),
+        [num_vertices](const std::pair<const int32_t, int32_t>& range) {
+          return range.second >= num_vertices;
+        });
+    if (free_range == page->free_ranges.end()) {
+      continue;
+    }
+
+    allocation.handle = page->handle;
+    allocation.first_vertex = free_range->first;
+    allocation.page = page.get();
+
+    int32_t remaining = free_range->second - num_vertices;
+    page->free_ranges.erase(free_range);
+    if (remaining > 0) {
+      page->free_ranges[allocation.first_vertex + num_vertices] = remaining;
+    }
+    page->num_allocated_vertices += num_vertices;
+    return allocation;
+  }
+
+  std::unique_ptr<Page> page(new Page());
+  page->layout_entry = entry;
+  page->capacity_in_vertices =
+      kPageSizeInBytes / entry->layout.stride_in_bytes;
+  page->num_allocated_vertices = num_vertices;
+  if (page->capacity_in_vertices > num_vertices) {
+    page->free_ranges[num_vertices] =
+        page->capacity_in_vertices - num_vertices;
+  }
+  GL_CALL(glGenBuffers(1, &page->handle));
+  GL_CALL(glBindBuffer(GL_ARRAY_BUFFER, page->handle));
+  GL_CALL(glBufferData(
+      GL_ARRAY_BUFFER,
+      page->capacity_in_vertices * entry->layout.stride_in_bytes, nullptr,
+      GL_STATIC_DRAW));
+
+  allocation.handle = page->handle;
+  allocation.first_vertex = 0;
+  allocation.page = page.get();
+  entry->pages.push_back(std::move(page));
+  return allocation;
+}
+
+void VertexBufferPool::Free(const Allocation& allocation) {
+  if (!allocation.page) {
+    deletion_queue_->Enqueue(
+        DeletionQueue::kHandleTypeBuffer, allocation.handle);
+    return;
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  Page* page = allocation.page;
+
+  int32_t first = allocation.first_vertex;
+  int32_t count = allocation.num_vertices;
+  auto next = page->free_ranges.lower_bound(first);
+  if (next != page->free_ranges.end() && first + count == next->first) {
+    count += next->second;
+    next = page->free_ranges.erase(next);
+  }
+  if (next != page->free_ranges.begin()) {
+    auto previous = std::prev(next);
+    if (previous->first + previous->second == first) {
+      first = previous->first;
+      count += previous->second;
+      page->free_ranges.erase(previous);
+    }
+  }
+  page->free_ranges[first] = count;
+  page->num_allocated_vertices -= allocation.num_vertices;
+
+  // Keep the last page of a layout even when it is empty, since small
+  // vertex buffers tend to be created and released every frame.
+  LayoutEntry* entry = page->layout_entry;
+  if (page->num_allocated_vertices == 0 && entry->pages.size() > 1) {
+    deletion_queue_->Enqueue(DeletionQueue::kHandleTypeBuffer, page->handle);
+    entry->pages.erase(std::find_if(
+        entry->pages.begin(), entry->pages.end(),
+        [page](const std::unique_ptr<Page>& x) { return x.get() == page; }));
+  }
+}
+
+void VertexBufferPool::Shutdown() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (const auto& entry : layouts_) {
+    for (const auto& page : entry->pages) {
+      deletion_queue_->Enqueue(
+          DeletionQueue::kHandleTypeBuffer, page->handle);
+    }
+  }
+}
+
+}  // namespace gles2
+}  // namespace renderer
+}  // namespace entify
@@ -0,0 +1,98 @@
+#ifndef _SRC_ENTIFY_RENDERER_GLES2_VERTEX_BUFFER_POOL_H_
+#define _SRC_ENTIFY_RENDERER_GLES2_VERTEX_BUFFER_POOL_H_
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <GLES2/gl2.h>
+
+#include "src/renderer/gles2/deletion_queue.h"
+#include "src/renderer/gles2/render_tree/types.h"
+
+namespace entify {
+namespace renderer {
+namespace gles2 {
+
+// Sub-allocates small static vertex buffers out of large shared GL buffers,
+// one set of shared buffers per vertex layout.  Draw calls whose vertices
+// live in the same shared buffer can then be issued back to back with only
+// a different first vertex, without rebinding the buffer or setting up the
+// vertex attributes again.  Larger vertex buffers get a GL buffer of their
+// own.  Allocating assumes that a context is current, while freeing may
+// happen on any thread.
+class VertexBufferPool {
+ public:
+  // The attributes of a vertex.  Layouts are interned, so vertex buffers
+  // with equal layouts point to the same Layout.
+  struct Layout {
+    int32_t stride_in_bytes;
+    render_tree::TypeTuple types;
+    std::vector<int32_t> data_offsets;
+  };
+
+  struct Page;
+
+  struct Allocation {
+    GLuint handle;
+    // The first vertex of the allocation within the buffer.
+    int32_t first_vertex;
+    int32_t num_vertices;
+    // The shared buffer that the allocation was made from, or nullptr if
+    // |handle| belongs to the allocation alone.
+    Page* page;
+  };
+
+  explicit VertexBufferPool(DeletionQueue* deletion_queue)
+      : deletion_queue_(deletion_queue) {}
+
+  const Layout* GetLayout(int32_t stride_in_bytes,
+                          const render_tree::TypeTuple& types,
+                          const std::vector<int32_t>& data_offsets);
+
+  // Allocates space for |num_vertices| vertices of |layout| and uploads
+  // |data| to it.
+  Allocation Allocate(const Layout* layout, const char* data,
+                      int32_t num_vertices);
+  void Free(const Allocation& allocation);
+
+  // Releases the shared buffers that are left.  Called when the device is
+  // torn down.
+  void Shutdown();
+
+ private:
+  struct LayoutEntry;
+
+  // Allocates a range of |num_vertices| vertices from one of |entry|'s
+  // pages, creating a new page if none has enough room.
+  Allocation AllocateFromPages(LayoutEntry* entry, int32_t num_vertices);
+
+  DeletionQueue* deletion_queue_;
+
+  std::mutex mutex_;
+  std::vector<std::unique_ptr<LayoutEntry>> layouts_;
+};
+
+// A shared GL buffer and the ranges of it that are not allocated.
+struct VertexBufferPool::Page {
+  VertexBufferPool::LayoutEntry* layout_entry;
+  GLuint handle;
+  int32_t capacity_in_vertices;
+  int32_t num_allocated_vertices;
+  // Maps the first vertex of each free range to its length, with adjacent
+  // ranges merged.
+  std::map<int32_t, int32_t> free_ranges;
+};
+
+struct VertexBufferPool::LayoutEntry {
+  Layout layout;
+  std::vector<std::unique_ptr<Page>> pages;
+};
+
+}  // namespace gles2
+}  // namespace renderer
+}  // namespace entify
+
+#endif  // _SRC_ENTIFY_RENDERER_GLES2_VERTEX_BUFFER_POOL_H_
@@ -0,0 +1,191 @@
+#include "src/renderer/gles2/vertex_buffer_pool.h"
+
+#include <map>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "src/renderer/gles2/deletion_queue.h"
+#include "src/renderer/gles2/fake_gl_for_testing.h"
+
+namespace entify {
+namespace renderer {
+namespace gles2 {
+
+namespace {
+// With 16 byte vertices, a 256KiB page holds 16384 vertices, and buffers of
+// up to 1024 vertices are pooled.
+const int32_t kStride = 16;
+const int32_t kPageCapacity = 16384;
+const int32_t kMaxPooledVertices = 1024;
+
+class VertexBufferPoolTests : public ::testing::Test {
+ protected:
+  VertexBufferPoolTests()
+      : pool_(&deletion_queue_),
+        layout_(pool_.GetLayout(
+            kStride, {render_tree::TypeFloat32V4}, {0})) {}
+
+  VertexBufferPool::Allocation Allocate(int32_t num_vertices) {
+    std::vector<char> data(num_vertices * kStride);
+    return pool_.Allocate(layout_, data.data(), num_vertices);
+  }
+
+  ScopedFakeGL fake_gl_;
+  DeletionQueue deletion_queue_;
+  VertexBufferPool pool_;
+  const VertexBufferPool::Layout* layout_;
+};
+
+typedef std::map<int32_t, int32_t> FreeRanges;
+}  // namespace
+
+TEST_F(VertexBufferPoolTests, EqualLayoutsAreInterned) {
+  EXPECT_EQ(layout_, pool_.GetLayout(
+      kStride, {render_tree::TypeFloat32V4}, {0}));
+  EXPECT_NE(layout_, pool_.GetLayout(
+      kStride, {render_tree::TypeFloat32V3}, {0}));
+  EXPECT_NE(layout_, pool_.GetLayout(
+      kStride * 2, {render_tree::TypeFloat32V4}, {0}));
+}
+
+TEST_F(VertexBufferPoolTests, LargeBuffersAreNotPooled) {
+  VertexBufferPool::Allocation allocation = Allocate(kMaxPooledVertices + 1);
+  EXPECT_EQ(nullptr, allocation.page);
+  EXPECT_EQ(0, allocation.first_vertex);
+  EXPECT_NE(0u, allocation.handle);
+
+  pool_.Free(allocation);
+  EXPECT_EQ(1u, deletion_queue_.size());
+}
+
+TEST_F(VertexBufferPoolTests, AllocationsArePackedIntoOnePage) {
+  VertexBufferPool::Allocation a = Allocate(10);
+  VertexBufferPool::Allocation b = Allocate(20);
+  VertexBufferPool::Allocation c = Allocate(kMaxPooledVertices);
+
+  ASSERT_NE(nullptr, a.page);
+  EXPECT_EQ(a.page, b.page);
+  EXPECT_EQ(a.page, c.page);
+  EXPECT_EQ(a.handle, c.handle);
+  EXPECT_EQ(0, a.first_vertex);
+  EXPECT_EQ(10, b.first_vertex);
+  EXPECT_EQ(30, c.first_vertex);
+  EXPECT_EQ(30 + kMaxPooledVertices, a.page->num_allocated_vertices);
+  EXPECT_EQ(FreeRanges({{30 + kMaxPooledVertices,
+                         kPageCapacity - 30 - kMaxPooledVertices}}),
+            a.page->free_ranges);
+  // Only the page got a GL buffer.
+  EXPECT_EQ(1, fake_gl_.calls(kGLFunction_glGenBuffers));
+}
+
+TEST_F(VertexBufferPoolTests, FreeMergesWithBothNeighbours) {
+  VertexBufferPool::Allocation a = Allocate(10);
+  VertexBufferPool::Allocation b = Allocate(20);
+  VertexBufferPool::Allocation c = Allocate(30);
+  VertexBufferPool::Page* page = a.page;
+
+  pool_.Free(b);
+  EXPECT_EQ(FreeRanges({{10, 20}, {60, kPageCapacity - 60}}),
+            page->free_ranges);
+  // Merges with the following free range only.
+  pool_.Free(a);
+  EXPECT_EQ(FreeRanges({{0, 30}, {60, kPageCapacity - 60}}),
+            page->free_ranges);
+  // Merges with the free ranges on both sides.
+  pool_.Free(c);
+  EXPECT_EQ(FreeRanges({{0, kPageCapacity}}), page->free_ranges);
+  EXPECT_EQ(0, page->num_allocated_vertices);
+}
+
+TEST_F(VertexBufferPoolTests, FreeMergesWithThePrecedingRange) {
+  VertexBufferPool::Allocation a = Allocate(10);
+  VertexBufferPool::Allocation b = Allocate(20);
+  VertexBufferPool::Allocation c = Allocate(30);
+  VertexBufferPool::Page* page = a.page;
+
+  pool_.Free(a);
+  EXPECT_EQ(FreeRanges({{0, 10}, {60, kPageCapacity - 60}}),
+            page->free_ranges);
+  pool_.Free(b);
+  EXPECT_EQ(FreeRanges({{0, 30}, {60, kPageCapacity - 60}}),
+            page->free_ranges);
+  pool_.Free(c);
+  EXPECT_EQ(FreeRanges({{0, kPageCapacity}}), page->free_ranges);
+}
+
+TEST_F(VertexBufferPoolTests, FreedRangesAreReusedFirstFit) {
+  VertexBufferPool::Allocation a = Allocate(10);
+  Allocate(10);
+  pool_.Free(a);
+
+  // Fits into the freed range, and leaves the rest of it free.
+  VertexBufferPool::Allocation c = Allocate(4);
+  EXPECT_EQ(0, c.first_vertex);
+  EXPECT_EQ(FreeRanges({{4, 6}, {20, kPageCapacity - 20}}),
+            c.page->free_ranges);
+
+  // Too large for what is left of the freed range.
+  VertexBufferPool::Allocation d = Allocate(7);
+  EXPECT_EQ(20, d.first_vertex);
+
+  // Uses up the rest of the freed range exactly.
+  VertexBufferPool::Allocation e = Allocate(6);
+  EXPECT_EQ(4, e.first_vertex);
+  EXPECT_EQ(FreeRanges({{27, kPageCapacity - 27}}), e.page->free_ranges);
+}
+
+TEST_F(VertexBufferPoolTests, FullPagesOpenANewPage) {
+  std::vector<VertexBufferPool::Allocation> allocations;
+  for (int i = 0; i < kPageCapacity / kMaxPooledVertices; ++i) {
+    allocations.push_back(Allocate(kMaxPooledVertices));
+  }
+  VertexBufferPool::Page* first_page = allocations[0].page;
+  EXPECT_TRUE(first_page->free_ranges.empty());
+  EXPECT_EQ(kPageCapacity, first_page->num_allocated_vertices);
+
+  VertexBufferPool::Allocation overflow = Allocate(1);
+  EXPECT_NE(first_page, overflow.page);
+  EXPECT_NE(allocations[0].handle, overflow.handle);
+  EXPECT_EQ(0, overflow.first_vertex);
+  EXPECT_EQ(2u, first_page->layout_entry->pages.size());
+
+  // Freeing space in the first page makes it used again.
+  pool_.Free(allocations[3]);
+  VertexBufferPool::Allocation refill = Allocate(kMaxPooledVertices);
+  EXPECT_EQ(first_page, refill.page);
+  EXPECT_EQ(allocations[3].first_vertex, refill.first_vertex);
+}
+
+TEST_F(VertexBufferPoolTests, EmptyPagesAreReleasedExceptTheLastOne) {
+  std::vector<VertexBufferPool::Allocation> allocations;
+  for (int i = 0; i < kPageCapacity / kMaxPooledVertices; ++i) {
+    allocations.push_back(Allocate(kMaxPooledVertices));
+  }
+  VertexBufferPool::Allocation overflow = Allocate(1);
+  auto* layout_entry = overflow.page->layout_entry;
+  ASSERT_EQ(2u, layout_entry->pages.size());
+
+  // Emptying the first page releases it, since there is another one.
+  for (const VertexBufferPool::Allocation& allocation : allocations) {
+    pool_.Free(allocation);
+  }
+  EXPECT_EQ(1u, layout_entry->pages.size());
+  EXPECT_EQ(overflow.page, layout_entry->pages[0].get());
+  EXPECT_EQ(1u, deletion_queue_.size());
+
+  // The last page is kept even when it is empty.
+  pool_.Free(overflow);
+  EXPECT_EQ(1u, layout_entry->pages.size());
+  EXPECT_EQ(1u, deletion_queue_.size());
+  EXPECT_EQ(FreeRanges({{0, kPageCapacity}}),
+            layout_entry->pages[0]->free_ranges);
+
+  // Until the pool shuts down.
+  pool_.Shutdown();
+  EXPECT_EQ(2u, deletion_queue_.size());
+}
+
+}  // namespace gles2
+}  // namespace renderer
+}  // namespace entify
@@ -0,0 +1,23 @@
+#ifndef _SRC_ENTIFY_RENDERER_GPU_TIMING_H_
+#define _SRC_ENTIFY_RENDERER_GPU_TIMING_H_
+
+#include <cstdint>
+
+#include "entify/entify.h"
+
+namespace entify {
+namespace renderer {
+
+// The GPU time spent on the work done for a render tree node.
+struct GPUTiming {
+  int64_t frame_number;
+  EntifyGPUTimingType type;
+  // The id of the node that the work was done for.
+  EntifyId id;
+  double gpu_ms;
+};
+
+}  // namespace renderer
+}  // namespace entify
+
+#endif  // _SRC_ENTIFY_RENDERER_GPU_TIMING_H_
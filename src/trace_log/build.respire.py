@@ -0,0 +1,18 @@
+import os
+
+import respire.buildlib.cc as cc
+import respire.buildlib.modules as modules
+
+
+def Build(registry, out_dir, configured_toolchain):
+  if not os.path.exists(out_dir):
+    os.makedirs(out_dir)
+
+  # Both the renderer and the entify library record trace events, so the
+  # trace log is a library of its own that they both depend on.
+  return modules.StaticLibraryModule(
+      'trace_log', registry, out_dir, configured_toolchain,
+      sources=[
+          'trace_log.cc',
+          'trace_log.h',
+      ])
@@ -0,0 +1,150 @@
+#include "src/trace_log/trace_log.h"
+
+#include <atomic>
+#include <cassert>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <mutex>
+
+namespace entify {
+
+namespace {
+// Events are collected in memory and written out in chunks of about this
+// size, so that writing the file does not add to the spans being traced.
+const size_t kWriteThresholdBytes = 64 * 1024;
+
+class TraceLog {
+ public:
+  TraceLog() : start_(std::chrono::steady_clock::now()) {
+    const char* path = std::getenv("ENTIFY_TRACE_PATH");
+    if (!path) {
+      return;
+    }
+
+    file_ = std::fopen(path, "w");
+    if (!file_) {
+      std::cerr << "Could not open trace file '" << path << "'." << std::endl;
+      return;
+    }
+    buffer_ = "{\"traceEvents\":[\n";
+  }
+
+  ~TraceLog() {
+    if (!file_) {
+      return;
+    }
+    buffer_ += "\n]}\n";
+    Write();
+    std::fclose(file_);
+  }
+
+  bool enabled() const { return file_ != nullptr; }
+
+  void AddCompleteEvent(
+      const char* category, const char* name,
+      std::chrono::steady_clock::time_point start,
+      std::chrono::steady_clock::time_point end, const std::string& args) {
+    char event[256];
+    int length = std::snprintf(
+        event, sizeof(event),
+        "{\"cat\":\"%s\",\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,"
+        "\"ts\":%.3f,\"dur\":%.3f,\"args\":{",
+        category, name, GetThreadId(), MicrosecondsSinceStart(start),
+        std::chrono::duration<double, std::micro>(end - start).count());
+    assert(length > 0 && static_cast<size_t>(length) < sizeof(event));
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!first_event_) {
+      buffer_ += ",\n";
+    }
+    first_event_ = false;
+    buffer_.append(event, length);
+    buffer_ += args;
+    buffer_ += "}}";
+
+    if (buffer_.size() >= kWriteThresholdBytes) {
+      Write();
+    }
+  }
+
+ private:
+  // Trace viewers group spans by thread id, and small sequential ids make
+  // for a more readable timeline than the platform's thread ids.
+  static int GetThreadId() {
+    static std::atomic<int> next_thread_id(1);
+    thread_local int thread_id = next_thread_id.fetch_add(1);
+    return thread_id;
+  }
+
+  double MicrosecondsSinceStart(
+      std::chrono::steady_clock::time_point time) const {
+    return std::chrono::duration<double, std::micro>(time - start_).count();
+  }
+
+  void Write() {
+    std::fwrite(buffer_.data(), 1, buffer_.size(), file_);
+    std::fflush(file_);
+    buffer_.clear();
+  }
+
+  const std::chrono::steady_clock::time_point start_;
+  std::FILE* file_ = nullptr;
+
+  std::mutex mutex_;
+  std::string buffer_;
+  bool first_event_ = true;
+};
+
+TraceLog& GetTraceLog() {
+  static TraceLog trace_log;
+  return trace_log;
+}
+}  // namespace
+
+bool IsTracingEnabled() {
+  return GetTraceLog().enabled();
+}
+
+ScopedTraceEvent::ScopedTraceEvent(const char* category, const char* name)
+    : enabled_(IsTracingEnabled()), category_(category), name_(name) {
+  if (enabled_) {
+    start_ = std::chrono::steady_clock::now();
+  }
+}
+
+ScopedTraceEvent::~ScopedTraceEvent() {
+  if (enabled_) {
+    GetTraceLog().AddCompleteEvent(
+        category_, name_, start_, std::chrono::steady_clock::now(), args_);
+  }
+}
+
+void ScopedTraceEvent::AddArg(const char* name, int64_t value) {
+  if (!enabled_) {
+    return;
+  }
+  if (!args_.empty()) {
+    args_ += ",";
+  }
+  args_ += "\"";
+  args_ += name;
+  args_ += "\":";
+  args_ += std::to_string(value);
+}
+
+void ScopedTraceEvent::AddArg(const char* name, const char* value) {
+  if (!enabled_) {
+    return;
+  }
+  if (!args_.empty()) {
+    args_ += ",";
+  }
+  args_ += "\"";
+  args_ += name;
+  args_ += "\":\"";
+  args_ += value;
+  args_ += "\"";
+}
+
+}  // namespace entify
@@ -0,0 +1,39 @@
+#ifndef _SRC_ENTIFY_TRACE_LOG_TRACE_LOG_H_
+#define _SRC_ENTIFY_TRACE_LOG_TRACE_LOG_H_
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+namespace entify {
+
+// Tracing records spans of time to a Chrome trace_event JSON file, which can
+// be loaded into chrome://tracing or Perfetto.  It is enabled by setting the
+// ENTIFY_TRACE_PATH environment variable to the path of the file to write,
+// and is otherwise disabled at the cost of a single check per span.
+bool IsTracingEnabled();
+
+// Records a span from its construction until its destruction, on the
+// calling thread.  |category| and |name| must outlive the object, and are
+// typically string literals.
+class ScopedTraceEvent {
+ public:
+  ScopedTraceEvent(const char* category, const char* name);
+  ~ScopedTraceEvent();
+
+  // Attaches an argument to the span, shown when the span is selected.
+  void AddArg(const char* name, int64_t value);
+  void AddArg(const char* name, const char* value);
+
+ private:
+  bool enabled_;
+  const char* category_;
+  const char* name_;
+  std::chrono::steady_clock::time_point start_;
+  // The arguments, already formatted as JSON object members.
+  std::string args_;
+};
+
+}  // namespace entify
+
+#endif  // _SRC_ENTIFY_TRACE_LOG_TRACE_LOG_H_